@@ -0,0 +1,283 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sensor_channel.h"  // temp_sens_data_t定義用
+#include "sensor_history.h"
+#include "sensor_rollup.h"
+#include "tx_schedule.h"
+
+// ==== 子機レジストリ設定 ====
+#define CHILD_REGISTRY_MAX_NODES    128     // 同時に管理できる子機数（スロット数）
+#define CHILD_NO_MIN                1       // 子機Noの最小値
+#define CHILD_NO_MAX                254     // 子機Noの最大値（uint8_t、0と255は無効）
+#define CHILD_STALE_TIMEOUT_MS      5000    // STALE判定タイムアウト（5秒）
+#define CHILD_EXPIRE_TIMEOUT_MS     60000   // この時間無通信ならスロットを解放（60秒）
+#define CHILD_TIMER_TICK_MS         250     // STALE判定・スロット解放の期限の分解能（タイマーホイールの1バケット）
+#define CHILD_STALE_MISSED_REPORTS  2       // 送信間隔を指示した子機は、この回数分届かなければSTALE
+#define CHILD_SEQ_WINDOW            32      // 重複判定に使う受信履歴（最新seqから遡る個数）
+#define CHILD_SEQ_RESTART_GAP       1024    // これ以上seqが巻き戻ったら子機再起動とみなす
+#define CHILD_SEQ_JUMP_MAX          65536   // これ以上seqが飛んだら欠番ではなく再同期とみなす
+#define CHILD_REGISTRY_MAX_SUBSCRIBERS  4   // 更新通知を受け取るタスク数（表示・Web・SD・上り送信）
+#define CHILD_ROLLUP_MAX_CHILDREN   16      // 集計（1分・1時間・1日）を持てる子機数（測定値を受けた順に割り当て）
+#define CHILD_SEALED_BLOCKS         16      // 保存待ちにできる閉じた履歴ブロック数
+#define CHILD_WARM_MAX_CHILDREN     32      // 再起動をまたいで引き継ぐ子機数（最終受信の新しい順）
+#define CHILD_WARM_MAX_ROLLUPS      6       // 再起動をまたいで集計中バケットを引き継ぐ子機数
+
+// 登録済み子機の参照（子機No昇順で列挙される）
+typedef struct {
+    uint8_t child_no;   // 子機No
+    uint8_t slot;       // スロット番号（0 ～ CHILD_REGISTRY_MAX_NODES-1）
+} child_registry_ref_t;
+
+// seq追跡統計（子機ごと・全体合計）
+typedef struct {
+    uint32_t received;      // 受理した測定値数
+    uint32_t lost;          // 欠番数（推定パケットロス、後から順序逆転で届いた分は差し引く）
+    uint32_t duplicate;     // 重複として破棄した数
+    uint32_t reordered;     // 順序逆転で届いた数
+    uint32_t resync;        // seq再同期回数（子機再起動・大きなジャンプ）
+    uint32_t last_seq;      // 受理した最大seq
+} child_seq_stats_t;
+
+// 最新測定値（コンパクト形式、チャネル値はsensor_channel.hの表の順に詰める）
+typedef sensor_packed_t child_reading_t;
+
+// 子機の公開ビュー（表示・HTTPがロックを取らずに読む最新状態、スロット番号で索引）
+// レジストリが受信・送信間隔の指示・スロット解放・STALE遷移のたびに書き直す。
+typedef struct {
+    child_reading_t reading;        // 最新測定値
+    int64_t commit_us;              // 最新測定値を公開した時刻（esp_timer µs、0=なし・再起動前から引き継いだ値）
+    uint32_t commit_delay_us;       // 最新測定値のソケット受信から公開までの時間（µs）
+    uint32_t last_recv_ms;          // 最終受信時刻（ms）
+    uint32_t version;               // 見える内容が最後に変化した時のバージョン（最終受信時刻だけの更新では変わらない）
+    uint8_t child_no;               // 子機No（0=空きスロット、スロット再利用の検出用）
+    uint8_t has_reading;            // 最新測定値あり
+    uint8_t active;                 // ACTIVE（STALE判定の期限前）
+    uint8_t restored;               // 最新測定値は再起動前に受けたもの（再起動後の受信で0に戻る）
+} child_view_t;
+
+// 公開ビューの読み出し統計
+typedef struct {
+    uint32_t publishes;     // ビューの書き込み回数
+    uint32_t reads;         // 1子機分の読み出し回数
+    uint32_t snapshots;     // 全スロット分の読み出し回数
+    uint32_t retries;       // 書き込みと重なってやり直した回数
+    uint32_t yields;        // やり直しが続いて1tick譲った回数
+    uint32_t version;       // 公開済みの最新バージョン
+    uint32_t notifies;      // 購読タスクへ通知した回数
+} child_view_stats_t;
+
+// STALE判定・スロット解放の期限の統計
+typedef struct {
+    uint32_t armed;         // 期限を設定中の子機数
+    uint32_t fired;         // 期限を迎えた回数（判定時間の延長による付け替えを含む）
+    uint32_t stale;         // ACTIVE → STALE の遷移数
+    uint32_t expired;       // 無通信によるスロット解放数
+} child_timer_stats_t;
+
+// 閉じた履歴ブロックの統計
+typedef struct {
+    uint32_t sealed;        // 保存待ちへ写したブロック数
+    uint32_t dropped;       // 保存待ちが満杯で捨てたブロック数
+    uint32_t pending;       // 保存待ちのブロック数
+} child_sealed_stats_t;
+
+// 再起動をまたいで引き継ぐ子機の状態（warm_restartがRTCメモリに置く）
+// 時刻は起動ごとに0から数え直すため、保存時点からの経過msで持つ
+typedef struct {
+    child_reading_t reading;        // 最新測定値
+    uint32_t source_ip;             // 送信元IPアドレス（ネットワークバイトオーダ）
+    uint32_t age_ms;                // 保存時点での最終受信からの経過
+    uint32_t last_seq;              // 受理した最大seq（seq_valid=0なら無効）
+    uint32_t report_interval_ms;    // 指示済みの送信間隔（0=指示なし）
+    uint8_t child_no;
+    uint8_t seq_valid;
+    uint8_t rollup;                 // child_warm_state_t.rollupsの番号+1（0=なし）
+    uint8_t reserved;
+} child_warm_node_t;
+
+typedef struct {
+    uint32_t count;                 // nodesの件数
+    uint32_t rollup_count;          // rollupsの件数
+    child_warm_node_t nodes[CHILD_WARM_MAX_CHILDREN];
+    // 集計中バケット（start_msは保存時点でのバケット開始からの経過）
+    sensor_rollup_bucket_t rollups[CHILD_WARM_MAX_ROLLUPS][SENSOR_ROLLUP_LEVELS];
+} child_warm_state_t;
+
+// 測定値がACTIVEな子機のものならtrue
+// ACTIVE/STALEはレジストリが期限で遷移させて公開するため、表示・HTTPは経過時間を計算しない
+static inline bool child_view_fresh(const child_view_t *view, uint8_t child_no)
+{
+    return view->child_no == child_no && view->has_reading && view->active;
+}
+
+// 測定値が再起動前から引き継いだもの（まだ再起動後の受信がない子機）ならtrue
+// 経過時間は最終受信時刻（last_recv_ms）から求める
+static inline bool child_view_restored(const child_view_t *view, uint8_t child_no)
+{
+    return view->child_no == child_no && view->has_reading && view->restored;
+}
+
+// 最新測定値をソケットで受信した時刻（esp_timer µs、0=なし）
+static inline int64_t child_view_recv_us(const child_view_t *view)
+{
+    return (view->commit_us != 0) ? view->commit_us - view->commit_delay_us : 0;
+}
+
+// 購読側が処理済みのバージョン（cursor）より後に変化したスロットならtrue（周回を考慮）
+static inline bool child_view_changed(const child_view_t *view, uint32_t cursor)
+{
+    return (int32_t)(view->version - cursor) > 0;
+}
+
+// 初期化（子機テーブル・インデックスを空にする）
+void child_registry_init(void);
+
+// 受信時の更新（未登録なら新規登録、満杯時は最も古いSTALEスロットを回収）
+// 測定値を持たないデータグラム用。測定値はchild_registry_ingest()で反映する
+// source_ip: 送信元IPv4アドレス（ネットワークバイトオーダ）
+// 戻り値: スロット番号、登録できなかった場合は-1
+int child_registry_update(uint8_t child_no, uint32_t source_ip, uint32_t current_time_ms);
+
+// 測定値の受信（登録・seq追跡・最新値の公開・履歴への追記・集計を1回のロックで行う）
+// track_seq=true: readings[0..count-1]から重複・窓外の古い測定値を取り除いて前詰めし、
+//                 最大seqを更新した値を最新値として保持する
+// track_seq=false: seqを送らない子機用。seq判定を行わず末尾の値を最新値とする
+// age_ms: 各測定値の受信時刻（current_time_ms）からさかのぼった測定時刻（バッチフレーム、NULLなら全て0）。
+//         readingsと同じ位置で前詰めする
+// 残った測定値は測定時刻（current_time_ms - age_ms）で履歴へ追記し、集計へ足し込む
+// recv_us: ソケット受信時刻（esp_timer µs、0=不明）。最新値を更新したら公開時刻と合わせて公開ビューに載せ、
+//          受信から公開までの遅延をlatency_traceへ記録する
+// advanced: 最新値が更新された場合true（NULL可）
+// 戻り値: 残った測定値数、登録できなかった場合は-1
+int child_registry_ingest(uint8_t child_no, uint32_t source_ip, uint32_t current_time_ms, int64_t recv_us,
+                          temp_sens_data_t *readings, uint16_t *age_ms, size_t count, bool track_seq,
+                          bool *advanced);
+
+// 測定値の受信（過負荷時の集約用）
+// 引数・戻り値はchild_registry_ingest()と同じ。登録・seq追跡・履歴への追記・集計は同じように行うが、
+// 公開ビューの更新・遅延の記録・購読タスクへの通知はchild_registry_publish_deferred()まで保留する
+int child_registry_ingest_deferred(uint8_t child_no, uint32_t source_ip, uint32_t current_time_ms,
+                                   int64_t recv_us, temp_sens_data_t *readings, uint16_t *age_ms, size_t count,
+                                   bool track_seq, bool *advanced);
+
+// 保留した子機を1回ずつ公開し、変化があれば購読タスクへ1回だけ通知する
+// 最新値を更新した子機は、最後に最新値を更新した測定値の受信時刻からの遅延を記録する
+// 戻り値: 公開したスロット数
+size_t child_registry_publish_deferred(void);
+
+// 最新測定値を取得（ロックなし、どのタスクからでも可）
+// 戻り値: false=未登録・測定値なし・STALE（dataは0クリア）
+bool child_registry_read_latest(uint8_t child_no, temp_sens_data_t *data);
+
+// 1子機分の公開ビューを写す（ロックなし、最新値の有無はchild_view_fresh/child_view_restoredで判定する）
+// 戻り値: false=未登録（viewは0クリア）
+bool child_registry_read_view(uint8_t child_no, child_view_t *view);
+
+// 全スロットの公開ビューを1回で写す（ロックなし、どの受信とも重ならなかった時点の一貫した状態）
+// viewsはCHILD_REGISTRY_MAX_NODES要素、child_registry_list()のslotで索引する
+// 戻り値: 写した状態のバージョン（それまでの変化はすべてviewsに含まれる、次回のcursorに使う）
+uint32_t child_registry_snapshot(child_view_t *views);
+
+// 公開済みの最新バージョン（ロックなし）。購読側のcursorと異なれば変化がある
+uint32_t child_registry_version(void);
+
+// 更新通知の購読（起動時に1回、購読するタスク自身のTaskHandle_tを渡す）
+// 見える内容が変化するたびにxTaskNotifyGive()で起こす。購読側はulTaskNotifyTake()で待ち、
+// child_registry_snapshot()で写してchild_view_changed()のスロットだけを処理する
+// 戻り値: false=購読数の上限（CHILD_REGISTRY_MAX_SUBSCRIBERS）
+bool child_registry_subscribe(void *task);
+
+// 公開ビューの読み出し統計
+void child_registry_get_view_stats(child_view_stats_t *stats);
+
+// 子機ごとのseq統計を取得、未登録ならfalse
+bool child_registry_get_seq_stats(uint8_t child_no, child_seq_stats_t *stats);
+
+// 子機の測定値履歴を写す（1子機分をロック内でコピー、復号はsensor_history_seek/nextで行う）
+// 未登録ならfalse
+bool child_registry_copy_history(uint8_t child_no, sensor_history_t *history);
+
+// 閉じた履歴ブロックの取り出しタスク（起動時に1回、取り出すタスク自身のTaskHandle_tを渡す）
+// 保存待ちへ写すたびにxTaskNotifyGive()で起こす。取り出し側はulTaskNotifyTake()で待ち、
+// child_registry_take_sealed()がfalseを返すまで取り出す
+void child_registry_set_sealed_consumer(void *task);
+
+// 閉じた履歴ブロック（満杯になったブロック・解放した子機の最後のブロック）を古い順に1つ取り出す
+// blockはSENSOR_HISTORY_BLOCK_BYTES。戻り値: false=保存待ちなし
+bool child_registry_take_sealed(uint8_t *child_no, uint8_t *block);
+
+// 閉じた履歴ブロックの統計
+void child_registry_get_sealed_stats(child_sealed_stats_t *stats);
+
+// 子機の集計を写す（集計中のバケットは写した側でsensor_rollup_roll()してから読む）
+// 未登録・集計領域の割り当てがなければfalse
+bool child_registry_copy_rollup(uint8_t child_no, sensor_rollup_t *rollup);
+
+// 全子機のseq統計合計（解放済みスロットの分も含む）
+void child_registry_get_seq_totals(child_seq_stats_t *stats);
+
+// 送信元IPを取得（ネットワークバイトオーダ）、未登録ならfalse
+bool child_registry_get_source_ip(uint8_t child_no, uint32_t *source_ip);
+
+// 子機へ指示した送信間隔を記録（STALE判定に使う）
+// 間隔を短くした場合は、子機が指示を受け取ったと見なせる次の受信まで旧間隔で判定する
+void child_registry_set_report_interval(uint8_t child_no, uint32_t interval_ms);
+
+// 到着位相・揺らぎを取得、未登録ならfalse（送信間隔を指示するまではinterval_ms=0）
+bool child_registry_get_tx_phase(uint8_t child_no, tx_phase_t *phase);
+
+// 送信位相の補正を指示した後に呼ぶ（補正前の到着で位相を測らないよう基準を取り直す）
+void child_registry_restart_tx_phase(uint8_t child_no);
+
+// 全子機の到着統計（近接到着数）
+void child_registry_get_arrival_stats(tx_arrival_stats_t *stats);
+
+// 子機No → スロット番号（O(1)）、未登録なら-1
+int child_registry_slot_of(uint8_t child_no);
+
+// 送信元IP → 子機No（O(1)ハッシュ検索）
+bool child_registry_find_by_ip(uint32_t source_ip, uint8_t *child_no);
+
+// 登録済み子機を子機No昇順で列挙（登録済みエントリのみ走査、ロックなし、どのタスクからでも可）
+// 列挙中に登録・解放された子機は含まれないことがある。slotの中身は公開ビューの子機Noで確かめること
+// 戻り値: outに格納した件数
+size_t child_registry_list(child_registry_ref_t *out, size_t max_count);
+
+// 1台でもACTIVEな子機があればtrue（O(1)、ロックなし）
+bool child_registry_has_active(void);
+
+// ACTIVEな子機数（O(1)、ロックなし）
+size_t child_registry_count_active(void);
+
+// 期限を迎えた子機だけをSTALEへ遷移・スロット解放し、購読タスクへ通知する（子機監視タスクから呼び出す）
+// 期限は受信のたびに付け替えるため、処理は期限を迎えた子機数に比例し、登録数には比例しない
+// 戻り値: 次に期限を確認すべき時刻までのms（最大CHILD_EXPIRE_TIMEOUT_MS）
+uint32_t child_registry_check_timeouts(uint32_t current_time_ms);
+
+// 期限の統計
+void child_registry_get_timer_stats(child_timer_stats_t *stats);
+
+// 再起動をまたいで引き継ぐ状態を写す（最終受信の新しい順にCHILD_WARM_MAX_CHILDREN台まで、
+// 集計はそのうち集計領域を持つ先頭CHILD_WARM_MAX_ROLLUPS台の集計中バケット）
+// 戻り値: 写した子機数
+size_t child_registry_save_warm(child_warm_state_t *state, uint32_t current_time_ms);
+
+// 引き継いだ状態を登録する（child_registry_init()の直後、受信を始める前に1回呼ぶ）
+// 子機はSTALE・restored=1で登録し、最終受信時刻はcurrent_time_msから保存時点の経過を引いた時刻とする。
+// 再起動後の受信がなければ、current_time_msからCHILD_EXPIRE_TIMEOUT_MSでスロットを解放する
+// 戻り値: 登録した子機数
+size_t child_registry_restore_warm(const child_warm_state_t *state, uint32_t current_time_ms);
+
+// メモリ使用量と登録状況をsyslogへ出力
+void child_registry_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
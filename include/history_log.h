@@ -0,0 +1,99 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sensor_history.h"
+
+// ==== 測定値履歴のフラッシュログ（セクタを巡回する追記専用ログ） ====
+// 閉じた履歴ブロック（sensor_codecの形式、SENSOR_HISTORY_BLOCK_BYTES）を子機No付きのレコードとして追記する。
+// セクタを順に使い、最後のセクタの次は最も古いセクタを消去して再利用するため、消去回数は全セクタで均等になる。
+//   セクタ: [ヘッダ HISTORY_LOG_HEADER_BYTES][レコード × HISTORY_LOG_RECORDS_PER_SECTOR]
+//     ヘッダ: magic u32, seq u32（セクタを始めるたびに+1）, erase_count u32, boot u16, 予備 u16, crc32 u32
+//   レコード: [child_no u8][0xFF][boot u16][crc32 u32][ブロック]
+//     ブロックを書いてからヘッダを書く（ヘッダの書き込みが確定）。ヘッダが消去状態なら空き
+// 起動時の復旧はセクタのヘッダだけを読んで最大のseqを書き込み中のセクタとし、
+// そのセクタのレコードヘッダから追記位置を求める（全体は読まない）。
+// 書き込み途中の電源断は、crc不一致のレコード・ヘッダのないセクタとして読み飛ばす。
+// 時刻は起動からのmsのため、レコードに起動番号（boot、ログを開くたびに+1）を付けて区別する。
+// フラッシュの読み書き・消去は呼び出し側の関数で行い、排他も呼び出し側で行う。
+// FreeRTOS/ESP-IDFに依存しないため、ホスト側ツールでも同じコードを使える。
+#define HISTORY_LOG_SECTOR_BYTES        4096
+#define HISTORY_LOG_HEADER_BYTES        20
+#define HISTORY_LOG_RECORD_HEADER_BYTES 8
+#define HISTORY_LOG_BLOCK_BYTES         SENSOR_HISTORY_BLOCK_BYTES
+#define HISTORY_LOG_RECORD_BYTES        (HISTORY_LOG_RECORD_HEADER_BYTES + HISTORY_LOG_BLOCK_BYTES)
+#define HISTORY_LOG_RECORDS_PER_SECTOR  ((HISTORY_LOG_SECTOR_BYTES - HISTORY_LOG_HEADER_BYTES) / HISTORY_LOG_RECORD_BYTES)
+#define HISTORY_LOG_MIN_SECTORS         2
+
+// フラッシュの操作（offsetはログ領域の先頭からのバイト位置）。失敗ならfalse
+// write: 消去状態（0xFF）のバイトへ書く（1→0のみ）、erase: offsetから1セクタを0xFFにする
+typedef struct {
+    bool (*read)(void *ctx, uint32_t offset, void *buf, size_t len);
+    bool (*write)(void *ctx, uint32_t offset, const void *buf, size_t len);
+    bool (*erase)(void *ctx, uint32_t offset);
+    void *ctx;
+} history_log_flash_t;
+
+// 統計
+typedef struct {
+    uint32_t appends;           // 追記したレコード数
+    uint32_t erases;            // 消去したセクタ数（開いてから）
+    uint32_t write_errors;      // 書き込み・消去の失敗数
+    uint32_t recovery_reads;    // 開く時に読んだバイト数
+    uint32_t recovery_skipped;  // 開く時に読み飛ばした書きかけのレコード数
+} history_log_stats_t;
+
+typedef struct {
+    history_log_flash_t flash;
+    uint16_t sectors;           // ログ領域のセクタ数
+    uint16_t head;              // 書き込み中のセクタ（物理番号）
+    uint32_t head_seq;          // 書き込み中のセクタのseq（0=空のログ）
+    uint16_t next_record;       // 書き込み中のセクタの次の追記位置
+    uint16_t boot;              // 今回の起動番号
+    uint16_t used_sectors;      // 有効なヘッダのあるセクタ数（開く時・セクタを始める時に数える）
+    uint32_t min_erases;        // ヘッダに記録された消去回数の最小・最大（同上）
+    uint32_t max_erases;
+    history_log_stats_t stats;
+} history_log_t;
+
+// 読み出したレコード
+typedef struct {
+    uint8_t child_no;
+    uint16_t boot;              // 書いた時の起動番号
+    uint32_t sector_seq;        // 書かれているセクタのseq（古い順の比較用）
+    uint8_t block[HISTORY_LOG_BLOCK_BYTES];
+} history_log_record_t;
+
+// 古い順の読み出し位置（history_log_iter_begin()で初期化し、history_log_iter_next()で1件ずつ取り出す）
+typedef struct {
+    const history_log_t *log;
+    uint16_t sector;            // 最も古いセクタからの順番
+    uint16_t record;
+    uint32_t sector_seq;        // 読み出し中のセクタのseq（0=無効なセクタ）
+    uint32_t skipped;           // 読み飛ばしたレコード数（crc不一致）
+} history_log_iter_t;
+
+// ログを開く（セクタのヘッダを読んで書き込み位置を復旧し、起動番号を進める）
+// sectors: HISTORY_LOG_MIN_SECTORS以上。戻り値: false=引数不正・読み出し失敗
+bool history_log_open(history_log_t *log, const history_log_flash_t *flash, uint16_t sectors);
+
+// 閉じたブロックを追記する（書き込み中のセクタが満杯なら次のセクタを消去して始める）
+// 戻り値: false=書き込み・消去の失敗（そのレコード位置は使わずに次へ進む）
+bool history_log_append(history_log_t *log, uint8_t child_no, const uint8_t *block);
+
+// 古い順に読む
+void history_log_iter_begin(history_log_iter_t *it, const history_log_t *log);
+bool history_log_iter_next(history_log_iter_t *it, history_log_record_t *record);
+
+// 使用中のセクタ数と、セクタのヘッダに記録された消去回数の最小・最大
+// （開く時・セクタを始める時に数えた値を返す。フラッシュは読まない）
+size_t history_log_wear(const history_log_t *log, uint32_t *min_erases, uint32_t *max_erases);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "history_log.h"
+
+// ==== 測定値履歴のフラッシュ保存 ====
+// userdataパーティションのうち、先頭セクタ（flash_data.cの設定）より後ろをhistory_logの領域として使い、
+// 子機レジストリで閉じた履歴ブロックを、保存タスクが閉じるたびの通知で起きて取り出し、追記する。
+// 起動時にセクタのヘッダから書き込み位置を復旧し、それまでの起動で保存したブロックを読み出せる。
+// 書き込み中のブロック（閉じる前の測定値）は電源断で失われる。
+
+// 保存の状態
+typedef struct {
+    bool ready;                 // ログ領域を開けた
+    uint16_t sectors;           // ログ領域のセクタ数
+    uint16_t used_sectors;      // ヘッダのあるセクタ数
+    uint16_t boot;              // 今回の起動番号
+    uint32_t head_seq;          // 書き込み中のセクタのseq
+    uint32_t min_erases;        // セクタの消去回数（ヘッダに記録された値）の最小・最大
+    uint32_t max_erases;
+    history_log_stats_t log;
+} history_store_stats_t;
+
+// 保存タスクを起動（ログ領域を開いてから、保存待ちの取り出しを始める）
+void start_history_store_task(void);
+
+// 保存したブロックを古い順に読む（1件ごとに保存タスクと排他する）
+// 戻り値: false=ログ領域を開いていない
+bool history_store_iter_begin(history_log_iter_t *it);
+bool history_store_iter_next(history_log_iter_t *it, history_log_record_t *record);
+
+// 保存の状態（フラッシュは読まない。/sensor/statsのポーリングごとに呼んでよい）
+void history_store_get_stats(history_store_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,81 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ==== 送信元IPごとの受信レート制限（トークンバケット） ====
+// 受信段でrecvfrom直後（デコード前）に呼び、送信元ごとの上限を超えたデータグラムを捨てる。
+// 送信元はオープンアドレス法ハッシュ（線形探査、後方シフト削除）でO(1)検索する。
+// 表の更新は受信段のタスクだけが行う。統計はどのタスクからでも読めるが、削除と重なると近似値になる。
+// FreeRTOS/ESP-IDFに依存しないため、ホスト側ツールでも同じコードを使える。
+#define INGEST_ADMIT_TABLE_SIZE     256     // 2のべき乗
+#define INGEST_ADMIT_MAX_SOURCES    128     // 追跡する送信元数（表の使用率を1/2以下に保つ）
+#define INGEST_ADMIT_IDLE_MS        60000   // この時間受信がない送信元は表から外す
+#define INGEST_ADMIT_RATE_PER_SEC   20      // 送信元ごとの平均上限（データグラム/秒）
+#define INGEST_ADMIT_BURST          40      // 送信元ごとの瞬間的な上限（バケット容量）
+
+// 判定結果
+typedef enum {
+    INGEST_ADMIT_PASS = 0,      // 受け付ける
+    INGEST_ADMIT_DROP,          // 上限超過で捨てる
+    INGEST_ADMIT_DROP_START,    // 上限超過で捨てる（この送信元で超過が始まった、ログ用）
+} ingest_admit_t;
+
+typedef struct {
+    _Atomic uint32_t source_ip;     // 送信元IP（ネットワークバイトオーダ、0=空き）
+    _Atomic uint32_t admitted;      // 受け付けた数
+    _Atomic uint32_t dropped;       // 捨てた数
+    uint32_t tokens_milli;          // 残りトークン（1/1000データグラム単位）
+    uint32_t last_ms;               // 最後にトークンを補充した時刻
+    bool limited;                   // 超過中（バケットが満杯に戻るまで）
+} ingest_admission_entry_t;
+
+typedef struct {
+    ingest_admission_entry_t table[INGEST_ADMIT_TABLE_SIZE];
+    ingest_admission_entry_t shared;    // 表が満杯の時に新しい送信元がまとめて使うバケット
+    uint32_t rate_per_sec;
+    uint32_t burst;
+    uint32_t sweep_pos;                 // 期限切れ確認の位置（1回の判定で1要素ずつ進める）
+    _Atomic uint32_t sources;           // 追跡中の送信元数
+    _Atomic uint32_t admitted;          // 受け付けた数（全体）
+    _Atomic uint32_t dropped;           // 捨てた数（全体）
+} ingest_admission_t;
+
+// 送信元ごとの統計
+typedef struct {
+    uint32_t source_ip;     // 0=表に入りきらなかった送信元の合計
+    uint32_t admitted;
+    uint32_t dropped;
+} ingest_admission_source_t;
+
+// 全体の統計
+typedef struct {
+    uint32_t rate_per_sec;
+    uint32_t burst;
+    uint32_t sources;       // 追跡中の送信元数
+    uint32_t admitted;
+    uint32_t dropped;
+} ingest_admission_stats_t;
+
+// 初期化（rate_per_sec: 平均上限、burst: バケット容量、どちらも1以上）
+// 戻り値: false=引数不正
+bool ingest_admission_init(ingest_admission_t *adm, uint32_t rate_per_sec, uint32_t burst);
+
+// 受信段から1データグラムごとに呼ぶ
+ingest_admit_t ingest_admission_check(ingest_admission_t *adm, uint32_t source_ip, uint32_t now_ms);
+
+// 捨てた数が1以上の送信元を列挙（表が満杯の時の合計はsource_ip=0）
+// 戻り値: outに格納した件数
+size_t ingest_admission_list_dropping(const ingest_admission_t *adm, ingest_admission_source_t *out, size_t max_count);
+
+void ingest_admission_get_stats(const ingest_admission_t *adm, ingest_admission_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
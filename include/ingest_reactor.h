@@ -0,0 +1,28 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+// ==== 受信リアクタ設定 ====
+#define INGEST_REACTOR_MAX_SOCKETS  4   // 監視できるソケット数（UDP受信、Ethernet側、制御ポート等）
+
+// ソケットが読み込み可能になった時に呼ばれるハンドラ
+// ソケットは非ブロッキングに設定済み。ハンドラはEWOULDBLOCKまで読み切ること。
+typedef void (*ingest_reactor_handler_t)(int sock, void *ctx);
+
+// リアクタタスクを指定コアで起動（select()で全ソケットを同時に待つ）
+void start_ingest_reactor_task(int core_id);
+
+// 監視対象ソケットを追加（起動前・起動後どちらでも可）
+// 戻り値: true=登録成功, false=満杯または引数不正
+bool ingest_reactor_add_socket(int sock, ingest_reactor_handler_t handler, void *ctx);
+
+// 監視対象ソケットを削除（ソケットのクローズは呼び出し側で行う）
+bool ingest_reactor_remove_socket(int sock);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ==== 遅延ヒストグラム ====
+// µs単位の遅延を2のべき乗幅のバケットで数える（O(1)）。
+// バケット0は0～1µs、バケットi（1以上）は2^i～2^(i+1)-1µs、最後のバケットはそれ以上すべて。
+// 分位点はバケットの上端（最大値を超えない）で返すため、実際の値より小さくはならない。
+// FreeRTOS/ESP-IDFに依存しないため、ホスト側ツールでも同じコードを使える。
+#define LATENCY_HIST_BUCKETS    24      // 最後のバケットは2^23µs（約8.4秒）以上
+
+typedef struct {
+    uint32_t count;                             // 記録数
+    uint32_t max_us;                            // 最大値
+    uint64_t sum_us;                            // 合計（平均用）
+    uint32_t buckets[LATENCY_HIST_BUCKETS];
+} latency_hist_t;
+
+// 空にする
+void latency_hist_reset(latency_hist_t *hist);
+
+// 遅延を1件数える（負の値は0、uint32_tを超える値はUINT32_MAXとして数える）
+void latency_hist_add(latency_hist_t *hist, int64_t us);
+
+// バケットの上端（µs、この値を含む）。最後のバケットはUINT32_MAX
+uint32_t latency_hist_bucket_max_us(size_t bucket);
+
+// 平均（µs）。count=0なら0
+uint32_t latency_hist_mean_us(const latency_hist_t *hist);
+
+// 分位点（permille=500で中央値、990で99%点）の上限（µs）。count=0なら0
+uint32_t latency_hist_percentile_us(const latency_hist_t *hist, uint32_t permille);
+
+#ifdef __cplusplus
+}
+#endif
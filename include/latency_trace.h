@@ -0,0 +1,39 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "latency_hist.h"
+
+// ==== 測定値の遅延計測 ====
+// 測定値にesp_timerの時刻（64bit µs）を、ソケット受信・子機レジストリでの公開・/sensor/dataの直列化・
+// 表示の描画で付け、区間ごとの遅延をヒストグラム（latency_hist）へ足し込む。
+// 子機の送信時刻は親機の時計と揃っていないため、最初の時刻はソケット受信とする。
+// HTTP・表示は同じ測定値を繰り返し出すため、測定値ごとに最初に出した時だけ数える。
+typedef enum {
+    LATENCY_RECV_TO_COMMIT = 0,     // ソケット受信 → 公開（受信リング・デコード・ロック待ち）
+    LATENCY_COMMIT_TO_HTTP,         // 公開 → /sensor/dataの直列化（ポーリング・更新通知の待ちを含む）
+    LATENCY_COMMIT_TO_DISPLAY,      // 公開 → 表示の描画（ページ送り・描画間隔の待ちを含む）
+    LATENCY_RECV_TO_HTTP,           // ソケット受信 → /sensor/data（全体）
+    LATENCY_RECV_TO_DISPLAY,        // ソケット受信 → 表示（全体）
+    LATENCY_STAGES
+} latency_stage_t;
+
+// 区間の遅延を記録（どのタスクからでも可、from_us=0は時刻なしとして記録しない）
+void latency_trace_record(latency_stage_t stage, int64_t from_us, int64_t to_us);
+
+// 区間のヒストグラムを写す
+void latency_trace_get(latency_stage_t stage, latency_hist_t *hist);
+
+// 区間の名前（"recv_commit"等、/sensor/statsのキー）
+const char *latency_trace_stage_name(latency_stage_t stage);
+
+// すべての区間を空にする
+void latency_trace_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,34 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ==== 受信生データキャプチャ（デバッグ用） ====
+// 子機ごとに生ペイロードを保持する代わりに、全子機共通の固定長リングへ直近の受信データを残す。
+// 実行時スイッチ（コンソール "rawcap on/off"）がオンの時だけ記録し、オフ時はフラグ判定のみ。
+// RAW_CAPTURE_ENABLEを0にするとリング自体を確保しない。
+#ifndef RAW_CAPTURE_ENABLE
+#define RAW_CAPTURE_ENABLE      1
+#endif
+#define RAW_CAPTURE_ENTRIES     8       // 保持するデータグラム数
+#define RAW_CAPTURE_DATA_SIZE   256     // 1件あたりの最大保持バイト数
+
+// 記録のオン/オフ（起動時はオフ）
+void raw_capture_set_enabled(bool enabled);
+bool raw_capture_is_enabled(void);
+
+// データグラムを記録（オフ時は何もしない）
+// source_ip: 送信元IPv4アドレス（ネットワークバイトオーダ）
+void raw_capture_put(uint32_t source_ip, uint32_t recv_time_ms, const void *data, size_t len);
+
+// 記録内容を古い順にsyslogへ出力（テキストはそのまま、バイナリは16進）
+void raw_capture_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
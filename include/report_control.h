@@ -0,0 +1,51 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ==== 子機送信間隔の下り制御 ====
+// 受信負荷・受信リング使用数・表示先の有無からreport_policyで送信間隔を決め、
+// 子機レジストリの送信元IPへ制御フレーム（sensor_frame version 3）を送る。
+// 送信位相の割り当てが有効なら、スロット番号ごとの目標位相（tx_schedule）へ子機の送信をずらす。
+#define REPORT_CONTROL_REFRESH_MS   10000   // 指示が変わらなくてもこの間隔で再送（UDPの取りこぼし対策）
+#define REPORT_SCHEDULE_WINDOW_MS   10000   // 到着統計（近接到着率・ロス率）の集計区間
+
+typedef struct {
+    uint32_t interval_ms;       // 現在の指示間隔
+    uint8_t backoff;            // 過負荷による倍率
+    bool overloaded;            // 直近の周期で過負荷と判定した
+    bool viewer_active;         // HTTPクライアントが閲覧中
+    bool display_active;        // ディスプレイがセンサ表示中
+    uint32_t active_children;   // ACTIVEな子機数
+    uint16_t ctrl_seq;          // 現在の指示の通番
+    uint32_t frames_sent;       // 送信した制御フレーム数（累計）
+    uint32_t send_errors;       // 送信失敗数（累計）
+    // 送信位相の割り当て
+    bool schedule_enabled;      // 位相の補正を行う
+    uint16_t phase_seq;         // 最後に送った位相補正の通番
+    uint32_t phase_shifts;      // 送った位相補正の数（累計）
+    uint32_t scheduled_children;// 現在の間隔で位相を測定できた子機数
+    uint32_t aligned_children;  // うち目標位相の許容範囲内の子機数
+    uint32_t jitter_ms;         // 到着揺らぎの平均（scheduled_children）
+    uint16_t close_permille;    // 直近の集計区間の近接到着率（‰）
+    uint16_t loss_permille;     // 直近の集計区間の欠番率（‰）
+} report_control_status_t;
+
+// 初期化（送信ソケットを作成）
+bool report_control_init(void);
+
+// 1周期分の制御（子機監視タスクから1秒ごとに呼び出す）
+void report_control_tick(uint32_t current_time_ms);
+
+void report_control_get_status(report_control_status_t *status);
+
+// 送信位相の補正の有効/無効（無効にしても到着統計の集計は続ける、比較用）
+void report_control_set_schedule(bool enable);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,54 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ==== 子機送信間隔の決定ポリシー ====
+// 表示先（HTTP・ディスプレイ）の有無で基本間隔を決め、受信負荷に応じて引き延ばす。
+// FreeRTOS/ESP-IDFに依存しないため、ホスト側ツールでも同じ制御ループを動かせる。
+#define REPORT_INTERVAL_MIN_MS          1000    // 指示する最短間隔
+#define REPORT_INTERVAL_MAX_MS          20000   // 指示する最長間隔
+#define REPORT_INTERVAL_VIEWER_MS       2000    // HTTPクライアントが閲覧中（ダッシュボードの更新周期）
+#define REPORT_INTERVAL_DISPLAY_MS      5000    // ディスプレイのみ表示中
+#define REPORT_INTERVAL_IDLE_MS         20000   // 誰も見ていない
+#define REPORT_RX_BUDGET_PER_SEC        100     // 処理段が余裕を持って捌ける測定値数/秒（全子機合計）
+#define REPORT_BACKOFF_MAX              8       // 過負荷時の間隔倍率の上限（2のべき乗）
+#define REPORT_CALM_TICKS_TO_RECOVER    5       // 倍率を半分に戻すまでに必要な平穏な周期数（基本値）
+#define REPORT_ESCALATE_HOLD_TICKS      2       // 倍率を上げた後、指示が効くまで次の引き上げを待つ周期数
+#define REPORT_PROBE_STRIKES_MAX        4       // 戻した直後の過負荷で待ち周期数を倍にする上限回数
+
+// 1周期分の入力（前回の周期からの差分）
+typedef struct {
+    uint32_t active_children;   // ACTIVEな子機数
+    uint32_t ring_pending;      // 受信リングの現在の使用数
+    uint32_t ring_capacity;     // 受信リングの要素数
+    uint32_t overflow_delta;    // リング満杯で破棄したデータグラム数
+    uint32_t coalesce_delta;    // 過負荷で最新値に集約した回数
+    bool viewer_active;         // HTTPクライアントが閲覧中
+    bool display_active;        // ディスプレイがセンサ表示中
+} report_policy_input_t;
+
+typedef struct {
+    uint32_t interval_ms;       // 現在の指示間隔
+    uint8_t backoff;            // 過負荷による倍率（1,2,4,..REPORT_BACKOFF_MAX）
+    uint8_t calm_ticks;         // 過負荷なしで経過した周期数
+    uint8_t hold_ticks;         // 次の引き上げまでの残り周期数
+    uint8_t since_recover;      // 最後に倍率を戻してからの周期数
+    uint8_t strikes;            // 戻した直後に過負荷になった回数（待ち周期数 = 基本値 << strikes）
+    bool overloaded;            // 直近の周期で過負荷と判定した
+} report_policy_t;
+
+void report_policy_init(report_policy_t *policy);
+
+// 1周期分の入力から指示間隔を更新（過負荷なら倍率を上げ、平穏が続けば徐々に戻す）
+// 戻した直後に過負荷になった場合は次に戻すまでの待ちを延ばし、処理能力付近での振動を抑える
+// 戻り値: 新しい指示間隔（ms）
+uint32_t report_policy_update(report_policy_t *policy, const report_policy_input_t *in);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,168 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ==== センサチャネル定義 ====
+// 子機が送る測定値の種類はこの表だけで定義する。
+// JSON・旧形式のデコード、/sensor/dataと上り送信のJSON、ログ・SSD1306の表示、HTMLページのカード、
+// 子機ごとのコンパクト格納はすべてこの表から生成されるため、新しいセンサは行を追加するだけでよい。
+// チャネル番号は表の順なので、行は末尾に追加する（最大32チャネル）。
+//
+// X(ID, key, label, name, decimals, unit, type, group)
+//   ID:       チャネル識別子（SENSOR_CH_<ID>）
+//   key:      JSONキー（値は10^decimals倍の整数）
+//   label:    短い表示名（ログ・SSD1306）。旧形式では実単位の小数で値を送るキーを兼ねる（N/S/R以外）
+//   name:     HTMLページの表示名
+//   decimals: 小数桁（実単位の値 = 整数値 / 10^decimals）
+//   unit:     単位（ASCII、SSD1306のフォントで表示できる文字）
+//   type:     コンパクト格納の幅（U8/I16/U16/I32）。範囲外の値は飽和させる
+//   group:    測定成功フラグの組（SENSOR_GROUP_TABLEの要素、NONE=フラグなし）
+#define SENSOR_CHANNEL_TABLE(X) \
+    X(AHT_T,  "aht_t01",  "T",  "温度",      1, "C",   I16, AHT) \
+    X(AHT_RH, "aht_rh01", "RH", "湿度",      1, "%",   U16, AHT) \
+    X(BMP_T,  "bmp_t01",  "BT", "温度(BMP)", 1, "C",   I16, BMP) \
+    X(BMP_P,  "bmp_p01",  "P",  "気圧",      1, "hPa", I32, BMP)
+
+// 追加例（フラグなしのチャネルは、値が届いた時だけ有効）:
+//   X(CO2,    "co2",      "CO2", "CO2",     0, "ppm", U16, NONE)
+//   X(LUX,    "lux01",    "L",   "照度",    1, "lx",  I32, NONE)
+
+// 測定成功フラグの組
+// X(ID, ok_key)
+//   ok_key: JSONキー（false=この組のチャネルはすべて無効、出力時は組のチャネルがすべて有効ならtrue）
+#define SENSOR_GROUP_TABLE(X) \
+    X(AHT, "aht_ok") \
+    X(BMP, "bmp_ok")
+
+// ==== 表から生成する定義 ====
+typedef enum {
+#define SENSOR_CH_ENUM(id, key, label, name, decimals, unit, type, group) SENSOR_CH_##id,
+    SENSOR_CHANNEL_TABLE(SENSOR_CH_ENUM)
+#undef SENSOR_CH_ENUM
+    SENSOR_CH_COUNT
+} sensor_ch_t;
+
+typedef enum {
+#define SENSOR_GROUP_ENUM(id, ok_key) SENSOR_GROUP_##id,
+    SENSOR_GROUP_TABLE(SENSOR_GROUP_ENUM)
+#undef SENSOR_GROUP_ENUM
+    SENSOR_GROUP_COUNT,
+    SENSOR_GROUP_NONE = SENSOR_GROUP_COUNT,     // フラグなし
+} sensor_group_t;
+
+typedef enum {
+    SENSOR_CH_TYPE_U8 = 0,
+    SENSOR_CH_TYPE_I16,
+    SENSOR_CH_TYPE_U16,
+    SENSOR_CH_TYPE_I32,
+} sensor_ch_type_t;
+
+#define SENSOR_CH_WIDTH_U8      1
+#define SENSOR_CH_WIDTH_I16     2
+#define SENSOR_CH_WIDTH_U16     2
+#define SENSOR_CH_WIDTH_I32     4
+
+// 表から合計を求める補助マクロ（SENSOR_CH_PACKED_SIZE等の展開に使うため#undefしない）
+#define SENSOR_CH_ADD_WIDTH(id, key, label, name, decimals, unit, type, group) + SENSOR_CH_WIDTH_##type
+#define SENSOR_CH_ADD_JSON_LEN(id, key, label, name, decimals, unit, type, group) + sizeof(key) + 14
+#define SENSOR_GROUP_ADD_JSON_LEN(id, ok_key) + sizeof(ok_key) + 8
+#define SENSOR_CH_ADD_TEXT_LEN(id, key, label, name, decimals, unit, type, group) + sizeof(label) + sizeof(unit) + 13
+
+#define SENSOR_CH_PACKED_SIZE   (0 SENSOR_CHANNEL_TABLE(SENSOR_CH_ADD_WIDTH))      // 全チャネルを詰めたバイト数
+#define SENSOR_CH_VALID_BYTES   ((SENSOR_CH_COUNT + 7) / 8)
+// sensor_data_write_json()の最大長（NUL終端を含む）: "key":-2147483648, と "ok_key":false, の合計
+#define SENSOR_DATA_JSON_MAX    (1 SENSOR_CHANNEL_TABLE(SENSOR_CH_ADD_JSON_LEN) SENSOR_GROUP_TABLE(SENSOR_GROUP_ADD_JSON_LEN))
+// sensor_data_format()の最大長（NUL終端を含む）: " label=-214748364.8unit" の合計
+#define SENSOR_DATA_TEXT_MAX    (1 SENSOR_CHANNEL_TABLE(SENSOR_CH_ADD_TEXT_LEN))
+
+// チャネルの属性
+typedef struct {
+    const char *key;
+    const char *label;
+    const char *name;
+    const char *unit;
+    uint8_t key_len;
+    uint8_t label_len;
+    uint8_t decimals;
+    uint8_t type;       // sensor_ch_type_t
+    uint8_t group;      // sensor_group_t
+} sensor_channel_t;
+
+// ==== 測定値 ====
+// デコード後の作業形式（受信リング・バッチ処理用、チャネル番号で索引）
+typedef struct temp_sens_data {
+    int32_t ch[SENSOR_CH_COUNT];    // チャネル値（10^decimals倍の整数、例：aht_t01=253 → 25.3℃）
+    uint32_t ch_valid;              // bit n = SENSOR_CH_n の値あり（今回の測定成功）
+    uint32_t seq;                   // 送信ごとにインクリメントする連番
+    int rssi;                       // RSSI値（dBm、通常-100～0、取得失敗時は0）
+} temp_sens_data_t;
+
+// コンパクト形式（子機ごとの最新値の保持用、チャネル値は表の順に格納幅で詰める）
+typedef struct {
+    uint32_t seq;
+    int8_t rssi;
+    uint8_t valid[SENSOR_CH_VALID_BYTES];   // bit n = SENSOR_CH_n の値あり
+    uint8_t values[SENSOR_CH_PACKED_SIZE];
+} sensor_packed_t;
+
+// チャネルの属性、範囲外ならNULL
+const sensor_channel_t *sensor_channel_get(sensor_ch_t ch);
+
+// 測定成功フラグのJSONキー、範囲外ならNULL
+const char *sensor_group_ok_key(sensor_group_t group);
+
+// 組に属するチャネルのビットマスク（bit n = SENSOR_CH_n）
+uint32_t sensor_group_mask(sensor_group_t group);
+
+// JSONキー・短い表示名 → チャネル番号、該当なしなら-1
+int sensor_channel_find_key(const char *key, size_t len);
+int sensor_channel_find_label(const char *label, size_t len);
+
+// 測定成功フラグのJSONキー → 組、該当なしなら-1
+int sensor_group_find_key(const char *key, size_t len);
+
+// 値を格納幅に飽和させて設定し、有効にする
+void sensor_data_set(temp_sens_data_t *data, sensor_ch_t ch, int64_t value);
+
+// 測定成功フラグを反映（ok=falseなら組のチャネルをすべて無効にする、値は残す）
+void sensor_data_apply_group(temp_sens_data_t *data, sensor_group_t group, bool ok);
+
+static inline bool sensor_data_valid(const temp_sens_data_t *data, sensor_ch_t ch)
+{
+    return (data->ch_valid & (1u << ch)) != 0;
+}
+
+// 組のチャネルがすべて有効ならtrue
+static inline bool sensor_data_group_ok(const temp_sens_data_t *data, sensor_group_t group)
+{
+    uint32_t mask = sensor_group_mask(group);
+    return mask != 0 && (data->ch_valid & mask) == mask;
+}
+
+// 作業形式 ⇔ コンパクト形式
+void sensor_data_pack(const temp_sens_data_t *data, sensor_packed_t *packed);
+void sensor_data_unpack(const sensor_packed_t *packed, temp_sens_data_t *data);
+
+// チャネル値を実単位の小数で書式化（例: 253 → "25.3"）
+// 戻り値: 書き込んだ文字数（snprintfと同じく、切り詰めた場合は必要な文字数）
+int sensor_channel_format(sensor_ch_t ch, int32_t value, char *buf, size_t size);
+
+// 全チャネルをログ用に書式化（例: "T=25.3C RH=48.2% BT=25.1C P=1008.5hPa"、無効な値は"--"）
+// sizeはSENSOR_DATA_TEXT_MAXあれば足りる
+int sensor_data_format(const temp_sens_data_t *data, char *buf, size_t size);
+
+// 全チャネルをJSONのメンバ列として書き込む（前後の括弧・カンマなし）
+// 例: "aht_t01":253,"aht_rh01":482,"bmp_t01":251,"bmp_p01":100845,"aht_ok":true,"bmp_ok":true
+// 無効なチャネルはnull。sizeはSENSOR_DATA_JSON_MAXあれば足りる
+// 戻り値: 書き込んだ文字数、バッファ不足なら0
+size_t sensor_data_write_json(const temp_sens_data_t *data, char *buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,86 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sensor_channel.h"
+
+// ==== 測定値の時系列圧縮（Gorilla方式のビット列） ====
+// 測定値はゆっくり変わり（0.1℃・0.1%RH刻み）、seqは連番、受信間隔はほぼ一定なので、
+// 直前の測定値との差をビット単位の可変長符号で詰める。
+//   時刻: 時刻差の差（delta-of-delta、SENSOR_CODEC_TIME_UNIT_MS単位）
+//   seq:  +1なら1bit、それ以外は差
+//   有効ビット: 変化なしなら1bit
+//   チャネル値: 直前の値との差をzig-zagで符号なしにして可変長符号（変化なしなら1bit）
+// 可変長符号（zig-zag後の値z）: 0 → "0"、z<8 → "10"+3bit、z<256 → "110"+8bit、
+//   z<65536 → "1110"+16bit、それ以外 → "1111"+32bit
+// 値は整数（10^decimals倍）なので、浮動小数点のXORの代わりに差のzig-zagを使う。
+//
+// ブロック（固定長、SENSOR_CODEC_BLOCK_MAXバイト以下）は単独で復号できる:
+//   [測定値数 u16 LE][先頭の時刻 u32 LE（ms）][ビット列（MSBから）]
+//   先頭の測定値は基準を0として符号化する（seqは32bit、有効ビットはSENSOR_CH_COUNTbit）。
+// ブロックの先頭を読むだけで時刻・件数が分かるため、ブロック単位で任意の位置から読み出せる。
+// 通常の受信（時刻差の揺れが±数tick、seq+1、値の変化が0～±1）は1件あたり10～25bit程度。
+// 時刻はuint32_tのmsで、差を符号付きで扱うため周回しても扱える。RSSIは符号化しない。
+// FreeRTOS/ESP-IDFに依存しないため、ホスト側ツールでも同じコードを使える。
+#define SENSOR_CODEC_TIME_UNIT_MS   10      // 時刻差の分解能（FreeRTOSの1tick）
+#define SENSOR_CODEC_HEADER_BYTES   6       // 測定値数 + 先頭の時刻
+#define SENSOR_CODEC_BLOCK_MAX      8191    // ブロックの最大バイト数（ビット位置をuint16_tで持つ）
+// 1件の最大バイト数（時刻・seqが32bitの差、有効ビットの変化、全チャネルが32bitの差）
+#define SENSOR_CODEC_SAMPLE_MAX     ((36 + 36 + 1 + SENSOR_CH_COUNT + 36 * SENSOR_CH_COUNT + 7) / 8)
+
+// 符号化の状態（直前の測定値、復号側と同じ値を持つ）。ブロックとは別に持ち、ポインタを含まない
+typedef struct {
+    uint16_t count;                 // ブロック内の測定値数
+    uint16_t bits;                  // ブロック内の使用ビット数（ヘッダを含む）
+    uint32_t time_ms;               // 直前の時刻（分解能に丸めた値）
+    int32_t time_delta;             // 直前の時刻差（SENSOR_CODEC_TIME_UNIT_MS単位）
+    uint32_t seq;
+    uint32_t valid;                 // bit n = SENSOR_CH_n の値あり
+    int32_t ch[SENSOR_CH_COUNT];    // チャネルごとの最後の有効な値
+} sensor_codec_state_t;
+
+// ブロックの読み出し位置
+typedef struct {
+    const uint8_t *block;
+    size_t size;
+    uint32_t bit;                   // 次に読むビット位置
+    sensor_codec_state_t state;     // 直前に復号した測定値（state.countは復号済みの件数）
+    uint16_t total;                 // ブロックの測定値数
+} sensor_codec_reader_t;
+
+// ---- 符号化 ----
+// ブロックを空にして書き始める（sizeはSENSOR_CODEC_HEADER_BYTESより大きくSENSOR_CODEC_BLOCK_MAX以下）
+// 戻り値: false=size不正
+bool sensor_codec_block_begin(uint8_t *block, size_t size, sensor_codec_state_t *state);
+
+// 測定値を追記。ブロックに収まらなければ何も書かずにfalse（次のブロックを始める）
+// time_msが直前より前なら直前と同じ時刻として扱う
+bool sensor_codec_block_append(uint8_t *block, size_t size, sensor_codec_state_t *state,
+                               uint32_t time_ms, const temp_sens_data_t *data);
+
+// 使用中のバイト数（ヘッダを含む、最後のバイトは端数のビットを含む）
+static inline size_t sensor_codec_block_bytes(const sensor_codec_state_t *state)
+{
+    return ((size_t)state->bits + 7) / 8;
+}
+
+// ---- ブロックの索引（復号しない） ----
+// ブロックの測定値数・先頭の時刻
+uint16_t sensor_codec_block_count(const uint8_t *block);
+uint32_t sensor_codec_block_first_ms(const uint8_t *block);
+
+// ---- 復号 ----
+// ブロックの先頭から読む。戻り値: false=ヘッダ不正
+bool sensor_codec_reader_begin(sensor_codec_reader_t *reader, const uint8_t *block, size_t size);
+
+// 次の測定値を復号する（dataのrssiは0）。ブロックの終わり・ビット列が壊れていればfalse
+bool sensor_codec_read(sensor_codec_reader_t *reader, uint32_t *time_ms, temp_sens_data_t *data);
+
+#ifdef __cplusplus
+}
+#endif
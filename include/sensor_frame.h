@@ -0,0 +1,141 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sensor_channel.h"
+
+// ==== バイナリセンサーフレーム定義（UDPポート50000） ====
+// 先頭バイトがSENSOR_FRAME_MAGICの場合はバイナリフレームとして扱う
+// （JSONは'{'、旧形式は'N'で始まるため衝突しない）
+//
+// 多バイト値はすべてビッグエンディアン
+// 配置は固定で、チャネル表（sensor_channel.h）のうちAHT_T/AHT_RH/BMP_T/BMP_Pの4チャネルだけを運ぶ。
+// 表に追加したチャネルはJSON・旧形式で送る。
+//  off size 内容
+//   0   1   magic (0xA5)
+//   1   1   version (1)
+//   2   1   child_no
+//   3   1   flags (bit0=aht_ok, bit1=bmp_ok)
+//   4   2   aht_t01  (int16, 0.1℃)
+//   6   2   aht_rh01 (uint16, 0.1%)
+//   8   2   bmp_t01  (int16, 0.1℃)
+//  10   4   bmp_p01  (uint32, 0.1hPa)
+//  14   4   seq      (uint32)
+//  18   1   rssi     (int8, dBm)
+//  19   2   CRC16-CCITT（先頭0～18バイト、初期値0xFFFF）
+#define SENSOR_FRAME_MAGIC          0xA5
+#define SENSOR_FRAME_VERSION        1
+#define SENSOR_FRAME_SIZE           21
+
+// ==== バッチフレーム定義（version 2、1データグラムに複数測定値） ====
+//  off size 内容
+//   0   1   magic (0xA5)
+//   1   1   version (2)
+//   2   1   child_no
+//   3   1   count（測定値数 1～SENSOR_FRAME_BATCH_MAX）
+//   4   4   base_seq（先頭測定値のseq）
+//   8   1   rssi（int8, dBm、送信時点の値）
+//   9  14*N 測定値レコード（古い順）
+//           +0  1 flags (bit0=aht_ok, bit1=bmp_ok)
+//           +1  1 seq_delta（seq = base_seq + seq_delta）
+//           +2  2 age_ms（送信時刻からさかのぼった測定時刻、uint16）
+//           +4  2 aht_t01 / +6 2 aht_rh01 / +8 2 bmp_t01 / +10 4 bmp_p01
+//  末尾 2   CRC16-CCITT（先頭から測定値レコード末尾まで）
+#define SENSOR_FRAME_VERSION_BATCH  2
+#define SENSOR_FRAME_BATCH_HDR_SIZE 9
+#define SENSOR_FRAME_BATCH_REC_SIZE 14
+#define SENSOR_FRAME_BATCH_MAX      16
+#define SENSOR_FRAME_BATCH_SIZE(n)  (SENSOR_FRAME_BATCH_HDR_SIZE + SENSOR_FRAME_BATCH_REC_SIZE * (n) + 2)
+
+#define SENSOR_FRAME_FLAG_AHT_OK    0x01
+#define SENSOR_FRAME_FLAG_BMP_OK    0x02
+
+// ==== 制御フレーム定義（version 3、ゲートウェイ→子機の下り） ====
+// 子機の送信元IPのSENSOR_CONTROL_PORTへ送る。子機はtypeごとに、ctrl_seqが前回適用した値と異なる場合のみ適用する
+// 指示は全子機へ同時に届くため、子機は間隔を切り替えた直後の送信を新しい間隔内の乱数位置にずらすこと
+// （その後の位相はSHIFT_PHASEでゲートウェイが子機ごとのスロットへ寄せる）
+//  off size 内容
+//   0   1   magic (0xA5)
+//   1   1   version (3)
+//   2   1   child_no（宛先）
+//   3   1   type（SENSOR_CONTROL_*）
+//   4   2   ctrl_seq（typeごとの通番。指示を変えるごとにインクリメント、同じ指示の再送では不変）
+//   6   4   value（SET_INTERVAL: 送信間隔ms、SHIFT_PHASE: 次の送信をずらす量ms（int32、負なら早める））
+//  10   2   CRC16-CCITT（先頭0～9バイト）
+#define SENSOR_FRAME_VERSION_CONTROL    3
+#define SENSOR_CONTROL_FRAME_SIZE       12
+#define SENSOR_CONTROL_PORT             50001   // 子機側の制御受信ポート
+#define SENSOR_CONTROL_SET_INTERVAL     1       // 送信間隔の指示
+#define SENSOR_CONTROL_SHIFT_PHASE      2       // 送信位相の補正（1回だけ次の送信時刻をずらす）
+
+typedef struct {
+    uint8_t child_no;
+    uint8_t type;           // SENSOR_CONTROL_*
+    uint16_t ctrl_seq;
+    uint32_t value;
+} sensor_control_t;
+
+// ==== デコード結果 ====
+typedef enum {
+    SENSOR_FRAME_OK = 0,
+    SENSOR_FRAME_ERR_MAGIC = -1,    // バイナリフレームではない
+    SENSOR_FRAME_ERR_VERSION = -2,  // 未対応バージョン
+    SENSOR_FRAME_ERR_LENGTH = -3,   // 長さ不正
+    SENSOR_FRAME_ERR_CRC = -4,      // CRC不一致
+} sensor_frame_result_t;
+
+// 先頭バイトでバイナリフレームかどうかを判定
+static inline bool sensor_frame_is_binary(const void *buf, size_t len)
+{
+    return len > 0 && ((const uint8_t *)buf)[0] == SENSOR_FRAME_MAGIC;
+}
+
+// バッチフレーム（version 2）かどうかを判定
+static inline bool sensor_frame_is_batch(const void *buf, size_t len)
+{
+    return sensor_frame_is_binary(buf, len) && len > 1 &&
+           ((const uint8_t *)buf)[1] == SENSOR_FRAME_VERSION_BATCH;
+}
+
+// CRC16-CCITT（多項式0x1021、初期値0xFFFF）
+uint16_t sensor_frame_crc16(const uint8_t *data, size_t len);
+
+// フレームをエンコード（子機・ホストツール用）
+// 戻り値: 書き込んだバイト数（バッファ不足時は0）
+size_t sensor_frame_encode(uint8_t child_no, const temp_sens_data_t *data,
+                           uint8_t *buf, size_t buf_size);
+
+// フレームをデコード
+sensor_frame_result_t sensor_frame_decode(const uint8_t *buf, size_t len,
+                                          uint8_t *child_no, temp_sens_data_t *out);
+
+// バッチフレームをエンコード
+// data[0..count-1]は古い順、seqはdata[0].seqから255以内であること
+// age_ms: 各測定値の経過時間（NULLなら全て0）、rssi: 送信時点のRSSI
+// 戻り値: 書き込んだバイト数（引数不正・バッファ不足時は0）
+size_t sensor_frame_encode_batch(uint8_t child_no, int rssi,
+                                 const temp_sens_data_t *data, const uint16_t *age_ms, size_t count,
+                                 uint8_t *buf, size_t buf_size);
+
+// バッチフレームをデコード
+// out/age_msはmax_count要素以上確保すること（age_msはNULL可）
+// 各測定値のrssiにはフレームのrssiが入る
+sensor_frame_result_t sensor_frame_decode_batch(const uint8_t *buf, size_t len, uint8_t *child_no,
+                                                temp_sens_data_t *out, uint16_t *age_ms,
+                                                size_t max_count, size_t *count);
+
+// 制御フレームをエンコード
+// 戻り値: 書き込んだバイト数（バッファ不足時は0）
+size_t sensor_frame_encode_control(const sensor_control_t *ctrl, uint8_t *buf, size_t buf_size);
+
+// 制御フレームをデコード（子機・ホストツール用）
+sensor_frame_result_t sensor_frame_decode_control(const uint8_t *buf, size_t len, sensor_control_t *ctrl);
+
+#ifdef __cplusplus
+}
+#endif
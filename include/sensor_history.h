@@ -0,0 +1,67 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sensor_channel.h"
+#include "sensor_codec.h"
+
+// ==== 子機ごとの測定値履歴（固定長リング） ====
+// 測定時刻付きの測定値を、sensor_codecのブロック（直前の値との差をビット単位で詰めたもの）へ追記する（O(1)）。
+// リングはSENSOR_HISTORY_BLOCKS個のブロックからなり、満杯になったら最も古いブロックを丸ごと捨てる。
+// ブロックは単独で復号できるため、古いブロックを捨てても残りは復元できる。
+// ブロックのヘッダ（先頭の時刻）を時間索引とし、範囲の読み出しは開始時刻を含むブロックから復号する。
+// 通常の受信は1件あたり2～3バイト程度。ブロックはそのまま書き出し（エクスポート）にも使える。
+// 時刻はuint32_tのmsで、差を符号付きで比べるため周回しても扱える。RSSIは保持しない。
+// FreeRTOS/ESP-IDFに依存しないため、ホスト側ツールでも同じコードを使える。
+#define SENSOR_HISTORY_BLOCK_BYTES  64      // 1ブロックのバイト数
+#define SENSOR_HISTORY_BLOCKS       4       // 1子機あたりのブロック数
+
+typedef struct {
+    uint8_t head;                                   // 最も古いブロック
+    uint8_t blocks;                                 // 使用中のブロック数（0=空）
+    uint16_t reserved;
+    sensor_codec_state_t last;                      // 書き込み中のブロック（最も新しいブロック）の状態
+    uint8_t data[SENSOR_HISTORY_BLOCKS][SENSOR_HISTORY_BLOCK_BYTES];
+} sensor_history_t;
+
+// 範囲読み出しの位置（sensor_history_seek()で初期化し、sensor_history_next()で1件ずつ取り出す）
+typedef struct {
+    const sensor_history_t *history;
+    uint32_t from_ms;               // これより前のレコードは読み飛ばす
+    size_t block;                   // 読み出し中のブロック（最も古いブロックからの順番）
+    sensor_codec_reader_t reader;
+} sensor_history_iter_t;
+
+// 空にする
+void sensor_history_reset(sensor_history_t *history);
+
+// 測定値を追記（time_msは直前の追記以降であること。古い時刻は直前と同じ時刻として扱う）
+// 戻り値: 直前のブロックが満杯で閉じた（新しいブロックを始めた）ならtrue。
+//         閉じたブロックは sensor_history_block(history, sensor_history_block_count(history) - 2)
+bool sensor_history_append(sensor_history_t *history, uint32_t time_ms, const temp_sens_data_t *data);
+
+// 保持している最古・最新の時刻。空ならfalse
+bool sensor_history_span(const sensor_history_t *history, uint32_t *oldest_ms, uint32_t *newest_ms);
+
+// 使用中のブロック数と、最も古いブロックからindex番目のブロック（sensor_codecの形式、SENSOR_HISTORY_BLOCK_BYTES）
+size_t sensor_history_block_count(const sensor_history_t *history);
+const uint8_t *sensor_history_block(const sensor_history_t *history, size_t index);
+
+// from_ms以降のレコードを含みうる最初のブロックの順番（時間索引の二分探索、最古以前なら0）。空なら0
+size_t sensor_history_find_block(const sensor_history_t *history, uint32_t from_ms);
+
+// from_ms以降のレコードを読む位置付け（時間索引でsensor_history_find_block()のブロックを選び、その先頭から復号する）
+// historyは読み出しの間変更しないこと（読み出し側で写したものを渡す）
+void sensor_history_seek(sensor_history_iter_t *it, const sensor_history_t *history, uint32_t from_ms);
+
+// 次のレコードを取り出す（dataのrssiは0）。終端ならfalse
+bool sensor_history_next(sensor_history_iter_t *it, uint32_t *time_ms, temp_sens_data_t *data);
+
+#ifdef __cplusplus
+}
+#endif
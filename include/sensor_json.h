@@ -0,0 +1,30 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sensor_channel.h"
+
+// ==== デコード結果 ====
+typedef enum {
+    SENSOR_JSON_OK = 0,             // 全必須フィールドを取得
+    SENSOR_JSON_ERR_SYNTAX = -1,    // JSONオブジェクトではない（旧形式等）
+    SENSOR_JSON_ERR_MISSING = -2,   // JSONとしては正しいが必須フィールド不足
+} sensor_json_result_t;
+
+// 子機JSONを1パスでデコードする（ヒープ未使用）
+// 形式: {"child_no":1,"aht_t01":253,"aht_rh01":482,"bmp_t01":251,"bmp_p01":100845,
+//        "aht_ok":true,"bmp_ok":true,"seq":123,"rssi":-60}
+// チャネルのキー・測定成功フラグはsensor_channel.hの表に従う。未知のキーは読み飛ばす。
+// child_no・seqと、チャネル1つ以上は必須。rssiは省略可（省略時0）。
+// 数値以外（null等）のチャネル、測定成功フラグがtrue以外の組のチャネルは無効とする。
+// buf: 受信バッファ（NUL終端不要）、len: バイト数
+sensor_json_result_t sensor_json_decode(const char *buf, size_t len,
+                                        uint8_t *child_no, temp_sens_data_t *out);
+
+#ifdef __cplusplus
+}
+#endif
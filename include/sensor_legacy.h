@@ -0,0 +1,32 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sensor_channel.h"
+
+// ==== デコード結果 ====
+typedef enum {
+    SENSOR_LEGACY_OK = 0,               // 測定値を1つ以上取得
+    SENSOR_LEGACY_ERR_FORMAT = -1,      // "N=<子機No>," で始まらない
+    SENSOR_LEGACY_ERR_MISSING = -2,     // 子機Noのみ（測定値なし、child_noは有効）
+} sensor_legacy_result_t;
+
+// 旧形式 "N=<子機No>,<key>=<value>,..." を1パスでデコードする（ヒープ未使用）
+// 認識するキー（未知のキーは読み飛ばす、同じキーは最初の値を採用）:
+//   10^decimals倍の整数: チャネルのJSONキー（aht_t01, aht_rh01, bmp_t01, bmp_p01 等）
+//   実単位の小数:        チャネルの短い表示名（T, RH, BT, P 等）、湿度のみ別名H
+//   その他:              測定成功フラグ aht_ok, bmp_ok 等（1/0/true/false）, seq/S, rssi/R
+// 値が届いたチャネルを有効とし、測定成功フラグが0/falseの組のチャネルは無効とする。
+// buf: 受信バッファ（NUL終端不要）、len: バイト数
+// has_seq: seqキーがあった場合true（NULL可、seqなしの子機はseq追跡の対象外）
+sensor_legacy_result_t sensor_legacy_decode(const char *buf, size_t len, uint8_t *child_no,
+                                            temp_sens_data_t *out, bool *has_seq);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,72 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sensor_channel.h"
+
+// ==== 測定値の集計（1分・1時間・1日） ====
+// 子機ごと・チャネルごとに件数・最小・最大・合計・2乗の合計を、受信のたびに各周期の集計中バケットへ足し込む（O(1)）。
+// 値はチャネルの10^decimals倍の整数のまま扱い（合計は10^decimals倍、2乗の合計は10^(2*decimals)倍）、
+// 平均・分散は読み出し側で count/sum/sum_sq から求める。
+// バケットの境界は起動からの時刻（uint32_tのms）を周期で割り切った位置。時計を持たないため時刻合わせはしない。
+// 周期ごとに集計中のバケットと直前に閉じたバケットを1つずつ持ち、周期をまたいだ測定値が来たら閉じる。
+// 集計中バケットより前の時刻の測定値（バッチフレーム）は、直前に閉じたバケットの周期内ならそこへ足し込み、
+// それより前なら集計中のバケットへ寄せる（閉じたバケットを開き直さない）。
+// 測定値が来ないまま周期をまたいだ場合は、読み出し時にsensor_rollup_roll()で閉じる。
+// FreeRTOS/ESP-IDFに依存しないため、ホスト側ツールでも同じコードを使える。
+typedef enum {
+    SENSOR_ROLLUP_MINUTE = 0,
+    SENSOR_ROLLUP_HOUR,
+    SENSOR_ROLLUP_DAY,
+    SENSOR_ROLLUP_LEVELS
+} sensor_rollup_level_t;
+
+#define SENSOR_ROLLUP_MINUTE_MS     60000u
+#define SENSOR_ROLLUP_HOUR_MS       3600000u
+#define SENSOR_ROLLUP_DAY_MS        86400000u
+
+// 1チャネル分の集計
+typedef struct {
+    int64_t sum;
+    uint64_t sum_sq;
+    uint32_t count;
+    int32_t min;
+    int32_t max;
+} sensor_rollup_stat_t;
+
+// 1周期分のバケット
+typedef struct {
+    uint32_t start_ms;                          // 開始時刻（周期の境界）
+    uint32_t samples;                           // 足し込んだ測定値数（0=空）
+    sensor_rollup_stat_t ch[SENSOR_CH_COUNT];
+} sensor_rollup_bucket_t;
+
+typedef struct {
+    sensor_rollup_bucket_t open[SENSOR_ROLLUP_LEVELS];      // 集計中
+    sensor_rollup_bucket_t closed[SENSOR_ROLLUP_LEVELS];    // 直前に閉じたバケット（samples=0ならなし）
+} sensor_rollup_t;
+
+// 周期の長さ（ms）と名前（"minute"/"hour"/"day"）
+uint32_t sensor_rollup_period_ms(sensor_rollup_level_t level);
+const char *sensor_rollup_level_name(sensor_rollup_level_t level);
+
+// 空にする
+void sensor_rollup_reset(sensor_rollup_t *rollup);
+
+// 測定値を各周期のtime_ms（測定時刻）のバケットへ足し込む（有効なチャネルのみ）
+void sensor_rollup_add(sensor_rollup_t *rollup, uint32_t time_ms, const temp_sens_data_t *data);
+
+// now_msが集計中バケットの周期を過ぎていれば閉じる（読み出し側で写したものに対して呼ぶ）
+void sensor_rollup_roll(sensor_rollup_t *rollup, uint32_t now_ms);
+
+// 平均（10^decimals倍の整数、四捨五入）。count=0なら0
+int32_t sensor_rollup_mean(const sensor_rollup_stat_t *stat);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,91 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// ==== シーケンスロック（単一ライタ・複数リーダ） ====
+// リーダはロックを取らずにデータを写し、写している間に書き込みがあればやり直す。
+// ライタはリーダを待たないため、表示・HTTPの読み出しが受信処理を止めることはない。
+//
+// 書き込み: seqlock_write_begin() → seqlock_store_words() → seqlock_write_end()
+//   ライタは1つだけ（複数ある場合は呼び出し側で排他する）。書き込み中はseqが奇数になる。
+// 読み出し: do { s = seqlock_read_begin(); seqlock_load_words(); } while (seqlock_read_retry(s));
+//   書き込み中（奇数）に読み始めた場合も、read_retryで必ずやり直しになる。
+// 保護するデータは_Atomic uint32_tの配列として置き、1語ずつrelaxedで読み書きする
+// （途中の値を読むことはあるが、データ競合にはならず、seqの確認で破棄される）。
+// FreeRTOS/ESP-IDFに依存しないため、ホスト側ツールでも同じコードを使える。
+typedef struct {
+    _Atomic uint32_t seq;
+} seqlock_t;
+
+#define SEQLOCK_INITIALIZER     { 0 }
+
+// 構造体を保護領域に置く時の語数（sizeofは4の倍数であること）
+#define SEQLOCK_WORDS(type)     (sizeof(type) / sizeof(uint32_t))
+
+static inline void seqlock_init(seqlock_t *lock)
+{
+    atomic_init(&lock->seq, 0);
+}
+
+// ---- ライタ側 ----
+static inline void seqlock_write_begin(seqlock_t *lock)
+{
+    uint32_t s = atomic_load_explicit(&lock->seq, memory_order_relaxed);
+    atomic_store_explicit(&lock->seq, s + 1, memory_order_relaxed);
+    // 奇数のseqをデータより先に見せる
+    atomic_thread_fence(memory_order_release);
+}
+
+static inline void seqlock_write_end(seqlock_t *lock)
+{
+    uint32_t s = atomic_load_explicit(&lock->seq, memory_order_relaxed);
+    // データを書き終えてから偶数に戻す
+    atomic_store_explicit(&lock->seq, s + 1, memory_order_release);
+}
+
+static inline void seqlock_store_words(_Atomic uint32_t *dst, const void *src, size_t words)
+{
+    const uint8_t *p = (const uint8_t *)src;
+    for (size_t i = 0; i < words; i++) {
+        uint32_t w;
+        memcpy(&w, p + i * sizeof(w), sizeof(w));
+        atomic_store_explicit(&dst[i], w, memory_order_relaxed);
+    }
+}
+
+// ---- リーダ側 ----
+// 戻り値は奇数のこともある（その場合read_retryは必ずtrue）
+static inline uint32_t seqlock_read_begin(const seqlock_t *lock)
+{
+    return atomic_load_explicit((_Atomic uint32_t *)&lock->seq, memory_order_acquire);
+}
+
+// 読み出し開始以降に書き込みがあった（または書き込み中だった）ならtrue
+static inline bool seqlock_read_retry(const seqlock_t *lock, uint32_t start)
+{
+    // データの読み出しをseqの再確認より先に完了させる
+    atomic_thread_fence(memory_order_acquire);
+    return (start & 1u) != 0 ||
+           atomic_load_explicit((_Atomic uint32_t *)&lock->seq, memory_order_relaxed) != start;
+}
+
+static inline void seqlock_load_words(void *dst, const _Atomic uint32_t *src, size_t words)
+{
+    uint8_t *p = (uint8_t *)dst;
+    for (size_t i = 0; i < words; i++) {
+        uint32_t w = atomic_load_explicit((_Atomic uint32_t *)&src[i], memory_order_relaxed);
+        memcpy(p + i * sizeof(w), &w, sizeof(w));
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ==== ロックフリーSPSCリング（単一プロデューサ・単一コンシューマ） ====
+// 固定長要素を事前確保した領域に格納する。ミューテックス・ヒープを使わない。
+// プロデューサはspsc_ring_acquire()で書き込み先を取得し、書き終えたらspsc_ring_publish()。
+// コンシューマはspsc_ring_front()で先頭要素を参照し、処理後にspsc_ring_pop()。
+// head/tailはそれぞれ片側のタスクだけが更新するため、異なるコア間でも排他不要。
+typedef struct {
+    uint8_t *storage;               // 要素格納領域（elem_size * capacity）
+    size_t elem_size;               // 要素サイズ
+    uint32_t mask;                  // capacity - 1（capacityは2のべき乗）
+    _Atomic uint32_t head;          // 書き込み位置（プロデューサのみ更新）
+    _Atomic uint32_t tail;          // 読み出し位置（コンシューマのみ更新）
+    _Atomic uint32_t high_water;    // 最大使用数（プロデューサのみ更新）
+    _Atomic uint32_t overflow;      // 満杯で破棄した数（プロデューサのみ更新）
+} spsc_ring_t;
+
+// 統計
+typedef struct {
+    uint32_t capacity;      // 要素数
+    uint32_t count;         // 現在の使用数
+    uint32_t high_water;    // 最大使用数
+    uint32_t overflow;      // 満杯で破棄した数
+} spsc_ring_stats_t;
+
+// 初期化（capacityは2のべき乗、storageはelem_size * capacityバイト以上）
+// 戻り値: false=引数不正
+bool spsc_ring_init(spsc_ring_t *ring, void *storage, size_t elem_size, uint32_t capacity);
+
+// ---- プロデューサ側 ----
+// 次の書き込み先を取得（満杯ならNULL、publishするまでコンシューマからは見えない）
+void *spsc_ring_acquire(spsc_ring_t *ring);
+
+// acquireした要素を公開
+void spsc_ring_publish(spsc_ring_t *ring);
+
+// 満杯のため1件破棄したことを記録
+void spsc_ring_note_overflow(spsc_ring_t *ring);
+
+// ---- コンシューマ側 ----
+// 先頭要素を参照（空ならNULL）
+void *spsc_ring_front(spsc_ring_t *ring);
+
+// 先頭要素を解放
+void spsc_ring_pop(spsc_ring_t *ring);
+
+// ---- 共通 ----
+// 現在の使用数
+uint32_t spsc_ring_count(const spsc_ring_t *ring);
+
+// 統計取得（どのタスクからでも可）
+void spsc_ring_get_stats(const spsc_ring_t *ring, spsc_ring_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
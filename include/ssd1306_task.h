@@ -8,7 +8,7 @@ extern "C" {
 #include <stdint.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "web_server_task.h"  // 子機センサーデータ取得用
+#include "child_registry.h"  // 子機センサーデータ取得用
 
 // ==== SSD1306設定 ====
 #define SSD1306_WIDTH  128
@@ -54,6 +54,9 @@ void ssd1306_invert_display(bool invert);
 // コントラスト設定（0-255）
 void ssd1306_set_contrast(uint8_t contrast);
 
+// ディスプレイが接続済みでセンサ情報を表示中ならtrue
+bool ssd1306_is_showing_sensors(void);
+
 #ifdef __cplusplus
 }
 #endif
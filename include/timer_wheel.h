@@ -0,0 +1,65 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ==== ハッシュドタイマーホイール ====
+// 要素（0 ～ count-1の番号）ごとに期限を1つ持ち、期限のtickで索引したバケットへ双方向リストで繋ぐ。
+// 設定・付け替え・解除はO(1)。進める時は経過したtickのバケットだけを見るため、
+// 1回の処理は「期限を迎えた要素数 + 同じバケットで周回を待つ要素数」で済み、全要素は走査しない。
+// 1周（TIMER_WHEEL_BUCKETS × tick_ms）より先の期限はバケットに置いたまま周回を待つ。
+// 時刻はuint32_tのmsで、差を符号付きで比べるため周回（約49日）しても扱える（期限は24日先まで）。
+// FreeRTOS/ESP-IDFに依存しないため、ホスト側ツールでも同じコードを使える。
+#define TIMER_WHEEL_BUCKETS     256     // 2のべき乗
+#define TIMER_WHEEL_NONE        0xFFFF  // リンクの終端・未設定
+
+// 要素ごとの期限（呼び出し側が要素数分の配列を用意する）
+typedef struct {
+    uint32_t deadline_ms;       // 期限
+    uint16_t next;              // 同じバケットの次の要素（TIMER_WHEEL_NONE=終端）
+    uint16_t prev;              // 同じバケットの前の要素（TIMER_WHEEL_NONE=先頭）
+    uint16_t bucket;            // 繋いでいるバケット（TIMER_WHEEL_NONE=未設定）
+    uint16_t reserved;
+} timer_wheel_entry_t;
+
+typedef struct {
+    timer_wheel_entry_t *entries;
+    uint16_t count;             // 要素数
+    uint32_t tick_ms;           // 1バケットの時間幅
+    uint32_t now_ms;            // 処理済みの時刻（tick_msの境界）
+    uint32_t cursor;            // 処理済みのバケット（now_msに対応、TIMER_WHEEL_BUCKETSで割った余りで索引）
+    uint32_t armed;             // 設定中の要素数
+    uint16_t heads[TIMER_WHEEL_BUCKETS];
+} timer_wheel_t;
+
+// 初期化（全要素を未設定にする）、entriesはcount要素、countはTIMER_WHEEL_NONE未満
+void timer_wheel_init(timer_wheel_t *tw, timer_wheel_entry_t *entries, uint16_t count,
+                      uint32_t tick_ms, uint32_t now_ms);
+
+// 期限を設定（設定済みなら付け替え）。過ぎた期限は次のtimer_wheel_advance()で期限切れになる
+void timer_wheel_arm(timer_wheel_t *tw, uint16_t id, uint32_t deadline_ms);
+
+// 期限を解除（未設定なら何もしない）
+void timer_wheel_cancel(timer_wheel_t *tw, uint16_t id);
+
+static inline bool timer_wheel_armed(const timer_wheel_t *tw, uint16_t id)
+{
+    return tw->entries[id].bucket != TIMER_WHEEL_NONE;
+}
+
+// now_msまで進め、期限を迎えた要素を解除してexpiredへ格納（expiredはcount要素）
+// 戻り値: 期限を迎えた要素数
+size_t timer_wheel_advance(timer_wheel_t *tw, uint32_t now_ms, uint16_t *expired);
+
+// 次に要素のあるバケットを処理すべき時刻までのms（周回待ちの要素で早めに起きることはある）
+// 1周先まで要素がなければlimit_ms。limit_msで頭打ち
+uint32_t timer_wheel_next_ms(const timer_wheel_t *tw, uint32_t now_ms, uint32_t limit_ms);
+
+#ifdef __cplusplus
+}
+#endif
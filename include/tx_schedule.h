@@ -0,0 +1,66 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ==== 子機送信位相（タイムスロット）の割り当て ====
+// 送信間隔内の目標位相を子機ごとに決め、ゲートウェイ側の受信時刻から測った位相とのずれを制御フレームで補正する。
+// 子機とゲートウェイの時計は同期しないため、位相はゲートウェイの受信時刻 mod 送信間隔で扱う。
+// FreeRTOS/ESP-IDFに依存しないため、ホスト側ツールでも同じ割り当て・統計を使える。
+#define TX_SCHEDULE_SLOT_BITS       7       // 目標位相の分解能（2^7 = 子機レジストリのスロット数）
+#define TX_PHASE_TOLERANCE_MIN_MS   20      // 位相ずれの許容下限（tick 10msの2倍）
+#define TX_PHASE_SETTLE_ARRIVALS    2       // 位相を補正した後、この回数受信して測り直すまで再補正しない
+#define TX_CLOSE_ARRIVAL_MS         10      // 直前の受信（他の子機を含む）からこの時間以内なら近接到着（衝突の目安）
+#define TX_JITTER_GAIN_SHIFT        4       // 到着揺らぎの平滑化係数（1/16、RFC 3550と同じ）
+
+// 子機ごとの到着位相・揺らぎ
+typedef struct {
+    uint32_t interval_ms;       // 位相を測っている送信間隔（0=未測定）
+    uint32_t last_arrival_ms;   // 最終受信時刻
+    uint32_t jitter_x16;        // 到着間隔と送信間隔の差の平滑値（1/16 ms単位）
+    uint8_t arrivals;           // 基準を取り直してからの受信回数（飽和、0=基準なし）
+} tx_phase_t;
+
+// 全子機の到着統計（近接到着の計数）
+typedef struct {
+    uint32_t arrivals;          // 受信データグラム数
+    uint32_t close_arrivals;    // 直前の受信からTX_CLOSE_ARRIVAL_MS以内に届いた数
+    uint32_t last_arrival_ms;   // 直前の受信時刻
+} tx_arrival_stats_t;
+
+// 受信ごとに呼ぶ。送信間隔が変わった・基準がない場合は基準を取り直すだけで揺らぎは更新しない
+// 欠落で複数周期空いた場合も、送信間隔で割った余りを揺らぎとして扱う
+void tx_phase_on_arrival(tx_phase_t *phase, uint32_t arrival_ms, uint32_t interval_ms);
+
+// 位相を補正した後に呼び、補正前の到着で再補正しないよう基準を取り直させる
+void tx_phase_restart(tx_phase_t *phase);
+
+// 到着揺らぎ（ms）
+static inline uint32_t tx_phase_jitter_ms(const tx_phase_t *phase)
+{
+    return phase->jitter_x16 >> TX_JITTER_GAIN_SHIFT;
+}
+
+// スロット番号の目標位相（0 ～ interval_ms-1）
+// スロット番号のビット反転で割り当てるため、若い番号から使うスロットが何個でもほぼ等間隔に並び、
+// 子機の増減で他の子機の目標位相は動かない
+uint32_t tx_schedule_target_ms(uint8_t slot, uint32_t interval_ms);
+
+// 許容する位相ずれ（ms）: 使用中のスロット範囲（最大スロット番号+1）で決まる最小間隔の1/4
+uint32_t tx_schedule_tolerance_ms(uint32_t interval_ms, size_t slot_span);
+
+// 位相の補正量を求める（目標との差が許容範囲内、または測り直し中ならfalse）
+// shift_ms: 次の送信をずらす量（正=遅らせる、負=早める、絶対値は送信間隔の半分以下）
+bool tx_schedule_correction(const tx_phase_t *phase, uint32_t target_ms, uint32_t tolerance_ms, int32_t *shift_ms);
+
+// 受信ごとに呼び、近接到着を数える
+void tx_arrival_note(tx_arrival_stats_t *stats, uint32_t arrival_ms);
+
+#ifdef __cplusplus
+}
+#endif
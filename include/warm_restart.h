@@ -0,0 +1,27 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ==== 再起動をまたぐ子機レジストリの状態 ====
+// exec_soft_reset()でesp_restart()する直前に、子機レジストリの状態（child_warm_state_t）を
+// RTC低速メモリへ写してcrc32を付ける。次の起動がソフトウェアリセットからで、crc32が一致すれば
+// 子機レジストリへ登録し直し、表示・/sensor/dataは子機の再送を待たずに最終値を経過時間付きで出す。
+// RTC低速メモリは電源断で消えるため、電源投入・パニック等からの起動では引き継がない。
+
+// 子機レジストリの状態を写す（esp_restart()の直前に呼ぶ）
+void warm_restart_save(void);
+
+// 保存した状態を子機レジストリへ登録し、同じ内容を二度使わないよう無効にする
+// （child_registry_init()の直後、受信を始める前に1回呼ぶ）
+// 戻り値: 登録した子機数
+size_t warm_restart_restore(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -9,6 +9,8 @@ extern "C" {
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include "spsc_ring.h"
+#include "ingest_admission.h"
 
 // temp_sens_data_tの型定義（前方宣言として使用）
 struct temp_sens_data;
@@ -26,6 +28,23 @@ bool wifi_send_temp_sens_data(const temp_sens_data_t *data);  // 新規構造体
 // 子機状態確認関数
 bool wifi_has_active_child(void);  // 1台でもACTIVEな子機があればtrue
 
+// 受信経路の統計
+typedef struct {
+    spsc_ring_stats_t ring;     // 受信段→処理段リング（最大使用数・満杯破棄数）
+    uint32_t coalesce_bursts;   // 過負荷で最新値に集約した回数
+    uint32_t superseded;        // 集約で後の値に置き換わり、個別に公開・ログしなかったデータグラム数
+    ingest_admission_stats_t admission;     // 送信元ごとのレート制限
+    bool admission_enabled;
+} wifi_ingest_stats_t;
+
+void wifi_get_ingest_stats(wifi_ingest_stats_t *stats);
+
+// レート制限で捨てたことのある送信元を列挙
+size_t wifi_list_admission_drops(ingest_admission_source_t *out, size_t max_count);
+
+// 送信元ごとのレート制限の有効/無効（1台のホストから多数の子機を模擬する負荷試験では無効にする）
+void wifi_set_admission_enabled(bool enabled);
+
 #ifdef __cplusplus
 }
 #endif
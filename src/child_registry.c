@@ -0,0 +1,1408 @@
+// src/child_registry.c
+// 子機レジストリ（子機No・送信元IPによるO(1)検索、スロット回収）
+//
+// - 子機No → スロット: 256要素の直接インデックス
+// - 送信元IP → スロット: オープンアドレス法ハッシュ（線形探査、後方シフト削除）
+// - 登録済み子機No: 256bitビットマップ（昇順列挙、登録済みのみ走査）
+// - 空きスロット: スタック（O(1)で確保・解放）
+// - seq追跡: 最大seqと直近CHILD_SEQ_WINDOW個の受信ビットマップで欠番・重複・順序逆転を判定
+// - 送信位相: 送信間隔を指示した子機の到着位相・揺らぎと、全子機の近接到着数（tx_schedule）
+// - 期限: STALE判定・スロット解放の期限をハッシュドタイマーホイール（timer_wheel）に置き、受信のたびに付け替える。
+//   期限を迎えた子機だけを遷移させ、周期的な全子機の走査・読み出しごとの経過時間の計算はしない
+// - 公開ビュー: 子機ごとの最新値・最終受信時刻・STALE判定時間をシーケンスロックで公開し、
+//   表示・HTTPはロックを取らずに読む（子機の状態・最新値を持つのはこのモジュールだけ）
+// - 更新通知: 見える内容が変わった公開ビューに通し番号（バージョン）を振り、購読タスクへ通知する。
+//   購読側は処理済みのバージョンを持ち、それより新しいスロットだけを処理する
+// - 保留公開: 過負荷時の集約では測定値の反映（seq追跡・履歴・集計）だけを行って公開を保留し、
+//   バーストの終わりに保留した子機を1回ずつ公開して購読タスクへ1回だけ通知する
+// - 遅延: 最新値を更新したら公開時刻（esp_timer µs）とソケット受信からの遅延を公開ビューに載せ、
+//   HTTP・表示は出力した時刻との差を区間ごとのヒストグラム（latency_trace）へ記録する
+// - 履歴: 受理した測定値を測定時刻（受信時刻 - age_ms）付きでスロットごとの固定長リング（sensor_history）へ追記する。
+//   読み出し側は1子機分をロック内で写し、ロックの外で復号する
+// - 保存: 履歴のブロックが閉じる（満杯になる）・スロットを解放するたびに、そのブロックを保存待ちへ写す。
+//   フラッシュへの書き込みは保存タスク（history_store）が取り出してロックの外で行う
+// - 集計: 測定値を受けた子機に集計領域（sensor_rollup、CHILD_ROLLUP_MAX_CHILDREN個）を割り当て、
+//   1分・1時間・1日のバケットへ足し込む。割り当てはスロット解放まで保持する
+// - 再起動: 子機の最新値・seq・送信間隔と集計中バケットを経過時間に直して写し（warm_restartがRTCメモリに置く）、
+//   起動時にSTALE・restoredとして登録し直す。再起動後の最初の受信で引き継いだ最新値を捨てる
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "lwip/sockets.h"
+#include "child_registry.h"
+#include "log_task.h"
+#include "esp_timer.h"
+#include "seqlock.h"
+#include "latency_trace.h"
+#include "sensor_history.h"
+#include "sensor_rollup.h"
+#include "timer_wheel.h"
+
+// ==== 内部定義 ====
+#define NO_INDEX_SIZE       256                             // uint8_t子機Noの全範囲
+#define IP_HASH_SIZE        256                             // 2のべき乗、スロット数の2倍
+#define IP_HASH_EMPTY       0xFF
+#define BITMAP_WORDS        (NO_INDEX_SIZE / 32)
+
+typedef enum {
+    CHILD_STATE_ACTIVE = 0,
+    CHILD_STATE_STALE
+} child_state_t;
+
+typedef struct {
+    uint32_t source_ip;                     // 送信元IPアドレス（ネットワークバイトオーダ）
+    uint32_t last_recv_time_ms;             // 最終受信時刻（ms）
+    uint8_t child_no;                       // 子機No（0=空きスロット）
+    uint8_t state;                          // 状態（child_state_t）
+    bool seq_valid;                         // seq受信済み
+    bool has_reading;                       // 最新測定値あり
+    uint32_t seq_window;                    // bit n = (last_seq - n) を受信済み
+    child_seq_stats_t seq_stats;            // seq統計
+    child_reading_t latest;                 // 最新測定値（デコード済み）
+    uint32_t report_interval_ms;            // STALE判定に使う送信間隔（0=指示なし）
+    uint32_t pending_interval_ms;           // 次の受信で反映する短い指示間隔（0=なし）
+    tx_phase_t tx_phase;                    // 到着位相・揺らぎ（送信間隔の指示後のみ）
+    uint32_t version;                       // 公開ビューが最後に変化した時のバージョン
+    int64_t commit_us;                      // 最新測定値を公開した時刻（esp_timer µs、0=なし）
+    uint32_t commit_delay_us;               // 最新測定値のソケット受信から公開までの時間（µs）
+    bool restored;                          // 最新測定値は再起動前から引き継いだもの
+} child_node_t;
+
+// 保留中の公開（スロット番号で索引）。新規登録でノードを0クリアしても一覧との対応が崩れないようノードの外に持つ
+typedef struct {
+    bool listed;                            // s_pending_slotsに登録済み
+    bool changed;                           // 保留中の変化に表示し直す必要のあるものを含む
+    bool advanced;                          // 保留中に最新値を更新した
+    int64_t recv_us;                        // 保留中に最新値を更新した測定値の受信時刻（esp_timer µs、0=不明）
+} pending_publish_t;
+
+static child_node_t s_nodes[CHILD_REGISTRY_MAX_NODES];
+static uint8_t s_no_index[NO_INDEX_SIZE];       // 子機No → スロット+1（0=未登録）
+static uint8_t s_ip_hash[IP_HASH_SIZE];         // IPハッシュ → スロット（IP_HASH_EMPTY=空き）
+static _Atomic uint32_t s_no_bitmap[BITMAP_WORDS];  // 登録済み子機No（child_registry_list()はロックなしで読む）
+static uint8_t s_free_slots[CHILD_REGISTRY_MAX_NODES];
+static size_t s_free_count = 0;
+static child_seq_stats_t s_seq_totals;          // 全子機合計
+static tx_arrival_stats_t s_arrival_stats;      // 全子機の近接到着
+static SemaphoreHandle_t s_mutex = NULL;
+
+// 保留公開（受信処理タスクだけが使う、s_mutexで保護）
+static pending_publish_t s_pending[CHILD_REGISTRY_MAX_NODES];
+static uint8_t s_pending_slots[CHILD_REGISTRY_MAX_NODES];
+static size_t s_pending_count = 0;
+static int64_t s_pending_recv_us[CHILD_REGISTRY_MAX_NODES];    // 公開時の遅延記録用
+
+// STALE判定・スロット解放の期限（スロット番号で索引、s_mutexで保護）
+static timer_wheel_t s_timers;
+static timer_wheel_entry_t s_timer_entries[CHILD_REGISTRY_MAX_NODES];
+static uint16_t s_expired[CHILD_REGISTRY_MAX_NODES];
+static child_timer_stats_t s_timer_stats;
+static _Atomic uint32_t s_active_count = 0;     // ACTIVEな子機数（遷移のたびに増減）
+
+// 測定値の履歴（スロット番号で索引、s_mutexで保護、登録・解放時に空にする）
+static sensor_history_t s_history[CHILD_REGISTRY_MAX_NODES];
+
+// 閉じた履歴ブロックの保存待ち（s_mutexで保護、保存タスクが古い順に取り出す。満杯なら最も古いものを捨てる）
+typedef struct {
+    uint8_t child_no;
+    uint8_t block[SENSOR_HISTORY_BLOCK_BYTES];
+} sealed_block_t;
+
+static sealed_block_t s_sealed[CHILD_SEALED_BLOCKS];
+static size_t s_sealed_head = 0;
+static size_t s_sealed_count = 0;
+static child_sealed_stats_t s_sealed_stats;
+
+// 測定値の集計（s_mutexで保護、測定値を受けた子機に空きから割り当て、スロット解放で返す）
+static sensor_rollup_t s_rollups[CHILD_ROLLUP_MAX_CHILDREN];
+static uint8_t s_rollup_of[CHILD_REGISTRY_MAX_NODES];   // スロット → 集計領域+1（0=なし）
+static uint8_t s_free_rollups[CHILD_ROLLUP_MAX_CHILDREN];
+static size_t s_free_rollup_count = 0;
+
+// 公開ビュー（書き込みはs_mutexを持ったままクリティカルセクション内で行うため、ライタは常に1つで
+// 書きかけのまま横取りされることもない。リーダはロックを取らない）
+#define VIEW_WORDS          SEQLOCK_WORDS(child_view_t)
+#define VIEW_READ_SPIN_MAX  16      // これ以上やり直したら1tick譲る
+
+static _Atomic uint32_t s_view_words[CHILD_REGISTRY_MAX_NODES][VIEW_WORDS];
+static _Atomic uint32_t s_view_version = 0;     // 公開済みの最新バージョン（シーケンスロック内で更新）
+static uint32_t s_next_version = 0;             // 最後に振ったバージョン（s_mutexで保護）
+static seqlock_t s_view_lock = SEQLOCK_INITIALIZER;
+static portMUX_TYPE s_view_mux = portMUX_INITIALIZER_UNLOCKED;
+static _Atomic uint32_t s_view_publishes = 0;
+static _Atomic uint32_t s_view_reads = 0;
+static _Atomic uint32_t s_view_snapshots = 0;
+static _Atomic uint32_t s_view_retries = 0;
+static _Atomic uint32_t s_view_yields = 0;
+
+// 更新通知の購読タスク（登録は起動時のみ、件数を増やす前に要素を書く）
+static TaskHandle_t s_subscribers[CHILD_REGISTRY_MAX_SUBSCRIBERS];
+static _Atomic uint32_t s_subscriber_count = 0;
+static _Atomic uint32_t s_notifies = 0;
+static TaskHandle_t volatile s_sealed_consumer = NULL;  // 保存待ちの取り出しタスク（保存待ちへ写すたびに起こす）
+
+_Static_assert(sizeof(child_view_t) % sizeof(uint32_t) == 0, "child view must be word aligned");
+_Static_assert(CHILD_REGISTRY_MAX_NODES < IP_HASH_EMPTY, "slot number must fit in uint8_t");
+_Static_assert(CHILD_SEQ_WINDOW <= 32, "seq window must fit in uint32_t");
+_Static_assert(CHILD_ROLLUP_MAX_CHILDREN <= CHILD_REGISTRY_MAX_NODES && CHILD_ROLLUP_MAX_CHILDREN < 255,
+               "rollup index must fit in uint8_t");
+_Static_assert(IP_HASH_SIZE >= CHILD_REGISTRY_MAX_NODES * 2, "IP hash load factor must stay <= 0.5");
+_Static_assert(CHILD_WARM_MAX_CHILDREN <= CHILD_REGISTRY_MAX_NODES && CHILD_WARM_MAX_ROLLUPS < 255,
+               "warm state index must fit in uint8_t");
+
+// ==== IPハッシュ ====
+static uint32_t ip_hash_home(uint32_t ip)
+{
+    // フィボナッチハッシュ（上位8bitを使用）
+    return (ip * 2654435761u) >> 24;
+}
+
+static int ip_hash_find(uint32_t ip)
+{
+    uint32_t pos = ip_hash_home(ip);
+    for (int n = 0; n < IP_HASH_SIZE; n++) {
+        uint8_t slot = s_ip_hash[pos];
+        if (slot == IP_HASH_EMPTY) {
+            return -1;
+        }
+        if (s_nodes[slot].source_ip == ip) {
+            return slot;
+        }
+        pos = (pos + 1) & (IP_HASH_SIZE - 1);
+    }
+    return -1;
+}
+
+static void ip_hash_insert(uint32_t ip, uint8_t slot)
+{
+    uint32_t pos = ip_hash_home(ip);
+    while (s_ip_hash[pos] != IP_HASH_EMPTY) {
+        pos = (pos + 1) & (IP_HASH_SIZE - 1);
+    }
+    s_ip_hash[pos] = slot;
+}
+
+static void ip_hash_remove(uint32_t ip, uint8_t slot)
+{
+    uint32_t pos = ip_hash_home(ip);
+    while (s_ip_hash[pos] != slot) {
+        if (s_ip_hash[pos] == IP_HASH_EMPTY) {
+            return;  // 未登録
+        }
+        pos = (pos + 1) & (IP_HASH_SIZE - 1);
+    }
+
+    // 後方シフト削除（探査列を途切れさせない）
+    uint32_t hole = pos;
+    uint32_t next = (pos + 1) & (IP_HASH_SIZE - 1);
+    while (s_ip_hash[next] != IP_HASH_EMPTY) {
+        uint32_t home = ip_hash_home(s_nodes[s_ip_hash[next]].source_ip);
+        // homeが(hole, next]の範囲外なら穴へ移動できる
+        if (((next - home) & (IP_HASH_SIZE - 1)) >= ((next - hole) & (IP_HASH_SIZE - 1))) {
+            s_ip_hash[hole] = s_ip_hash[next];
+            hole = next;
+        }
+        next = (next + 1) & (IP_HASH_SIZE - 1);
+    }
+    s_ip_hash[hole] = IP_HASH_EMPTY;
+}
+
+// ==== seq追跡 ====
+typedef enum {
+    SEQ_NEW = 0,        // 最大seqを更新
+    SEQ_REORDERED,      // 窓内の未受信seq（順序逆転）
+    SEQ_DUPLICATE,      // 受信済みseq
+    SEQ_TOO_OLD,        // 窓外の古いseq（重複か判別不可）
+} seq_verdict_t;
+
+static seq_verdict_t seq_classify(child_node_t *node, uint32_t seq)
+{
+    child_seq_stats_t *st = &node->seq_stats;
+    int32_t diff = (int32_t)(seq - st->last_seq);
+
+    if (!node->seq_valid || diff < -CHILD_SEQ_RESTART_GAP || diff > CHILD_SEQ_JUMP_MAX) {
+        // 初回受信、または子機再起動等でseqが不連続 → 再同期
+        if (node->seq_valid) {
+            st->resync++;
+            s_seq_totals.resync++;
+        }
+        node->seq_valid = true;
+        node->seq_window = 1;
+        st->last_seq = seq;
+        return SEQ_NEW;
+    }
+
+    if (diff > 0) {
+        // 前進: 間の欠番を計上
+        uint32_t gap = (uint32_t)diff - 1;
+        st->lost += gap;
+        s_seq_totals.lost += gap;
+        node->seq_window = (diff >= CHILD_SEQ_WINDOW) ? 1 : ((node->seq_window << diff) | 1);
+        st->last_seq = seq;
+        return SEQ_NEW;
+    }
+
+    uint32_t offset = (uint32_t)(-diff);
+    if (offset >= CHILD_SEQ_WINDOW) {
+        return SEQ_TOO_OLD;
+    }
+    if (node->seq_window & (1u << offset)) {
+        return SEQ_DUPLICATE;
+    }
+
+    // 欠番として計上済みのseqが遅れて届いた
+    node->seq_window |= (1u << offset);
+    if (st->lost > 0) {
+        st->lost--;
+    }
+    if (s_seq_totals.lost > 0) {
+        s_seq_totals.lost--;
+    }
+    return SEQ_REORDERED;
+}
+
+// ==== 送信間隔 ====
+static uint32_t node_stale_timeout_ms(const child_node_t *node)
+{
+    uint32_t timeout_ms = node->report_interval_ms * CHILD_STALE_MISSED_REPORTS;
+    return (timeout_ms > CHILD_STALE_TIMEOUT_MS) ? timeout_ms : CHILD_STALE_TIMEOUT_MS;
+}
+
+// ==== 公開ビュー ====
+// スロットの現在の状態を公開（s_mutex取得済みで呼ぶ）
+// changed=true: 表示・送信し直す必要のある変化（新しい測定値・登録・解放・ACTIVE/STALEの遷移等）。
+//               新しいバージョンを振り、解放後に購読タスクへ通知する
+// changed=false: 最終受信時刻だけの更新等。バージョンは変えず、購読タスクも起こさない
+static void view_publish(uint8_t slot, bool changed)
+{
+    child_node_t *node = &s_nodes[slot];
+    if (changed) {
+        node->version = ++s_next_version;
+    }
+    child_view_t view = {
+        .reading = node->latest,
+        .commit_us = node->commit_us,
+        .commit_delay_us = node->commit_delay_us,
+        .last_recv_ms = node->last_recv_time_ms,
+        .version = node->version,
+        .child_no = node->child_no,
+        .has_reading = node->has_reading,
+        .active = node->child_no != 0 && node->state == CHILD_STATE_ACTIVE,
+        .restored = node->restored,
+    };
+
+    taskENTER_CRITICAL(&s_view_mux);
+    seqlock_write_begin(&s_view_lock);
+    seqlock_store_words(s_view_words[slot], &view, VIEW_WORDS);
+    atomic_store_explicit(&s_view_version, s_next_version, memory_order_relaxed);
+    seqlock_write_end(&s_view_lock);
+    taskEXIT_CRITICAL(&s_view_mux);
+    atomic_fetch_add_explicit(&s_view_publishes, 1, memory_order_relaxed);
+}
+
+// 書き込みと重なった時のやり直し（続いたら書き込み側のコアへ1tick譲る）
+static void view_read_backoff(uint32_t *retries)
+{
+    (*retries)++;
+    atomic_fetch_add_explicit(&s_view_retries, 1, memory_order_relaxed);
+    if (*retries % VIEW_READ_SPIN_MAX == 0) {
+        atomic_fetch_add_explicit(&s_view_yields, 1, memory_order_relaxed);
+        vTaskDelay(1);
+    }
+}
+
+// 先頭slotからwords語を写す（ロックなし）
+// 戻り値: 写した時点で公開済みの最新バージョン
+static uint32_t view_read(void *dst, int slot, size_t words)
+{
+    uint32_t retries = 0;
+    for (;;) {
+        uint32_t start = seqlock_read_begin(&s_view_lock);
+        seqlock_load_words(dst, s_view_words[slot], words);
+        uint32_t version = atomic_load_explicit(&s_view_version, memory_order_relaxed);
+        if (!seqlock_read_retry(&s_view_lock, start)) {
+            return version;
+        }
+        view_read_backoff(&retries);
+    }
+}
+
+// ==== 更新通知 ====
+// 購読タスクを起こす（s_mutex解放後に呼ぶ。通知は数えず溜まるだけなので、連続した変化は1回の起床にまとまる）
+static void notify_subscribers(void)
+{
+    uint32_t count = atomic_load_explicit(&s_subscriber_count, memory_order_acquire);
+    for (uint32_t i = 0; i < count; i++) {
+        xTaskNotifyGive(s_subscribers[i]);
+    }
+    atomic_fetch_add_explicit(&s_notifies, 1, memory_order_relaxed);
+}
+
+// ==== 期限（タイマーホイール） ====
+// ACTIVEならSTALE判定、STALEならスロット解放の期限を最終受信時刻から設定（s_mutex取得済みで呼ぶ）
+static void node_arm_timer(uint8_t slot)
+{
+    const child_node_t *node = &s_nodes[slot];
+    uint32_t timeout_ms = CHILD_EXPIRE_TIMEOUT_MS;
+    if (node->state == CHILD_STATE_ACTIVE) {
+        uint32_t stale_ms = node_stale_timeout_ms(node);
+        if (stale_ms < timeout_ms) {
+            timeout_ms = stale_ms;
+        }
+    }
+    timer_wheel_arm(&s_timers, slot, node->last_recv_time_ms + timeout_ms);
+}
+
+static void node_set_state(child_node_t *node, child_state_t state)
+{
+    if (node->state == state) {
+        return;
+    }
+    node->state = state;
+    if (state == CHILD_STATE_ACTIVE) {
+        atomic_fetch_add_explicit(&s_active_count, 1, memory_order_relaxed);
+    } else {
+        atomic_fetch_sub_explicit(&s_active_count, 1, memory_order_relaxed);
+    }
+}
+
+// ==== 保存待ちの履歴ブロック ====
+// 閉じたブロックを保存待ちへ写し、取り出しタスクを起こす（s_mutex取得済みで呼ぶ。通知は待たないためロック内でよい）
+static void sealed_push(uint8_t child_no, const uint8_t *block)
+{
+    if (s_sealed_count == CHILD_SEALED_BLOCKS) {
+        // 保存が追いつかない: 最も古いものを捨てる
+        s_sealed_head = (s_sealed_head + 1) % CHILD_SEALED_BLOCKS;
+        s_sealed_count--;
+        s_sealed_stats.dropped++;
+    }
+    sealed_block_t *entry = &s_sealed[(s_sealed_head + s_sealed_count) % CHILD_SEALED_BLOCKS];
+    entry->child_no = child_no;
+    memcpy(entry->block, block, SENSOR_HISTORY_BLOCK_BYTES);
+    s_sealed_count++;
+    s_sealed_stats.sealed++;
+
+    TaskHandle_t consumer = s_sealed_consumer;
+    if (consumer != NULL) {
+        xTaskNotifyGive(consumer);
+    }
+}
+
+// ==== スロット管理 ====
+static void slot_release(uint8_t slot)
+{
+    child_node_t *node = &s_nodes[slot];
+    // 書き込み中のブロックも単独で復号できるため、閉じたものとして保存へ回す
+    size_t blocks = sensor_history_block_count(&s_history[slot]);
+    if (blocks > 0) {
+        sealed_push(node->child_no, sensor_history_block(&s_history[slot], blocks - 1));
+    }
+    timer_wheel_cancel(&s_timers, slot);
+    node_set_state(node, CHILD_STATE_STALE);
+    ip_hash_remove(node->source_ip, slot);
+    s_no_index[node->child_no] = 0;
+    atomic_fetch_and_explicit(&s_no_bitmap[node->child_no / 32], ~(1u << (node->child_no % 32)),
+                              memory_order_release);
+    node->child_no = 0;
+    node->source_ip = 0;
+    node->has_reading = false;
+    s_pending[slot].changed = false;    // 解放はここで公開する（保留の一覧には残り、空きとして公開し直すだけ）
+    s_pending[slot].advanced = false;
+    sensor_history_reset(&s_history[slot]);
+    if (s_rollup_of[slot] != 0) {
+        s_free_rollups[s_free_rollup_count++] = (uint8_t)(s_rollup_of[slot] - 1);
+        s_rollup_of[slot] = 0;
+    }
+    s_free_slots[s_free_count++] = slot;
+    view_publish(slot, true);
+}
+
+// 満杯時: 最も長く無通信のSTALEスロットを回収
+static int slot_reclaim_oldest_stale(uint32_t current_time_ms)
+{
+    int oldest = -1;
+    uint32_t oldest_elapsed = 0;
+    for (int i = 0; i < CHILD_REGISTRY_MAX_NODES; i++) {
+        if (s_nodes[i].child_no == 0 || s_nodes[i].state != CHILD_STATE_STALE) {
+            continue;
+        }
+        uint32_t elapsed = current_time_ms - s_nodes[i].last_recv_time_ms;
+        if (oldest < 0 || elapsed > oldest_elapsed) {
+            oldest = i;
+            oldest_elapsed = elapsed;
+        }
+    }
+    if (oldest >= 0) {
+        syslog(WARN, "[RECLAIM] N=%d slot=%d idle=%lums", s_nodes[oldest].child_no, oldest,
+               (unsigned long)oldest_elapsed);
+        slot_release((uint8_t)oldest);
+    }
+    return oldest;
+}
+
+static int slot_alloc(uint32_t current_time_ms)
+{
+    if (s_free_count == 0 && slot_reclaim_oldest_stale(current_time_ms) < 0) {
+        return -1;
+    }
+    return s_free_slots[--s_free_count];
+}
+
+// ==== 公開関数 ====
+void child_registry_init(void)
+{
+    if (s_mutex == NULL) {
+        s_mutex = xSemaphoreCreateMutex();
+        configASSERT(s_mutex);
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    memset(s_nodes, 0, sizeof(s_nodes));
+    memset(s_pending, 0, sizeof(s_pending));
+    s_pending_count = 0;
+    memset(s_no_index, 0, sizeof(s_no_index));
+    memset(s_ip_hash, IP_HASH_EMPTY, sizeof(s_ip_hash));
+    for (int w = 0; w < BITMAP_WORDS; w++) {
+        atomic_store_explicit(&s_no_bitmap[w], 0, memory_order_relaxed);
+    }
+    memset(&s_seq_totals, 0, sizeof(s_seq_totals));
+    memset(&s_arrival_stats, 0, sizeof(s_arrival_stats));
+    memset(&s_timer_stats, 0, sizeof(s_timer_stats));
+    memset(s_history, 0, sizeof(s_history));
+    s_sealed_head = 0;
+    s_sealed_count = 0;
+    memset(&s_sealed_stats, 0, sizeof(s_sealed_stats));
+    memset(s_rollup_of, 0, sizeof(s_rollup_of));
+    s_free_rollup_count = 0;
+    for (int i = CHILD_ROLLUP_MAX_CHILDREN - 1; i >= 0; i--) {
+        s_free_rollups[s_free_rollup_count++] = (uint8_t)i;
+    }
+    timer_wheel_init(&s_timers, s_timer_entries, CHILD_REGISTRY_MAX_NODES, CHILD_TIMER_TICK_MS,
+                     xTaskGetTickCount() * portTICK_PERIOD_MS);
+    for (int i = 0; i < CHILD_REGISTRY_MAX_NODES; i++) {
+        s_nodes[i].state = CHILD_STATE_STALE;   // 空きスロットはACTIVEな子機数に数えない
+        view_publish((uint8_t)i, false);
+    }
+    atomic_store_explicit(&s_active_count, 0, memory_order_relaxed);
+    // 若い番号のスロットから使用する
+    s_free_count = 0;
+    for (int i = CHILD_REGISTRY_MAX_NODES - 1; i >= 0; i--) {
+        s_free_slots[s_free_count++] = (uint8_t)i;
+    }
+    xSemaphoreGive(s_mutex);
+
+    child_registry_dump();
+}
+
+// 登録・受信時刻・送信位相の更新（s_mutex取得済みで呼ぶ）
+// changed: 新規登録・STALEからの復帰・STALE判定時間の変更でtrue
+static int node_update(uint8_t child_no, uint32_t source_ip, uint32_t current_time_ms, bool *changed)
+{
+    int slot = (int)s_no_index[child_no] - 1;
+    if (slot < 0) {
+        // 新規登録
+        slot = slot_alloc(current_time_ms);
+        if (slot < 0) {
+            syslog(WARN, "Child table full, cannot register child_no=%d", child_no);
+            return -1;
+        }
+        memset(&s_nodes[slot], 0, sizeof(child_node_t));
+        sensor_history_reset(&s_history[slot]);
+        s_nodes[slot].state = CHILD_STATE_STALE;   // 下でACTIVEにする
+        s_nodes[slot].child_no = child_no;
+        s_nodes[slot].source_ip = source_ip;
+        s_no_index[child_no] = (uint8_t)(slot + 1);
+        atomic_fetch_or_explicit(&s_no_bitmap[child_no / 32], 1u << (child_no % 32), memory_order_release);
+        ip_hash_insert(source_ip, (uint8_t)slot);
+        *changed = true;
+    } else if (s_nodes[slot].source_ip != source_ip) {
+        // 送信元IPが変わった（DHCP再割当等）
+        ip_hash_remove(s_nodes[slot].source_ip, (uint8_t)slot);
+        s_nodes[slot].source_ip = source_ip;
+        ip_hash_insert(source_ip, (uint8_t)slot);
+    }
+
+    // 更新
+    child_node_t *node = &s_nodes[slot];
+    if (node->restored) {
+        // 再起動前の測定値を再起動後の最新値として見せない（測定値を含む受信ならこの後で置き換わる）
+        node->restored = false;
+        node->has_reading = false;
+        *changed = true;
+    }
+    node->last_recv_time_ms = current_time_ms;
+    if (node->state != CHILD_STATE_ACTIVE) {
+        node_set_state(node, CHILD_STATE_ACTIVE);
+        *changed = true;
+    }
+    if (node->pending_interval_ms != 0) {
+        // 短縮した指示間隔は受信を1回挟んでから判定に使う
+        node->report_interval_ms = node->pending_interval_ms;
+        node->pending_interval_ms = 0;
+        *changed = true;
+    }
+    node_arm_timer((uint8_t)slot);  // 受信のたびにSTALE判定の期限を付け替える
+    if (node->report_interval_ms != 0) {
+        tx_phase_on_arrival(&node->tx_phase, current_time_ms, node->report_interval_ms);
+    }
+    tx_arrival_note(&s_arrival_stats, current_time_ms);
+    return slot;
+}
+
+int child_registry_update(uint8_t child_no, uint32_t source_ip, uint32_t current_time_ms)
+{
+    if (s_mutex == NULL || child_no < CHILD_NO_MIN || child_no > CHILD_NO_MAX) {
+        return -1;
+    }
+
+    bool changed = false;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    int slot = node_update(child_no, source_ip, current_time_ms, &changed);
+    if (slot >= 0) {
+        view_publish((uint8_t)slot, changed);
+    }
+    xSemaphoreGive(s_mutex);
+
+    if (changed) {
+        notify_subscribers();
+    }
+    return slot;
+}
+
+// スロットの集計領域（なければ空きから割り当てる、空きがなければNULL）（s_mutex取得済みで呼ぶ）
+static sensor_rollup_t *slot_rollup(uint8_t slot)
+{
+    if (s_rollup_of[slot] == 0) {
+        if (s_free_rollup_count == 0) {
+            return NULL;
+        }
+        uint8_t index = s_free_rollups[--s_free_rollup_count];
+        sensor_rollup_reset(&s_rollups[index]);
+        s_rollup_of[slot] = (uint8_t)(index + 1);
+    }
+    return &s_rollups[s_rollup_of[slot] - 1];
+}
+
+static void reading_store(child_node_t *node, const temp_sens_data_t *src)
+{
+    sensor_data_pack(src, &node->latest);
+    node->has_reading = true;
+}
+
+// seq追跡と最新値の保持（s_mutex取得済みで呼ぶ）
+// 残した測定値をreadings・age_msの先頭へ詰める
+static size_t node_accept(child_node_t *node, temp_sens_data_t *readings, uint16_t *age_ms, size_t count,
+                          bool track_seq, bool *advanced)
+{
+    if (!track_seq) {
+        // seqなし: 到着順で末尾を最新値とする
+        if (count > 0) {
+            reading_store(node, &readings[count - 1]);
+            *advanced = true;
+        }
+        return count;
+    }
+
+    const temp_sens_data_t *newest = NULL;
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+        seq_verdict_t verdict = seq_classify(node, readings[i].seq);
+        switch (verdict) {
+        case SEQ_NEW:
+            newest = &readings[kept];   // 前詰め後の位置
+            break;
+        case SEQ_REORDERED:
+            node->seq_stats.reordered++;
+            s_seq_totals.reordered++;
+            break;
+        case SEQ_TOO_OLD:
+            // 窓外の古い値は重複の可能性があるため破棄（順序逆転として計上）
+            node->seq_stats.reordered++;
+            s_seq_totals.reordered++;
+            continue;
+        case SEQ_DUPLICATE:
+            node->seq_stats.duplicate++;
+            s_seq_totals.duplicate++;
+            continue;
+        }
+        node->seq_stats.received++;
+        s_seq_totals.received++;
+        if (kept != i) {
+            readings[kept] = readings[i];
+            if (age_ms != NULL) {
+                age_ms[kept] = age_ms[i];
+            }
+        }
+        kept++;
+    }
+
+    if (newest != NULL) {
+        reading_store(node, newest);
+        *advanced = true;
+    }
+    return kept;
+}
+
+// 最新値を更新した時の公開時刻と受信からの遅延（受信時刻が不明なら遅延は0とする）（s_mutex取得済みで呼ぶ）
+static void node_commit(child_node_t *node, int64_t recv_us, int64_t commit_us)
+{
+    node->commit_us = commit_us;
+    node->commit_delay_us = (recv_us != 0) ? (uint32_t)(commit_us - recv_us) : 0;
+}
+
+// 登録・seq追跡・履歴への追記・集計（s_mutex取得済みで呼ぶ、公開はしない）
+// kept: 残った測定値数、changed: 公開ビューに表示し直す変化があればtrue
+// 戻り値: スロット番号、登録できなかった場合は-1
+static int node_ingest(uint8_t child_no, uint32_t source_ip, uint32_t current_time_ms,
+                       temp_sens_data_t *readings, uint16_t *age_ms, size_t count, bool track_seq,
+                       size_t *kept, bool *advanced, bool *changed)
+{
+    int slot = node_update(child_no, source_ip, current_time_ms, changed);
+    if (slot < 0) {
+        return -1;
+    }
+    *kept = node_accept(&s_nodes[slot], readings, age_ms, count, track_seq, advanced);
+    sensor_rollup_t *rollup = (*kept > 0) ? slot_rollup((uint8_t)slot) : NULL;
+    sensor_history_t *history = &s_history[slot];
+    for (size_t i = 0; i < *kept; i++) {
+        // バッチフレームの測定値は各自の測定時刻で追記・集計する
+        // （直前の追記より古ければ履歴側で切り上げ、集計中バケットより前なら集計側で振り分け）
+        uint32_t time_ms = current_time_ms - ((age_ms != NULL) ? age_ms[i] : 0);
+        if (sensor_history_append(history, time_ms, &readings[i])) {
+            sealed_push(child_no, sensor_history_block(history, sensor_history_block_count(history) - 2));
+        }
+        if (rollup != NULL) {
+            sensor_rollup_add(rollup, time_ms, &readings[i]);
+        }
+    }
+    *changed |= *advanced;
+    return slot;
+}
+
+int child_registry_ingest(uint8_t child_no, uint32_t source_ip, uint32_t current_time_ms, int64_t recv_us,
+                          temp_sens_data_t *readings, uint16_t *age_ms, size_t count, bool track_seq,
+                          bool *advanced)
+{
+    bool dummy;
+    if (advanced == NULL) {
+        advanced = &dummy;
+    }
+    *advanced = false;
+    if (s_mutex == NULL || readings == NULL || child_no < CHILD_NO_MIN || child_no > CHILD_NO_MAX) {
+        return -1;
+    }
+
+    bool changed = false;
+    size_t kept = 0;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    int slot = node_ingest(child_no, source_ip, current_time_ms, readings, age_ms, count, track_seq,
+                           &kept, advanced, &changed);
+    if (slot < 0) {
+        xSemaphoreGive(s_mutex);
+        return -1;
+    }
+    int64_t commit_us = 0;
+    if (*advanced) {
+        commit_us = esp_timer_get_time();
+        node_commit(&s_nodes[slot], recv_us, commit_us);
+    }
+    view_publish((uint8_t)slot, changed);
+    xSemaphoreGive(s_mutex);
+
+    if (commit_us != 0) {
+        latency_trace_record(LATENCY_RECV_TO_COMMIT, recv_us, commit_us);
+    }
+    if (changed) {
+        notify_subscribers();
+    }
+    return (int)kept;
+}
+
+int child_registry_ingest_deferred(uint8_t child_no, uint32_t source_ip, uint32_t current_time_ms,
+                                   int64_t recv_us, temp_sens_data_t *readings, uint16_t *age_ms, size_t count,
+                                   bool track_seq, bool *advanced)
+{
+    bool dummy;
+    if (advanced == NULL) {
+        advanced = &dummy;
+    }
+    *advanced = false;
+    if (s_mutex == NULL || readings == NULL || child_no < CHILD_NO_MIN || child_no > CHILD_NO_MAX) {
+        return -1;
+    }
+
+    bool changed = false;
+    size_t kept = 0;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    int slot = node_ingest(child_no, source_ip, current_time_ms, readings, age_ms, count, track_seq,
+                           &kept, advanced, &changed);
+    if (slot < 0) {
+        xSemaphoreGive(s_mutex);
+        return -1;
+    }
+    // 同じスロットは1回だけ一覧に載せる（解放・再登録されても保留のまま）
+    pending_publish_t *pending = &s_pending[slot];
+    if (!pending->listed) {
+        pending->listed = true;
+        s_pending_slots[s_pending_count++] = (uint8_t)slot;
+    }
+    pending->changed |= changed;
+    if (*advanced) {
+        pending->advanced = true;
+        pending->recv_us = recv_us;
+    }
+    xSemaphoreGive(s_mutex);
+    return (int)kept;
+}
+
+size_t child_registry_publish_deferred(void)
+{
+    if (s_mutex == NULL) {
+        return 0;
+    }
+
+    size_t published = 0;
+    size_t commits = 0;
+    bool changed = false;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    // 保留した子機は同じ時刻で公開する（遅延はそれぞれの最新値の受信時刻から）
+    int64_t commit_us = (s_pending_count > 0) ? esp_timer_get_time() : 0;
+    for (size_t i = 0; i < s_pending_count; i++) {
+        uint8_t slot = s_pending_slots[i];
+        pending_publish_t *pending = &s_pending[slot];
+        if (pending->advanced) {
+            node_commit(&s_nodes[slot], pending->recv_us, commit_us);
+            if (pending->recv_us != 0) {
+                s_pending_recv_us[commits++] = pending->recv_us;
+            }
+        }
+        view_publish(slot, pending->changed);
+        changed |= pending->changed;
+        memset(pending, 0, sizeof(*pending));
+        published++;
+    }
+    s_pending_count = 0;
+    xSemaphoreGive(s_mutex);
+
+    // s_pending_recv_usは受信処理タスクだけが書くため、ロックの外で読んでよい
+    for (size_t i = 0; i < commits; i++) {
+        latency_trace_record(LATENCY_RECV_TO_COMMIT, s_pending_recv_us[i], commit_us);
+    }
+    if (changed) {
+        notify_subscribers();
+    }
+    return published;
+}
+
+bool child_registry_read_latest(uint8_t child_no, temp_sens_data_t *data)
+{
+    if (data == NULL) {
+        return false;
+    }
+
+    int slot = child_registry_slot_of(child_no);
+    if (slot >= 0) {
+        child_view_t view;
+        view_read(&view, slot, VIEW_WORDS);
+        atomic_fetch_add_explicit(&s_view_reads, 1, memory_order_relaxed);
+        if (child_view_fresh(&view, child_no)) {
+            sensor_data_unpack(&view.reading, data);
+            return true;
+        }
+    }
+    memset(data, 0, sizeof(*data));
+    return false;
+}
+
+bool child_registry_read_view(uint8_t child_no, child_view_t *view)
+{
+    if (view == NULL) {
+        return false;
+    }
+
+    int slot = child_registry_slot_of(child_no);
+    if (slot >= 0) {
+        view_read(view, slot, VIEW_WORDS);
+        atomic_fetch_add_explicit(&s_view_reads, 1, memory_order_relaxed);
+        if (view->child_no == child_no) {
+            return true;
+        }
+    }
+    memset(view, 0, sizeof(*view));
+    return false;
+}
+
+uint32_t child_registry_snapshot(child_view_t *views)
+{
+    if (views == NULL) {
+        return 0;
+    }
+    uint32_t version = view_read(views, 0, CHILD_REGISTRY_MAX_NODES * VIEW_WORDS);
+    atomic_fetch_add_explicit(&s_view_snapshots, 1, memory_order_relaxed);
+    return version;
+}
+
+uint32_t child_registry_version(void)
+{
+    return atomic_load_explicit(&s_view_version, memory_order_acquire);
+}
+
+bool child_registry_subscribe(void *task)
+{
+    if (task == NULL) {
+        return false;
+    }
+
+    // child_registry_init()より先に起動したタスクも購読できるよう、s_mutexではなくs_view_muxで守る
+    bool ok = false;
+    taskENTER_CRITICAL(&s_view_mux);
+    uint32_t count = atomic_load_explicit(&s_subscriber_count, memory_order_relaxed);
+    if (count < CHILD_REGISTRY_MAX_SUBSCRIBERS) {
+        s_subscribers[count] = (TaskHandle_t)task;
+        atomic_store_explicit(&s_subscriber_count, count + 1, memory_order_release);
+        ok = true;
+    }
+    taskEXIT_CRITICAL(&s_view_mux);
+
+    if (!ok) {
+        syslog(WARN, "Child registry: too many subscribers (max %d)", CHILD_REGISTRY_MAX_SUBSCRIBERS);
+    }
+    return ok;
+}
+
+void child_registry_get_view_stats(child_view_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    stats->publishes = atomic_load_explicit(&s_view_publishes, memory_order_relaxed);
+    stats->reads = atomic_load_explicit(&s_view_reads, memory_order_relaxed);
+    stats->snapshots = atomic_load_explicit(&s_view_snapshots, memory_order_relaxed);
+    stats->retries = atomic_load_explicit(&s_view_retries, memory_order_relaxed);
+    stats->yields = atomic_load_explicit(&s_view_yields, memory_order_relaxed);
+    stats->version = atomic_load_explicit(&s_view_version, memory_order_relaxed);
+    stats->notifies = atomic_load_explicit(&s_notifies, memory_order_relaxed);
+}
+
+bool child_registry_get_seq_stats(uint8_t child_no, child_seq_stats_t *stats)
+{
+    if (s_mutex == NULL || stats == NULL) {
+        return false;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    int slot = (int)s_no_index[child_no] - 1;
+    if (slot >= 0) {
+        *stats = s_nodes[slot].seq_stats;
+    }
+    xSemaphoreGive(s_mutex);
+
+    return slot >= 0;
+}
+
+bool child_registry_copy_history(uint8_t child_no, sensor_history_t *history)
+{
+    if (s_mutex == NULL || history == NULL) {
+        return false;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    int slot = (int)s_no_index[child_no] - 1;
+    if (slot >= 0) {
+        *history = s_history[slot];
+    }
+    xSemaphoreGive(s_mutex);
+
+    return slot >= 0;
+}
+
+void child_registry_set_sealed_consumer(void *task)
+{
+    s_sealed_consumer = (TaskHandle_t)task;
+}
+
+bool child_registry_take_sealed(uint8_t *child_no, uint8_t *block)
+{
+    if (s_mutex == NULL || child_no == NULL || block == NULL) {
+        return false;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    bool found = (s_sealed_count > 0);
+    if (found) {
+        const sealed_block_t *entry = &s_sealed[s_sealed_head];
+        *child_no = entry->child_no;
+        memcpy(block, entry->block, SENSOR_HISTORY_BLOCK_BYTES);
+        s_sealed_head = (s_sealed_head + 1) % CHILD_SEALED_BLOCKS;
+        s_sealed_count--;
+    }
+    xSemaphoreGive(s_mutex);
+
+    return found;
+}
+
+void child_registry_get_sealed_stats(child_sealed_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    if (s_mutex == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    *stats = s_sealed_stats;
+    stats->pending = (uint32_t)s_sealed_count;
+    xSemaphoreGive(s_mutex);
+}
+
+bool child_registry_copy_rollup(uint8_t child_no, sensor_rollup_t *rollup)
+{
+    if (s_mutex == NULL || rollup == NULL) {
+        return false;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    int slot = (int)s_no_index[child_no] - 1;
+    bool found = (slot >= 0 && s_rollup_of[slot] != 0);
+    if (found) {
+        *rollup = s_rollups[s_rollup_of[slot] - 1];
+    }
+    xSemaphoreGive(s_mutex);
+
+    return found;
+}
+
+void child_registry_get_seq_totals(child_seq_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    if (s_mutex == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    *stats = s_seq_totals;
+    xSemaphoreGive(s_mutex);
+}
+
+bool child_registry_get_source_ip(uint8_t child_no, uint32_t *source_ip)
+{
+    if (s_mutex == NULL || source_ip == NULL) {
+        return false;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    int slot = (int)s_no_index[child_no] - 1;
+    if (slot >= 0) {
+        *source_ip = s_nodes[slot].source_ip;
+    }
+    xSemaphoreGive(s_mutex);
+
+    return slot >= 0;
+}
+
+void child_registry_set_report_interval(uint8_t child_no, uint32_t interval_ms)
+{
+    if (s_mutex == NULL) {
+        return;
+    }
+
+    bool changed = false;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    int slot = (int)s_no_index[child_no] - 1;
+    if (slot >= 0) {
+        child_node_t *node = &s_nodes[slot];
+        uint32_t old_timeout_ms = node_stale_timeout_ms(node);
+        if (interval_ms >= node->report_interval_ms) {
+            node->report_interval_ms = interval_ms;
+            node->pending_interval_ms = 0;
+        } else {
+            node->pending_interval_ms = interval_ms;
+        }
+        changed = node_stale_timeout_ms(node) != old_timeout_ms;
+        if (changed && node->state == CHILD_STATE_ACTIVE) {
+            node_arm_timer((uint8_t)slot);
+        }
+        view_publish((uint8_t)slot, changed);
+    }
+    xSemaphoreGive(s_mutex);
+
+    if (changed) {
+        notify_subscribers();
+    }
+}
+
+bool child_registry_get_tx_phase(uint8_t child_no, tx_phase_t *phase)
+{
+    if (s_mutex == NULL || phase == NULL) {
+        return false;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    int slot = (int)s_no_index[child_no] - 1;
+    if (slot >= 0) {
+        *phase = s_nodes[slot].tx_phase;
+    }
+    xSemaphoreGive(s_mutex);
+
+    return slot >= 0;
+}
+
+void child_registry_restart_tx_phase(uint8_t child_no)
+{
+    if (s_mutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    int slot = (int)s_no_index[child_no] - 1;
+    if (slot >= 0) {
+        tx_phase_restart(&s_nodes[slot].tx_phase);
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+void child_registry_get_arrival_stats(tx_arrival_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    if (s_mutex == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    *stats = s_arrival_stats;
+    xSemaphoreGive(s_mutex);
+}
+
+int child_registry_slot_of(uint8_t child_no)
+{
+    // 1バイト読み出しのためロック不要
+    return (int)s_no_index[child_no] - 1;
+}
+
+bool child_registry_find_by_ip(uint32_t source_ip, uint8_t *child_no)
+{
+    if (s_mutex == NULL) {
+        return false;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    int slot = ip_hash_find(source_ip);
+    if (slot >= 0 && child_no != NULL) {
+        *child_no = s_nodes[slot].child_no;
+    }
+    xSemaphoreGive(s_mutex);
+
+    return slot >= 0;
+}
+
+size_t child_registry_list(child_registry_ref_t *out, size_t max_count)
+{
+    if (s_mutex == NULL || out == NULL) {
+        return 0;
+    }
+
+    // ロックなし: ビットマップは1語ずつ、子機No → スロットは1バイトずつ読む。
+    // 読んでいる間に解放された子機は飛ばし、スロットが再利用された場合は公開ビューの子機Noで読み出し側が弾く
+    size_t count = 0;
+    for (int w = 0; w < BITMAP_WORDS && count < max_count; w++) {
+        uint32_t bits = atomic_load_explicit(&s_no_bitmap[w], memory_order_acquire);
+        while (bits != 0 && count < max_count) {
+            int bit = __builtin_ctz(bits);
+            bits &= bits - 1;
+            uint8_t no = (uint8_t)(w * 32 + bit);
+            uint8_t index = s_no_index[no];
+            if (index == 0) {
+                continue;
+            }
+            out[count].child_no = no;
+            out[count].slot = (uint8_t)(index - 1);
+            count++;
+        }
+    }
+
+    return count;
+}
+
+bool child_registry_has_active(void)
+{
+    return child_registry_count_active() > 0;
+}
+
+size_t child_registry_count_active(void)
+{
+    if (s_mutex == NULL) {
+        return 0;  // まだ初期化されていない
+    }
+    return atomic_load_explicit(&s_active_count, memory_order_relaxed);
+}
+
+uint32_t child_registry_check_timeouts(uint32_t current_time_ms)
+{
+    if (s_mutex == NULL) {
+        return CHILD_EXPIRE_TIMEOUT_MS;
+    }
+
+    bool changed = false;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    size_t fired = timer_wheel_advance(&s_timers, current_time_ms, s_expired);
+    s_timer_stats.fired += fired;
+    for (size_t i = 0; i < fired; i++) {
+        uint8_t slot = (uint8_t)s_expired[i];
+        child_node_t *node = &s_nodes[slot];
+        uint32_t elapsed_ms = current_time_ms - node->last_recv_time_ms;
+
+        if (elapsed_ms >= CHILD_EXPIRE_TIMEOUT_MS) {
+            // 長時間無通信 → スロット解放
+            syslog(WARN, "[EXPIRE] N=%d last_seen=%lums", node->child_no, (unsigned long)elapsed_ms);
+            slot_release(slot);
+            s_timer_stats.expired++;
+            changed = true;
+        } else if (node->state == CHILD_STATE_ACTIVE && elapsed_ms >= node_stale_timeout_ms(node)) {
+            // ACTIVE → STALE に遷移し、解放の期限を設定
+            node_set_state(node, CHILD_STATE_STALE);
+            syslog(WARN, "[STALE] N=%d last_seen=%lums", node->child_no, (unsigned long)elapsed_ms);
+            node_arm_timer(slot);
+            view_publish(slot, true);
+            s_timer_stats.stale++;
+            changed = true;
+        } else {
+            node_arm_timer(slot);  // 期限前（判定時間の延長等）: 付け替えのみ
+        }
+    }
+    s_timer_stats.armed = s_timers.armed;
+    uint32_t next_ms = timer_wheel_next_ms(&s_timers, current_time_ms, CHILD_EXPIRE_TIMEOUT_MS);
+    xSemaphoreGive(s_mutex);
+
+    if (changed) {
+        notify_subscribers();
+    }
+    return next_ms;
+}
+
+void child_registry_get_timer_stats(child_timer_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    if (s_mutex == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    *stats = s_timer_stats;
+    stats->armed = s_timers.armed;
+    xSemaphoreGive(s_mutex);
+}
+
+// ==== 再起動をまたぐ状態 ====
+size_t child_registry_save_warm(child_warm_state_t *state, uint32_t current_time_ms)
+{
+    if (state == NULL) {
+        return 0;
+    }
+    memset(state, 0, sizeof(*state));
+    if (s_mutex == NULL) {
+        return 0;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    // 測定値を持つ子機を最終受信の新しい順に選ぶ（挿入ソート、再起動前に1回だけ）
+    uint8_t order[CHILD_WARM_MAX_CHILDREN];
+    size_t count = 0;
+    for (int i = 0; i < CHILD_REGISTRY_MAX_NODES; i++) {
+        const child_node_t *node = &s_nodes[i];
+        if (node->child_no == 0 || !node->has_reading) {
+            continue;
+        }
+        uint32_t age_ms = current_time_ms - node->last_recv_time_ms;
+        size_t pos = count;
+        while (pos > 0 && current_time_ms - s_nodes[order[pos - 1]].last_recv_time_ms > age_ms) {
+            pos--;
+        }
+        if (pos >= CHILD_WARM_MAX_CHILDREN) {
+            continue;
+        }
+        if (count < CHILD_WARM_MAX_CHILDREN) {
+            count++;
+        }
+        memmove(&order[pos + 1], &order[pos], count - 1 - pos);
+        order[pos] = (uint8_t)i;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        uint8_t slot = order[i];
+        const child_node_t *node = &s_nodes[slot];
+        child_warm_node_t *warm = &state->nodes[i];
+        warm->reading = node->latest;
+        warm->source_ip = node->source_ip;
+        warm->age_ms = current_time_ms - node->last_recv_time_ms;
+        warm->last_seq = node->seq_stats.last_seq;
+        warm->report_interval_ms = node->report_interval_ms;
+        warm->child_no = node->child_no;
+        warm->seq_valid = node->seq_valid;
+        if (s_rollup_of[slot] != 0 && state->rollup_count < CHILD_WARM_MAX_ROLLUPS) {
+            const sensor_rollup_t *rollup = &s_rollups[s_rollup_of[slot] - 1];
+            sensor_rollup_bucket_t *buckets = state->rollups[state->rollup_count];
+            for (int level = 0; level < SENSOR_ROLLUP_LEVELS; level++) {
+                buckets[level] = rollup->open[level];
+                buckets[level].start_ms = current_time_ms - rollup->open[level].start_ms;
+            }
+            warm->rollup = (uint8_t)++state->rollup_count;
+        }
+    }
+    state->count = (uint32_t)count;
+    xSemaphoreGive(s_mutex);
+
+    return count;
+}
+
+size_t child_registry_restore_warm(const child_warm_state_t *state, uint32_t current_time_ms)
+{
+    if (s_mutex == NULL || state == NULL || state->count > CHILD_WARM_MAX_CHILDREN ||
+        state->rollup_count > CHILD_WARM_MAX_ROLLUPS) {
+        return 0;
+    }
+
+    size_t restored = 0;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (uint32_t i = 0; i < state->count && s_free_count > 0; i++) {
+        const child_warm_node_t *warm = &state->nodes[i];
+        if (warm->child_no < CHILD_NO_MIN || warm->child_no > CHILD_NO_MAX || s_no_index[warm->child_no] != 0) {
+            continue;
+        }
+        uint8_t slot = s_free_slots[--s_free_count];
+        child_node_t *node = &s_nodes[slot];
+        memset(node, 0, sizeof(*node));
+        sensor_history_reset(&s_history[slot]);
+        node->state = CHILD_STATE_STALE;
+        node->child_no = warm->child_no;
+        node->source_ip = warm->source_ip;
+        node->last_recv_time_ms = current_time_ms - warm->age_ms;
+        node->latest = warm->reading;
+        node->has_reading = true;
+        node->restored = true;
+        node->seq_valid = (warm->seq_valid != 0);
+        node->seq_window = 1;
+        node->seq_stats.last_seq = warm->last_seq;
+        node->report_interval_ms = warm->report_interval_ms;
+        s_no_index[node->child_no] = (uint8_t)(slot + 1);
+        atomic_fetch_or_explicit(&s_no_bitmap[node->child_no / 32], 1u << (node->child_no % 32),
+                                 memory_order_release);
+        ip_hash_insert(node->source_ip, slot);
+
+        if (warm->rollup != 0 && warm->rollup <= state->rollup_count) {
+            sensor_rollup_t *rollup = slot_rollup(slot);
+            if (rollup != NULL) {
+                // バケットの境界は引き継いだ開始時刻から数える（周期を過ぎたら次の測定値で閉じる）
+                const sensor_rollup_bucket_t *buckets = state->rollups[warm->rollup - 1];
+                for (int level = 0; level < SENSOR_ROLLUP_LEVELS; level++) {
+                    rollup->open[level] = buckets[level];
+                    rollup->open[level].start_ms = current_time_ms - buckets[level].start_ms;
+                }
+            }
+        }
+
+        // 再起動後の受信がなければ、引き継いだ時点から無通信の解放時間が過ぎたら解放する
+        timer_wheel_arm(&s_timers, slot, current_time_ms + CHILD_EXPIRE_TIMEOUT_MS);
+        view_publish(slot, true);
+        restored++;
+    }
+    s_timer_stats.armed = s_timers.armed;
+    xSemaphoreGive(s_mutex);
+
+    if (restored > 0) {
+        notify_subscribers();
+    }
+    return restored;
+}
+
+// ダンプ用の子機1台分の写し（s_mutex保持中に写し、ログ出力は解放後）
+typedef struct {
+    uint8_t child_no;
+    uint8_t slot;
+    uint8_t state;
+    uint32_t source_ip;
+    uint32_t report_interval_ms;
+    uint32_t jitter_ms;
+    child_seq_stats_t seq_stats;
+    child_reading_t latest;
+} dump_entry_t;
+
+void child_registry_dump(void)
+{
+    if (s_mutex == NULL) {
+        return;
+    }
+
+    size_t index_bytes = sizeof(s_no_index) + sizeof(s_ip_hash) + sizeof(s_no_bitmap) + sizeof(s_free_slots);
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    size_t used = CHILD_REGISTRY_MAX_NODES - s_free_count;
+    size_t free_rollups = s_free_rollup_count;
+    xSemaphoreGive(s_mutex);
+
+    syslog(INFO, "Child registry: %u slots x %u bytes/entry = %u bytes, index %u bytes, used %u",
+           (unsigned int)CHILD_REGISTRY_MAX_NODES, (unsigned int)sizeof(child_node_t),
+           (unsigned int)sizeof(s_nodes), (unsigned int)index_bytes, (unsigned int)used);
+    syslog(INFO, "Child history: %u slots x %u bytes = %u bytes (%u blocks x %u bytes/slot)",
+           (unsigned int)CHILD_REGISTRY_MAX_NODES, (unsigned int)sizeof(sensor_history_t),
+           (unsigned int)sizeof(s_history), (unsigned int)SENSOR_HISTORY_BLOCKS,
+           (unsigned int)SENSOR_HISTORY_BLOCK_BYTES);
+    syslog(INFO, "Child sealed history: %u blocks x %u bytes = %u bytes",
+           (unsigned int)CHILD_SEALED_BLOCKS, (unsigned int)sizeof(sealed_block_t), (unsigned int)sizeof(s_sealed));
+    syslog(INFO, "Child rollup: %u children x %u bytes = %u bytes, free %u",
+           (unsigned int)CHILD_ROLLUP_MAX_CHILDREN, (unsigned int)sizeof(sensor_rollup_t),
+           (unsigned int)sizeof(s_rollups), (unsigned int)free_rollups);
+
+    child_registry_ref_t refs[16];
+    size_t count = child_registry_list(refs, sizeof(refs) / sizeof(refs[0]));
+    for (size_t i = 0; i < count; i++) {
+        dump_entry_t entry;
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        const child_node_t *node = &s_nodes[refs[i].slot];
+        bool listed = (node->child_no == refs[i].child_no);    // 列挙後に解放・再利用されていない
+        if (listed) {
+            entry.child_no = node->child_no;
+            entry.slot = refs[i].slot;
+            entry.state = node->state;
+            entry.source_ip = node->source_ip;
+            entry.report_interval_ms = node->report_interval_ms;
+            entry.jitter_ms = tx_phase_jitter_ms(&node->tx_phase);
+            entry.seq_stats = node->seq_stats;
+            entry.latest = node->latest;
+        }
+        xSemaphoreGive(s_mutex);
+        if (!listed) {
+            continue;
+        }
+        char ip_str[16];
+        struct in_addr addr = { .s_addr = entry.source_ip };
+        inet_ntop(AF_INET, &addr, ip_str, sizeof(ip_str));
+        temp_sens_data_t latest;
+        char values[SENSOR_DATA_TEXT_MAX];
+        sensor_data_unpack(&entry.latest, &latest);
+        sensor_data_format(&latest, values, sizeof(values));
+        syslog(INFO, "  N=%d slot=%d IP=%s state=%s interval=%lums jitter=%lums %s seq=%lu rx=%lu lost=%lu dup=%lu reorder=%lu resync=%lu",
+               entry.child_no, entry.slot, ip_str,
+               entry.state == CHILD_STATE_ACTIVE ? "ACTIVE" : "STALE",
+               (unsigned long)entry.report_interval_ms, (unsigned long)entry.jitter_ms,
+               values, (unsigned long)entry.seq_stats.last_seq, (unsigned long)entry.seq_stats.received,
+               (unsigned long)entry.seq_stats.lost, (unsigned long)entry.seq_stats.duplicate,
+               (unsigned long)entry.seq_stats.reordered, (unsigned long)entry.seq_stats.resync);
+    }
+
+    child_seq_stats_t totals;
+    child_registry_get_seq_totals(&totals);
+    syslog(INFO, "Seq totals: rx=%lu lost=%lu dup=%lu reorder=%lu resync=%lu",
+           (unsigned long)totals.received, (unsigned long)totals.lost, (unsigned long)totals.duplicate,
+           (unsigned long)totals.reordered, (unsigned long)totals.resync);
+}
@@ -357,10 +357,12 @@ void flashdata_dump_all(void)
 
 
 /**
- * @brief ユーザーデータ領域を完全消去（全バイト0xFF化）
+ * @brief ユーザーデータ領域の設定セクタ（先頭FLASH_PAGE_BYTES）を消去（全バイト0xFF化）
  * @retval ESP_OK           正常終了
  * @retval ESP_ERR_NOT_FOUND パーティション未検出
  * @retval ESP_FAIL          消去失敗
+ * @note   2セクタ目以降は測定値履歴のフラッシュログ（history_store）が使うため消去しない。
+ *         保存タスクが書き込み位置を持っているので、ここで消すとログと食い違う
  * @note   OK帰るが、消去できない。恐らくプロテクトかかっている
  * @note   機能には不要のため、深追いはしていない。
  */
@@ -373,13 +375,11 @@ void flashdata_dump_all(void)
         return ESP_ERR_NOT_FOUND;
     }
 
-    syslog(INFO, "Erasing userdata partition... (addr=0x%06X, size=%u)",
-           part->address, part->size);
+    syslog(INFO, "Erasing userdata settings sector... (addr=0x%06X, size=%u)",
+           part->address, FLASH_PAGE_BYTES);
 
-    // 1. esp_partition_erase_range は消去サイズを 4KB アライメントにする必要がある
-    size_t erase_size = (part->size + 0xFFF) & ~0xFFF;
-
-    esp_err_t err = esp_partition_erase_range(part, 0, erase_size);
+    // 1. esp_partition_erase_range は消去サイズを 4KB アライメントにする必要がある（FLASH_PAGE_BYTESは4KB）
+    esp_err_t err = esp_partition_erase_range(part, 0, FLASH_PAGE_BYTES);
     if (err != ESP_OK) {
         syslog(ERR, "esp_partition_erase_range failed (%s)", esp_err_to_name(err));
         return err;
@@ -393,10 +393,20 @@ void flashdata_dump_all(void)
 }
 
 
+/**
+ * @brief 設定セクタを物理アドレス指定で消去（パーティションAPIを通さない確認用）
+ * @note  2セクタ目以降の測定値履歴（history_store）は消去しない
+ */
 void flash_force_erase_test(void)
 {
-    uint32_t addr = 0x110000;   // userdata offset
-    uint32_t size = 0x20000;    // 128KB
+    const esp_partition_t* part = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, USERDATA_SUBTYPE, USERDATA_NAME);
+    if (!part) {
+        syslog(ERR, "userdata partition not found");
+        return;
+    }
+    uint32_t addr = part->address;      // userdata offset
+    uint32_t size = FLASH_PAGE_BYTES;   // 設定セクタのみ
 
     syslog(INFO, "Force erasing physical region 0x%06X - 0x%06X", addr, addr + size);
 
@@ -0,0 +1,349 @@
+// src/history_log.c
+// 測定値履歴のフラッシュログ（セクタを巡回する追記専用ログ）
+//
+// - 追記: 書き込み中のセクタの次のレコード位置へ、ブロック → レコードヘッダの順に書く。
+//   満杯なら次のセクタ（最も古いセクタ）の消去回数をヘッダから引き継いで消去し、seqを+1したヘッダを書く
+// - 復旧: 全セクタのヘッダ（HISTORY_LOG_HEADER_BYTES）だけを読み、有効なヘッダのうちseqが最大のセクタを
+//   書き込み中とする。そのセクタのレコードを先頭から読み、最初の空きを追記位置、最大の起動番号+1を今回の起動番号とする
+// - 読み出し: 書き込み中のセクタの次（最も古いセクタ）から物理順に巡回する（書き込み順と一致する）
+// - 消去回数: 使用中のセクタ数と消去回数の最小・最大は、開く時のヘッダの走査とセクタを始めるたびの
+//   ヘッダの読み直しで求めておき、統計の読み出しではフラッシュを読まない
+// FreeRTOS/ESP-IDFに依存しないため、ホスト側ツールでも同じコードを使える。
+
+#include <string.h>
+#include "history_log.h"
+
+#define SECTOR_MAGIC        0x31474C48u     // "HLG1"
+#define ERASED_BYTE         0xFF
+
+_Static_assert(HISTORY_LOG_RECORDS_PER_SECTOR > 0 && HISTORY_LOG_RECORDS_PER_SECTOR <= UINT16_MAX,
+               "a sector must hold at least one record");
+
+// セクタのヘッダ（復号後）
+typedef struct {
+    uint32_t seq;
+    uint32_t erase_count;
+    uint16_t boot;
+} sector_info_t;
+
+// ==== CRC-32（IEEE 802.3） ====
+static uint32_t crc32_update(uint32_t crc, const uint8_t *p, size_t len)
+{
+    while (len-- > 0) {
+        crc ^= *p++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+        }
+    }
+    return crc;
+}
+
+static void put_le16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint16_t get_le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static bool all_erased(const uint8_t *p, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        if (p[i] != ERASED_BYTE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ==== セクタ・レコードの位置 ====
+static uint32_t sector_offset(uint16_t sector)
+{
+    return (uint32_t)sector * HISTORY_LOG_SECTOR_BYTES;
+}
+
+static uint32_t record_offset(uint16_t sector, uint16_t record)
+{
+    return sector_offset(sector) + HISTORY_LOG_HEADER_BYTES + (uint32_t)record * HISTORY_LOG_RECORD_BYTES;
+}
+
+// セクタのヘッダを読む。消去状態・壊れたヘッダ・読み出し失敗ならfalse
+static bool read_sector_info(const history_log_t *log, uint16_t sector, sector_info_t *info)
+{
+    uint8_t buf[HISTORY_LOG_HEADER_BYTES];
+    if (!log->flash.read(log->flash.ctx, sector_offset(sector), buf, sizeof(buf)) ||
+        get_le32(&buf[0]) != SECTOR_MAGIC ||
+        get_le32(&buf[16]) != ~crc32_update(0xFFFFFFFFu, buf, 16)) {
+        return false;
+    }
+    info->seq = get_le32(&buf[4]);
+    info->erase_count = get_le32(&buf[8]);
+    info->boot = get_le16(&buf[12]);
+    return info->seq != 0;
+}
+
+static uint32_t record_crc(const uint8_t *header, const uint8_t *block)
+{
+    uint32_t crc = crc32_update(0xFFFFFFFFu, header, 4);
+    return ~crc32_update(crc, block, HISTORY_LOG_BLOCK_BYTES);
+}
+
+// レコードを読む。戻り値: 1=有効、0=空き（ヘッダ・ブロックとも消去状態）、-1=書きかけ・壊れている
+static int read_record(const history_log_t *log, uint16_t sector, uint16_t record,
+                       uint8_t *header, uint8_t *block)
+{
+    uint32_t offset = record_offset(sector, record);
+    if (!log->flash.read(log->flash.ctx, offset, header, HISTORY_LOG_RECORD_HEADER_BYTES) ||
+        !log->flash.read(log->flash.ctx, offset + HISTORY_LOG_RECORD_HEADER_BYTES, block, HISTORY_LOG_BLOCK_BYTES)) {
+        return -1;
+    }
+    if (all_erased(header, HISTORY_LOG_RECORD_HEADER_BYTES)) {
+        return all_erased(block, HISTORY_LOG_BLOCK_BYTES) ? 0 : -1;
+    }
+    return (get_le32(&header[4]) == record_crc(header, block)) ? 1 : -1;
+}
+
+// ==== 消去回数 ====
+static void wear_reset(history_log_t *log)
+{
+    log->used_sectors = 0;
+    log->min_erases = 0;
+    log->max_erases = 0;
+}
+
+static void wear_add(history_log_t *log, uint32_t erase_count)
+{
+    if (log->used_sectors == 0 || erase_count < log->min_erases) {
+        log->min_erases = erase_count;
+    }
+    if (log->used_sectors == 0 || erase_count > log->max_erases) {
+        log->max_erases = erase_count;
+    }
+    log->used_sectors++;
+}
+
+// 全セクタのヘッダを読み直す（セクタを始める時、消去・ヘッダの書き込みの成否にかかわらず呼ぶ）
+static void wear_rescan(history_log_t *log)
+{
+    wear_reset(log);
+    for (uint16_t s = 0; s < log->sectors; s++) {
+        sector_info_t info;
+        if (read_sector_info(log, s, &info)) {
+            wear_add(log, info.erase_count);
+        }
+    }
+}
+
+// ==== 復旧 ====
+bool history_log_open(history_log_t *log, const history_log_flash_t *flash, uint16_t sectors)
+{
+    if (log == NULL || flash == NULL || flash->read == NULL || flash->write == NULL || flash->erase == NULL ||
+        sectors < HISTORY_LOG_MIN_SECTORS) {
+        return false;
+    }
+    memset(log, 0, sizeof(*log));
+    log->flash = *flash;
+    log->sectors = sectors;
+
+    // セクタのヘッダだけを読み、seqが最大のセクタを書き込み中とする（消去回数も同じ走査で数える）
+    uint16_t boot = 0;
+    for (uint16_t s = 0; s < sectors; s++) {
+        sector_info_t info;
+        log->stats.recovery_reads += HISTORY_LOG_HEADER_BYTES;
+        if (!read_sector_info(log, s, &info)) {
+            continue;
+        }
+        wear_add(log, info.erase_count);
+        if (log->head_seq == 0 || (int32_t)(info.seq - log->head_seq) > 0) {
+            log->head = s;
+            log->head_seq = info.seq;
+            boot = info.boot;
+        }
+    }
+
+    // 書き込み中のセクタの追記位置と、最後に書いた起動番号
+    if (log->head_seq != 0) {
+        log->next_record = HISTORY_LOG_RECORDS_PER_SECTOR;
+        for (uint16_t r = 0; r < HISTORY_LOG_RECORDS_PER_SECTOR; r++) {
+            uint8_t header[HISTORY_LOG_RECORD_HEADER_BYTES];
+            uint8_t block[HISTORY_LOG_BLOCK_BYTES];
+            int state = read_record(log, log->head, r, header, block);
+            log->stats.recovery_reads += HISTORY_LOG_RECORD_BYTES;
+            if (state == 0) {
+                log->next_record = r;
+                break;
+            }
+            if (state < 0) {
+                log->stats.recovery_skipped++;  // 書きかけ: この位置は使わない
+                continue;
+            }
+            uint16_t record_boot = get_le16(&header[2]);
+            if ((int16_t)(record_boot - boot) > 0) {
+                boot = record_boot;
+            }
+        }
+    }
+    log->boot = (uint16_t)(boot + 1);
+    return true;
+}
+
+// ==== 追記 ====
+// 次のセクタを消去して始める（消去回数は消去前のヘッダから引き継ぐ。消しかけでヘッダが読めなければ、
+// 巡回で同じ周回に消去した書き込み中のセクタと同じ値とする）
+static bool start_sector(history_log_t *log)
+{
+    uint16_t next = (log->head_seq == 0) ? 0 : (uint16_t)((log->head + 1) % log->sectors);
+    sector_info_t old;
+    uint32_t erase_count = 1;
+    if (read_sector_info(log, next, &old)) {
+        erase_count = old.erase_count + 1;
+    } else if (log->head_seq != 0 && read_sector_info(log, log->head, &old)) {
+        erase_count = old.erase_count;
+    }
+
+    if (!log->flash.erase(log->flash.ctx, sector_offset(next))) {
+        log->stats.write_errors++;
+        wear_rescan(log);
+        return false;
+    }
+    log->stats.erases++;
+
+    uint8_t buf[HISTORY_LOG_HEADER_BYTES];
+    uint32_t seq = log->head_seq + 1;
+    put_le32(&buf[0], SECTOR_MAGIC);
+    put_le32(&buf[4], seq);
+    put_le32(&buf[8], erase_count);
+    put_le16(&buf[12], log->boot);
+    put_le16(&buf[14], 0xFFFF);
+    put_le32(&buf[16], ~crc32_update(0xFFFFFFFFu, buf, 16));
+    if (!log->flash.write(log->flash.ctx, sector_offset(next), buf, sizeof(buf))) {
+        log->stats.write_errors++;
+        wear_rescan(log);
+        return false;   // ヘッダのないセクタは空きとして扱われ、次の追記で消去し直す
+    }
+
+    log->head = next;
+    log->head_seq = seq;
+    log->next_record = 0;
+    wear_rescan(log);
+    return true;
+}
+
+bool history_log_append(history_log_t *log, uint8_t child_no, const uint8_t *block)
+{
+    if (log == NULL || block == NULL || log->sectors == 0) {
+        return false;
+    }
+    if (log->head_seq == 0 || log->next_record >= HISTORY_LOG_RECORDS_PER_SECTOR) {
+        if (!start_sector(log)) {
+            return false;
+        }
+    }
+
+    uint32_t offset = record_offset(log->head, log->next_record);
+    log->next_record++;
+
+    uint8_t header[HISTORY_LOG_RECORD_HEADER_BYTES];
+    header[0] = child_no;
+    header[1] = 0xFF;
+    put_le16(&header[2], log->boot);
+    put_le32(&header[4], record_crc(header, block));
+    // ブロック → ヘッダの順に書く（ヘッダが書けた時点で確定）
+    if (!log->flash.write(log->flash.ctx, offset + HISTORY_LOG_RECORD_HEADER_BYTES, block, HISTORY_LOG_BLOCK_BYTES) ||
+        !log->flash.write(log->flash.ctx, offset, header, sizeof(header))) {
+        log->stats.write_errors++;
+        return false;
+    }
+    log->stats.appends++;
+    return true;
+}
+
+// ==== 読み出し ====
+static uint16_t iter_physical_sector(const history_log_iter_t *it)
+{
+    return (uint16_t)((it->log->head + 1 + it->sector) % it->log->sectors);
+}
+
+// セクタに入る（古いseqのセクタ・ヘッダのないセクタは読まない）
+static void iter_enter_sector(history_log_iter_t *it)
+{
+    const history_log_t *log = it->log;
+    sector_info_t info;
+    it->record = 0;
+    it->sector_seq = 0;
+    if (read_sector_info(log, iter_physical_sector(it), &info) && log->head_seq - info.seq < log->sectors) {
+        it->sector_seq = info.seq;
+    }
+}
+
+void history_log_iter_begin(history_log_iter_t *it, const history_log_t *log)
+{
+    if (it == NULL) {
+        return;
+    }
+    memset(it, 0, sizeof(*it));
+    it->log = log;
+    if (log == NULL || log->head_seq == 0) {
+        it->sector = (log != NULL) ? log->sectors : 0;
+        return;
+    }
+    iter_enter_sector(it);
+}
+
+bool history_log_iter_next(history_log_iter_t *it, history_log_record_t *record)
+{
+    if (it == NULL || it->log == NULL || record == NULL) {
+        return false;
+    }
+
+    const history_log_t *log = it->log;
+    while (it->sector < log->sectors) {
+        uint16_t phys = iter_physical_sector(it);
+        uint16_t limit = (phys == log->head) ? log->next_record : HISTORY_LOG_RECORDS_PER_SECTOR;
+        if (it->sector_seq != 0 && it->record < limit) {
+            uint8_t header[HISTORY_LOG_RECORD_HEADER_BYTES];
+            int state = read_record(log, phys, it->record++, header, record->block);
+            if (state <= 0) {
+                it->skipped++;
+                continue;
+            }
+            record->child_no = header[0];
+            record->boot = get_le16(&header[2]);
+            record->sector_seq = it->sector_seq;
+            return true;
+        }
+        it->sector++;
+        if (it->sector < log->sectors) {
+            iter_enter_sector(it);
+        }
+    }
+    return false;
+}
+
+size_t history_log_wear(const history_log_t *log, uint32_t *min_erases, uint32_t *max_erases)
+{
+    size_t used = (log != NULL) ? log->used_sectors : 0;
+    if (min_erases != NULL) {
+        *min_erases = (log != NULL) ? log->min_erases : 0;
+    }
+    if (max_erases != NULL) {
+        *max_erases = (log != NULL) ? log->max_erases : 0;
+    }
+    return used;
+}
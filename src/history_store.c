@@ -0,0 +1,165 @@
+// src/history_store.c
+// 測定値履歴のフラッシュ保存（userdataパーティションのhistory_log）
+//
+// - 領域: パーティションの先頭セクタ（FLASH_PAGE_BYTES）は設定用のため、その後ろからパーティションの終わりまで
+// - 保存: 子機レジストリがブロックを閉じるたびに通知で起き、閉じたブロックをすべて取り出して1件ずつ追記する
+//   （フラッシュの書き込み・消去はレジストリのロックの外で行う。保存待ちがなければ起きない）
+// - 読み出し: HTTPタスクから1件ずつ排他して読む
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_partition.h"
+#include "flash_data.h"
+#include "child_registry.h"
+#include "history_store.h"
+#include "log_task.h"
+
+#define HISTORY_STORE_OFFSET    FLASH_PAGE_BYTES    // 先頭セクタはflash_data.cの設定
+
+_Static_assert(HISTORY_LOG_SECTOR_BYTES == FLASH_PAGE_BYTES, "log sector must match the flash erase unit");
+
+static const esp_partition_t *s_part = NULL;
+static history_log_t s_log;
+static SemaphoreHandle_t s_mutex = NULL;
+static volatile bool s_ready = false;
+
+// ==== フラッシュの操作（history_logから呼ばれる） ====
+static bool part_read(void *ctx, uint32_t offset, void *buf, size_t len)
+{
+    (void)ctx;
+    return esp_partition_read(s_part, HISTORY_STORE_OFFSET + offset, buf, len) == ESP_OK;
+}
+
+static bool part_write(void *ctx, uint32_t offset, const void *buf, size_t len)
+{
+    (void)ctx;
+    return esp_partition_write(s_part, HISTORY_STORE_OFFSET + offset, buf, len) == ESP_OK;
+}
+
+static bool part_erase(void *ctx, uint32_t offset)
+{
+    (void)ctx;
+    return esp_partition_erase_range(s_part, HISTORY_STORE_OFFSET + offset, HISTORY_LOG_SECTOR_BYTES) == ESP_OK;
+}
+
+// ログ領域を開く（セクタのヘッダから書き込み位置を復旧）
+static bool history_store_open(void)
+{
+    s_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, USERDATA_SUBTYPE, USERDATA_NAME);
+    if (s_part == NULL) {
+        syslog(ERR, "history_store: userdata partition not found");
+        return false;
+    }
+    if (s_part->size < HISTORY_STORE_OFFSET + HISTORY_LOG_MIN_SECTORS * HISTORY_LOG_SECTOR_BYTES) {
+        syslog(ERR, "history_store: userdata partition too small (%u bytes)", (unsigned int)s_part->size);
+        return false;
+    }
+
+    static const history_log_flash_t flash = {
+        .read = part_read,
+        .write = part_write,
+        .erase = part_erase,
+        .ctx = NULL,
+    };
+    uint16_t sectors = (uint16_t)((s_part->size - HISTORY_STORE_OFFSET) / HISTORY_LOG_SECTOR_BYTES);
+    TickType_t start = xTaskGetTickCount();
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    bool ok = history_log_open(&s_log, &flash, sectors);
+    xSemaphoreGive(s_mutex);
+    if (!ok) {
+        syslog(ERR, "history_store: open failed");
+        return false;
+    }
+    syslog(INFO, "history_store: %u sectors x %u records, head seq=%lu record=%u, boot=%u "
+           "(recovered in %lu ms, read %lu bytes, skipped %lu)",
+           (unsigned int)sectors, (unsigned int)HISTORY_LOG_RECORDS_PER_SECTOR,
+           (unsigned long)s_log.head_seq, (unsigned int)s_log.next_record, (unsigned int)s_log.boot,
+           (unsigned long)((xTaskGetTickCount() - start) * portTICK_PERIOD_MS),
+           (unsigned long)s_log.stats.recovery_reads, (unsigned long)s_log.stats.recovery_skipped);
+    return true;
+}
+
+// ==== 保存タスク ====
+static void history_store_task(void *pvParameters)
+{
+    s_ready = history_store_open();
+    if (!s_ready) {
+        vTaskDelete(NULL);
+        return;
+    }
+
+    // 開くまでに閉じたブロックは保存待ちに残っているため、登録してから先に取り出す
+    child_registry_set_sealed_consumer(xTaskGetCurrentTaskHandle());
+
+    uint8_t block[SENSOR_HISTORY_BLOCK_BYTES];
+    uint8_t child_no;
+    while (1) {
+        while (child_registry_take_sealed(&child_no, block)) {
+            xSemaphoreTake(s_mutex, portMAX_DELAY);
+            bool ok = history_log_append(&s_log, child_no, block);
+            xSemaphoreGive(s_mutex);
+            if (!ok) {
+                syslog(WARN, "history_store: append failed (N=%d, errors=%lu)",
+                       child_no, (unsigned long)s_log.stats.write_errors);
+            }
+        }
+
+        // 次のブロックが閉じるまで待つ（取り出し中に届いた通知は数が残り、すぐ起きる）
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+void start_history_store_task(void)
+{
+    if (s_mutex == NULL) {
+        s_mutex = xSemaphoreCreateMutex();
+        configASSERT(s_mutex);
+    }
+    xTaskCreate(history_store_task, "HistoryStore", 3072, NULL, 2, NULL);
+    syslog(INFO, "history_store task created");
+}
+
+// ==== 読み出し ====
+bool history_store_iter_begin(history_log_iter_t *it)
+{
+    if (!s_ready || it == NULL) {
+        return false;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    history_log_iter_begin(it, &s_log);
+    xSemaphoreGive(s_mutex);
+    return true;
+}
+
+bool history_store_iter_next(history_log_iter_t *it, history_log_record_t *record)
+{
+    if (!s_ready) {
+        return false;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    bool found = history_log_iter_next(it, record);
+    xSemaphoreGive(s_mutex);
+    return found;
+}
+
+void history_store_get_stats(history_store_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+    if (!s_ready) {
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    stats->ready = true;
+    stats->sectors = s_log.sectors;
+    stats->boot = s_log.boot;
+    stats->head_seq = s_log.head_seq;
+    stats->used_sectors = (uint16_t)history_log_wear(&s_log, &stats->min_erases, &stats->max_erases);
+    stats->log = s_log.stats;
+    xSemaphoreGive(s_mutex);
+}
@@ -0,0 +1,204 @@
+// src/ingest_admission.c
+// 送信元IPごとの受信レート制限（トークンバケット）
+//
+// - 送信元IP → 表の要素: フィボナッチハッシュ + 線形探査、後方シフト削除（child_registryのIPハッシュと同じ方式）
+// - トークン: 1/1000データグラム単位。経過ms × rate_per_sec を補充し、1データグラムで1000消費
+// - 超過の開始はバケットが満杯に戻るまで1回だけ報告する（連続した超過でログを溢れさせない）
+// - 期限切れ: 判定のたびに表を1要素ずつ確認し、INGEST_ADMIT_IDLE_MS受信のない送信元を外す
+// FreeRTOS/ESP-IDFに依存しないため、ホスト側ツールでも同じコードを使える。
+
+#include <string.h>
+#include "ingest_admission.h"
+
+// ==== 内部定義 ====
+#define TABLE_BITS  8
+#define TABLE_MASK  (INGEST_ADMIT_TABLE_SIZE - 1)
+#define TOKEN_UNIT  1000u
+
+_Static_assert((1u << TABLE_BITS) == INGEST_ADMIT_TABLE_SIZE, "TABLE_BITS must match the table size");
+_Static_assert(INGEST_ADMIT_MAX_SOURCES * 2 <= INGEST_ADMIT_TABLE_SIZE, "table load factor must stay <= 0.5");
+
+static uint32_t hash_home(uint32_t ip)
+{
+    // フィボナッチハッシュ（上位TABLE_BITSビットを使用）
+    return (ip * 2654435761u) >> (32 - TABLE_BITS);
+}
+
+static uint32_t load_u32(const _Atomic uint32_t *v)
+{
+    return atomic_load_explicit(v, memory_order_relaxed);
+}
+
+static void store_u32(_Atomic uint32_t *v, uint32_t value)
+{
+    atomic_store_explicit(v, value, memory_order_relaxed);
+}
+
+static void entry_reset(ingest_admission_t *adm, ingest_admission_entry_t *e, uint32_t source_ip, uint32_t now_ms)
+{
+    store_u32(&e->admitted, 0);
+    store_u32(&e->dropped, 0);
+    e->tokens_milli = adm->burst * TOKEN_UNIT;
+    e->last_ms = now_ms;
+    e->limited = false;
+    store_u32(&e->source_ip, source_ip);
+}
+
+static void entry_move(ingest_admission_entry_t *dst, ingest_admission_entry_t *src)
+{
+    store_u32(&dst->admitted, load_u32(&src->admitted));
+    store_u32(&dst->dropped, load_u32(&src->dropped));
+    dst->tokens_milli = src->tokens_milli;
+    dst->last_ms = src->last_ms;
+    dst->limited = src->limited;
+    store_u32(&dst->source_ip, load_u32(&src->source_ip));
+}
+
+// ==== 表の操作 ====
+static void table_remove(ingest_admission_t *adm, uint32_t pos)
+{
+    // 後方シフト削除（探査列を途切れさせない）
+    uint32_t hole = pos;
+    uint32_t next = (pos + 1) & TABLE_MASK;
+    uint32_t ip;
+    while ((ip = load_u32(&adm->table[next].source_ip)) != 0) {
+        uint32_t home = hash_home(ip);
+        // homeが(hole, next]の範囲外なら穴へ移動できる
+        if (((next - home) & TABLE_MASK) >= ((next - hole) & TABLE_MASK)) {
+            entry_move(&adm->table[hole], &adm->table[next]);
+            hole = next;
+        }
+        next = (next + 1) & TABLE_MASK;
+    }
+    store_u32(&adm->table[hole].source_ip, 0);
+    store_u32(&adm->sources, load_u32(&adm->sources) - 1);
+}
+
+static ingest_admission_entry_t *table_find_or_insert(ingest_admission_t *adm, uint32_t source_ip, uint32_t now_ms)
+{
+    uint32_t pos = hash_home(source_ip);
+    for (int n = 0; n < INGEST_ADMIT_TABLE_SIZE; n++) {
+        ingest_admission_entry_t *e = &adm->table[pos];
+        uint32_t ip = load_u32(&e->source_ip);
+        if (ip == source_ip) {
+            return e;
+        }
+        if (ip == 0) {
+            if (load_u32(&adm->sources) >= INGEST_ADMIT_MAX_SOURCES) {
+                break;
+            }
+            entry_reset(adm, e, source_ip, now_ms);
+            store_u32(&adm->sources, load_u32(&adm->sources) + 1);
+            return e;
+        }
+        pos = (pos + 1) & TABLE_MASK;
+    }
+    return &adm->shared;  // 満杯: 新しい送信元はまとめて制限する
+}
+
+// 期限切れの送信元を1要素分だけ確認
+static void table_sweep_step(ingest_admission_t *adm, uint32_t now_ms)
+{
+    uint32_t pos = adm->sweep_pos;
+    adm->sweep_pos = (pos + 1) & TABLE_MASK;
+
+    ingest_admission_entry_t *e = &adm->table[pos];
+    if (load_u32(&e->source_ip) != 0 && now_ms - e->last_ms > INGEST_ADMIT_IDLE_MS) {
+        table_remove(adm, pos);
+    }
+}
+
+// ==== トークンバケット ====
+static void bucket_refill(const ingest_admission_t *adm, ingest_admission_entry_t *e, uint32_t now_ms)
+{
+    uint32_t max_milli = adm->burst * TOKEN_UNIT;
+    uint32_t elapsed_ms = now_ms - e->last_ms;
+    e->last_ms = now_ms;
+
+    if (elapsed_ms >= max_milli / adm->rate_per_sec) {
+        e->tokens_milli = max_milli;
+    } else {
+        uint32_t tokens = e->tokens_milli + elapsed_ms * adm->rate_per_sec;
+        e->tokens_milli = (tokens > max_milli) ? max_milli : tokens;
+    }
+}
+
+// ==== 公開関数 ====
+bool ingest_admission_init(ingest_admission_t *adm, uint32_t rate_per_sec, uint32_t burst)
+{
+    if (adm == NULL || rate_per_sec == 0 || burst == 0 || burst > UINT32_MAX / TOKEN_UNIT) {
+        return false;
+    }
+
+    memset(adm, 0, sizeof(*adm));
+    adm->rate_per_sec = rate_per_sec;
+    adm->burst = burst;
+    entry_reset(adm, &adm->shared, 0, 0);
+    atomic_init(&adm->sources, 0);
+    atomic_init(&adm->admitted, 0);
+    atomic_init(&adm->dropped, 0);
+    return true;
+}
+
+ingest_admit_t ingest_admission_check(ingest_admission_t *adm, uint32_t source_ip, uint32_t now_ms)
+{
+    if (adm == NULL || source_ip == 0) {
+        return INGEST_ADMIT_PASS;
+    }
+
+    table_sweep_step(adm, now_ms);
+    ingest_admission_entry_t *e = table_find_or_insert(adm, source_ip, now_ms);
+    bucket_refill(adm, e, now_ms);
+
+    if (e->limited && e->tokens_milli == adm->burst * TOKEN_UNIT) {
+        e->limited = false;  // 上限内に戻った
+    }
+    if (e->tokens_milli >= TOKEN_UNIT) {
+        e->tokens_milli -= TOKEN_UNIT;
+        store_u32(&e->admitted, load_u32(&e->admitted) + 1);
+        store_u32(&adm->admitted, load_u32(&adm->admitted) + 1);
+        return INGEST_ADMIT_PASS;
+    }
+
+    store_u32(&e->dropped, load_u32(&e->dropped) + 1);
+    store_u32(&adm->dropped, load_u32(&adm->dropped) + 1);
+    if (!e->limited) {
+        e->limited = true;
+        return INGEST_ADMIT_DROP_START;
+    }
+    return INGEST_ADMIT_DROP;
+}
+
+size_t ingest_admission_list_dropping(const ingest_admission_t *adm, ingest_admission_source_t *out, size_t max_count)
+{
+    if (adm == NULL || out == NULL) {
+        return 0;
+    }
+
+    size_t count = 0;
+    for (int i = 0; i <= INGEST_ADMIT_TABLE_SIZE && count < max_count; i++) {
+        const ingest_admission_entry_t *e = (i < INGEST_ADMIT_TABLE_SIZE) ? &adm->table[i] : &adm->shared;
+        uint32_t ip = load_u32(&e->source_ip);
+        uint32_t dropped = load_u32(&e->dropped);
+        if ((ip == 0 && e != &adm->shared) || dropped == 0) {
+            continue;
+        }
+        out[count].source_ip = ip;
+        out[count].admitted = load_u32(&e->admitted);
+        out[count].dropped = dropped;
+        count++;
+    }
+    return count;
+}
+
+void ingest_admission_get_stats(const ingest_admission_t *adm, ingest_admission_stats_t *stats)
+{
+    if (adm == NULL || stats == NULL) {
+        return;
+    }
+    stats->rate_per_sec = adm->rate_per_sec;
+    stats->burst = adm->burst;
+    stats->sources = load_u32(&adm->sources);
+    stats->admitted = load_u32(&adm->admitted);
+    stats->dropped = load_u32(&adm->dropped);
+}
@@ -0,0 +1,198 @@
+// src/ingest_reactor.c
+// 受信リアクタ（select()による複数ソケットの同時待ち受け）
+//
+// 登録された全ソケットと内部のウェイクアップ用ソケットをselect()で待ち、
+// 読み込み可能になったソケットのハンドラを呼び出す。
+// タイムアウトによるポーリングを行わないため、待機中はCPUを消費しない。
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+#include "ingest_reactor.h"
+#include "log_task.h"
+
+// ==== 内部定義 ====
+typedef struct {
+    int sock;
+    ingest_reactor_handler_t handler;
+    void *ctx;
+} reactor_entry_t;
+
+static reactor_entry_t s_entries[INGEST_REACTOR_MAX_SOCKETS];
+static int s_entry_count = 0;
+static portMUX_TYPE s_entries_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// 登録変更時にselect()を起こすためのループバックソケット
+static int s_wakeup_sock = -1;
+static struct sockaddr_in s_wakeup_addr;
+
+static void set_nonblocking(int sock)
+{
+    int flags = fcntl(sock, F_GETFL, 0);
+    if (flags >= 0) {
+        fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+    }
+}
+
+// ==== ウェイクアップ ====
+static void reactor_wakeup(void)
+{
+    if (s_wakeup_sock >= 0) {
+        uint8_t dummy = 0;
+        sendto(s_wakeup_sock, &dummy, sizeof(dummy), 0,
+               (struct sockaddr *)&s_wakeup_addr, sizeof(s_wakeup_addr));
+    }
+}
+
+static void reactor_drain_wakeup(void)
+{
+    uint8_t dummy[8];
+    while (recv(s_wakeup_sock, dummy, sizeof(dummy), MSG_DONTWAIT) > 0) {
+        // 読み捨て
+    }
+}
+
+static bool reactor_open_wakeup_socket(void)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        return false;
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;  // 空きポートを自動割当
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(sock);
+        return false;
+    }
+
+    socklen_t addr_len = sizeof(s_wakeup_addr);
+    if (getsockname(sock, (struct sockaddr *)&s_wakeup_addr, &addr_len) < 0) {
+        close(sock);
+        return false;
+    }
+
+    set_nonblocking(sock);
+    s_wakeup_sock = sock;
+    return true;
+}
+
+// ==== リアクタタスク ====
+static void ingest_reactor_task(void *pvParameters)
+{
+    if (!reactor_open_wakeup_socket()) {
+        // ウェイクアップなしでも動作は可能（起動後の登録変更は次の受信で反映）
+        syslog(WARN, "Ingest reactor: wakeup socket unavailable");
+    }
+
+    syslog(INFO, "Ingest reactor task started on core %d", xPortGetCoreID());
+
+    reactor_entry_t entries[INGEST_REACTOR_MAX_SOCKETS];
+
+    while (1) {
+        // 登録テーブルのスナップショットを取得
+        taskENTER_CRITICAL(&s_entries_mux);
+        int count = s_entry_count;
+        memcpy(entries, s_entries, sizeof(reactor_entry_t) * count);
+        taskEXIT_CRITICAL(&s_entries_mux);
+
+        fd_set read_fds;
+        FD_ZERO(&read_fds);
+        int max_fd = -1;
+        if (s_wakeup_sock >= 0) {
+            FD_SET(s_wakeup_sock, &read_fds);
+            max_fd = s_wakeup_sock;
+        }
+        for (int i = 0; i < count; i++) {
+            FD_SET(entries[i].sock, &read_fds);
+            if (entries[i].sock > max_fd) {
+                max_fd = entries[i].sock;
+            }
+        }
+
+        if (max_fd < 0) {
+            // 監視対象がない（ウェイクアップソケットも作成失敗）
+            vTaskDelay(pdMS_TO_TICKS(1000));
+            continue;
+        }
+
+        // タイムアウトなしで待機（パケット到着時のみ起床）
+        int ready = select(max_fd + 1, &read_fds, NULL, NULL, NULL);
+        if (ready < 0) {
+            syslog(WARN, "Ingest reactor: select failed errno=%d", errno);
+            vTaskDelay(pdMS_TO_TICKS(100));
+            continue;
+        }
+
+        if (s_wakeup_sock >= 0 && FD_ISSET(s_wakeup_sock, &read_fds)) {
+            reactor_drain_wakeup();
+        }
+
+        for (int i = 0; i < count; i++) {
+            if (FD_ISSET(entries[i].sock, &read_fds)) {
+                entries[i].handler(entries[i].sock, entries[i].ctx);
+            }
+        }
+    }
+}
+
+// ==== 公開関数 ====
+void start_ingest_reactor_task(int core_id)
+{
+    xTaskCreatePinnedToCore(ingest_reactor_task, "IngestReactor", 4096, NULL, 5, NULL, core_id);
+}
+
+bool ingest_reactor_add_socket(int sock, ingest_reactor_handler_t handler, void *ctx)
+{
+    if (sock < 0 || handler == NULL) {
+        return false;
+    }
+
+    // ソケットオプションは登録時に1回だけ設定
+    set_nonblocking(sock);
+
+    bool added = false;
+    taskENTER_CRITICAL(&s_entries_mux);
+    if (s_entry_count < INGEST_REACTOR_MAX_SOCKETS) {
+        s_entries[s_entry_count].sock = sock;
+        s_entries[s_entry_count].handler = handler;
+        s_entries[s_entry_count].ctx = ctx;
+        s_entry_count++;
+        added = true;
+    }
+    taskEXIT_CRITICAL(&s_entries_mux);
+
+    if (!added) {
+        syslog(WARN, "Ingest reactor: socket table full (sock=%d)", sock);
+        return false;
+    }
+
+    reactor_wakeup();
+    return true;
+}
+
+bool ingest_reactor_remove_socket(int sock)
+{
+    bool removed = false;
+    taskENTER_CRITICAL(&s_entries_mux);
+    for (int i = 0; i < s_entry_count; i++) {
+        if (s_entries[i].sock == sock) {
+            s_entries[i] = s_entries[s_entry_count - 1];
+            s_entry_count--;
+            removed = true;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&s_entries_mux);
+
+    if (removed) {
+        reactor_wakeup();
+    }
+    return removed;
+}
@@ -0,0 +1,81 @@
+// src/latency_hist.c
+// 遅延ヒストグラム（2のべき乗幅のバケット）
+//
+// - 追加: 遅延のビット長でバケットを決める（__builtin_clz、ループなし）
+// - 分位点: 小さい側からバケットの件数を足し、目標の件数に届いたバケットの上端を返す
+// FreeRTOS/ESP-IDFに依存しないため、ホスト側ツールでも同じコードを使える。
+
+#include <string.h>
+#include "latency_hist.h"
+
+_Static_assert(LATENCY_HIST_BUCKETS >= 2 && LATENCY_HIST_BUCKETS <= 32, "bucket must fit in uint32_t");
+
+static size_t bucket_of(uint32_t us)
+{
+    if (us < 2) {
+        return 0;
+    }
+    size_t bucket = (size_t)(31 - __builtin_clz(us));
+    return (bucket < LATENCY_HIST_BUCKETS) ? bucket : LATENCY_HIST_BUCKETS - 1;
+}
+
+void latency_hist_reset(latency_hist_t *hist)
+{
+    if (hist != NULL) {
+        memset(hist, 0, sizeof(*hist));
+    }
+}
+
+void latency_hist_add(latency_hist_t *hist, int64_t us)
+{
+    if (hist == NULL) {
+        return;
+    }
+    uint32_t value = (us < 0) ? 0 : (us > (int64_t)UINT32_MAX) ? UINT32_MAX : (uint32_t)us;
+    hist->buckets[bucket_of(value)]++;
+    hist->count++;
+    hist->sum_us += value;
+    if (value > hist->max_us) {
+        hist->max_us = value;
+    }
+}
+
+uint32_t latency_hist_bucket_max_us(size_t bucket)
+{
+    if (bucket >= LATENCY_HIST_BUCKETS - 1) {
+        return UINT32_MAX;
+    }
+    return (uint32_t)((2ull << bucket) - 1);
+}
+
+uint32_t latency_hist_mean_us(const latency_hist_t *hist)
+{
+    if (hist == NULL || hist->count == 0) {
+        return 0;
+    }
+    return (uint32_t)(hist->sum_us / hist->count);
+}
+
+uint32_t latency_hist_percentile_us(const latency_hist_t *hist, uint32_t permille)
+{
+    if (hist == NULL || hist->count == 0) {
+        return 0;
+    }
+    if (permille > 1000) {
+        permille = 1000;
+    }
+    // 目標の件数（切り上げ、最低1件）
+    uint64_t target = ((uint64_t)hist->count * permille + 999) / 1000;
+    if (target == 0) {
+        target = 1;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= target) {
+            uint32_t upper = latency_hist_bucket_max_us(i);
+            return (upper < hist->max_us) ? upper : hist->max_us;
+        }
+    }
+    return hist->max_us;
+}
@@ -0,0 +1,56 @@
+// src/latency_trace.c
+// 測定値の区間ごとの遅延ヒストグラム
+//
+// - 記録: 受信処理タスク・HTTPタスク・表示タスクから呼ばれるため、ヒストグラムの更新はクリティカルセクションで行う
+//   （数十命令で終わるためミューテックスは使わない）
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "latency_trace.h"
+
+static latency_hist_t s_hists[LATENCY_STAGES];
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *const s_stage_names[LATENCY_STAGES] = {
+    [LATENCY_RECV_TO_COMMIT]    = "recv_commit",
+    [LATENCY_COMMIT_TO_HTTP]    = "commit_http",
+    [LATENCY_COMMIT_TO_DISPLAY] = "commit_display",
+    [LATENCY_RECV_TO_HTTP]      = "recv_http",
+    [LATENCY_RECV_TO_DISPLAY]   = "recv_display",
+};
+
+void latency_trace_record(latency_stage_t stage, int64_t from_us, int64_t to_us)
+{
+    if (stage >= LATENCY_STAGES || from_us == 0) {
+        return;
+    }
+    taskENTER_CRITICAL(&s_mux);
+    latency_hist_add(&s_hists[stage], to_us - from_us);
+    taskEXIT_CRITICAL(&s_mux);
+}
+
+void latency_trace_get(latency_stage_t stage, latency_hist_t *hist)
+{
+    if (hist == NULL) {
+        return;
+    }
+    if (stage >= LATENCY_STAGES) {
+        latency_hist_reset(hist);
+        return;
+    }
+    taskENTER_CRITICAL(&s_mux);
+    *hist = s_hists[stage];
+    taskEXIT_CRITICAL(&s_mux);
+}
+
+const char *latency_trace_stage_name(latency_stage_t stage)
+{
+    return (stage < LATENCY_STAGES) ? s_stage_names[stage] : "";
+}
+
+void latency_trace_reset(void)
+{
+    taskENTER_CRITICAL(&s_mux);
+    memset(s_hists, 0, sizeof(s_hists));
+    taskEXIT_CRITICAL(&s_mux);
+}
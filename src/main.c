@@ -21,6 +21,8 @@
 #include "bluetooth_task.h"
 #include "web_server_task.h"
 #include "ssd1306_task.h"
+#include "history_store.h"
+#include "warm_restart.h"
 
 #include "nvs_flash.h"
 #include "esp_bt.h"
@@ -43,6 +45,7 @@ void exec_soft_reset(void)
     vTaskDelay(pdMS_TO_TICKS(1000));
     syslog(INFO,"system reset exec after 1 seconds...");
     vTaskDelay(pdMS_TO_TICKS(1000));
+    warm_restart_save();    // 子機の最終値・集計を次の起動へ引き継ぐ
     esp_restart();
 }
 
@@ -105,6 +108,7 @@ void app_main(void)
     //start_user_bt_test_task();
     //start_sd_task();
     start_ssd1306_task();
+    start_history_store_task();
 
 #endif
     while (1) {
@@ -0,0 +1,132 @@
+// src/raw_capture.c
+// 受信生データキャプチャ（全子機共通の固定長リング、デバッグ用）
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "lwip/sockets.h"
+#include "raw_capture.h"
+#include "log_task.h"
+
+static volatile bool s_enabled = false;
+
+#if RAW_CAPTURE_ENABLE
+
+typedef struct {
+    uint32_t source_ip;                     // 送信元IP（ネットワークバイトオーダ）
+    uint32_t recv_time_ms;                  // 受信時刻（ms）
+    uint16_t len;                           // 元のデータ長
+    uint16_t stored;                        // 保持したバイト数
+    uint8_t data[RAW_CAPTURE_DATA_SIZE];
+} raw_capture_entry_t;
+
+static raw_capture_entry_t s_entries[RAW_CAPTURE_ENTRIES];
+static uint32_t s_write_count = 0;          // 累計記録数（次の書き込み位置 = s_write_count % ENTRIES）
+static SemaphoreHandle_t s_mutex = NULL;
+
+static bool is_text(const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        if ((data[i] < 0x20 && data[i] != '\r' && data[i] != '\n' && data[i] != '\t') || data[i] >= 0x7F) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void raw_capture_set_enabled(bool enabled)
+{
+    if (enabled && s_mutex == NULL) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (s_mutex == NULL) {
+            syslog(ERR, "raw capture: failed to create mutex");
+            return;
+        }
+    }
+    s_enabled = enabled;
+    syslog(INFO, "raw capture %s (%d entries x %d bytes)", enabled ? "on" : "off",
+           RAW_CAPTURE_ENTRIES, RAW_CAPTURE_DATA_SIZE);
+}
+
+void raw_capture_put(uint32_t source_ip, uint32_t recv_time_ms, const void *data, size_t len)
+{
+    if (!s_enabled || data == NULL) {
+        return;
+    }
+
+    size_t stored = (len < RAW_CAPTURE_DATA_SIZE) ? len : RAW_CAPTURE_DATA_SIZE;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    raw_capture_entry_t *e = &s_entries[s_write_count % RAW_CAPTURE_ENTRIES];
+    e->source_ip = source_ip;
+    e->recv_time_ms = recv_time_ms;
+    e->len = (uint16_t)len;
+    e->stored = (uint16_t)stored;
+    memcpy(e->data, data, stored);
+    s_write_count++;
+    xSemaphoreGive(s_mutex);
+}
+
+void raw_capture_dump(void)
+{
+    if (s_mutex == NULL) {
+        syslog(INFO, "raw capture: empty (use \"rawcap on\")");
+        return;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    uint32_t total = s_write_count;
+    uint32_t count = (total < RAW_CAPTURE_ENTRIES) ? total : RAW_CAPTURE_ENTRIES;
+    syslog(INFO, "raw capture: %s, %lu captured, showing last %lu",
+           s_enabled ? "on" : "off", (unsigned long)total, (unsigned long)count);
+
+    for (uint32_t n = total - count; n < total; n++) {
+        const raw_capture_entry_t *e = &s_entries[n % RAW_CAPTURE_ENTRIES];
+        char ip_str[16];
+        struct in_addr addr = { .s_addr = e->source_ip };
+        inet_ntop(AF_INET, &addr, ip_str, sizeof(ip_str));
+
+        if (is_text(e->data, e->stored)) {
+            syslog(INFO, "  #%lu t=%lums IP=%s len=%u: %.*s", (unsigned long)n, (unsigned long)e->recv_time_ms,
+                   ip_str, e->len, (int)e->stored, (const char *)e->data);
+        } else {
+            // バイナリは先頭48バイトまで16進表示
+            char hex[48 * 2 + 1];
+            size_t shown = (e->stored < 48) ? e->stored : 48;
+            for (size_t i = 0; i < shown; i++) {
+                static const char digits[] = "0123456789abcdef";
+                hex[i * 2] = digits[e->data[i] >> 4];
+                hex[i * 2 + 1] = digits[e->data[i] & 0x0F];
+            }
+            hex[shown * 2] = '\0';
+            syslog(INFO, "  #%lu t=%lums IP=%s len=%u: %s%s", (unsigned long)n, (unsigned long)e->recv_time_ms,
+                   ip_str, e->len, hex, (shown < e->stored) ? "..." : "");
+        }
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+#else  // RAW_CAPTURE_ENABLE
+
+void raw_capture_set_enabled(bool enabled)
+{
+    if (enabled) {
+        syslog(WARN, "raw capture disabled at build time (RAW_CAPTURE_ENABLE=0)");
+    }
+}
+
+void raw_capture_put(uint32_t source_ip, uint32_t recv_time_ms, const void *data, size_t len)
+{
+}
+
+void raw_capture_dump(void)
+{
+    syslog(INFO, "raw capture disabled at build time (RAW_CAPTURE_ENABLE=0)");
+}
+
+#endif  // RAW_CAPTURE_ENABLE
+
+bool raw_capture_is_enabled(void)
+{
+    return s_enabled;
+}
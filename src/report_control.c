@@ -0,0 +1,264 @@
+// src/report_control.c
+// 子機送信間隔の下り制御（ゲートウェイ→子機）
+//
+// 子機監視タスクの1秒周期で受信経路の統計と表示先の状態を集め、report_policyで指示間隔を決める。
+// 指示が変わった子機、またはREPORT_CONTROL_REFRESH_MS以上送っていない子機へ制御フレームを送る。
+// 子機ごとの送信状態は子機レジストリのスロット番号で索引する（スロット再利用は子機Noで検出）。
+// 送信位相の割り当て: 現在の間隔で位相を測れた子機のうち、スロットの目標位相から外れた子機へ位相補正を送る。
+// REPORT_SCHEDULE_WINDOW_MSごとに近接到着率・欠番率・揺らぎをログへ出し、割り当ての効果を比較できるようにする。
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+#include "esp_random.h"
+#include "report_control.h"
+#include "report_policy.h"
+#include "tx_schedule.h"
+#include "sensor_frame.h"
+#include "child_registry.h"
+#include "wifi_task.h"
+#include "web_server_task.h"
+#include "ssd1306_task.h"
+#include "log_task.h"
+
+_Static_assert(REPORT_INTERVAL_MAX_MS * CHILD_STALE_MISSED_REPORTS < CHILD_EXPIRE_TIMEOUT_MS,
+               "longest report interval must not expire a child");
+
+// ==== 内部定義 ====
+typedef struct {
+    uint8_t child_no;           // 送信先の子機No（0=未送信）
+    uint16_t ctrl_seq;          // 送信済みの指示通番
+    uint32_t last_sent_ms;      // 最終送信時刻（ms）
+} control_slot_t;
+
+static control_slot_t s_slots[CHILD_REGISTRY_MAX_NODES];
+static child_registry_ref_t s_refs[CHILD_REGISTRY_MAX_NODES];  // 子機監視タスク専用
+static report_policy_t s_policy;
+static report_control_status_t s_status;
+static uint32_t s_last_overflow = 0;
+static uint32_t s_last_coalesce = 0;
+static int s_sock = -1;
+
+// 到着統計の集計区間の開始値
+static uint32_t s_window_start_ms = 0;
+static tx_arrival_stats_t s_window_arrivals;
+static child_seq_stats_t s_window_seq;
+
+// ==== 制御フレーム送信 ====
+static bool send_control(uint8_t child_no, uint32_t source_ip, uint8_t type, uint16_t ctrl_seq, uint32_t value)
+{
+    sensor_control_t ctrl = {
+        .child_no = child_no,
+        .type = type,
+        .ctrl_seq = ctrl_seq,
+        .value = value,
+    };
+    uint8_t frame[SENSOR_CONTROL_FRAME_SIZE];
+    size_t len = sensor_frame_encode_control(&ctrl, frame, sizeof(frame));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = source_ip;
+    addr.sin_port = htons(SENSOR_CONTROL_PORT);
+
+    if (sendto(s_sock, frame, len, MSG_DONTWAIT, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        s_status.send_errors++;
+        return false;
+    }
+    s_status.frames_sent++;
+    return true;
+}
+
+// ==== 送信位相の割り当て ====
+typedef struct {
+    uint32_t scheduled;     // 現在の間隔で位相を測定できた子機数
+    uint32_t aligned;       // うち許容範囲内の子機数
+    uint32_t jitter_sum;    // 揺らぎの合計（ms）
+} schedule_tally_t;
+
+static void schedule_child(const child_registry_ref_t *ref, uint32_t tolerance_ms,
+                           uint32_t current_time_ms, schedule_tally_t *tally)
+{
+    tx_phase_t phase;
+    if (!child_registry_get_tx_phase(ref->child_no, &phase) || phase.interval_ms != s_status.interval_ms ||
+        current_time_ms - phase.last_arrival_ms > phase.interval_ms * CHILD_STALE_MISSED_REPORTS) {
+        return;  // 新しい間隔での到着待ち、または届いていない
+    }
+    tally->scheduled++;
+    tally->jitter_sum += tx_phase_jitter_ms(&phase);
+
+    int32_t shift_ms;
+    uint32_t target_ms = tx_schedule_target_ms(ref->slot, phase.interval_ms);
+    if (!tx_schedule_correction(&phase, target_ms, tolerance_ms, &shift_ms)) {
+        if (phase.arrivals >= TX_PHASE_SETTLE_ARRIVALS) {
+            tally->aligned++;
+        }
+        return;
+    }
+    if (!s_status.schedule_enabled) {
+        return;
+    }
+
+    uint32_t source_ip;
+    if (!child_registry_get_source_ip(ref->child_no, &source_ip)) {
+        return;
+    }
+    uint16_t phase_seq = s_status.phase_seq + 1;
+    if (send_control(ref->child_no, source_ip, SENSOR_CONTROL_SHIFT_PHASE, phase_seq, (uint32_t)shift_ms)) {
+        s_status.phase_seq = phase_seq;
+        s_status.phase_shifts++;
+        child_registry_restart_tx_phase(ref->child_no);
+    }
+}
+
+// 集計区間ごとの近接到着率・欠番率
+static void schedule_window(uint32_t current_time_ms)
+{
+    if (current_time_ms - s_window_start_ms < REPORT_SCHEDULE_WINDOW_MS) {
+        return;
+    }
+
+    tx_arrival_stats_t arrivals;
+    child_seq_stats_t seq;
+    child_registry_get_arrival_stats(&arrivals);
+    child_registry_get_seq_totals(&seq);
+
+    uint32_t rx = arrivals.arrivals - s_window_arrivals.arrivals;
+    uint32_t close = arrivals.close_arrivals - s_window_arrivals.close_arrivals;
+    uint32_t received = seq.received - s_window_seq.received;
+    // 欠番は後から届いた分が差し引かれるため、区間内で減ることがある
+    uint32_t lost = (seq.lost > s_window_seq.lost) ? seq.lost - s_window_seq.lost : 0;
+
+    s_status.close_permille = (rx > 0) ? (uint16_t)((uint64_t)close * 1000u / rx) : 0;
+    s_status.loss_permille = (received + lost > 0) ? (uint16_t)((uint64_t)lost * 1000u / (received + lost)) : 0;
+
+    if (rx > 0) {
+        syslog(INFO, "[SCHED] %s aligned=%lu/%lu jitter=%lums close=%u.%u%% loss=%u.%u%% shifts=%lu",
+               s_status.schedule_enabled ? "on" : "off",
+               (unsigned long)s_status.aligned_children, (unsigned long)s_status.scheduled_children,
+               (unsigned long)s_status.jitter_ms,
+               s_status.close_permille / 10, s_status.close_permille % 10,
+               s_status.loss_permille / 10, s_status.loss_permille % 10, (unsigned long)s_status.phase_shifts);
+    }
+
+    s_window_start_ms = current_time_ms;
+    s_window_arrivals = arrivals;
+    s_window_seq = seq;
+}
+
+// ==== 公開関数 ====
+bool report_control_init(void)
+{
+    report_policy_init(&s_policy);
+    memset(s_slots, 0, sizeof(s_slots));
+    memset(&s_status, 0, sizeof(s_status));
+    s_status.interval_ms = s_policy.interval_ms;
+    s_status.backoff = s_policy.backoff;
+    // 再起動前の通番と重ならないよう乱数から始める（子機は通番が変わった時だけ適用する）
+    s_status.ctrl_seq = (uint16_t)esp_random();
+    s_status.phase_seq = (uint16_t)esp_random();
+    s_status.schedule_enabled = true;
+
+    s_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s_sock < 0) {
+        syslog(ERR, "Report control: failed to create UDP socket");
+        return false;
+    }
+
+    syslog(INFO, "Report control started (child port %d, interval %lu-%lums)", SENSOR_CONTROL_PORT,
+           (unsigned long)REPORT_INTERVAL_MIN_MS, (unsigned long)REPORT_INTERVAL_MAX_MS);
+    return true;
+}
+
+void report_control_tick(uint32_t current_time_ms)
+{
+    if (s_sock < 0) {
+        return;
+    }
+
+    // 前回の周期からの受信経路の変化を集める
+    wifi_ingest_stats_t ingest;
+    wifi_get_ingest_stats(&ingest);
+
+    report_policy_input_t in = {
+        .active_children = (uint32_t)child_registry_count_active(),
+        .ring_pending = ingest.ring.count,
+        .ring_capacity = ingest.ring.capacity,
+        .overflow_delta = ingest.ring.overflow - s_last_overflow,
+        .coalesce_delta = ingest.coalesce_bursts - s_last_coalesce,
+        .viewer_active = web_server_has_viewer(),
+        .display_active = ssd1306_is_showing_sensors(),
+    };
+    s_last_overflow = ingest.ring.overflow;
+    s_last_coalesce = ingest.coalesce_bursts;
+
+    uint32_t interval_ms = report_policy_update(&s_policy, &in);
+    if (interval_ms != s_status.interval_ms) {
+        syslog(INFO, "[CTRL] interval %lums -> %lums (children=%lu viewer=%d display=%d backoff=%u%s)",
+               (unsigned long)s_status.interval_ms, (unsigned long)interval_ms,
+               (unsigned long)in.active_children, in.viewer_active, in.display_active,
+               (unsigned int)s_policy.backoff, s_policy.overloaded ? " overload" : "");
+        s_status.interval_ms = interval_ms;
+        s_status.ctrl_seq++;
+    }
+    s_status.backoff = s_policy.backoff;
+    s_status.overloaded = s_policy.overloaded;
+    s_status.viewer_active = in.viewer_active;
+    s_status.display_active = in.display_active;
+    s_status.active_children = in.active_children;
+
+    // 指示が変わった子機・再送時期の子機へ送信（位相の補正も同じ走査で行う）
+    size_t count = child_registry_list(s_refs, CHILD_REGISTRY_MAX_NODES);
+    size_t slot_span = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (s_refs[i].slot >= slot_span) {
+            slot_span = s_refs[i].slot + 1;
+        }
+    }
+    uint32_t tolerance_ms = tx_schedule_tolerance_ms(s_status.interval_ms, slot_span);
+    schedule_tally_t tally = { 0 };
+
+    for (size_t i = 0; i < count; i++) {
+        schedule_child(&s_refs[i], tolerance_ms, current_time_ms, &tally);
+
+        control_slot_t *slot = &s_slots[s_refs[i].slot];
+        bool same_child = slot->child_no == s_refs[i].child_no;
+        if (same_child && slot->ctrl_seq == s_status.ctrl_seq &&
+            current_time_ms - slot->last_sent_ms < REPORT_CONTROL_REFRESH_MS) {
+            continue;
+        }
+
+        uint32_t source_ip;
+        if (!child_registry_get_source_ip(s_refs[i].child_no, &source_ip)) {
+            continue;  // 列挙後に解放された
+        }
+        if (send_control(s_refs[i].child_no, source_ip, SENSOR_CONTROL_SET_INTERVAL,
+                         s_status.ctrl_seq, s_status.interval_ms)) {
+            slot->child_no = s_refs[i].child_no;
+            slot->ctrl_seq = s_status.ctrl_seq;
+            slot->last_sent_ms = current_time_ms;
+            child_registry_set_report_interval(s_refs[i].child_no, s_status.interval_ms);
+        }
+    }
+
+    s_status.scheduled_children = tally.scheduled;
+    s_status.aligned_children = tally.aligned;
+    s_status.jitter_ms = (tally.scheduled > 0) ? tally.jitter_sum / tally.scheduled : 0;
+    schedule_window(current_time_ms);
+}
+
+void report_control_get_status(report_control_status_t *status)
+{
+    if (status == NULL) {
+        return;
+    }
+    *status = s_status;
+}
+
+void report_control_set_schedule(bool enable)
+{
+    s_status.schedule_enabled = enable;
+    syslog(INFO, "Report control: transmit phase schedule %s", enable ? "enabled" : "disabled");
+}
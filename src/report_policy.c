@@ -0,0 +1,90 @@
+// src/report_policy.c
+// 子機送信間隔の決定ポリシー（ゲートウェイ→子機の下り制御用）
+//
+// 間隔 = max(表示先による基本間隔, 受信予算から求めた下限) × 過負荷倍率
+// 過負荷倍率は乗算増加・段階的減少（過負荷で2倍、平穏がREPORT_CALM_TICKS_TO_RECOVER周期続けば1/2）。
+// - 引き上げ後REPORT_ESCALATE_HOLD_TICKS周期は、指示が効く前の過負荷で重ねて引き上げない
+// - 戻した直後に過負荷になったら、次に戻すまでの待ちを倍にする（処理能力の手前で落ち着かせる）
+// FreeRTOS/ESP-IDFに依存しないため、ホスト側ツールでも同じコードを使える。
+
+#include <stdint.h>
+#include <string.h>
+#include "report_policy.h"
+
+void report_policy_init(report_policy_t *policy)
+{
+    if (policy == NULL) {
+        return;
+    }
+    memset(policy, 0, sizeof(*policy));
+    policy->backoff = 1;
+    policy->since_recover = UINT8_MAX;
+    policy->interval_ms = REPORT_INTERVAL_IDLE_MS;
+}
+
+static bool is_overloaded(const report_policy_input_t *in)
+{
+    // 破棄・集約が起きた、またはリングが半分以上埋まったまま
+    return in->overflow_delta > 0 || in->coalesce_delta > 0 ||
+           (in->ring_capacity > 0 && in->ring_pending * 2 >= in->ring_capacity);
+}
+
+uint32_t report_policy_update(report_policy_t *policy, const report_policy_input_t *in)
+{
+    if (policy == NULL || in == NULL) {
+        return REPORT_INTERVAL_IDLE_MS;
+    }
+
+    if (policy->since_recover < UINT8_MAX) {
+        policy->since_recover++;
+    }
+    if (policy->hold_ticks > 0) {
+        policy->hold_ticks--;
+    }
+
+    uint32_t calm_required = (uint32_t)REPORT_CALM_TICKS_TO_RECOVER << policy->strikes;
+    policy->overloaded = is_overloaded(in);
+    if (policy->overloaded) {
+        if (policy->since_recover <= REPORT_CALM_TICKS_TO_RECOVER && policy->strikes < REPORT_PROBE_STRIKES_MAX) {
+            policy->strikes++;  // 戻しすぎた
+        }
+        if (policy->hold_ticks == 0 && policy->backoff < REPORT_BACKOFF_MAX) {
+            policy->backoff *= 2;
+            policy->hold_ticks = REPORT_ESCALATE_HOLD_TICKS;
+        }
+        policy->calm_ticks = 0;
+        policy->since_recover = UINT8_MAX;
+    } else if (policy->backoff > 1) {
+        if (++policy->calm_ticks >= calm_required) {
+            policy->backoff /= 2;
+            policy->calm_ticks = 0;
+            policy->since_recover = 0;
+        }
+    } else if (policy->strikes > 0 && policy->since_recover >= calm_required) {
+        // 倍率1のまま平穏が続いた → 負荷が下がったので待ちを元に戻していく
+        policy->strikes--;
+        policy->since_recover = 0;
+    }
+
+    // 表示先による基本間隔
+    uint32_t interval_ms = in->viewer_active  ? REPORT_INTERVAL_VIEWER_MS :
+                           in->display_active ? REPORT_INTERVAL_DISPLAY_MS :
+                                                REPORT_INTERVAL_IDLE_MS;
+
+    // 全子機合計が受信予算を超えない下限（切り上げ）
+    uint32_t budget_ms = (in->active_children * 1000u + REPORT_RX_BUDGET_PER_SEC - 1) / REPORT_RX_BUDGET_PER_SEC;
+    if (interval_ms < budget_ms) {
+        interval_ms = budget_ms;
+    }
+
+    interval_ms *= policy->backoff;
+    if (interval_ms < REPORT_INTERVAL_MIN_MS) {
+        interval_ms = REPORT_INTERVAL_MIN_MS;
+    }
+    if (interval_ms > REPORT_INTERVAL_MAX_MS) {
+        interval_ms = REPORT_INTERVAL_MAX_MS;
+    }
+
+    policy->interval_ms = interval_ms;
+    return interval_ms;
+}
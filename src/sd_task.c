@@ -12,6 +12,7 @@
 #include "sd_task.h"
 
 #include "flash_data.h"
+#include "child_registry.h"
 #include <arpa/inet.h>  // inet_ntoa, etc.
 
 // ==== GPIO割当（HSPI専用）====
@@ -24,6 +25,10 @@
 #define SD_QUEUE_DEPTH   64
 #define SD_LINE_LEN      128
 
+// 子機の測定値ログ（値が変わった子機だけを追記、書き込みは最短でもこの間隔にまとめる）
+#define SD_SENSOR_LOG_PATH             SD_MOUNT_POINT "/sensor.csv"
+#define SD_SENSOR_LOG_MIN_INTERVAL_MS  1000
+
 typedef enum {
     SD_CMD_WRITE_LOG,
     SD_CMD_EXPORT_FLASHDATA,
@@ -134,7 +139,9 @@ bool sd_enqueue_line(const char *line)
     if (!qSdCmd) return false;
     SdMsg msg = { .cmd = SD_CMD_WRITE_LOG };
     strncpy(msg.line, line, sizeof(msg.line) - 1);
-    return (xQueueSend(qSdCmd, &msg, 0) == pdPASS);
+    if (xQueueSend(qSdCmd, &msg, 0) != pdPASS) return false;
+    xTaskNotifyGive(sdTaskHandle);  // sd_taskは通知でのみ起きる
+    return true;
 }
 
 // flashdata.csv出力要求
@@ -142,7 +149,9 @@ bool sd_request_flashdata_export(void)
 {
     if (!qSdCmd) return false;
     SdMsg msg = { .cmd = SD_CMD_EXPORT_FLASHDATA };
-    return (xQueueSend(qSdCmd, &msg, 0) == pdPASS);
+    if (xQueueSend(qSdCmd, &msg, 0) != pdPASS) return false;
+    xTaskNotifyGive(sdTaskHandle);
+    return true;
 }
 
 // ===================================================
@@ -210,6 +219,65 @@ static void sd_export_flashdata_csv(void)
 
 
 
+// ===================================================
+// 子機の測定値ログ（前回書いた後に値が変わった子機だけ追記）
+// 形式: ms,child_no,seq,<チャネルの表示名...>,rssi（値は実単位、無効なチャネルは空欄）
+// ===================================================
+static child_view_t s_sensor_views[CHILD_REGISTRY_MAX_NODES];
+static uint32_t s_sensor_cursor = 0;
+
+// 戻り値: 書き込んだ行数（変化なし・未マウントなら0）
+static int sd_append_sensor_log(void)
+{
+    if (child_registry_version() == s_sensor_cursor || !sd_is_mounted()) {
+        return 0;
+    }
+    uint32_t version = child_registry_snapshot(s_sensor_views);
+
+    xSemaphoreTake(mtxSD, portMAX_DELAY);
+    FILE *fp = fopen(SD_SENSOR_LOG_PATH, "a");
+    if (!fp) {
+        xSemaphoreGive(mtxSD);
+        syslog(ERR, "fopen(sensor.csv) failed");
+        return 0;
+    }
+    if (ftell(fp) == 0) {
+        fprintf(fp, "ms,child_no,seq");
+        for (int ch = 0; ch < SENSOR_CH_COUNT; ch++) {
+            const sensor_channel_t *c = sensor_channel_get((sensor_ch_t)ch);
+            fprintf(fp, ",%s[%s]", c->label, c->unit);
+        }
+        fprintf(fp, ",rssi\n");
+    }
+
+    int rows = 0;
+    for (int slot = 0; slot < CHILD_REGISTRY_MAX_NODES; slot++) {
+        const child_view_t *view = &s_sensor_views[slot];
+        // STALEへの遷移・解放も変化として通知されるが、記録するのは新しい測定値のみ
+        if (!child_view_changed(view, s_sensor_cursor) ||
+            !child_view_fresh(view, view->child_no)) {
+            continue;
+        }
+        temp_sens_data_t data;
+        sensor_data_unpack(&view->reading, &data);
+        fprintf(fp, "%lu,%d,%lu", (unsigned long)view->last_recv_ms, view->child_no, (unsigned long)data.seq);
+        for (int ch = 0; ch < SENSOR_CH_COUNT; ch++) {
+            char value[16] = "";
+            if (sensor_data_valid(&data, (sensor_ch_t)ch)) {
+                sensor_channel_format((sensor_ch_t)ch, data.ch[ch], value, sizeof(value));
+            }
+            fprintf(fp, ",%s", value);
+        }
+        fprintf(fp, ",%d\n", data.rssi);
+        rows++;
+    }
+    fclose(fp);
+    xSemaphoreGive(mtxSD);
+
+    s_sensor_cursor = version;
+    return rows;
+}
+
 // ============================================================
 // SD書込み本体ループ
 // ============================================================
@@ -224,9 +292,15 @@ void sd_task(void *pv)
         syslog(ERR, "SD init failed");
     }
 
+    // 書き込み要求（sd_enqueue_line等）と子機の値の変化でのみ起きる
+    child_registry_subscribe(xTaskGetCurrentTaskHandle());
+    s_sensor_cursor = child_registry_version();
+
     SdMsg msg;
     for (;;) {
-        if (xQueueReceive(qSdCmd, &msg, pdMS_TO_TICKS(100))) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while (xQueueReceive(qSdCmd, &msg, 0)) {
             switch (msg.cmd) {
                 case SD_CMD_WRITE_LOG: {
                     xSemaphoreTake(mtxSD, portMAX_DELAY);
@@ -246,6 +320,11 @@ void sd_task(void *pv)
                     break;
             }
         }
+
+        if (sd_append_sensor_log() > 0) {
+            // 変化が続く間も書き込みは最短間隔にまとめる（待つ間の要求・変化は通知が残り、次の周回で処理する）
+            vTaskDelay(pdMS_TO_TICKS(SD_SENSOR_LOG_MIN_INTERVAL_MS));
+        }
     }
 }
 
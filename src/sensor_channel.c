@@ -0,0 +1,255 @@
+// src/sensor_channel.c
+// センサチャネル表の属性と、表に沿った汎用の変換（飽和・詰め込み・書式化・JSON出力）
+//
+// チャネルごとの処理は書かず、SENSOR_CHANNEL_TABLEから生成した属性表を順に引く。
+// 浮動小数点は使わず、10^decimals倍の整数のまま扱う。
+// FreeRTOS/ESP-IDFに依存しないため、ホスト側ツールでも同じコードを使える。
+
+#include <stdio.h>
+#include <string.h>
+#include "sensor_channel.h"
+
+_Static_assert(SENSOR_CH_COUNT <= 32, "channel valid bits must fit in uint32_t");
+_Static_assert(sizeof(sensor_packed_t) == ((4 + 1 + SENSOR_CH_VALID_BYTES + SENSOR_CH_PACKED_SIZE + 3) & ~3u),
+               "sensor_packed_t must stay densely packed");
+
+// ==== 属性表 ====
+static const sensor_channel_t s_channels[SENSOR_CH_COUNT] = {
+#define SENSOR_CH_ENTRY(id, key, label, name, decimals, unit, type, group) \
+    [SENSOR_CH_##id] = { key, label, name, unit, sizeof(key) - 1, sizeof(label) - 1, \
+                         decimals, SENSOR_CH_TYPE_##type, SENSOR_GROUP_##group },
+    SENSOR_CHANNEL_TABLE(SENSOR_CH_ENTRY)
+#undef SENSOR_CH_ENTRY
+};
+
+static const char *const s_group_keys[SENSOR_GROUP_COUNT] = {
+#define SENSOR_GROUP_ENTRY(id, ok_key) [SENSOR_GROUP_##id] = ok_key,
+    SENSOR_GROUP_TABLE(SENSOR_GROUP_ENTRY)
+#undef SENSOR_GROUP_ENTRY
+};
+
+static const uint8_t s_type_width[] = {
+    [SENSOR_CH_TYPE_U8]  = SENSOR_CH_WIDTH_U8,
+    [SENSOR_CH_TYPE_I16] = SENSOR_CH_WIDTH_I16,
+    [SENSOR_CH_TYPE_U16] = SENSOR_CH_WIDTH_U16,
+    [SENSOR_CH_TYPE_I32] = SENSOR_CH_WIDTH_I32,
+};
+
+const sensor_channel_t *sensor_channel_get(sensor_ch_t ch)
+{
+    return ((unsigned)ch < SENSOR_CH_COUNT) ? &s_channels[ch] : NULL;
+}
+
+const char *sensor_group_ok_key(sensor_group_t group)
+{
+    return ((unsigned)group < SENSOR_GROUP_COUNT) ? s_group_keys[group] : NULL;
+}
+
+uint32_t sensor_group_mask(sensor_group_t group)
+{
+    uint32_t mask = 0;
+    if ((unsigned)group >= SENSOR_GROUP_COUNT) {
+        return 0;
+    }
+    for (int i = 0; i < SENSOR_CH_COUNT; i++) {
+        if (s_channels[i].group == group) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+int sensor_channel_find_key(const char *key, size_t len)
+{
+    for (int i = 0; i < SENSOR_CH_COUNT; i++) {
+        if (s_channels[i].key_len == len && memcmp(s_channels[i].key, key, len) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int sensor_channel_find_label(const char *label, size_t len)
+{
+    for (int i = 0; i < SENSOR_CH_COUNT; i++) {
+        if (s_channels[i].label_len == len && memcmp(s_channels[i].label, label, len) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int sensor_group_find_key(const char *key, size_t len)
+{
+    for (int i = 0; i < SENSOR_GROUP_COUNT; i++) {
+        if (strlen(s_group_keys[i]) == len && memcmp(s_group_keys[i], key, len) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// ==== 値の設定 ====
+static int32_t saturate(uint8_t type, int64_t value)
+{
+    int64_t lo, hi;
+    switch (type) {
+    case SENSOR_CH_TYPE_U8:  lo = 0;         hi = UINT8_MAX;  break;
+    case SENSOR_CH_TYPE_I16: lo = INT16_MIN; hi = INT16_MAX;  break;
+    case SENSOR_CH_TYPE_U16: lo = 0;         hi = UINT16_MAX; break;
+    default:                 lo = INT32_MIN; hi = INT32_MAX;  break;
+    }
+    return (int32_t)(value < lo ? lo : (value > hi ? hi : value));
+}
+
+void sensor_data_set(temp_sens_data_t *data, sensor_ch_t ch, int64_t value)
+{
+    if (data == NULL || (unsigned)ch >= SENSOR_CH_COUNT) {
+        return;
+    }
+    data->ch[ch] = saturate(s_channels[ch].type, value);
+    data->ch_valid |= 1u << ch;
+}
+
+void sensor_data_apply_group(temp_sens_data_t *data, sensor_group_t group, bool ok)
+{
+    if (data != NULL && !ok) {
+        data->ch_valid &= ~sensor_group_mask(group);
+    }
+}
+
+// ==== コンパクト形式 ====
+void sensor_data_pack(const temp_sens_data_t *data, sensor_packed_t *packed)
+{
+    if (data == NULL || packed == NULL) {
+        return;
+    }
+
+    int rssi = data->rssi;
+    if (rssi < -128) rssi = -128;
+    if (rssi > 127) rssi = 127;
+
+    memset(packed, 0, sizeof(*packed));
+    packed->seq = data->seq;
+    packed->rssi = (int8_t)rssi;
+
+    size_t offset = 0;
+    for (int i = 0; i < SENSOR_CH_COUNT; i++) {
+        uint8_t type = s_channels[i].type;
+        int32_t v = saturate(type, data->ch[i]);
+        switch (type) {
+        case SENSOR_CH_TYPE_U8:  { uint8_t n = (uint8_t)v;   memcpy(&packed->values[offset], &n, sizeof(n)); break; }
+        case SENSOR_CH_TYPE_I16: { int16_t n = (int16_t)v;   memcpy(&packed->values[offset], &n, sizeof(n)); break; }
+        case SENSOR_CH_TYPE_U16: { uint16_t n = (uint16_t)v; memcpy(&packed->values[offset], &n, sizeof(n)); break; }
+        default:                 memcpy(&packed->values[offset], &v, sizeof(v)); break;
+        }
+        offset += s_type_width[type];
+        if (data->ch_valid & (1u << i)) {
+            packed->valid[i / 8] |= (uint8_t)(1u << (i % 8));
+        }
+    }
+}
+
+void sensor_data_unpack(const sensor_packed_t *packed, temp_sens_data_t *data)
+{
+    if (packed == NULL || data == NULL) {
+        return;
+    }
+
+    memset(data, 0, sizeof(*data));
+    data->seq = packed->seq;
+    data->rssi = packed->rssi;
+
+    size_t offset = 0;
+    for (int i = 0; i < SENSOR_CH_COUNT; i++) {
+        uint8_t type = s_channels[i].type;
+        switch (type) {
+        case SENSOR_CH_TYPE_U8:  { uint8_t n;  memcpy(&n, &packed->values[offset], sizeof(n)); data->ch[i] = n; break; }
+        case SENSOR_CH_TYPE_I16: { int16_t n;  memcpy(&n, &packed->values[offset], sizeof(n)); data->ch[i] = n; break; }
+        case SENSOR_CH_TYPE_U16: { uint16_t n; memcpy(&n, &packed->values[offset], sizeof(n)); data->ch[i] = n; break; }
+        default:                 memcpy(&data->ch[i], &packed->values[offset], sizeof(int32_t)); break;
+        }
+        offset += s_type_width[type];
+        if (packed->valid[i / 8] & (1u << (i % 8))) {
+            data->ch_valid |= 1u << i;
+        }
+    }
+}
+
+// ==== 書式化 ====
+int sensor_channel_format(sensor_ch_t ch, int32_t value, char *buf, size_t size)
+{
+    if ((unsigned)ch >= SENSOR_CH_COUNT || buf == NULL) {
+        return 0;
+    }
+
+    uint8_t decimals = s_channels[ch].decimals;
+    if (decimals == 0) {
+        return snprintf(buf, size, "%ld", (long)value);
+    }
+
+    uint32_t scale = 1;
+    for (uint8_t i = 0; i < decimals; i++) {
+        scale *= 10;
+    }
+    uint32_t mag = (value < 0) ? (uint32_t)0 - (uint32_t)value : (uint32_t)value;
+    return snprintf(buf, size, "%s%lu.%0*lu", (value < 0) ? "-" : "",
+                    (unsigned long)(mag / scale), (int)decimals, (unsigned long)(mag % scale));
+}
+
+int sensor_data_format(const temp_sens_data_t *data, char *buf, size_t size)
+{
+    if (data == NULL || buf == NULL || size == 0) {
+        return 0;
+    }
+
+    size_t len = 0;
+    buf[0] = '\0';
+    for (int i = 0; i < SENSOR_CH_COUNT; i++) {
+        const sensor_channel_t *c = &s_channels[i];
+        bool valid = (data->ch_valid & (1u << i)) != 0;
+        char value[16] = "--";
+        if (valid) {
+            sensor_channel_format((sensor_ch_t)i, data->ch[i], value, sizeof(value));
+        }
+        // 切り詰めた後も必要な文字数だけ数える
+        int n = snprintf((len < size) ? buf + len : NULL, (len < size) ? size - len : 0, "%s%s=%s%s",
+                         (i > 0) ? " " : "", c->label, value, valid ? c->unit : "");
+        if (n > 0) {
+            len += (size_t)n;
+        }
+    }
+    return (int)len;
+}
+
+size_t sensor_data_write_json(const temp_sens_data_t *data, char *buf, size_t size)
+{
+    if (data == NULL || buf == NULL) {
+        return 0;
+    }
+
+    size_t len = 0;
+    int n;
+    for (int i = 0; i < SENSOR_CH_COUNT; i++) {
+        if (data->ch_valid & (1u << i)) {
+            n = snprintf(buf + len, size - len, "%s\"%s\":%ld",
+                         (i > 0) ? "," : "", s_channels[i].key, (long)data->ch[i]);
+        } else {
+            n = snprintf(buf + len, size - len, "%s\"%s\":null",
+                         (i > 0) ? "," : "", s_channels[i].key);
+        }
+        if (n < 0 || (size_t)n >= size - len) {
+            return 0;
+        }
+        len += (size_t)n;
+    }
+    for (int g = 0; g < SENSOR_GROUP_COUNT; g++) {
+        n = snprintf(buf + len, size - len, "%s\"%s\":%s", (len > 0) ? "," : "", s_group_keys[g],
+                     sensor_data_group_ok(data, (sensor_group_t)g) ? "true" : "false");
+        if (n < 0 || (size_t)n >= size - len) {
+            return 0;
+        }
+        len += (size_t)n;
+    }
+    return len;
+}
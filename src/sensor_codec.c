@@ -0,0 +1,281 @@
+// src/sensor_codec.c
+// 測定値の時系列圧縮（時刻はdelta-of-delta、値は差のzig-zagをビット単位の可変長符号で詰める）
+//
+// - 追記: 状態を写した上でビット列を書き、ブロックに収まらなければ状態を戻してfalse（書きかけのビットは
+//   件数に含まれないため読まれない）
+// - 復号: ヘッダの件数だけ、符号化と同じ順に差を足し戻す
+// FreeRTOS/ESP-IDFに依存しないため、ホスト側ツールでも同じコードを使える。
+
+#include <string.h>
+#include "sensor_codec.h"
+
+#define CH_VALID_MASK       ((uint32_t)(((uint64_t)1 << SENSOR_CH_COUNT) - 1))
+
+_Static_assert(SENSOR_CH_COUNT <= 32, "channel valid bits must fit in uint32_t");
+_Static_assert(SENSOR_CODEC_BLOCK_MAX * 8 <= UINT16_MAX, "bit position must fit in uint16_t");
+
+// ==== ビット列 ====
+typedef struct {
+    uint8_t *buf;
+    uint32_t bit;
+    uint32_t limit;     // 書ける最大ビット数
+    bool overflow;
+} bit_writer_t;
+
+// valueの下位nビット（n≦32）をMSBから書く。既存の内容は上書きする
+static void put_bits(bit_writer_t *w, uint32_t value, int n)
+{
+    if (w->overflow || w->bit + (uint32_t)n > w->limit) {
+        w->overflow = true;
+        return;
+    }
+    while (n > 0) {
+        uint8_t *byte = &w->buf[w->bit >> 3];
+        int space = 8 - (int)(w->bit & 7);
+        int take = (n < space) ? n : space;
+        uint8_t chunk = (uint8_t)((value >> (n - take)) & ((1u << take) - 1));
+        uint8_t mask = (uint8_t)(((1u << take) - 1) << (space - take));
+        *byte = (uint8_t)((*byte & ~mask) | (chunk << (space - take)));
+        w->bit += (uint32_t)take;
+        n -= take;
+    }
+}
+
+// nビット（n≦32）をMSBから読む。範囲外ならfalse
+static bool get_bits(const uint8_t *buf, uint32_t limit, uint32_t *bit, int n, uint32_t *value)
+{
+    if (*bit + (uint32_t)n > limit) {
+        return false;
+    }
+    uint32_t v = 0;
+    while (n > 0) {
+        uint8_t byte = buf[*bit >> 3];
+        int space = 8 - (int)(*bit & 7);
+        int take = (n < space) ? n : space;
+        v = (v << take) | ((uint32_t)(byte >> (space - take)) & ((1u << take) - 1));
+        *bit += (uint32_t)take;
+        n -= take;
+    }
+    *value = v;
+    return true;
+}
+
+// ==== 可変長符号 ====
+static uint32_t zigzag_encode(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t zigzag_decode(uint32_t v)
+{
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+// 接頭辞の1の数ごとの値のビット数（"0"は値0）
+static const int s_class_bits[] = { 0, 3, 8, 16, 32 };
+#define CLASS_COUNT     (int)(sizeof(s_class_bits) / sizeof(s_class_bits[0]))
+
+static void put_code(bit_writer_t *w, int32_t v)
+{
+    uint32_t z = zigzag_encode(v);
+    if (z == 0) {
+        put_bits(w, 0, 1);
+        return;
+    }
+    int cls = 1;
+    while (cls < CLASS_COUNT - 1 && (z >> s_class_bits[cls]) != 0) {
+        cls++;
+    }
+    // 接頭辞: cls個の1と終端の0（最後の組は終端なし）
+    int prefix_len = (cls < CLASS_COUNT - 1) ? cls + 1 : cls;
+    put_bits(w, ((1u << cls) - 1) << (prefix_len - cls), prefix_len);
+    put_bits(w, z, s_class_bits[cls]);
+}
+
+static bool get_code(const uint8_t *buf, uint32_t limit, uint32_t *bit, int32_t *v)
+{
+    int cls = 0;
+    while (cls < CLASS_COUNT - 1) {
+        uint32_t b;
+        if (!get_bits(buf, limit, bit, 1, &b)) {
+            return false;
+        }
+        if (b == 0) {
+            break;
+        }
+        cls++;
+    }
+    uint32_t z = 0;
+    if (cls > 0 && !get_bits(buf, limit, bit, s_class_bits[cls], &z)) {
+        return false;
+    }
+    *v = zigzag_decode(z);
+    return true;
+}
+
+// ==== ヘッダ ====
+static void put_le16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+uint16_t sensor_codec_block_count(const uint8_t *block)
+{
+    return (uint16_t)(block[0] | (block[1] << 8));
+}
+
+uint32_t sensor_codec_block_first_ms(const uint8_t *block)
+{
+    return (uint32_t)block[2] | ((uint32_t)block[3] << 8) | ((uint32_t)block[4] << 16) | ((uint32_t)block[5] << 24);
+}
+
+// ==== 符号化 ====
+bool sensor_codec_block_begin(uint8_t *block, size_t size, sensor_codec_state_t *state)
+{
+    if (block == NULL || state == NULL || size <= SENSOR_CODEC_HEADER_BYTES || size > SENSOR_CODEC_BLOCK_MAX) {
+        return false;
+    }
+    memset(state, 0, sizeof(*state));
+    state->bits = SENSOR_CODEC_HEADER_BYTES * 8;
+    memset(block, 0, SENSOR_CODEC_HEADER_BYTES);
+    return true;
+}
+
+bool sensor_codec_block_append(uint8_t *block, size_t size, sensor_codec_state_t *state,
+                               uint32_t time_ms, const temp_sens_data_t *data)
+{
+    if (block == NULL || state == NULL || data == NULL || size > SENSOR_CODEC_BLOCK_MAX ||
+        state->count == UINT16_MAX) {
+        return false;
+    }
+
+    sensor_codec_state_t next = *state;
+    bit_writer_t w = { .buf = block, .bit = state->bits, .limit = (uint32_t)size * 8, .overflow = false };
+    uint32_t valid = data->ch_valid & CH_VALID_MASK;
+
+    if (state->count == 0) {
+        // 先頭: 時刻はヘッダ、seq・有効ビットはそのまま、値は0からの差
+        next.time_ms = time_ms;
+        next.time_delta = 0;
+        put_bits(&w, data->seq, 32);
+        put_bits(&w, valid, SENSOR_CH_COUNT);
+    } else {
+        uint32_t units = 0;
+        if ((int32_t)(time_ms - state->time_ms) > 0) {
+            units = (time_ms - state->time_ms) / SENSOR_CODEC_TIME_UNIT_MS;
+        }
+        put_code(&w, (int32_t)(units - (uint32_t)state->time_delta));
+        next.time_delta = (int32_t)units;
+        next.time_ms = state->time_ms + units * SENSOR_CODEC_TIME_UNIT_MS;
+        put_code(&w, (int32_t)(data->seq - state->seq - 1));
+        if (valid == state->valid) {
+            put_bits(&w, 0, 1);
+        } else {
+            put_bits(&w, 1, 1);
+            put_bits(&w, valid, SENSOR_CH_COUNT);
+        }
+    }
+    for (int ch = 0; ch < SENSOR_CH_COUNT; ch++) {
+        if (valid & (1u << ch)) {
+            put_code(&w, (int32_t)((uint32_t)data->ch[ch] - (uint32_t)state->ch[ch]));
+            next.ch[ch] = data->ch[ch];
+        }
+    }
+    if (w.overflow) {
+        return false;   // 収まらない（書きかけのビットは件数外なので読まれない）
+    }
+
+    next.seq = data->seq;
+    next.valid = valid;
+    next.count = (uint16_t)(state->count + 1);
+    next.bits = (uint16_t)w.bit;
+    *state = next;
+    put_le16(&block[0], state->count);
+    if (state->count == 1) {
+        put_le32(&block[2], time_ms);
+    }
+    return true;
+}
+
+// ==== 復号 ====
+bool sensor_codec_reader_begin(sensor_codec_reader_t *reader, const uint8_t *block, size_t size)
+{
+    if (reader == NULL) {
+        return false;
+    }
+    memset(reader, 0, sizeof(*reader));
+    if (block == NULL || size <= SENSOR_CODEC_HEADER_BYTES || size > SENSOR_CODEC_BLOCK_MAX) {
+        return false;
+    }
+    reader->block = block;
+    reader->size = size;
+    reader->bit = SENSOR_CODEC_HEADER_BYTES * 8;
+    reader->total = sensor_codec_block_count(block);
+    reader->state.time_ms = sensor_codec_block_first_ms(block);
+    return true;
+}
+
+bool sensor_codec_read(sensor_codec_reader_t *reader, uint32_t *time_ms, temp_sens_data_t *data)
+{
+    if (reader == NULL || reader->block == NULL || reader->state.count >= reader->total) {
+        return false;
+    }
+
+    const uint8_t *buf = reader->block;
+    uint32_t limit = (uint32_t)reader->size * 8;
+    uint32_t bit = reader->bit;
+    sensor_codec_state_t next = reader->state;
+
+    if (reader->state.count == 0) {
+        if (!get_bits(buf, limit, &bit, 32, &next.seq) ||
+            !get_bits(buf, limit, &bit, SENSOR_CH_COUNT, &next.valid)) {
+            return false;
+        }
+    } else {
+        int32_t dod;
+        int32_t seq_delta;
+        uint32_t changed;
+        if (!get_code(buf, limit, &bit, &dod) || !get_code(buf, limit, &bit, &seq_delta) ||
+            !get_bits(buf, limit, &bit, 1, &changed)) {
+            return false;
+        }
+        next.time_delta = (int32_t)((uint32_t)next.time_delta + (uint32_t)dod);
+        next.time_ms += (uint32_t)next.time_delta * SENSOR_CODEC_TIME_UNIT_MS;
+        next.seq += (uint32_t)seq_delta + 1;
+        if (changed && !get_bits(buf, limit, &bit, SENSOR_CH_COUNT, &next.valid)) {
+            return false;
+        }
+    }
+    for (int ch = 0; ch < SENSOR_CH_COUNT; ch++) {
+        if (next.valid & (1u << ch)) {
+            int32_t delta;
+            if (!get_code(buf, limit, &bit, &delta)) {
+                return false;
+            }
+            next.ch[ch] = (int32_t)((uint32_t)next.ch[ch] + (uint32_t)delta);
+        }
+    }
+
+    next.count++;
+    reader->state = next;
+    reader->bit = bit;
+    if (time_ms != NULL) {
+        *time_ms = next.time_ms;
+    }
+    if (data != NULL) {
+        memset(data, 0, sizeof(*data));
+        memcpy(data->ch, next.ch, sizeof(data->ch));
+        data->ch_valid = next.valid;
+        data->seq = next.seq;
+    }
+    return true;
+}
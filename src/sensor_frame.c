@@ -0,0 +1,266 @@
+// src/sensor_frame.c
+// 子機センサーデータのバイナリフレーム エンコーダ／デコーダ
+//
+// テキスト解析を行わず固定オフセットから値を取り出す。
+// FreeRTOS/ESP-IDFに依存しないため、子機側やホスト側ツールでも同じコードを使える。
+
+#include <string.h>
+#include "sensor_frame.h"
+
+// ==== バイト列アクセス（ビッグエンディアン） ====
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(((uint16_t)p[0] << 8) | p[1]);
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+// ==== CRC16-CCITT（4bitテーブル版、ROM 32バイト） ====
+static const uint16_t s_crc16_nibble[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+
+uint16_t sensor_frame_crc16(const uint8_t *data, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc = (uint16_t)((crc << 4) ^ s_crc16_nibble[(crc >> 12) ^ (data[i] >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ s_crc16_nibble[(crc >> 12) ^ (data[i] & 0x0F)]);
+    }
+    return crc;
+}
+
+// ==== 測定値ブロック（version 1・2共通のflagsと+4～+13の値） ====
+// バイナリフレームの配置は固定で、チャネル表のうち初期の4チャネルだけを運ぶ
+static uint8_t frame_flags(const temp_sens_data_t *data)
+{
+    return (sensor_data_group_ok(data, SENSOR_GROUP_AHT) ? SENSOR_FRAME_FLAG_AHT_OK : 0) |
+           (sensor_data_group_ok(data, SENSOR_GROUP_BMP) ? SENSOR_FRAME_FLAG_BMP_OK : 0);
+}
+
+static void put_values(uint8_t *p, const temp_sens_data_t *data)
+{
+    put_u16(&p[0], (uint16_t)data->ch[SENSOR_CH_AHT_T]);
+    put_u16(&p[2], (uint16_t)data->ch[SENSOR_CH_AHT_RH]);
+    put_u16(&p[4], (uint16_t)data->ch[SENSOR_CH_BMP_T]);
+    put_u32(&p[6], (uint32_t)data->ch[SENSOR_CH_BMP_P]);
+}
+
+static void get_values(const uint8_t *p, uint8_t flags, temp_sens_data_t *out)
+{
+    sensor_data_set(out, SENSOR_CH_AHT_T, (int16_t)get_u16(&p[0]));
+    sensor_data_set(out, SENSOR_CH_AHT_RH, get_u16(&p[2]));
+    sensor_data_set(out, SENSOR_CH_BMP_T, (int16_t)get_u16(&p[4]));
+    sensor_data_set(out, SENSOR_CH_BMP_P, get_u32(&p[6]));
+    sensor_data_apply_group(out, SENSOR_GROUP_AHT, (flags & SENSOR_FRAME_FLAG_AHT_OK) != 0);
+    sensor_data_apply_group(out, SENSOR_GROUP_BMP, (flags & SENSOR_FRAME_FLAG_BMP_OK) != 0);
+}
+
+// ==== エンコード ====
+size_t sensor_frame_encode(uint8_t child_no, const temp_sens_data_t *data,
+                           uint8_t *buf, size_t buf_size)
+{
+    if (data == NULL || buf == NULL || buf_size < SENSOR_FRAME_SIZE) {
+        return 0;
+    }
+
+    // RSSIはint8に飽和
+    int rssi = data->rssi;
+    if (rssi < -128) rssi = -128;
+    if (rssi > 127) rssi = 127;
+
+    buf[0] = SENSOR_FRAME_MAGIC;
+    buf[1] = SENSOR_FRAME_VERSION;
+    buf[2] = child_no;
+    buf[3] = frame_flags(data);
+    put_values(&buf[4], data);
+    put_u32(&buf[14], data->seq);
+    buf[18] = (uint8_t)(int8_t)rssi;
+    put_u16(&buf[19], sensor_frame_crc16(buf, SENSOR_FRAME_SIZE - 2));
+
+    return SENSOR_FRAME_SIZE;
+}
+
+// ==== デコード ====
+sensor_frame_result_t sensor_frame_decode(const uint8_t *buf, size_t len,
+                                          uint8_t *child_no, temp_sens_data_t *out)
+{
+    if (buf == NULL || child_no == NULL || out == NULL) {
+        return SENSOR_FRAME_ERR_LENGTH;
+    }
+    if (!sensor_frame_is_binary(buf, len)) {
+        return SENSOR_FRAME_ERR_MAGIC;
+    }
+    if (len < 2) {
+        return SENSOR_FRAME_ERR_LENGTH;
+    }
+    if (buf[1] != SENSOR_FRAME_VERSION) {
+        return SENSOR_FRAME_ERR_VERSION;
+    }
+    if (len != SENSOR_FRAME_SIZE) {
+        return SENSOR_FRAME_ERR_LENGTH;
+    }
+    if (get_u16(&buf[19]) != sensor_frame_crc16(buf, SENSOR_FRAME_SIZE - 2)) {
+        return SENSOR_FRAME_ERR_CRC;
+    }
+
+    *child_no = buf[2];
+    memset(out, 0, sizeof(*out));
+    get_values(&buf[4], buf[3], out);
+    out->seq = get_u32(&buf[14]);
+    out->rssi = (int8_t)buf[18];
+
+    return SENSOR_FRAME_OK;
+}
+
+// ==== バッチフレーム エンコード ====
+size_t sensor_frame_encode_batch(uint8_t child_no, int rssi,
+                                 const temp_sens_data_t *data, const uint16_t *age_ms, size_t count,
+                                 uint8_t *buf, size_t buf_size)
+{
+    if (data == NULL || buf == NULL || count == 0 || count > SENSOR_FRAME_BATCH_MAX) {
+        return 0;
+    }
+    size_t frame_size = SENSOR_FRAME_BATCH_SIZE(count);
+    if (buf_size < frame_size) {
+        return 0;
+    }
+
+    if (rssi < -128) rssi = -128;
+    if (rssi > 127) rssi = 127;
+
+    uint32_t base_seq = data[0].seq;
+    buf[0] = SENSOR_FRAME_MAGIC;
+    buf[1] = SENSOR_FRAME_VERSION_BATCH;
+    buf[2] = child_no;
+    buf[3] = (uint8_t)count;
+    put_u32(&buf[4], base_seq);
+    buf[8] = (uint8_t)(int8_t)rssi;
+
+    uint8_t *rec = &buf[SENSOR_FRAME_BATCH_HDR_SIZE];
+    for (size_t i = 0; i < count; i++) {
+        uint32_t seq_delta = data[i].seq - base_seq;
+        if (seq_delta > 0xFF) {
+            return 0;
+        }
+        rec[0] = frame_flags(&data[i]);
+        rec[1] = (uint8_t)seq_delta;
+        put_u16(&rec[2], age_ms ? age_ms[i] : 0);
+        put_values(&rec[4], &data[i]);
+        rec += SENSOR_FRAME_BATCH_REC_SIZE;
+    }
+    put_u16(&buf[frame_size - 2], sensor_frame_crc16(buf, frame_size - 2));
+
+    return frame_size;
+}
+
+// ==== バッチフレーム デコード ====
+sensor_frame_result_t sensor_frame_decode_batch(const uint8_t *buf, size_t len, uint8_t *child_no,
+                                                temp_sens_data_t *out, uint16_t *age_ms,
+                                                size_t max_count, size_t *count)
+{
+    if (buf == NULL || child_no == NULL || out == NULL || count == NULL) {
+        return SENSOR_FRAME_ERR_LENGTH;
+    }
+    if (!sensor_frame_is_binary(buf, len)) {
+        return SENSOR_FRAME_ERR_MAGIC;
+    }
+    if (len < SENSOR_FRAME_BATCH_HDR_SIZE) {
+        return SENSOR_FRAME_ERR_LENGTH;
+    }
+    if (buf[1] != SENSOR_FRAME_VERSION_BATCH) {
+        return SENSOR_FRAME_ERR_VERSION;
+    }
+    size_t n = buf[3];
+    if (n == 0 || n > SENSOR_FRAME_BATCH_MAX || n > max_count || len != SENSOR_FRAME_BATCH_SIZE(n)) {
+        return SENSOR_FRAME_ERR_LENGTH;
+    }
+    if (get_u16(&buf[len - 2]) != sensor_frame_crc16(buf, len - 2)) {
+        return SENSOR_FRAME_ERR_CRC;
+    }
+
+    uint32_t base_seq = get_u32(&buf[4]);
+    int rssi = (int8_t)buf[8];
+    const uint8_t *rec = &buf[SENSOR_FRAME_BATCH_HDR_SIZE];
+    for (size_t i = 0; i < n; i++) {
+        memset(&out[i], 0, sizeof(out[i]));
+        out[i].seq = base_seq + rec[1];
+        if (age_ms) {
+            age_ms[i] = get_u16(&rec[2]);
+        }
+        get_values(&rec[4], rec[0], &out[i]);
+        out[i].rssi = rssi;
+        rec += SENSOR_FRAME_BATCH_REC_SIZE;
+    }
+
+    *child_no = buf[2];
+    *count = n;
+    return SENSOR_FRAME_OK;
+}
+
+// ==== 制御フレーム エンコード ====
+size_t sensor_frame_encode_control(const sensor_control_t *ctrl, uint8_t *buf, size_t buf_size)
+{
+    if (ctrl == NULL || buf == NULL || buf_size < SENSOR_CONTROL_FRAME_SIZE) {
+        return 0;
+    }
+
+    buf[0] = SENSOR_FRAME_MAGIC;
+    buf[1] = SENSOR_FRAME_VERSION_CONTROL;
+    buf[2] = ctrl->child_no;
+    buf[3] = ctrl->type;
+    put_u16(&buf[4], ctrl->ctrl_seq);
+    put_u32(&buf[6], ctrl->value);
+    put_u16(&buf[10], sensor_frame_crc16(buf, SENSOR_CONTROL_FRAME_SIZE - 2));
+
+    return SENSOR_CONTROL_FRAME_SIZE;
+}
+
+// ==== 制御フレーム デコード ====
+sensor_frame_result_t sensor_frame_decode_control(const uint8_t *buf, size_t len, sensor_control_t *ctrl)
+{
+    if (buf == NULL || ctrl == NULL) {
+        return SENSOR_FRAME_ERR_LENGTH;
+    }
+    if (!sensor_frame_is_binary(buf, len)) {
+        return SENSOR_FRAME_ERR_MAGIC;
+    }
+    if (len < 2) {
+        return SENSOR_FRAME_ERR_LENGTH;
+    }
+    if (buf[1] != SENSOR_FRAME_VERSION_CONTROL) {
+        return SENSOR_FRAME_ERR_VERSION;
+    }
+    if (len != SENSOR_CONTROL_FRAME_SIZE) {
+        return SENSOR_FRAME_ERR_LENGTH;
+    }
+    if (get_u16(&buf[10]) != sensor_frame_crc16(buf, SENSOR_CONTROL_FRAME_SIZE - 2)) {
+        return SENSOR_FRAME_ERR_CRC;
+    }
+
+    ctrl->child_no = buf[2];
+    ctrl->type = buf[3];
+    ctrl->ctrl_seq = get_u16(&buf[4]);
+    ctrl->value = get_u32(&buf[6]);
+
+    return SENSOR_FRAME_OK;
+}
@@ -0,0 +1,160 @@
+// src/sensor_history.c
+// 子機ごとの測定値履歴（sensor_codecで圧縮した固定長ブロックのリング）
+//
+// - 追記: 最も新しいブロックへ符号化して書き足す。収まらなければ次のブロック
+//   （満杯なら最も古いブロックを捨てた跡）を始めて、その先頭に書く
+// - 時間索引: ブロックのヘッダにある先頭の時刻。範囲の読み出しは開始時刻を含むブロックの先頭から復号する
+// FreeRTOS/ESP-IDFに依存しないため、ホスト側ツールでも同じコードを使える。
+
+#include <string.h>
+#include "sensor_history.h"
+
+_Static_assert(SENSOR_HISTORY_BLOCKS <= 255, "block count must fit in uint8_t");
+_Static_assert(SENSOR_HISTORY_BLOCK_BYTES <= SENSOR_CODEC_BLOCK_MAX, "block must be a valid codec block");
+_Static_assert(SENSOR_CODEC_HEADER_BYTES + SENSOR_CODEC_SAMPLE_MAX <= SENSOR_HISTORY_BLOCK_BYTES,
+               "a sample must fit in an empty block");
+
+static uint8_t physical_block(const sensor_history_t *history, size_t index)
+{
+    return (uint8_t)((history->head + index) % SENSOR_HISTORY_BLOCKS);
+}
+
+// ==== 追記 ====
+void sensor_history_reset(sensor_history_t *history)
+{
+    if (history != NULL) {
+        memset(history, 0, sizeof(*history));
+    }
+}
+
+bool sensor_history_append(sensor_history_t *history, uint32_t time_ms, const temp_sens_data_t *data)
+{
+    if (history == NULL || data == NULL) {
+        return false;
+    }
+
+    bool sealed = false;
+    if (history->blocks > 0) {
+        uint8_t cur = physical_block(history, history->blocks - 1);
+        if (sensor_codec_block_append(history->data[cur], SENSOR_HISTORY_BLOCK_BYTES, &history->last,
+                                      time_ms, data)) {
+            return false;
+        }
+        sealed = true;
+        // 収まらない: 次のブロックの先頭に書く
+        if ((int32_t)(time_ms - history->last.time_ms) < 0) {
+            time_ms = history->last.time_ms;    // 時間索引を単調に保つ
+        }
+    }
+
+    if (history->blocks == SENSOR_HISTORY_BLOCKS) {
+        // 最も古いブロックを捨てる
+        history->head = physical_block(history, 1);
+        history->blocks--;
+    }
+    uint8_t next = physical_block(history, history->blocks);
+    sensor_codec_block_begin(history->data[next], SENSOR_HISTORY_BLOCK_BYTES, &history->last);
+    sensor_codec_block_append(history->data[next], SENSOR_HISTORY_BLOCK_BYTES, &history->last, time_ms, data);
+    history->blocks++;
+    return sealed;
+}
+
+// ==== 時間索引 ====
+bool sensor_history_span(const sensor_history_t *history, uint32_t *oldest_ms, uint32_t *newest_ms)
+{
+    if (history == NULL || history->blocks == 0) {
+        return false;
+    }
+    if (oldest_ms != NULL) {
+        *oldest_ms = sensor_codec_block_first_ms(history->data[history->head]);
+    }
+    if (newest_ms != NULL) {
+        *newest_ms = history->last.time_ms;
+    }
+    return true;
+}
+
+size_t sensor_history_block_count(const sensor_history_t *history)
+{
+    return (history != NULL) ? history->blocks : 0;
+}
+
+const uint8_t *sensor_history_block(const sensor_history_t *history, size_t index)
+{
+    if (history == NULL || index >= history->blocks) {
+        return NULL;
+    }
+    return history->data[physical_block(history, index)];
+}
+
+size_t sensor_history_find_block(const sensor_history_t *history, uint32_t from_ms)
+{
+    if (history == NULL || history->blocks == 0) {
+        return 0;
+    }
+
+    // ブロック先頭の時刻は古い順に並ぶので、最古からの経過時間で二分探索し、
+    // 先頭がfrom_msより前の最後のブロックを選ぶ（切り上げた時刻で始めたブロックは直前のブロックの末尾と
+    // 同じ時刻になるため、先頭がfrom_msちょうどのブロックからでは同じ時刻のレコードを読み落とす）
+    uint32_t oldest = sensor_codec_block_first_ms(history->data[history->head]);
+    uint32_t key = from_ms - oldest;
+    if ((int32_t)key < 0) {
+        key = 0;
+    }
+    size_t lo = 0;
+    size_t hi = history->blocks;
+    while (hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        uint32_t start = sensor_codec_block_first_ms(history->data[physical_block(history, mid)]);
+        if (start - oldest < key) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// ==== 読み出し ====
+void sensor_history_seek(sensor_history_iter_t *it, const sensor_history_t *history, uint32_t from_ms)
+{
+    if (it == NULL) {
+        return;
+    }
+    memset(it, 0, sizeof(*it));
+    it->history = history;
+    it->from_ms = from_ms;
+    if (history == NULL || history->blocks == 0) {
+        return;
+    }
+    it->block = sensor_history_find_block(history, from_ms);
+    sensor_codec_reader_begin(&it->reader, sensor_history_block(history, it->block), SENSOR_HISTORY_BLOCK_BYTES);
+}
+
+bool sensor_history_next(sensor_history_iter_t *it, uint32_t *time_ms, temp_sens_data_t *data)
+{
+    if (it == NULL || it->history == NULL) {
+        return false;
+    }
+
+    while (it->block < it->history->blocks) {
+        uint32_t t;
+        if (!sensor_codec_read(&it->reader, &t, data)) {
+            // 次のブロックへ
+            it->block++;
+            if (it->block < it->history->blocks) {
+                sensor_codec_reader_begin(&it->reader, sensor_history_block(it->history, it->block),
+                                          SENSOR_HISTORY_BLOCK_BYTES);
+            }
+            continue;
+        }
+        if ((int32_t)(t - it->from_ms) < 0) {
+            continue;
+        }
+        if (time_ms != NULL) {
+            *time_ms = t;
+        }
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,367 @@
+// src/sensor_json.c
+// 子機センサーJSONのゼロアロケーション・ストリーミングデコーダ
+//
+// cJSON_Parseはデータグラム毎にヒープ上へツリーを構築するため、
+// 受信バッファを先頭から1回だけ走査し、temp_sens_data_tへ直接値を格納する。
+// チャネルのキーはsensor_channel.hの表から引く。
+// FreeRTOS/ESP-IDFに依存しないため、ホスト環境でもそのままコンパイルできる。
+
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "sensor_json.h"
+
+// ==== 設定 ====
+#define JSON_MAX_DEPTH      8           // 読み飛ばす入れ子の最大深さ
+#define JSON_MANTISSA_MAX   100000000000000000LL  // 仮数部の最大桁（1e17）
+
+// ==== フィールド定義 ====
+// 固定のフィールドの後にチャネル（sensor_channel.hの表の順）、測定成功フラグを並べる
+enum {
+    FIELD_CHILD_NO = 0,
+    FIELD_SEQ,
+    FIELD_RSSI,
+    FIELD_CH_BASE,
+    FIELD_GROUP_BASE = FIELD_CH_BASE + SENSOR_CH_COUNT,
+    FIELD_MAX = FIELD_GROUP_BASE + SENSOR_GROUP_COUNT
+};
+
+_Static_assert(FIELD_MAX <= 64, "JSON fields must fit in uint64_t");
+
+typedef struct {
+    const char *key;
+    uint8_t key_len;
+} json_key_t;
+
+#define JSON_KEY(s) { s, sizeof(s) - 1 }
+
+static const json_key_t s_keys[FIELD_CH_BASE] = {
+    [FIELD_CHILD_NO] = JSON_KEY("child_no"),
+    [FIELD_SEQ]      = JSON_KEY("seq"),
+    [FIELD_RSSI]     = JSON_KEY("rssi"),
+};
+
+#define FIELD_BIT(f)    ((uint64_t)1 << (f))
+
+// child_noとseqは必須、チャネルは1つ以上必須（rssi・測定成功フラグは省略可）
+#define REQUIRED_MASK   (FIELD_BIT(FIELD_CHILD_NO) | FIELD_BIT(FIELD_SEQ))
+#define CHANNEL_MASK    (((FIELD_BIT(SENSOR_CH_COUNT) - 1)) << FIELD_CH_BASE)
+
+// ==== 値の種類 ====
+typedef enum {
+    VALUE_NUMBER,
+    VALUE_TRUE,
+    VALUE_OTHER,    // false/null/文字列/オブジェクト/配列
+} value_kind_t;
+
+typedef struct {
+    const char *p;
+    const char *end;
+} cursor_t;
+
+// ==== 字句解析ヘルパ ====
+static void skip_ws(cursor_t *c)
+{
+    while (c->p < c->end &&
+           (*c->p == ' ' || *c->p == '\t' || *c->p == '\r' || *c->p == '\n')) {
+        c->p++;
+    }
+}
+
+static bool is_digit(char ch)
+{
+    return ch >= '0' && ch <= '9';
+}
+
+// 文字列を読み飛ばし、中身の先頭と長さを返す（エスケープは展開しない）
+static bool scan_string(cursor_t *c, const char **start, size_t *len)
+{
+    if (c->p >= c->end || *c->p != '"') {
+        return false;
+    }
+    c->p++;
+    const char *s = c->p;
+    while (c->p < c->end) {
+        char ch = *c->p;
+        if (ch == '"') {
+            if (start) *start = s;
+            if (len) *len = (size_t)(c->p - s);
+            c->p++;
+            return true;
+        }
+        if (ch == '\\') {
+            c->p++;     // エスケープ文字を1つ読み飛ばす
+            if (c->p >= c->end) {
+                return false;
+            }
+        } else if ((unsigned char)ch < 0x20) {
+            return false;
+        }
+        c->p++;
+    }
+    return false;
+}
+
+static bool scan_literal(cursor_t *c, const char *lit, size_t lit_len)
+{
+    if ((size_t)(c->end - c->p) < lit_len || memcmp(c->p, lit, lit_len) != 0) {
+        return false;
+    }
+    c->p += lit_len;
+    return true;
+}
+
+// 数値を整数に変換（小数部は0方向へ切り捨て、cJSON経由のキャストと同じ結果）
+static bool scan_number(cursor_t *c, int64_t *out)
+{
+    bool neg = false;
+    int64_t mant = 0;
+    int exp10 = 0;
+
+    if (c->p < c->end && *c->p == '-') {
+        neg = true;
+        c->p++;
+    }
+    if (c->p >= c->end || !is_digit(*c->p)) {
+        return false;
+    }
+    while (c->p < c->end && is_digit(*c->p)) {
+        if (mant < JSON_MANTISSA_MAX) {
+            mant = mant * 10 + (*c->p - '0');
+        } else {
+            exp10++;
+        }
+        c->p++;
+    }
+    if (c->p < c->end && *c->p == '.') {
+        c->p++;
+        if (c->p >= c->end || !is_digit(*c->p)) {
+            return false;
+        }
+        while (c->p < c->end && is_digit(*c->p)) {
+            if (mant < JSON_MANTISSA_MAX) {
+                mant = mant * 10 + (*c->p - '0');
+                exp10--;
+            }
+            c->p++;
+        }
+    }
+    if (c->p < c->end && (*c->p == 'e' || *c->p == 'E')) {
+        int exp_sign = 1;
+        int e = 0;
+        c->p++;
+        if (c->p < c->end && (*c->p == '+' || *c->p == '-')) {
+            exp_sign = (*c->p == '-') ? -1 : 1;
+            c->p++;
+        }
+        if (c->p >= c->end || !is_digit(*c->p)) {
+            return false;
+        }
+        while (c->p < c->end && is_digit(*c->p)) {
+            if (e < 1000) {
+                e = e * 10 + (*c->p - '0');
+            }
+            c->p++;
+        }
+        exp10 += exp_sign * e;
+    }
+
+    // 10のべき乗を適用（オーバーフロー時は飽和）
+    while (exp10 > 0 && mant != 0) {
+        if (mant > INT64_MAX / 10) {
+            mant = INT64_MAX;
+            break;
+        }
+        mant *= 10;
+        exp10--;
+    }
+    while (exp10 < 0 && mant != 0) {
+        mant /= 10;
+        exp10++;
+    }
+
+    *out = neg ? -mant : mant;
+    return true;
+}
+
+// オブジェクト/配列を入れ子ごと読み飛ばす
+static bool skip_container(cursor_t *c)
+{
+    char stack[JSON_MAX_DEPTH];
+    int depth = 0;
+
+    while (c->p < c->end) {
+        char ch = *c->p;
+        if (ch == '"') {
+            if (!scan_string(c, NULL, NULL)) {
+                return false;
+            }
+            continue;
+        }
+        if (ch == '{' || ch == '[') {
+            if (depth >= JSON_MAX_DEPTH) {
+                return false;
+            }
+            stack[depth++] = (ch == '{') ? '}' : ']';
+        } else if (ch == '}' || ch == ']') {
+            if (depth == 0 || stack[depth - 1] != ch) {
+                return false;
+            }
+            depth--;
+            if (depth == 0) {
+                c->p++;
+                return true;
+            }
+        }
+        c->p++;
+    }
+    return false;
+}
+
+static bool scan_value(cursor_t *c, value_kind_t *kind, int64_t *num)
+{
+    skip_ws(c);
+    if (c->p >= c->end) {
+        return false;
+    }
+
+    switch (*c->p) {
+        case '"':
+            *kind = VALUE_OTHER;
+            return scan_string(c, NULL, NULL);
+        case '{':
+        case '[':
+            *kind = VALUE_OTHER;
+            return skip_container(c);
+        case 't':
+            *kind = VALUE_TRUE;
+            return scan_literal(c, "true", 4);
+        case 'f':
+            *kind = VALUE_OTHER;
+            return scan_literal(c, "false", 5);
+        case 'n':
+            *kind = VALUE_OTHER;
+            return scan_literal(c, "null", 4);
+        default:
+            *kind = VALUE_NUMBER;
+            return scan_number(c, num);
+    }
+}
+
+static int lookup_field(const char *key, size_t len)
+{
+    for (int i = 0; i < FIELD_CH_BASE; i++) {
+        if (s_keys[i].key_len == len && memcmp(s_keys[i].key, key, len) == 0) {
+            return i;
+        }
+    }
+    int ch = sensor_channel_find_key(key, len);
+    if (ch >= 0) {
+        return FIELD_CH_BASE + ch;
+    }
+    int group = sensor_group_find_key(key, len);
+    if (group >= 0) {
+        return FIELD_GROUP_BASE + group;
+    }
+    return -1;
+}
+
+// ==== 公開関数 ====
+sensor_json_result_t sensor_json_decode(const char *buf, size_t len,
+                                        uint8_t *child_no, temp_sens_data_t *out)
+{
+    if (buf == NULL || child_no == NULL || out == NULL) {
+        return SENSOR_JSON_ERR_SYNTAX;
+    }
+
+    cursor_t c = { buf, buf + len };
+    int64_t values[FIELD_MAX] = {0};
+    value_kind_t kinds[FIELD_MAX];
+    uint64_t found = 0;
+
+    skip_ws(&c);
+    if (c.p >= c.end || *c.p != '{') {
+        return SENSOR_JSON_ERR_SYNTAX;
+    }
+    c.p++;
+
+    skip_ws(&c);
+    if (c.p < c.end && *c.p == '}') {
+        return SENSOR_JSON_ERR_MISSING;    // 空オブジェクト
+    }
+
+    while (1) {
+        const char *key;
+        size_t key_len;
+        value_kind_t kind;
+        int64_t num = 0;
+
+        skip_ws(&c);
+        if (!scan_string(&c, &key, &key_len)) {
+            return SENSOR_JSON_ERR_SYNTAX;
+        }
+        skip_ws(&c);
+        if (c.p >= c.end || *c.p != ':') {
+            return SENSOR_JSON_ERR_SYNTAX;
+        }
+        c.p++;
+        if (!scan_value(&c, &kind, &num)) {
+            return SENSOR_JSON_ERR_SYNTAX;
+        }
+
+        // 同じキーが複数ある場合は最初の値を採用（cJSON_GetObjectItemと同じ）
+        int field = lookup_field(key, key_len);
+        if (field >= 0 && !(found & FIELD_BIT(field))) {
+            found |= FIELD_BIT(field);
+            kinds[field] = kind;
+            values[field] = num;
+        }
+
+        skip_ws(&c);
+        if (c.p >= c.end) {
+            return SENSOR_JSON_ERR_SYNTAX;
+        }
+        if (*c.p == ',') {
+            c.p++;
+            continue;
+        }
+        if (*c.p == '}') {
+            break;
+        }
+        return SENSOR_JSON_ERR_SYNTAX;
+    }
+
+    if ((found & REQUIRED_MASK) != REQUIRED_MASK || (found & CHANNEL_MASK) == 0) {
+        return SENSOR_JSON_ERR_MISSING;
+    }
+
+    // 数値以外が入っていた固定フィールドは0扱い（cJSON_GetNumberValueと同じ）
+    for (int i = 0; i < FIELD_CH_BASE; i++) {
+        if ((found & FIELD_BIT(i)) && kinds[i] != VALUE_NUMBER) {
+            values[i] = 0;
+        }
+    }
+
+    *child_no = (uint8_t)values[FIELD_CHILD_NO];
+    memset(out, 0, sizeof(*out));
+    out->seq = (uint32_t)values[FIELD_SEQ];
+    // RSSIはオプショナル（存在しない場合は0）
+    out->rssi = (found & FIELD_BIT(FIELD_RSSI)) ? (int)values[FIELD_RSSI] : 0;
+
+    // 数値のチャネルだけ有効（null等は測定失敗として扱う）
+    for (int ch = 0; ch < SENSOR_CH_COUNT; ch++) {
+        int field = FIELD_CH_BASE + ch;
+        if ((found & FIELD_BIT(field)) && kinds[field] == VALUE_NUMBER) {
+            sensor_data_set(out, (sensor_ch_t)ch, values[field]);
+        }
+    }
+    // 測定成功フラグがtrue以外なら組のチャネルを無効にする（省略時は値の有無のみで判断）
+    for (int g = 0; g < SENSOR_GROUP_COUNT; g++) {
+        int field = FIELD_GROUP_BASE + g;
+        if (found & FIELD_BIT(field)) {
+            sensor_data_apply_group(out, (sensor_group_t)g, kinds[field] == VALUE_TRUE);
+        }
+    }
+
+    return SENSOR_JSON_OK;
+}
@@ -0,0 +1,268 @@
+// src/sensor_legacy.c
+// 旧形式 "N=<子機No>,<key>=<value>,..." のゼロアロケーション・トークナイザ
+//
+// 受信バッファを先頭から1回だけ走査し、キーを表引きしてtemp_sens_data_tへ直接格納する。
+// チャネルのキーはsensor_channel.hの表（JSONキーと短い表示名）から引く。
+// 小数は浮動小数点を使わず固定小数点（0.1単位）へ変換する。
+// FreeRTOS/ESP-IDFに依存しないため、ホスト環境でもそのままコンパイルできる。
+
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "sensor_legacy.h"
+#include "child_registry.h"  // CHILD_NO_MIN/CHILD_NO_MAX
+
+// ==== フィールド定義 ====
+// 固定のフィールドの後にチャネル（sensor_channel.hの表の順）、測定成功フラグを並べる
+enum {
+    FIELD_SEQ = 0,
+    FIELD_RSSI,
+    FIELD_CH_BASE,
+    FIELD_GROUP_BASE = FIELD_CH_BASE + SENSOR_CH_COUNT,
+    FIELD_MAX = FIELD_GROUP_BASE + SENSOR_GROUP_COUNT
+};
+
+_Static_assert(FIELD_MAX <= 64, "legacy fields must fit in uint64_t");
+
+typedef struct {
+    const char *key;
+    uint8_t key_len;
+    uint8_t field;
+    uint8_t decimals;   // 値を10^decimals倍して格納（実単位→0.1単位は1）
+} legacy_key_t;
+
+#define LEGACY_KEY(s, f, d) { s, sizeof(s) - 1, f, d }
+
+// チャネル表にない旧形式のキー
+static const legacy_key_t s_keys[] = {
+    LEGACY_KEY("seq",      FIELD_SEQ,                        0),
+    LEGACY_KEY("rssi",     FIELD_RSSI,                       0),
+    LEGACY_KEY("S",        FIELD_SEQ,                        0),
+    LEGACY_KEY("R",        FIELD_RSSI,                       0),
+    LEGACY_KEY("H",        FIELD_CH_BASE + SENSOR_CH_AHT_RH, 1),   // 湿度の別名
+};
+
+#define LEGACY_VALUE_MAX    4294967295LL    // uint32_tの最大値（これ以上は飽和）
+
+#define FIELD_BIT(f)    ((uint64_t)1 << (f))
+
+// 測定値のいずれか1つは必須
+#define MEASURE_MASK    (((FIELD_BIT(SENSOR_CH_COUNT) - 1)) << FIELD_CH_BASE)
+
+typedef struct {
+    const char *p;
+    const char *end;
+} cursor_t;
+
+// ==== 字句解析ヘルパ ====
+static bool is_digit(char ch)
+{
+    return ch >= '0' && ch <= '9';
+}
+
+// キー → フィールド（チャネルはJSONキーなら整数、短い表示名なら実単位の小数）
+static bool lookup_key(const char *key, size_t key_len, legacy_key_t *out)
+{
+    for (size_t i = 0; i < sizeof(s_keys) / sizeof(s_keys[0]); i++) {
+        if (s_keys[i].key_len == key_len && memcmp(s_keys[i].key, key, key_len) == 0) {
+            *out = s_keys[i];
+            return true;
+        }
+    }
+    int ch = sensor_channel_find_key(key, key_len);
+    if (ch >= 0) {
+        out->field = (uint8_t)(FIELD_CH_BASE + ch);
+        out->decimals = 0;
+        return true;
+    }
+    ch = sensor_channel_find_label(key, key_len);
+    if (ch >= 0) {
+        out->field = (uint8_t)(FIELD_CH_BASE + ch);
+        out->decimals = sensor_channel_get((sensor_ch_t)ch)->decimals;
+        return true;
+    }
+    int group = sensor_group_find_key(key, key_len);
+    if (group >= 0) {
+        out->field = (uint8_t)(FIELD_GROUP_BASE + group);
+        out->decimals = 0;
+        return true;
+    }
+    return false;
+}
+
+// 10進数（符号・小数部可）を10^decimals倍した整数に変換（次の桁で四捨五入）
+// 値の終端（','またはバッファ末尾）以外の文字があればfalse
+static bool scan_fixed(cursor_t *c, uint8_t decimals, int64_t *out)
+{
+    bool neg = false;
+    int64_t value = 0;
+    int frac_digits = -1;   // 小数点以降の桁数（-1=小数点なし）
+    bool round_up = false;
+    bool any = false;
+
+    if (c->p < c->end && (*c->p == '-' || *c->p == '+')) {
+        neg = (*c->p == '-');
+        c->p++;
+    }
+    for (; c->p < c->end && *c->p != ','; c->p++) {
+        char ch = *c->p;
+        if (ch == '.' && frac_digits < 0) {
+            frac_digits = 0;
+            continue;
+        }
+        if (!is_digit(ch)) {
+            break;
+        }
+        any = true;
+        if (frac_digits >= 0) {
+            if (frac_digits >= decimals) {
+                // 格納桁より下は切り捨て（直後の1桁で四捨五入）
+                if (frac_digits == decimals && ch >= '5') {
+                    round_up = true;
+                }
+                frac_digits++;
+                continue;
+            }
+            frac_digits++;
+        }
+        if (value <= LEGACY_VALUE_MAX) {
+            value = value * 10 + (ch - '0');
+        }
+    }
+    if (!any) {
+        return false;
+    }
+
+    // 不足した小数桁を補う
+    int have = (frac_digits < 0) ? 0 : (frac_digits > decimals ? decimals : frac_digits);
+    for (int i = have; i < decimals; i++) {
+        value *= 10;
+    }
+    if (round_up) {
+        value++;
+    }
+    if (value > LEGACY_VALUE_MAX) {
+        value = LEGACY_VALUE_MAX;
+    }
+    *out = neg ? -value : value;
+    return true;
+}
+
+// 真偽値: 1/0/true/false
+static bool scan_bool(cursor_t *c, int64_t *out)
+{
+    size_t n = 0;
+    while (c->p + n < c->end && c->p[n] != ',') {
+        n++;
+    }
+    bool ok = true;
+    if ((n == 1 && c->p[0] == '1') || (n == 4 && memcmp(c->p, "true", 4) == 0)) {
+        *out = 1;
+    } else if ((n == 1 && c->p[0] == '0') || (n == 5 && memcmp(c->p, "false", 5) == 0)) {
+        *out = 0;
+    } else {
+        ok = false;
+    }
+    c->p += n;
+    return ok;
+}
+
+// 行末の空白・改行
+static bool is_trailing_ws(char ch)
+{
+    return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n' || ch == '\0';
+}
+
+// ==== 公開関数 ====
+sensor_legacy_result_t sensor_legacy_decode(const char *buf, size_t len, uint8_t *child_no,
+                                            temp_sens_data_t *out, bool *has_seq)
+{
+    if (buf == NULL || child_no == NULL || out == NULL) {
+        return SENSOR_LEGACY_ERR_FORMAT;
+    }
+
+    // 末尾の改行等を除く
+    while (len > 0 && is_trailing_ws(buf[len - 1])) {
+        len--;
+    }
+
+    cursor_t c = { buf, buf + len };
+
+    // "N=<子機No>,"
+    if (len < 4 || c.p[0] != 'N' || c.p[1] != '=') {
+        return SENSOR_LEGACY_ERR_FORMAT;
+    }
+    c.p += 2;
+    int no = 0;
+    const char *digits = c.p;
+    while (c.p < c.end && is_digit(*c.p)) {
+        no = no * 10 + (*c.p - '0');
+        c.p++;
+        if (no > CHILD_NO_MAX) {
+            return SENSOR_LEGACY_ERR_FORMAT;  // 範囲外
+        }
+    }
+    if (c.p == digits || c.p >= c.end || *c.p != ',' || no < CHILD_NO_MIN) {
+        return SENSOR_LEGACY_ERR_FORMAT;
+    }
+    c.p++;
+    *child_no = (uint8_t)no;
+
+    // "<key>=<value>" をカンマ区切りで走査
+    int64_t values[FIELD_MAX] = {0};
+    uint64_t found = 0;
+    while (c.p < c.end) {
+        const char *key = c.p;
+        while (c.p < c.end && *c.p != '=' && *c.p != ',') {
+            c.p++;
+        }
+        size_t key_len = (size_t)(c.p - key);
+        legacy_key_t k;
+        bool known = false;
+
+        if (c.p < c.end && *c.p == '=') {
+            c.p++;
+            known = lookup_key(key, key_len, &k);
+        }
+
+        if (known && !(found & FIELD_BIT(k.field))) {
+            int64_t v;
+            bool ok = (k.field >= FIELD_GROUP_BASE) ? scan_bool(&c, &v) : scan_fixed(&c, k.decimals, &v);
+            if (ok && (c.p >= c.end || *c.p == ',')) {
+                found |= FIELD_BIT(k.field);
+                values[k.field] = v;
+            }
+        }
+
+        // 次のトークンへ（未知のキー・不正な値は読み飛ばす）
+        while (c.p < c.end && *c.p != ',') {
+            c.p++;
+        }
+        if (c.p < c.end) {
+            c.p++;
+        }
+    }
+
+    if (has_seq != NULL) {
+        *has_seq = (found & FIELD_BIT(FIELD_SEQ)) != 0;
+    }
+    if ((found & MEASURE_MASK) == 0) {
+        return SENSOR_LEGACY_ERR_MISSING;
+    }
+
+    memset(out, 0, sizeof(*out));
+    for (int ch = 0; ch < SENSOR_CH_COUNT; ch++) {
+        if (found & FIELD_BIT(FIELD_CH_BASE + ch)) {
+            sensor_data_set(out, (sensor_ch_t)ch, values[FIELD_CH_BASE + ch]);
+        }
+    }
+    for (int g = 0; g < SENSOR_GROUP_COUNT; g++) {
+        if (found & FIELD_BIT(FIELD_GROUP_BASE + g)) {
+            sensor_data_apply_group(out, (sensor_group_t)g, values[FIELD_GROUP_BASE + g] != 0);
+        }
+    }
+    out->seq = (uint32_t)values[FIELD_SEQ];
+    out->rssi = (int)values[FIELD_RSSI];
+
+    return SENSOR_LEGACY_OK;
+}
@@ -0,0 +1,122 @@
+// src/sensor_rollup.c
+// 測定値の集計（1分・1時間・1日のバケットへ受信のたびに足し込む）
+//
+// - 足し込み: 周期ごとに、測定値の時刻が集計中バケットの周期を過ぎていれば閉じて新しいバケットを始め、
+//   有効なチャネルの件数・最小・最大・合計・2乗の合計を更新する（周期数 × チャネル数の定数時間）
+// - 閉じる: 集計中のバケットを「直前に閉じたバケット」へ移す。空のバケットは移さない
+// - 古い測定値: 集計中バケットより前の時刻（バッチフレームの測定時刻・順序逆転）はバケットを戻さず、
+//   直前に閉じたバケットの周期内ならそこへ、それより前なら集計中のバケットへ足し込む
+// FreeRTOS/ESP-IDFに依存しないため、ホスト側ツールでも同じコードを使える。
+
+#include <string.h>
+#include "sensor_rollup.h"
+
+static const uint32_t s_period_ms[SENSOR_ROLLUP_LEVELS] = {
+    [SENSOR_ROLLUP_MINUTE] = SENSOR_ROLLUP_MINUTE_MS,
+    [SENSOR_ROLLUP_HOUR]   = SENSOR_ROLLUP_HOUR_MS,
+    [SENSOR_ROLLUP_DAY]    = SENSOR_ROLLUP_DAY_MS,
+};
+
+static const char *const s_level_names[SENSOR_ROLLUP_LEVELS] = {
+    [SENSOR_ROLLUP_MINUTE] = "minute",
+    [SENSOR_ROLLUP_HOUR]   = "hour",
+    [SENSOR_ROLLUP_DAY]    = "day",
+};
+
+uint32_t sensor_rollup_period_ms(sensor_rollup_level_t level)
+{
+    return (level < SENSOR_ROLLUP_LEVELS) ? s_period_ms[level] : 0;
+}
+
+const char *sensor_rollup_level_name(sensor_rollup_level_t level)
+{
+    return (level < SENSOR_ROLLUP_LEVELS) ? s_level_names[level] : NULL;
+}
+
+void sensor_rollup_reset(sensor_rollup_t *rollup)
+{
+    if (rollup != NULL) {
+        memset(rollup, 0, sizeof(*rollup));
+    }
+}
+
+// time_msが集計中バケットの周期を過ぎていれば閉じて、time_msを含む周期のバケットを始める
+// （時刻の周回で戻った場合も新しいバケットにする。集計中より前の時刻はbucket_for()で振り分け済み）
+static void bucket_roll(sensor_rollup_t *rollup, int level, uint32_t time_ms)
+{
+    sensor_rollup_bucket_t *open = &rollup->open[level];
+    uint32_t period = s_period_ms[level];
+    if (open->samples > 0 && (time_ms - open->start_ms) < period) {
+        return;
+    }
+    if (open->samples > 0) {
+        rollup->closed[level] = *open;
+    }
+    memset(open, 0, sizeof(*open));
+    open->start_ms = time_ms - (time_ms % period);
+}
+
+// time_msの測定値を足し込むバケット
+static sensor_rollup_bucket_t *bucket_for(sensor_rollup_t *rollup, int level, uint32_t time_ms)
+{
+    sensor_rollup_bucket_t *open = &rollup->open[level];
+    if (open->samples > 0 && (int32_t)(time_ms - open->start_ms) < 0) {
+        // 集計中より前: 直前に閉じたバケットの周期内ならそこへ、それより前は集計中へ寄せる
+        sensor_rollup_bucket_t *closed = &rollup->closed[level];
+        if (closed->samples > 0 && (time_ms - closed->start_ms) < s_period_ms[level]) {
+            return closed;
+        }
+        return open;
+    }
+    bucket_roll(rollup, level, time_ms);
+    return open;
+}
+
+void sensor_rollup_add(sensor_rollup_t *rollup, uint32_t time_ms, const temp_sens_data_t *data)
+{
+    if (rollup == NULL || data == NULL) {
+        return;
+    }
+
+    for (int level = 0; level < SENSOR_ROLLUP_LEVELS; level++) {
+        sensor_rollup_bucket_t *bucket = bucket_for(rollup, level, time_ms);
+        bucket->samples++;
+        for (int ch = 0; ch < SENSOR_CH_COUNT; ch++) {
+            if (!sensor_data_valid(data, (sensor_ch_t)ch)) {
+                continue;
+            }
+            int32_t v = data->ch[ch];
+            sensor_rollup_stat_t *stat = &bucket->ch[ch];
+            if (stat->count == 0 || v < stat->min) {
+                stat->min = v;
+            }
+            if (stat->count == 0 || v > stat->max) {
+                stat->max = v;
+            }
+            stat->count++;
+            stat->sum += v;
+            stat->sum_sq += (uint64_t)((int64_t)v * v);
+        }
+    }
+}
+
+void sensor_rollup_roll(sensor_rollup_t *rollup, uint32_t now_ms)
+{
+    if (rollup == NULL) {
+        return;
+    }
+    for (int level = 0; level < SENSOR_ROLLUP_LEVELS; level++) {
+        if (rollup->open[level].samples > 0) {
+            bucket_roll(rollup, level, now_ms);
+        }
+    }
+}
+
+int32_t sensor_rollup_mean(const sensor_rollup_stat_t *stat)
+{
+    if (stat == NULL || stat->count == 0) {
+        return 0;
+    }
+    int64_t half = (stat->sum >= 0) ? (int64_t)(stat->count / 2) : -(int64_t)(stat->count / 2);
+    return (int32_t)((stat->sum + half) / (int64_t)stat->count);
+}
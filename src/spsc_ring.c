@@ -0,0 +1,91 @@
+// src/spsc_ring.c
+// ロックフリーSPSCリング
+//
+// head/tailは巡回しない32bitカウンタとして扱い、格納位置は mask で求める。
+// 使用数 = head - tail（オーバーフローしても差分は正しい）。
+// プロデューサは要素を書き終えてからheadをrelease storeし、
+// コンシューマはheadをacquire loadしてから要素を読むことで順序を保証する。
+
+#include "spsc_ring.h"
+
+bool spsc_ring_init(spsc_ring_t *ring, void *storage, size_t elem_size, uint32_t capacity)
+{
+    if (ring == NULL || storage == NULL || elem_size == 0 ||
+        capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        return false;
+    }
+
+    ring->storage = (uint8_t *)storage;
+    ring->elem_size = elem_size;
+    ring->mask = capacity - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->high_water, 0);
+    atomic_init(&ring->overflow, 0);
+    return true;
+}
+
+// ==== プロデューサ側 ====
+void *spsc_ring_acquire(spsc_ring_t *ring)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - tail > ring->mask) {
+        return NULL;  // 満杯
+    }
+    return ring->storage + (size_t)(head & ring->mask) * ring->elem_size;
+}
+
+void spsc_ring_publish(spsc_ring_t *ring)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed) + 1;
+    atomic_store_explicit(&ring->head, head, memory_order_release);
+
+    // 最大使用数の更新（tailが進んでいても過大にはならない）
+    uint32_t used = head - atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if (used > atomic_load_explicit(&ring->high_water, memory_order_relaxed)) {
+        atomic_store_explicit(&ring->high_water, used, memory_order_relaxed);
+    }
+}
+
+void spsc_ring_note_overflow(spsc_ring_t *ring)
+{
+    uint32_t overflow = atomic_load_explicit(&ring->overflow, memory_order_relaxed);
+    atomic_store_explicit(&ring->overflow, overflow + 1, memory_order_relaxed);
+}
+
+// ==== コンシューマ側 ====
+void *spsc_ring_front(spsc_ring_t *ring)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (head == tail) {
+        return NULL;  // 空
+    }
+    return ring->storage + (size_t)(tail & ring->mask) * ring->elem_size;
+}
+
+void spsc_ring_pop(spsc_ring_t *ring)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
+
+// ==== 共通 ====
+uint32_t spsc_ring_count(const spsc_ring_t *ring)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    return head - tail;
+}
+
+void spsc_ring_get_stats(const spsc_ring_t *ring, spsc_ring_stats_t *stats)
+{
+    if (ring == NULL || stats == NULL) {
+        return;
+    }
+    stats->capacity = ring->mask + 1;
+    stats->count = spsc_ring_count(ring);
+    stats->high_water = atomic_load_explicit(&ring->high_water, memory_order_relaxed);
+    stats->overflow = atomic_load_explicit(&ring->overflow, memory_order_relaxed);
+}
@@ -9,10 +9,13 @@
 #include "driver/i2c.h"
 #include "esp_log.h"
 #include "esp_attr.h"  // IRAM_ATTR用
+#include "esp_timer.h"  // 描画時刻（遅延計測）用
 #include "log_task.h"
 #include "flash_data.h"
 #include "user_common.h"
 #include "version.h"
+#include "child_registry.h"
+#include "latency_trace.h"
 #include <string.h>
 #include <stdint.h>
 
@@ -87,6 +90,30 @@ static bool s_executing = false;  // 実行中フラグ
 static TickType_t s_result_timer = 0;  // 実行結果表示タイマー（0=無効）
 static char s_result_message[64] = "";  // 実行結果メッセージ
 
+// ==== センサ表示ページ送り ====
+#define SENSOR_ROWS_PER_PAGE     4      // 1ページに表示する子機数
+#define SENSOR_PAGE_INTERVAL_MS  3000   // ページ切替間隔（3秒）
+#define SENSOR_LINE_CHARS        21     // 1行の文字数（128px / 6px）
+static child_registry_ref_t s_display_refs[CHILD_REGISTRY_MAX_NODES];  // 表示対象の子機一覧
+static size_t s_sensor_page = 0;
+static TickType_t s_sensor_page_tick = 0;
+
+// ==== 描画の遅延計測 ====
+// 初めて描画する測定値を集め、画面へ送り終えた時刻で公開・受信からの遅延を記録する
+typedef struct {
+    uint8_t slot;
+    int64_t commit_us;
+    int64_t recv_us;
+} drawn_reading_t;
+static drawn_reading_t s_drawn[SENSOR_ROWS_PER_PAGE];
+static size_t s_drawn_count = 0;
+static int64_t s_display_commit_us[CHILD_REGISTRY_MAX_NODES];  // 描画済みの最新値の公開時刻（スロットで索引）
+
+// ==== 描画の契機 ====
+// 子機レジストリの更新通知・ボタン押下で起き、それ以外はページ送り・タイマーの期限まで眠る
+#define DISPLAY_MIN_INTERVAL_MS  100    // 描画間隔の下限（変化が続いてもこれより速くは描かない）
+#define DISPLAY_IDLE_REFRESH_MS  5000   // 変化がなくても描き直す間隔
+
 // ==== デバウンス管理 ====
 static TickType_t s_sw1_last_press = 0;  // SW1最後に押された時刻（0=未押下）
 static TickType_t s_sw2_last_press = 0;  // SW2最後に押された時刻（0=未押下）
@@ -412,6 +439,9 @@ void IRAM_ATTR ssd1306_notify_sw1_press(void)
             button_event_t event = BUTTON_EVENT_SW1;
             BaseType_t xHigherPriorityTaskWoken = pdFALSE;
             xQueueSendFromISR(s_button_queue, &event, &xHigherPriorityTaskWoken);
+            if (s_task) {
+                vTaskNotifyGiveFromISR(s_task, &xHigherPriorityTaskWoken);  // 待機中の描画ループを起こす
+            }
             portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
         }
         // 0.5秒以内の場合は無視（チャタリング対策）
@@ -432,6 +462,9 @@ void IRAM_ATTR ssd1306_notify_sw2_press(void)
             button_event_t event = BUTTON_EVENT_SW2;
             BaseType_t xHigherPriorityTaskWoken = pdFALSE;
             xQueueSendFromISR(s_button_queue, &event, &xHigherPriorityTaskWoken);
+            if (s_task) {
+                vTaskNotifyGiveFromISR(s_task, &xHigherPriorityTaskWoken);  // 待機中の描画ループを起こす
+            }
             portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
         }
         // 0.5秒以内の場合は無視（チャタリング対策）
@@ -663,6 +696,46 @@ void ssd1306_set_contrast(uint8_t contrast)
     ssd1306_send_command(contrast);
 }
 
+bool ssd1306_is_showing_sensors(void)
+{
+    // タスクは初期化成功時のみ起動される
+    return s_task != NULL && s_display_mode == SSD1306_MODE_SENSOR;
+}
+
+// ==== センサ表示行 ====
+// "<子機No> <値><単位> ... <RSSI>dBm"
+// 再起動前から引き継いだ値は "<子機No>* <値><単位> ... <経過>s"（経過が1000秒以上なら分で"m"）
+// チャネルはsensor_channel.hの表の順に、RSSIと合わせて1行に収まるところまで並べる
+static void format_sensor_line(char *line, size_t size, uint8_t child_no, const temp_sens_data_t *data, bool valid,
+                               bool restored, uint32_t age_ms)
+{
+    char rssi[12];
+    int rssi_len;
+    if (restored) {
+        unsigned long age_s = age_ms / 1000;
+        rssi_len = (age_s < 1000) ? snprintf(rssi, sizeof(rssi), " %lus", age_s)
+                                  : snprintf(rssi, sizeof(rssi), " %lum", age_s / 60);
+    } else {
+        rssi_len = snprintf(rssi, sizeof(rssi), " %ddBm", valid ? data->rssi : 0);
+    }
+    int len = snprintf(line, size, restored ? "%d*" : "%d", child_no);
+
+    for (int ch = 0; ch < SENSOR_CH_COUNT; ch++) {
+        const sensor_channel_t *c = sensor_channel_get((sensor_ch_t)ch);
+        char value[16] = "--";
+        char item[24];
+        if ((valid || restored) && sensor_data_valid(data, (sensor_ch_t)ch)) {
+            sensor_channel_format((sensor_ch_t)ch, data->ch[ch], value, sizeof(value));
+        }
+        int n = snprintf(item, sizeof(item), " %s%s", value, c->unit);
+        if (len + n + rssi_len > SENSOR_LINE_CHARS) {
+            break;
+        }
+        len += snprintf(&line[len], size - len, "%s", item);
+    }
+    snprintf(&line[len], size - len, "%s", rssi);
+}
+
 // ==== モード実行処理 ====
 static void execute_mode_action(ssd1306_display_mode_t mode, TickType_t current_tick)
 {
@@ -729,16 +802,48 @@ static void execute_mode_action(ssd1306_display_mode_t mode, TickType_t current_
     }
 }
 
+// 期限までの残りtick（過ぎていれば0）とwaitの小さい方（tick一周をまたいでも符号付き差で比較）
+static TickType_t wait_until(TickType_t deadline, TickType_t now, TickType_t wait)
+{
+    TickType_t left = ((int32_t)(deadline - now) > 0) ? deadline - now : 0;
+    return (left < wait) ? left : wait;
+}
+
+// 次に描画が必要になるまでのtick（通知がなければこの時間眠る）
+static TickType_t display_wait_ticks(TickType_t now, size_t page_count)
+{
+    TickType_t wait = pdMS_TO_TICKS(DISPLAY_IDLE_REFRESH_MS);
+    if (s_display_mode == SSD1306_MODE_SENSOR) {
+        if (page_count > 1) {
+            TickType_t elapsed = now - s_sensor_page_tick;
+            TickType_t interval = pdMS_TO_TICKS(SENSOR_PAGE_INTERVAL_MS);
+            TickType_t left = (elapsed < interval) ? interval - elapsed : 0;
+            wait = (left < wait) ? left : wait;
+        }
+    } else if (s_display_mode != SSD1306_MODE_VERSION && s_mode_timer != 0) {
+        wait = wait_until(s_mode_timer, now, wait);
+    }
+    if (s_executing && s_result_timer != 0) {
+        wait = wait_until(s_result_timer, now, wait);
+    }
+    return wait;
+}
+
 // ==== タスクエントリ ====
 static void ssd1306_task_entry(void *arg)
 {
     char line[64];
     button_event_t button_event;
     TickType_t current_tick;
+    TickType_t last_draw_tick;
+    size_t page_count = 0;
     
     // スタートアップアニメーションを実行
     ssd1306_play_startup_animation();
 
+    // 子機の値が変わった時だけ起きる（一定周期での描き直しはしない）
+    child_registry_subscribe(xTaskGetCurrentTaskHandle());
+
     while (1) {
         current_tick = xTaskGetTickCount();
         
@@ -795,26 +900,52 @@ static void ssd1306_task_entry(void *arg)
         ssd1306_clear();
 
         if (s_display_mode == SSD1306_MODE_SENSOR) {
-            // モード0：センサ情報表示
-            for (uint8_t child_no = 1; child_no <= 4; child_no++) {
+            // モード0：センサ情報表示（登録済み子機を4台ずつページ送り）
+            size_t child_count = child_registry_list(s_display_refs, CHILD_REGISTRY_MAX_NODES);
+            page_count = (child_count + SENSOR_ROWS_PER_PAGE - 1) / SENSOR_ROWS_PER_PAGE;
+            if (current_tick - s_sensor_page_tick >= pdMS_TO_TICKS(SENSOR_PAGE_INTERVAL_MS)) {
+                s_sensor_page++;
+                s_sensor_page_tick = current_tick;
+            }
+            if (s_sensor_page >= page_count) {
+                s_sensor_page = 0;
+            }
+            
+            if (child_count == 0) {
+                ssd1306_draw_string(0, 0, "waiting child...");
+            }
+            s_drawn_count = 0;
+            
+            for (uint8_t row = 0; row < SENSOR_ROWS_PER_PAGE; row++) {
+                size_t i = s_sensor_page * SENSOR_ROWS_PER_PAGE + row;
+                if (i >= child_count) {
+                    break;
+                }
+                uint8_t child_no = s_display_refs[i].child_no;
+                uint8_t slot = s_display_refs[i].slot;
+                child_view_t view;
                 temp_sens_data_t data;
-                bool valid = web_server_get_child_sensor_data(child_no, &data);
-                
-                if (valid && data.aht_ok && data.bmp_ok) {
-                    // 有効なデータがある場合
-                    float temp = (float)data.aht_t01 / 10.0f;
-                    float rh = (float)data.aht_rh01 / 10.0f;
-                    int rssi = data.rssi;
-                    
-                    snprintf(line, sizeof(line), "%d %.1fC %.1f%% %ddBm",
-                             child_no, temp, rh, rssi);
+                bool found = child_registry_read_view(child_no, &view);
+                bool valid = found && child_view_fresh(&view, child_no);
+                bool restored = found && !valid && child_view_restored(&view, child_no);
+                if (valid || restored) {
+                    sensor_data_unpack(&view.reading, &data);
                 } else {
-                    // 無効なデータまたは通信できなかった場合
-                    snprintf(line, sizeof(line), "%d 0.0C 0.0%% 0dBm", child_no);
+                    memset(&data, 0, sizeof(data));
                 }
+                if (valid && view.commit_us != s_display_commit_us[slot]) {
+                    drawn_reading_t *drawn = &s_drawn[s_drawn_count++];
+                    drawn->slot = slot;
+                    drawn->commit_us = view.commit_us;
+                    drawn->recv_us = child_view_recv_us(&view);
+                }
+                
+                // 無効なデータまたは通信できなかった場合は値を"--"で表示（再起動前の値は経過時間付きで表示）
+                format_sensor_line(line, sizeof(line), child_no, &data, valid, restored,
+                                   current_tick * portTICK_PERIOD_MS - view.last_recv_ms);
                 
                 // 各行を表示（ページ0-3、各ページは8ピクセル高さ）
-                ssd1306_draw_string(0, child_no - 1, line);
+                ssd1306_draw_string(0, row, line);
             }
         } else {
             // モード1～7：各モードの表示
@@ -891,8 +1022,27 @@ static void ssd1306_task_entry(void *arg)
         
         // 画面更新
         ssd1306_display();
+        last_draw_tick = xTaskGetTickCount();
+
+        // 初めて描画した測定値の遅延を記録
+        if (s_drawn_count > 0) {
+            int64_t now_us = esp_timer_get_time();
+            for (size_t i = 0; i < s_drawn_count; i++) {
+                const drawn_reading_t *drawn = &s_drawn[i];
+                s_display_commit_us[drawn->slot] = drawn->commit_us;
+                latency_trace_record(LATENCY_COMMIT_TO_DISPLAY, drawn->commit_us, now_us);
+                latency_trace_record(LATENCY_RECV_TO_DISPLAY, drawn->recv_us, now_us);
+            }
+            s_drawn_count = 0;
+        }
 
-        // 100ms待機（応答性向上）
-        vTaskDelay(pdMS_TO_TICKS(100));
+        // 子機の更新・ボタン押下の通知か、ページ送り・タイマーの期限まで待つ
+        ulTaskNotifyTake(pdTRUE, display_wait_ticks(last_draw_tick, page_count));
+
+        // 変化が続く間は描画間隔の下限まで待ち、その間の通知は次の描画にまとめる
+        TickType_t since_draw = xTaskGetTickCount() - last_draw_tick;
+        if (since_draw < pdMS_TO_TICKS(DISPLAY_MIN_INTERVAL_MS)) {
+            vTaskDelay(pdMS_TO_TICKS(DISPLAY_MIN_INTERVAL_MS) - since_draw);
+        }
     }
 }
@@ -0,0 +1,145 @@
+// src/timer_wheel.c
+// ハッシュドタイマーホイール（要素ごとの期限をtickで索引したバケットに繋ぐ）
+//
+// - バケット: 期限までのtick数を現在位置に足し、TIMER_WHEEL_BUCKETSで割った余り
+// - 設定・解除: バケットの双方向リストへの付け外し（O(1)）
+// - 進める: 経過tick分のバケットだけを巡り、期限を迎えた要素を外す（周回待ちの要素は残す）
+// - 1周以上経過した場合は全バケットを1回だけ巡る
+// FreeRTOS/ESP-IDFに依存しないため、ホスト側ツールでも同じコードを使える。
+
+#include <string.h>
+#include "timer_wheel.h"
+
+#define BUCKET_MASK     (TIMER_WHEEL_BUCKETS - 1)
+
+_Static_assert((TIMER_WHEEL_BUCKETS & BUCKET_MASK) == 0, "bucket count must be a power of 2");
+_Static_assert(TIMER_WHEEL_BUCKETS < TIMER_WHEEL_NONE, "bucket index must fit in uint16_t");
+
+static bool deadline_reached(uint32_t deadline_ms, uint32_t now_ms)
+{
+    return (int32_t)(deadline_ms - now_ms) <= 0;
+}
+
+static void entry_unlink(timer_wheel_t *tw, uint16_t id)
+{
+    timer_wheel_entry_t *e = &tw->entries[id];
+    if (e->prev == TIMER_WHEEL_NONE) {
+        tw->heads[e->bucket] = e->next;
+    } else {
+        tw->entries[e->prev].next = e->next;
+    }
+    if (e->next != TIMER_WHEEL_NONE) {
+        tw->entries[e->next].prev = e->prev;
+    }
+    e->next = TIMER_WHEEL_NONE;
+    e->prev = TIMER_WHEEL_NONE;
+    e->bucket = TIMER_WHEEL_NONE;
+    tw->armed--;
+}
+
+void timer_wheel_init(timer_wheel_t *tw, timer_wheel_entry_t *entries, uint16_t count,
+                      uint32_t tick_ms, uint32_t now_ms)
+{
+    if (tw == NULL || entries == NULL || tick_ms == 0 || count >= TIMER_WHEEL_NONE) {
+        return;
+    }
+
+    memset(tw, 0, sizeof(*tw));
+    tw->entries = entries;
+    tw->count = count;
+    tw->tick_ms = tick_ms;
+    tw->now_ms = now_ms;
+    for (int i = 0; i < TIMER_WHEEL_BUCKETS; i++) {
+        tw->heads[i] = TIMER_WHEEL_NONE;
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        entries[i].deadline_ms = 0;
+        entries[i].next = TIMER_WHEEL_NONE;
+        entries[i].prev = TIMER_WHEEL_NONE;
+        entries[i].bucket = TIMER_WHEEL_NONE;
+    }
+}
+
+void timer_wheel_arm(timer_wheel_t *tw, uint16_t id, uint32_t deadline_ms)
+{
+    if (tw == NULL || id >= tw->count) {
+        return;
+    }
+    if (timer_wheel_armed(tw, id)) {
+        entry_unlink(tw, id);
+    }
+
+    // 期限を過ぎない最初のtickのバケット（過ぎた期限は次のtick）
+    int32_t delta = (int32_t)(deadline_ms - tw->now_ms);
+    uint32_t ticks = (delta <= 0) ? 1 : ((uint32_t)delta + tw->tick_ms - 1) / tw->tick_ms;
+    uint16_t bucket = (uint16_t)((tw->cursor + ticks) & BUCKET_MASK);
+
+    timer_wheel_entry_t *e = &tw->entries[id];
+    e->deadline_ms = deadline_ms;
+    e->bucket = bucket;
+    e->prev = TIMER_WHEEL_NONE;
+    e->next = tw->heads[bucket];
+    if (e->next != TIMER_WHEEL_NONE) {
+        tw->entries[e->next].prev = id;
+    }
+    tw->heads[bucket] = id;
+    tw->armed++;
+}
+
+void timer_wheel_cancel(timer_wheel_t *tw, uint16_t id)
+{
+    if (tw == NULL || id >= tw->count || !timer_wheel_armed(tw, id)) {
+        return;
+    }
+    entry_unlink(tw, id);
+}
+
+size_t timer_wheel_advance(timer_wheel_t *tw, uint32_t now_ms, uint16_t *expired)
+{
+    if (tw == NULL || expired == NULL) {
+        return 0;
+    }
+    int32_t elapsed = (int32_t)(now_ms - tw->now_ms);
+    if (elapsed < (int32_t)tw->tick_ms) {
+        return 0;
+    }
+
+    uint32_t steps = (uint32_t)elapsed / tw->tick_ms;
+    uint32_t visit = (steps > TIMER_WHEEL_BUCKETS) ? TIMER_WHEEL_BUCKETS : steps;
+    uint32_t target_ms = tw->now_ms + steps * tw->tick_ms;
+    size_t count = 0;
+
+    for (uint32_t k = 1; k <= visit; k++) {
+        uint16_t id = tw->heads[(tw->cursor + k) & BUCKET_MASK];
+        while (id != TIMER_WHEEL_NONE) {
+            uint16_t next = tw->entries[id].next;
+            if (deadline_reached(tw->entries[id].deadline_ms, target_ms)) {
+                entry_unlink(tw, id);
+                expired[count++] = id;
+            }
+            id = next;
+        }
+    }
+
+    tw->cursor += steps;
+    tw->now_ms = target_ms;
+    return count;
+}
+
+uint32_t timer_wheel_next_ms(const timer_wheel_t *tw, uint32_t now_ms, uint32_t limit_ms)
+{
+    if (tw == NULL || tw->armed == 0) {
+        return limit_ms;
+    }
+
+    for (uint32_t k = 1; k <= TIMER_WHEEL_BUCKETS; k++) {
+        int32_t wait = (int32_t)(tw->now_ms + k * tw->tick_ms - now_ms);
+        if (wait >= (int32_t)limit_ms) {
+            break;
+        }
+        if (tw->heads[(tw->cursor + k) & BUCKET_MASK] != TIMER_WHEEL_NONE) {
+            return (wait > 0) ? (uint32_t)wait : 0;
+        }
+    }
+    return limit_ms;
+}
@@ -0,0 +1,98 @@
+// src/tx_schedule.c
+// 子機送信位相（タイムスロット）の割り当てと到着統計
+//
+// 目標位相 = bitrev(スロット番号) / 2^TX_SCHEDULE_SLOT_BITS × 送信間隔
+// 測定位相 = 最終受信時刻 mod 送信間隔（ゲートウェイの時計）
+// 差が許容範囲を超えたら、近い方向（±送信間隔/2以内）へ次の送信をずらすよう子機に指示する。
+// FreeRTOS/ESP-IDFに依存しないため、ホスト側ツールでも同じコードを使える。
+
+#include <stdint.h>
+#include "tx_schedule.h"
+
+// 送信間隔の差を±interval/2に折り返す
+static int32_t fold_ms(uint32_t diff_ms, uint32_t interval_ms)
+{
+    uint32_t r = diff_ms % interval_ms;
+    return (r > interval_ms / 2) ? (int32_t)r - (int32_t)interval_ms : (int32_t)r;
+}
+
+void tx_phase_on_arrival(tx_phase_t *phase, uint32_t arrival_ms, uint32_t interval_ms)
+{
+    if (phase == NULL || interval_ms == 0) {
+        return;
+    }
+
+    if (phase->arrivals == 0 || phase->interval_ms != interval_ms) {
+        // 基準の取り直し（揺らぎは前の値を引き継ぐ）
+        phase->interval_ms = interval_ms;
+        phase->last_arrival_ms = arrival_ms;
+        phase->arrivals = 1;
+        return;
+    }
+
+    int32_t d = fold_ms(arrival_ms - phase->last_arrival_ms, interval_ms);
+    uint32_t abs_d = (uint32_t)(d < 0 ? -d : d);
+    phase->jitter_x16 += abs_d - (phase->jitter_x16 >> TX_JITTER_GAIN_SHIFT);
+    phase->last_arrival_ms = arrival_ms;
+    if (phase->arrivals < UINT8_MAX) {
+        phase->arrivals++;
+    }
+}
+
+void tx_phase_restart(tx_phase_t *phase)
+{
+    if (phase == NULL) {
+        return;
+    }
+    phase->arrivals = 0;
+}
+
+uint32_t tx_schedule_target_ms(uint8_t slot, uint32_t interval_ms)
+{
+    uint32_t rev = 0;
+    for (int i = 0; i < TX_SCHEDULE_SLOT_BITS; i++) {
+        rev = (rev << 1) | ((slot >> i) & 1u);
+    }
+    return (uint32_t)(((uint64_t)interval_ms * rev) >> TX_SCHEDULE_SLOT_BITS);
+}
+
+uint32_t tx_schedule_tolerance_ms(uint32_t interval_ms, size_t slot_span)
+{
+    // slot_span以上の最小の2のべき乗で区切った間隔（ビット反転の割り当てでの最小間隔）
+    int bits = 0;
+    while (bits < TX_SCHEDULE_SLOT_BITS && ((size_t)1 << bits) < slot_span) {
+        bits++;
+    }
+    uint32_t tolerance_ms = (interval_ms >> bits) / 4;
+    return (tolerance_ms < TX_PHASE_TOLERANCE_MIN_MS) ? TX_PHASE_TOLERANCE_MIN_MS : tolerance_ms;
+}
+
+bool tx_schedule_correction(const tx_phase_t *phase, uint32_t target_ms, uint32_t tolerance_ms, int32_t *shift_ms)
+{
+    if (phase == NULL || shift_ms == NULL || phase->interval_ms == 0 ||
+        phase->arrivals < TX_PHASE_SETTLE_ARRIVALS) {
+        return false;
+    }
+
+    // 目標位相 - 測定位相（折り返し）
+    int32_t err = fold_ms(target_ms - phase->last_arrival_ms % phase->interval_ms + phase->interval_ms,
+                          phase->interval_ms);
+    uint32_t abs_err = (uint32_t)(err < 0 ? -err : err);
+    if (abs_err <= tolerance_ms) {
+        return false;
+    }
+    *shift_ms = err;
+    return true;
+}
+
+void tx_arrival_note(tx_arrival_stats_t *stats, uint32_t arrival_ms)
+{
+    if (stats == NULL) {
+        return;
+    }
+    if (stats->arrivals > 0 && arrival_ms - stats->last_arrival_ms <= TX_CLOSE_ARRIVAL_MS) {
+        stats->close_arrivals++;
+    }
+    stats->arrivals++;
+    stats->last_arrival_ms = arrival_ms;
+}
@@ -9,6 +9,10 @@
 #include "flash_data.h"
 #include "user_common.h"
 #include "sd_task.h"
+#include "child_registry.h"
+#include "wifi_task.h"
+#include "raw_capture.h"
+#include "report_control.h"
 #include <string.h>
 #include <stdlib.h>
 
@@ -67,6 +71,52 @@ static void execute_command(const char *cmd)
     else if (strcmp(cmd, "save") == 0) {
         flashdata_save();
     }
+    else if (strcmp(cmd, "childinfo") == 0) {
+        child_registry_dump();
+        wifi_ingest_stats_t ingest;
+        wifi_get_ingest_stats(&ingest);
+        syslog(INFO, "Ingest ring: used=%lu/%lu high_water=%lu overflow=%lu coalesce=%lu superseded=%lu",
+               (unsigned long)ingest.ring.count, (unsigned long)ingest.ring.capacity,
+               (unsigned long)ingest.ring.high_water, (unsigned long)ingest.ring.overflow,
+               (unsigned long)ingest.coalesce_bursts, (unsigned long)ingest.superseded);
+        syslog(INFO, "Admission: %s rate=%lu/s burst=%lu sources=%lu admitted=%lu dropped=%lu",
+               ingest.admission_enabled ? "on" : "off",
+               (unsigned long)ingest.admission.rate_per_sec, (unsigned long)ingest.admission.burst,
+               (unsigned long)ingest.admission.sources, (unsigned long)ingest.admission.admitted,
+               (unsigned long)ingest.admission.dropped);
+        report_control_status_t ctrl;
+        report_control_get_status(&ctrl);
+        syslog(INFO, "Report control: interval=%lums backoff=%u%s viewer=%d display=%d active=%lu ctrl_seq=%u sent=%lu err=%lu",
+               (unsigned long)ctrl.interval_ms, (unsigned int)ctrl.backoff, ctrl.overloaded ? " (overload)" : "",
+               ctrl.viewer_active, ctrl.display_active, (unsigned long)ctrl.active_children,
+               (unsigned int)ctrl.ctrl_seq, (unsigned long)ctrl.frames_sent, (unsigned long)ctrl.send_errors);
+        syslog(INFO, "Tx schedule: %s aligned=%lu/%lu jitter=%lums close=%u.%u%% loss=%u.%u%% shifts=%lu",
+               ctrl.schedule_enabled ? "on" : "off",
+               (unsigned long)ctrl.aligned_children, (unsigned long)ctrl.scheduled_children,
+               (unsigned long)ctrl.jitter_ms, ctrl.close_permille / 10, ctrl.close_permille % 10,
+               ctrl.loss_permille / 10, ctrl.loss_permille % 10, (unsigned long)ctrl.phase_shifts);
+    }
+    else if (strcmp(cmd, "txsched on") == 0) {
+        report_control_set_schedule(true);
+    }
+    else if (strcmp(cmd, "txsched off") == 0) {
+        report_control_set_schedule(false);
+    }
+    else if (strcmp(cmd, "admit on") == 0) {
+        wifi_set_admission_enabled(true);
+    }
+    else if (strcmp(cmd, "admit off") == 0) {
+        wifi_set_admission_enabled(false);
+    }
+    else if (strcmp(cmd, "rawcap on") == 0) {
+        raw_capture_set_enabled(true);
+    }
+    else if (strcmp(cmd, "rawcap off") == 0) {
+        raw_capture_set_enabled(false);
+    }
+    else if (strcmp(cmd, "rawcap") == 0) {
+        raw_capture_dump();
+    }
     else if (strcmp(cmd, "reset") == 0) {
         exec_soft_reset();
     }
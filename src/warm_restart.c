@@ -0,0 +1,71 @@
+// src/warm_restart.c
+// 再起動をまたぐ子機レジストリの状態（RTC低速メモリ）
+//
+// - 保存: 子機レジストリの状態を写し、magic・長さ・crc32を付ける（写している間はmagicを消しておく）
+// - 復元: ソフトウェアリセットからの起動で、magic・長さ・crc32が一致すれば子機レジストリへ登録する
+// 経過時間は保存時点までのもので、再起動にかかった時間（数秒）は含まない。
+
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_system.h"
+#include "esp_rom_crc.h"
+#include "child_registry.h"
+#include "warm_restart.h"
+#include "log_task.h"
+
+#define WARM_RESTART_MAGIC      0x4D524157u     // "WARM"
+#define WARM_RESTART_MAX_BYTES  4096            // RTC低速メモリ（8KB）のうち使ってよい量
+
+typedef struct {
+    uint32_t magic;
+    uint32_t length;                // sizeof(child_warm_state_t)（構造の異なるファームウェアの内容を使わない）
+    uint32_t crc;                   // stateのcrc32
+    child_warm_state_t state;
+} warm_restart_image_t;
+
+_Static_assert(sizeof(warm_restart_image_t) <= WARM_RESTART_MAX_BYTES, "warm state must fit in RTC slow memory");
+
+// ソフトウェアリセットでは消えない（電源投入時は不定）
+static RTC_NOINIT_ATTR warm_restart_image_t s_image;
+
+static uint32_t image_crc(void)
+{
+    return esp_rom_crc32_le(0, (const uint8_t *)&s_image.state, sizeof(s_image.state));
+}
+
+void warm_restart_save(void)
+{
+    s_image.magic = 0;
+    size_t count = child_registry_save_warm(&s_image.state, xTaskGetTickCount() * portTICK_PERIOD_MS);
+    s_image.length = sizeof(s_image.state);
+    s_image.crc = image_crc();
+    s_image.magic = WARM_RESTART_MAGIC;
+    syslog(INFO, "warm_restart: saved %u children, %lu rollups (%u bytes)",
+           (unsigned int)count, (unsigned long)s_image.state.rollup_count, (unsigned int)sizeof(s_image));
+}
+
+size_t warm_restart_restore(void)
+{
+    bool valid = s_image.magic == WARM_RESTART_MAGIC && s_image.length == sizeof(s_image.state) &&
+                 s_image.crc == image_crc();
+    s_image.magic = 0;
+
+    esp_reset_reason_t reason = esp_reset_reason();
+    if (reason != ESP_RST_SW) {
+        if (valid) {
+            syslog(INFO, "warm_restart: discarded (reset reason %d)", (int)reason);
+        }
+        return 0;
+    }
+    if (!valid) {
+        syslog(WARN, "warm_restart: no valid state after software reset");
+        return 0;
+    }
+
+    size_t restored = child_registry_restore_warm(&s_image.state, xTaskGetTickCount() * portTICK_PERIOD_MS);
+    syslog(INFO, "warm_restart: restored %u/%lu children, %lu rollups",
+           (unsigned int)restored, (unsigned long)s_image.state.count, (unsigned long)s_image.state.rollup_count);
+    return restored;
+}
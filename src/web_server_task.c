@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -6,26 +7,48 @@
 #include "esp_log.h"
 #include "esp_http_server.h"
 #include "esp_netif.h"
+#include "esp_timer.h"
 #include "web_server_task.h"
 #include "log_task.h"
 #include "wifi_task.h"
+#include "child_registry.h"
+#include "report_control.h"
+#include "history_store.h"
+#include "latency_trace.h"
+#include "lwip/sockets.h"  // inet_ntop用
 
 static httpd_handle_t s_server = NULL;
 
-// 各子機のセンサデータを保持（1-4）
-typedef struct {
-    temp_sens_data_t data;
-    bool is_valid;
-    uint32_t last_update_ms;
-} child_sensor_data_t;
+// ==== タイムアウト設定 ====
+#define WEB_VIEWER_TIMEOUT_MS  6000   // /sensor/dataの取得がこの時間なければ閲覧者なし（ダッシュボード3周期分）
 
-static child_sensor_data_t s_child_sensor_data[4] = {0};  // 子機1-4
-static SemaphoreHandle_t s_sensor_data_mutex = NULL;
+static volatile uint32_t s_last_poll_ms = 0;
+static volatile bool s_polled = false;
 
-// ==== タイムアウト設定 ====
-#define CHILD_DATA_TIMEOUT_MS  10000  // 10秒でタイムアウト
+// /sensor/dataで返した最新値の公開時刻（スロットで索引、httpdタスクのみ参照）
+// 同じ測定値を返し直しても遅延を数え直さない
+static int64_t s_http_commit_us[CHILD_REGISTRY_MAX_NODES];
+
+// ==== 更新のプッシュ（WebSocket） ====
+// ダッシュボードは/sensor/wsに接続し、子機の値が変わった時だけ{"version":N}を受け取って/sensor/dataを取り直す
+// （接続できなければ従来どおり2秒周期で取得する）。通知の送信はhttpdタスクで行う（httpd_queue_work）
+#define WS_MAX_CLIENTS          4
+#define WS_PUSH_MIN_INTERVAL_MS 250     // 通知間隔の下限（変化が続いても取り直しはこの周期まで）
+#define WS_KEEPALIVE_MS         10000   // 変化がなくても通知する間隔（切断したクライアントの検出用）
+
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+static int s_ws_fds[WS_MAX_CLIENTS] = { -1, -1, -1, -1 };   // 通知先のソケット（httpdタスクのみ参照）
+static volatile uint32_t s_ws_clients = 0;
+#endif
+
+// /sensor/data応答の分割送信バッファサイズ
+#define SENSOR_JSON_CHUNK_SIZE 1024
+
+// HTMLページ用のチャネル表（sensor_channel.hの表から生成、k=JSONキー n=表示名 d=小数桁 u=単位）
+#define HTML_CHANNEL(id, key, label, name, decimals, unit, type, group) \
+"{k:'" key "',n:'" name "',d:" #decimals ",u:'" unit "'},"
 
-// HTMLページ（4子機対応版）
+// HTMLページ（子機数可変、カードは受信した子機分だけ生成、カードの項目はチャネル表から生成）
 static const char html_page[] = 
 "<!DOCTYPE html>"
 "<html lang='ja'>"
@@ -50,6 +73,7 @@ static const char html_page[] =
 ".child-card{background:white;padding:20px;border-radius:15px;box-shadow:0 5px 20px rgba(0,0,0,0.2)}"
 ".child-header{font-size:20px;font-weight:bold;color:#333;margin-bottom:15px;padding-bottom:10px;border-bottom:2px solid #667eea}"
 ".child-header.inactive{color:#999;border-bottom-color:#ccc}"
+".child-age{margin-left:8px;font-size:14px;font-weight:normal;color:#999}"
 ".sensor-item{display:flex;justify-content:space-between;padding:8px 0;border-bottom:1px solid #dee2e6}"
 ".sensor-item:last-child{border-bottom:none}"
 ".sensor-label{font-weight:bold;color:#495057}"
@@ -62,15 +86,14 @@ static const char html_page[] =
 "<div class='led-section'>"
 "<button id='log-button' class='log-button' onclick='toggleLogging()'>ロギングON</button>"
 "</div>"
-"<div class='children-grid'>"
-"<div class='child-card'><div class='child-header' id='child1-header'>部屋A</div><div class='sensor-item'><span class='sensor-label'>温度:</span><span id='child1-temp' class='sensor-value na'>--</span></div><div class='sensor-item'><span class='sensor-label'>湿度:</span><span id='child1-rh' class='sensor-value na'>--</span></div><div class='sensor-item'><span class='sensor-label'>気圧:</span><span id='child1-pressure' class='sensor-value na'>--</span></div><div class='sensor-item'><span class='sensor-label'>RSSI:</span><span id='child1-rssi' class='sensor-value na'>--</span></div></div>"
-"<div class='child-card'><div class='child-header' id='child2-header'>部屋B</div><div class='sensor-item'><span class='sensor-label'>温度:</span><span id='child2-temp' class='sensor-value na'>--</span></div><div class='sensor-item'><span class='sensor-label'>湿度:</span><span id='child2-rh' class='sensor-value na'>--</span></div><div class='sensor-item'><span class='sensor-label'>気圧:</span><span id='child2-pressure' class='sensor-value na'>--</span></div><div class='sensor-item'><span class='sensor-label'>RSSI:</span><span id='child2-rssi' class='sensor-value na'>--</span></div></div>"
-"<div class='child-card'><div class='child-header' id='child3-header'>部屋C</div><div class='sensor-item'><span class='sensor-label'>温度:</span><span id='child3-temp' class='sensor-value na'>--</span></div><div class='sensor-item'><span class='sensor-label'>湿度:</span><span id='child3-rh' class='sensor-value na'>--</span></div><div class='sensor-item'><span class='sensor-label'>気圧:</span><span id='child3-pressure' class='sensor-value na'>--</span></div><div class='sensor-item'><span class='sensor-label'>RSSI:</span><span id='child3-rssi' class='sensor-value na'>--</span></div></div>"
-"<div class='child-card'><div class='child-header' id='child4-header'>部屋D</div><div class='sensor-item'><span class='sensor-label'>温度:</span><span id='child4-temp' class='sensor-value na'>--</span></div><div class='sensor-item'><span class='sensor-label'>湿度:</span><span id='child4-rh' class='sensor-value na'>--</span></div><div class='sensor-item'><span class='sensor-label'>気圧:</span><span id='child4-pressure' class='sensor-value na'>--</span></div><div class='sensor-item'><span class='sensor-label'>RSSI:</span><span id='child4-rssi' class='sensor-value na'>--</span></div></div>"
-"</div>"
+"<div class='children-grid' id='children-grid'></div>"
 "<script>"
+"const CHANNELS=[" SENSOR_CHANNEL_TABLE(HTML_CHANNEL) "];"
 "let loggingState=false;"
 "let logData=[];"
+"let lastItem={};"
+"let pollTimer=null;"
+"let pushVersion=-1;"
 "function toggleLogging(){"
 "if(!loggingState){"
 "loggingState=true;"
@@ -104,7 +127,7 @@ static const char html_page[] =
 "let csv='';"
 "for(let i=0;i<logData.length;i++){"
 "const entry=logData[i];"
-"csv+=entry.timestamp+','+entry.childNo+','+entry.temp+','+entry.rh+','+entry.pressure+','+entry.rssi+'\\n';"
+"csv+=entry.timestamp+','+entry.childNo+','+CHANNELS.map(c=>entry[c.k]).join(',')+','+entry.rssi+'\\n';"
 "}"
 "const blob=new Blob([csv],{type:'text/plain;charset=utf-8'});"
 "const url=URL.createObjectURL(blob);"
@@ -119,6 +142,34 @@ static const char html_page[] =
 "URL.revokeObjectURL(url);"
 "logData=[];"
 "}"
+"const ROOM_NAMES={1:'部屋A',2:'部屋B',3:'部屋C',4:'部屋D'};"
+"function sensorItem(no,key,label){"
+"return '<div class=\"sensor-item\"><span class=\"sensor-label\">'+label+':</span><span id=\"child'+no+'-'+key+'\" class=\"sensor-value na\">--</span></div>';"
+"}"
+"function childCard(no){"
+"let card=document.getElementById('child'+no);"
+"if(card)return card;"
+"card=document.createElement('div');"
+"card.className='child-card';"
+"card.id='child'+no;"
+"card.dataset.no=no;"
+"const name=ROOM_NAMES[no]||('子機'+no);"
+"card.innerHTML='<div class=\"child-header\" id=\"child'+no+'-header\">'+name+'<span class=\"child-age\" id=\"child'+no+'-age\"></span></div>'+"
+"CHANNELS.map(c=>sensorItem(no,c.k,c.n)).join('')+sensorItem(no,'rssi','RSSI');"
+"const grid=document.getElementById('children-grid');"
+"let next=null;"
+"for(const c of grid.children){if(Number(c.dataset.no)>no){next=c;break;}}"
+"grid.insertBefore(card,next);"
+"return card;"
+"}"
+"function setValue(no,key,text){"
+"const el=document.getElementById('child'+no+'-'+key);"
+"el.textContent=text;"
+"if(text==='--'){el.classList.add('na');}else{el.classList.remove('na');}"
+"}"
+"function setAge(no,ms){"
+"document.getElementById('child'+no+'-age').textContent=(ms>=0)?'（再起動前・'+Math.round(ms/1000)+'秒前）':'';"
+"}"
 "function updateSensorData(){"
 "fetch('/sensor/data')"
 ".then(r=>{"
@@ -131,46 +182,66 @@ static const char html_page[] =
 "const now=new Date();"
 "const timestamp=formatTimestamp(now);"
 "if(d&&typeof d==='object'&&Array.isArray(d.children)){"
-"for(let i=0;i<4;i++){"
-"const child=d.children[i];"
-"const idx=i+1;"
+"const seen={};"
+"for(const child of d.children){"
+"if(!child||typeof child.child_no!=='number')continue;"
+"const idx=child.child_no;"
+"seen[idx]=true;"
+"childCard(idx);"
 "const header=document.getElementById('child'+idx+'-header');"
-"if(child&&child.valid){"
-"header.classList.remove('inactive');"
-"const temp=(child.aht_t01/10).toFixed(1);"
-"const rh=(child.aht_rh01/10).toFixed(1);"
-"const pressure=(child.bmp_p01/10).toFixed(1);"
+"if(child.valid||child.restored){"
+"header.classList.toggle('inactive',!child.valid);"
+"setAge(idx,child.restored?child.age_ms:-1);"
+"const row={timestamp:timestamp,childNo:idx};"
+"const item=JSON.stringify(child);"
+"const fresh=item!==lastItem[idx];"
+"lastItem[idx]=item;"
+"for(const c of CHANNELS){"
+"const v=child[c.k];"
+"const text=(typeof v==='number')?(v/Math.pow(10,c.d)).toFixed(c.d):'--';"
+"setValue(idx,c.k,text==='--'?text:text+' '+c.u);"
+"row[c.k]=text;"
+"}"
 "const rssi=child.rssi!==undefined?child.rssi:0;"
-"document.getElementById('child'+idx+'-temp').textContent=temp+' ℃';"
-"document.getElementById('child'+idx+'-temp').classList.remove('na');"
-"document.getElementById('child'+idx+'-rh').textContent=rh+' %';"
-"document.getElementById('child'+idx+'-rh').classList.remove('na');"
-"document.getElementById('child'+idx+'-pressure').textContent=pressure+' hPa';"
-"document.getElementById('child'+idx+'-pressure').classList.remove('na');"
-"document.getElementById('child'+idx+'-rssi').textContent=rssi+' dBm';"
-"document.getElementById('child'+idx+'-rssi').classList.remove('na');"
-"if(loggingState){"
-"logData.push({timestamp:timestamp,childNo:idx,temp:temp,rh:rh,pressure:pressure,rssi:rssi});"
+"setValue(idx,'rssi',rssi+' dBm');"
+"row.rssi=rssi;"
+"if(loggingState&&fresh&&child.valid){"
+"logData.push(row);"
 "}"
 "}else{"
 "header.classList.add('inactive');"
-"document.getElementById('child'+idx+'-temp').textContent='--';"
-"document.getElementById('child'+idx+'-temp').classList.add('na');"
-"document.getElementById('child'+idx+'-rh').textContent='--';"
-"document.getElementById('child'+idx+'-rh').classList.add('na');"
-"document.getElementById('child'+idx+'-pressure').textContent='--';"
-"document.getElementById('child'+idx+'-pressure').classList.add('na');"
-"document.getElementById('child'+idx+'-rssi').textContent='--';"
-"document.getElementById('child'+idx+'-rssi').classList.add('na');"
+"setAge(idx,-1);"
+"for(const c of CHANNELS){setValue(idx,c.k,'--');}"
+"setValue(idx,'rssi','--');"
 "}"
 "}"
+"document.querySelectorAll('.child-card').forEach(c=>{if(!seen[c.dataset.no])c.remove();});"
 "}"
 "}catch(e){console.error('JSON parse error:',e);}"
 "})"
 ".catch(e=>console.error('Fetch error:',e));"
 "}"
+"function startPolling(){"
+"if(!pollTimer)pollTimer=setInterval(updateSensorData,2000);"
+"}"
+"function connectPush(){"
+"if(!('WebSocket' in window))return;"
+"const ws=new WebSocket('ws://'+location.host+'/sensor/ws');"
+"ws.onopen=()=>{"
+"if(pollTimer){clearInterval(pollTimer);pollTimer=null;}"
+"updateSensorData();"
+"};"
+"ws.onmessage=e=>{"
+"try{"
+"const m=JSON.parse(e.data);"
+"if(m.version!==pushVersion){pushVersion=m.version;updateSensorData();}"
+"}catch(err){console.error('Push parse error:',err);}"
+"};"
+"ws.onclose=()=>{startPolling();setTimeout(connectPush,30000);};"
+"}"
 "updateSensorData();"
-"setInterval(updateSensorData,2000);"
+"startPolling();"
+"connectPush();"
 "</script>"
 "</body>"
 "</html>";
@@ -198,159 +269,643 @@ static esp_err_t favicon_handler(httpd_req_t *req)
 }
 
 
-// ルートハンドラ: センサデータ取得（全子機のデータを返す）
+// 分割送信用バッファへ追記し、溜まったら1チャンク送信
+typedef struct {
+    httpd_req_t *req;
+    char buf[SENSOR_JSON_CHUNK_SIZE];
+    size_t len;
+} json_chunk_writer_t;
+
+static void json_chunk_flush(json_chunk_writer_t *w)
+{
+    if (w->len > 0) {
+        httpd_resp_send_chunk(w->req, w->buf, w->len);
+        w->len = 0;
+    }
+}
+
+static void json_chunk_append(json_chunk_writer_t *w, const char *str, size_t len)
+{
+    if (w->len + len > sizeof(w->buf)) {
+        json_chunk_flush(w);
+    }
+    memcpy(&w->buf[w->len], str, len);
+    w->len += len;
+}
+
+// ルートハンドラ: センサデータ取得（登録済み子機のデータを返す）
+// 形式: {"children":[{"child_no":1,"valid":true,"aht_t01":...,"seq":..,"rssi":..},{"child_no":2,"valid":false},...]}
+// チャネルはsensor_channel.hの表の順（無効なチャネルはnull）
+// 再起動前から引き継いだ最終値（再起動後にまだ受信のない子機）は、valid=falseのまま
+// "restored":true,"age_ms":最終受信からの経過ms を付けて値も返す
 static esp_err_t sensor_data_handler(httpd_req_t *req)
 {
     syslog(INFO, "sensor_data_handler: request received");
-    char response[1024];  // 4子機分のデータ用に拡張
+    uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    s_last_poll_ms = now_ms;
+    s_polled = true;
     
-    if (s_sensor_data_mutex == NULL) {
-        // ミューテックスが初期化されていない場合、空の配列を返す
-        snprintf(response, sizeof(response), "{\"children\":[null,null,null,null]}");
-        syslog(WARN, "sensor_data_handler: mutex not initialized");
-    } else {
-        xSemaphoreTake(s_sensor_data_mutex, portMAX_DELAY);
-        uint32_t current_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
-        
-        // JSON配列を構築
-        char *p = response;
-        int len = snprintf(p, sizeof(response), "{\"children\":[");
-        p += len;
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    
+    // 登録済み子機のみ列挙し、全スロットを1回で写してから組み立てる（httpdタスク専用の静的領域）
+    // 有効性はレジストリが期限で遷移させたACTIVE/STALEをそのまま使う
+    static child_registry_ref_t refs[CHILD_REGISTRY_MAX_NODES];
+    static child_view_t views[CHILD_REGISTRY_MAX_NODES];
+    static json_chunk_writer_t writer;
+    size_t count = child_registry_list(refs, CHILD_REGISTRY_MAX_NODES);
+    child_registry_snapshot(views);
+    
+    writer.req = req;
+    writer.len = 0;
+    json_chunk_append(&writer, "{\"children\":[", 13);
+    
+    for (size_t i = 0; i < count; i++) {
+        const child_view_t *view = &views[refs[i].slot];
+        bool is_valid = child_view_fresh(view, refs[i].child_no);
+        bool is_restored = !is_valid && child_view_restored(view, refs[i].child_no);
         
-        for (int i = 0; i < 4; i++) {
-            if (i > 0) {
-                len = snprintf(p, sizeof(response) - (p - response), ",");
-                p += len;
-            }
-            
-            // タイムアウトチェック（10秒以上更新がない場合は無効化）
-            bool is_valid = s_child_sensor_data[i].is_valid;
-            if (is_valid) {
-                uint32_t elapsed_ms = current_ms - s_child_sensor_data[i].last_update_ms;
-                if (elapsed_ms >= CHILD_DATA_TIMEOUT_MS) {
-                    // タイムアウト：データを0にクリア
-                    memset(&s_child_sensor_data[i].data, 0, sizeof(temp_sens_data_t));
-                    s_child_sensor_data[i].is_valid = false;
-                    is_valid = false;
-                }
-            }
-            
-            if (is_valid) {
-                len = snprintf(p, sizeof(response) - (p - response),
-                    "{\"valid\":true,\"aht_t01\":%d,\"aht_rh01\":%u,\"bmp_t01\":%d,\"bmp_p01\":%lu,\"aht_ok\":%s,\"bmp_ok\":%s,\"seq\":%lu,\"rssi\":%d}",
-                    (int)s_child_sensor_data[i].data.aht_t01,
-                    (unsigned int)s_child_sensor_data[i].data.aht_rh01,
-                    (int)s_child_sensor_data[i].data.bmp_t01,
-                    (unsigned long)s_child_sensor_data[i].data.bmp_p01,
-                    s_child_sensor_data[i].data.aht_ok ? "true" : "false",
-                    s_child_sensor_data[i].data.bmp_ok ? "true" : "false",
-                    (unsigned long)s_child_sensor_data[i].data.seq,
-                    (int)s_child_sensor_data[i].data.rssi);
-            } else {
-                len = snprintf(p, sizeof(response) - (p - response), "null");
+        static char item[SENSOR_DATA_JSON_MAX + 112];
+        int len;
+        if (is_valid || is_restored) {
+            temp_sens_data_t data;
+            sensor_data_unpack(&view->reading, &data);
+            len = snprintf(item, sizeof(item), "%s{\"child_no\":%d,\"valid\":%s,",
+                           (i > 0) ? "," : "", refs[i].child_no, is_valid ? "true" : "false");
+            if (is_restored) {
+                len += snprintf(&item[len], sizeof(item) - len, "\"restored\":true,\"age_ms\":%lu,",
+                                (unsigned long)(now_ms - view->last_recv_ms));
+            } else if (view->commit_us != s_http_commit_us[refs[i].slot]) {
+                // この測定値を初めて返す: 公開・受信からの遅延を記録
+                int64_t now_us = esp_timer_get_time();
+                s_http_commit_us[refs[i].slot] = view->commit_us;
+                latency_trace_record(LATENCY_COMMIT_TO_HTTP, view->commit_us, now_us);
+                latency_trace_record(LATENCY_RECV_TO_HTTP, child_view_recv_us(view), now_us);
             }
-            p += len;
+            len += (int)sensor_data_write_json(&data, &item[len], sizeof(item) - len);
+            len += snprintf(&item[len], sizeof(item) - len, ",\"seq\":%lu,\"rssi\":%d}",
+                            (unsigned long)data.seq, data.rssi);
+        } else {
+            len = snprintf(item, sizeof(item), "%s{\"child_no\":%d,\"valid\":false}",
+                           (i > 0) ? "," : "", refs[i].child_no);
         }
-        
-        len = snprintf(p, sizeof(response) - (p - response), "]}");
-        p += len;
-        
-        xSemaphoreGive(s_sensor_data_mutex);
-        syslog(DEBUG, "sensor_data_handler: returning data for 4 children");
+        json_chunk_append(&writer, item, (size_t)len);
     }
     
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-    httpd_resp_send(req, response, HTTPD_RESP_USE_STRLEN);
+    json_chunk_append(&writer, "]}", 2);
+    json_chunk_flush(&writer);
+    httpd_resp_send_chunk(req, NULL, 0);
+    
+    syslog(DEBUG, "sensor_data_handler: returning data for %u children", (unsigned int)count);
     return ESP_OK;
 }
 
-// センサデータ更新関数（UDP受信タスクから呼び出される、子機番号付き）
-void web_server_update_sensor_data_with_child_no(uint8_t child_no, const temp_sens_data_t *data)
+// クエリの数値パラメータ（10進）。なければfalse
+static bool query_get_u32(const char *query, const char *key, uint32_t *value)
 {
-    if (data == NULL) {
-        syslog(WARN, "web_server_update_sensor_data: data is NULL");
-        return;
+    char buf[16];
+    if (httpd_query_key_value(query, key, buf, sizeof(buf)) != ESP_OK || buf[0] == '\0') {
+        return false;
     }
-    
-    if (child_no < 1 || child_no > 4) {
-        syslog(WARN, "web_server_update_sensor_data: invalid child_no=%d", child_no);
+    char *end;
+    unsigned long v = strtoul(buf, &end, 10);
+    if (*end != '\0') {
+        return false;
+    }
+    *value = (uint32_t)v;
+    return true;
+}
+
+// 履歴の圧縮ブロックをそのまま送る（format=bin）
+// 形式: 'S' 'C' [ブロックのバイト数 u16 LE]、続けて[from,to]に掛かるブロックを古い順に固定長で並べる
+// 各ブロックはsensor_codecの形式で単独で復号できる（末尾の未使用部分はヘッダの件数の外）
+static void history_send_blocks(httpd_req_t *req, json_chunk_writer_t *writer, const sensor_history_t *history,
+                                uint32_t from_ms, uint32_t to_ms)
+{
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    writer->req = req;
+    writer->len = 0;
+
+    const char header[4] = { 'S', 'C', (char)(SENSOR_HISTORY_BLOCK_BYTES & 0xFF), (char)(SENSOR_HISTORY_BLOCK_BYTES >> 8) };
+    json_chunk_append(writer, header, sizeof(header));
+
+    size_t sent = 0;
+    size_t count = sensor_history_block_count(history);
+    for (size_t i = sensor_history_find_block(history, from_ms); i < count; i++) {
+        const uint8_t *block = sensor_history_block(history, i);
+        if ((int32_t)(sensor_codec_block_first_ms(block) - to_ms) > 0) {
+            break;
+        }
+        json_chunk_append(writer, (const char *)block, SENSOR_HISTORY_BLOCK_BYTES);
+        sent++;
+    }
+    json_chunk_flush(writer);
+    httpd_resp_send_chunk(req, NULL, 0);
+
+    syslog(DEBUG, "sensor_history_handler: returning %u blocks", (unsigned int)sent);
+}
+
+// フラッシュに保存した履歴ブロックのうち子機のものを古い順に送る（format=bin&source=flash）
+// 形式: 'S' 'L' [ブロックのバイト数 u16 LE][今回の起動番号 u16 LE]、続けて[起動番号 u16 LE][ブロック]を並べる
+// ブロックの時刻は書いた時の起動からのmsのため、起動番号が今回と異なるものは今回の時刻と比べられない
+static void history_send_stored(httpd_req_t *req, json_chunk_writer_t *writer, uint8_t child_no)
+{
+    history_log_iter_t it;
+    if (!history_store_iter_begin(&it)) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "history store not available");
         return;
     }
-    
-    if (s_sensor_data_mutex == NULL) {
-        syslog(WARN, "web_server_update_sensor_data: mutex not initialized");
+    history_store_stats_t stats;
+    history_store_get_stats(&stats);
+
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    writer->req = req;
+    writer->len = 0;
+
+    const char header[6] = { 'S', 'L', (char)(SENSOR_HISTORY_BLOCK_BYTES & 0xFF), (char)(SENSOR_HISTORY_BLOCK_BYTES >> 8),
+                             (char)(stats.boot & 0xFF), (char)(stats.boot >> 8) };
+    json_chunk_append(writer, header, sizeof(header));
+
+    static history_log_record_t record;
+    size_t sent = 0;
+    while (history_store_iter_next(&it, &record)) {
+        if (record.child_no != child_no) {
+            continue;
+        }
+        const char boot[2] = { (char)(record.boot & 0xFF), (char)(record.boot >> 8) };
+        json_chunk_append(writer, boot, sizeof(boot));
+        json_chunk_append(writer, (const char *)record.block, SENSOR_HISTORY_BLOCK_BYTES);
+        sent++;
+    }
+    json_chunk_flush(writer);
+    httpd_resp_send_chunk(req, NULL, 0);
+
+    syslog(DEBUG, "sensor_history_handler: N=%d returning %u stored blocks", child_no, (unsigned int)sent);
+}
+
+// 履歴ハンドラ: 子機の測定値履歴のうち指定範囲を返す
+// クエリ: child=子機No（必須）、from=開始時刻、to=終了時刻（起動からのms、省略時は保持している最古・最新）、
+//         format=bin（圧縮ブロックのまま返す、history_send_blocks参照）、
+//         format=bin&source=flash（フラッシュに保存した過去の起動分を含むブロック、history_send_stored参照）
+// 形式: {"child_no":1,"now_ms":..,"oldest_ms":..,"newest_ms":..,
+//        "samples":[{"t":..,"seq":..,"aht_t01":...},...],"count":..}
+// 時間索引で開始時刻を含むブロックから復号し、範囲内のレコードだけを分割送信する（RSSIは保持しない）
+static esp_err_t sensor_history_handler(httpd_req_t *req)
+{
+    char query[96];
+    uint32_t child_no;
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK ||
+        !query_get_u32(query, "child", &child_no) || child_no < CHILD_NO_MIN || child_no > CHILD_NO_MAX) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "child=1..254 is required");
+        return ESP_OK;
+    }
+
+    // フラッシュに保存した分は、今は登録されていない子機も返す
+    static json_chunk_writer_t writer;
+    char format[8];
+    char source[8];
+    bool binary = httpd_query_key_value(query, "format", format, sizeof(format)) == ESP_OK &&
+                  strcmp(format, "bin") == 0;
+    if (binary && httpd_query_key_value(query, "source", source, sizeof(source)) == ESP_OK &&
+        strcmp(source, "flash") == 0) {
+        history_send_stored(req, &writer, (uint8_t)child_no);
+        return ESP_OK;
+    }
+
+    // 1子機分をロック内で写し、ロックの外で復号する（httpdタスク専用の静的領域）
+    static sensor_history_t history;
+    if (!child_registry_copy_history((uint8_t)child_no, &history)) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "child not registered");
+        return ESP_OK;
+    }
+
+    uint32_t oldest_ms = 0;
+    uint32_t newest_ms = 0;
+    bool has_history = sensor_history_span(&history, &oldest_ms, &newest_ms);
+    uint32_t from_ms = oldest_ms;
+    uint32_t to_ms = newest_ms;
+    query_get_u32(query, "from", &from_ms);
+    query_get_u32(query, "to", &to_ms);
+
+    if (binary) {
+        history_send_blocks(req, &writer, &history, from_ms, to_ms);
+        return ESP_OK;
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    writer.req = req;
+    writer.len = 0;
+
+    static char item[SENSOR_DATA_JSON_MAX + 64];
+    int len = snprintf(item, sizeof(item),
+        "{\"child_no\":%lu,\"now_ms\":%lu,\"oldest_ms\":%lu,\"newest_ms\":%lu,\"samples\":[",
+        (unsigned long)child_no, (unsigned long)(xTaskGetTickCount() * portTICK_PERIOD_MS),
+        (unsigned long)oldest_ms, (unsigned long)newest_ms);
+    json_chunk_append(&writer, item, (size_t)len);
+
+    size_t count = 0;
+    if (has_history) {
+        sensor_history_iter_t it;
+        uint32_t time_ms;
+        temp_sens_data_t data;
+        sensor_history_seek(&it, &history, from_ms);
+        while (sensor_history_next(&it, &time_ms, &data) && (int32_t)(time_ms - to_ms) <= 0) {
+            len = snprintf(item, sizeof(item), "%s{\"t\":%lu,\"seq\":%lu,",
+                           (count > 0) ? "," : "", (unsigned long)time_ms, (unsigned long)data.seq);
+            len += (int)sensor_data_write_json(&data, &item[len], sizeof(item) - len);
+            item[len++] = '}';
+            json_chunk_append(&writer, item, (size_t)len);
+            count++;
+        }
+    }
+
+    len = snprintf(item, sizeof(item), "],\"count\":%u}", (unsigned int)count);
+    json_chunk_append(&writer, item, (size_t)len);
+    json_chunk_flush(&writer);
+    httpd_resp_send_chunk(req, NULL, 0);
+
+    syslog(DEBUG, "sensor_history_handler: N=%lu returning %u samples", (unsigned long)child_no, (unsigned int)count);
+    return ESP_OK;
+}
+
+// 集計バケットをJSONで追記（空ならnull）
+// 形式: {"start_ms":..,"samples":..,"channels":{"aht_t01":{"count":..,"min":..,"max":..,"mean":..,"sum":..,"sum_sq":..},...}}
+// 値はチャネルの10^decimals倍の整数（sum_sqは10^(2*decimals)倍）、測定値のないチャネルはnull
+static void rollup_bucket_append(json_chunk_writer_t *writer, const sensor_rollup_bucket_t *bucket)
+{
+    if (bucket->samples == 0) {
+        json_chunk_append(writer, "null", 4);
         return;
     }
-    
-    xSemaphoreTake(s_sensor_data_mutex, portMAX_DELAY);
-    int idx = child_no - 1;  // 0-3に変換
-    memcpy(&s_child_sensor_data[idx].data, data, sizeof(temp_sens_data_t));
-    s_child_sensor_data[idx].is_valid = true;
-    s_child_sensor_data[idx].last_update_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
-    xSemaphoreGive(s_sensor_data_mutex);
-    
-    syslog(INFO, "Web server sensor data updated: Child %d AHT T=%.1fC RH=%.1f%% BMP T=%.1fC P=%.1fhPa RSSI=%d dBm seq=%lu",
-           child_no,
-           (float)data->aht_t01 / 10.0f,
-           (float)data->aht_rh01 / 10.0f,
-           (float)data->bmp_t01 / 10.0f,
-           (float)data->bmp_p01 / 10.0f,
-           data->rssi,
-           (unsigned long)data->seq);
+
+    char item[128 + SENSOR_DATA_JSON_MAX];     // 数値6個とキー1つ（キーの長さはJSON全体の最大長で抑える）
+    int len = snprintf(item, sizeof(item), "{\"start_ms\":%lu,\"samples\":%lu,\"channels\":{",
+                       (unsigned long)bucket->start_ms, (unsigned long)bucket->samples);
+    json_chunk_append(writer, item, (size_t)len);
+    for (int ch = 0; ch < SENSOR_CH_COUNT; ch++) {
+        const sensor_channel_t *info = sensor_channel_get((sensor_ch_t)ch);
+        const sensor_rollup_stat_t *stat = &bucket->ch[ch];
+        if (stat->count == 0) {
+            len = snprintf(item, sizeof(item), "%s\"%s\":null", (ch > 0) ? "," : "", info->key);
+        } else {
+            len = snprintf(item, sizeof(item),
+                "%s\"%s\":{\"count\":%lu,\"min\":%ld,\"max\":%ld,\"mean\":%ld,\"sum\":%lld,\"sum_sq\":%llu}",
+                (ch > 0) ? "," : "", info->key, (unsigned long)stat->count, (long)stat->min, (long)stat->max,
+                (long)sensor_rollup_mean(stat), (long long)stat->sum, (unsigned long long)stat->sum_sq);
+        }
+        json_chunk_append(writer, item, (size_t)len);
+    }
+    json_chunk_append(writer, "}}", 2);
 }
 
-// 後方互換性のため（既存コード用）
-void web_server_update_sensor_data(const temp_sens_data_t *data)
+// 集計ハンドラ: 子機の1分・1時間・1日の集計（集計中と直前に閉じたバケット）を返す
+// クエリ: child=子機No（必須）、level=minute/hour/day（省略時はすべて）
+// 形式: {"child_no":1,"now_ms":..,"levels":[{"level":"minute","period_ms":60000,"open":{..},"closed":{..}},...]}
+// 測定値が来ないまま周期を過ぎた集計中バケットは、写した後に現在時刻で閉じてから返す
+static esp_err_t sensor_rollup_handler(httpd_req_t *req)
 {
-    // 子機番号が不明な場合は、最初の有効な子機または子機1に保存
-    web_server_update_sensor_data_with_child_no(1, data);
+    char query[64];
+    uint32_t child_no;
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK ||
+        !query_get_u32(query, "child", &child_no) || child_no < CHILD_NO_MIN || child_no > CHILD_NO_MAX) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "child=1..254 is required");
+        return ESP_OK;
+    }
+    int only_level = -1;
+    char level_name[8];
+    if (httpd_query_key_value(query, "level", level_name, sizeof(level_name)) == ESP_OK) {
+        for (int level = 0; level < SENSOR_ROLLUP_LEVELS; level++) {
+            if (strcmp(level_name, sensor_rollup_level_name((sensor_rollup_level_t)level)) == 0) {
+                only_level = level;
+            }
+        }
+        if (only_level < 0) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "level must be minute, hour or day");
+            return ESP_OK;
+        }
+    }
+
+    // 1子機分をロック内で写す（httpdタスク専用の静的領域）
+    static sensor_rollup_t rollup;
+    static json_chunk_writer_t writer;
+    if (!child_registry_copy_rollup((uint8_t)child_no, &rollup)) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "no rollup for this child");
+        return ESP_OK;
+    }
+    uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    sensor_rollup_roll(&rollup, now_ms);
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    writer.req = req;
+    writer.len = 0;
+
+    char item[96];
+    int len = snprintf(item, sizeof(item), "{\"child_no\":%lu,\"now_ms\":%lu,\"levels\":[",
+                       (unsigned long)child_no, (unsigned long)now_ms);
+    json_chunk_append(&writer, item, (size_t)len);
+    bool first = true;
+    for (int level = 0; level < SENSOR_ROLLUP_LEVELS; level++) {
+        if (only_level >= 0 && level != only_level) {
+            continue;
+        }
+        len = snprintf(item, sizeof(item), "%s{\"level\":\"%s\",\"period_ms\":%lu,\"open\":",
+                       first ? "" : ",", sensor_rollup_level_name((sensor_rollup_level_t)level),
+                       (unsigned long)sensor_rollup_period_ms((sensor_rollup_level_t)level));
+        json_chunk_append(&writer, item, (size_t)len);
+        rollup_bucket_append(&writer, &rollup.open[level]);
+        json_chunk_append(&writer, ",\"closed\":", 10);
+        rollup_bucket_append(&writer, &rollup.closed[level]);
+        json_chunk_append(&writer, "}", 1);
+        first = false;
+    }
+    json_chunk_append(&writer, "]}", 2);
+    json_chunk_flush(&writer);
+    httpd_resp_send_chunk(req, NULL, 0);
+    return ESP_OK;
 }
 
-// 子機センサーデータ取得（SSD1306表示用）
-bool web_server_get_child_sensor_data(uint8_t child_no, temp_sens_data_t *data)
+// 区間の遅延ヒストグラムをJSONで追記
+// 形式: "recv_commit":{"count":..,"mean_us":..,"p50_us":..,"p90_us":..,"p99_us":..,"max_us":..,"hist":[..]}
+// hist[i]は2^i～2^(i+1)-1µs（hist[0]は0～1µs）の件数、最後の空でないバケットまで
+static void latency_stage_append(json_chunk_writer_t *writer, latency_stage_t stage)
 {
-    if (data == NULL) {
-        return false;
+    latency_hist_t hist;
+    latency_trace_get(stage, &hist);
+    char item[192];
+    int len = snprintf(item, sizeof(item),
+        "%s\"%s\":{\"count\":%lu,\"mean_us\":%lu,\"p50_us\":%lu,\"p90_us\":%lu,\"p99_us\":%lu,\"max_us\":%lu,\"hist\":[",
+        (stage > 0) ? "," : "", latency_trace_stage_name(stage), (unsigned long)hist.count,
+        (unsigned long)latency_hist_mean_us(&hist), (unsigned long)latency_hist_percentile_us(&hist, 500),
+        (unsigned long)latency_hist_percentile_us(&hist, 900), (unsigned long)latency_hist_percentile_us(&hist, 990),
+        (unsigned long)hist.max_us);
+    json_chunk_append(writer, item, (size_t)len);
+
+    size_t used = LATENCY_HIST_BUCKETS;
+    while (used > 0 && hist.buckets[used - 1] == 0) {
+        used--;
+    }
+    for (size_t i = 0; i < used; i++) {
+        len = snprintf(item, sizeof(item), "%s%lu", (i > 0) ? "," : "", (unsigned long)hist.buckets[i]);
+        json_chunk_append(writer, item, (size_t)len);
     }
+    json_chunk_append(writer, "]}", 2);
+}
+
+// 受信統計ハンドラ: 受信リング統計と子機ごとのseq追跡統計（リンク品質・取りこぼしの確認用）
+// 形式: {"ingest_ring":{"capacity":..,"used":..,"high_water":..,"overflow":..,"coalesce_bursts":..,"superseded":..},
+//        "store":{"writes":..,"reads":..,"snapshots":..,"retries":..,"yields":..,"version":..,"notifies":..},
+//        "timers":{"armed":..,"fired":..,"stale":..,"expired":..},
+//        "history_store":{"ready":..,"sectors":..,"used_sectors":..,"boot":..,"head_seq":..,"min_erases":..,"max_erases":..,
+//                         "appends":..,"erases":..,"write_errors":..,"sealed":..,"dropped":..,"pending":..},
+//        "latency":{"recv_commit":{..},"commit_http":{..},"commit_display":{..},"recv_http":{..},"recv_display":{..}},
+//        "admission":{"enabled":..,"rate":..,"burst":..,"sources":..,"admitted":..,"dropped":..,"dropping":[{"ip":"..","admitted":..,"dropped":..},...]},
+//        "report_control":{"interval_ms":..,"backoff":..,"overloaded":..,"viewer":..,"display":..,"ctrl_seq":..,"sent":..,"send_errors":..},
+//        "tx_schedule":{"enabled":..,"scheduled":..,"aligned":..,"jitter_ms":..,"close_permille":..,"loss_permille":..,"shifts":..},
+//        "total":{"received":..,"lost":..,...},"children":[{"child_no":1,"received":..,...,"jitter_ms":..},...]}
+static esp_err_t sensor_stats_handler(httpd_req_t *req)
+{
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
     
-    if (child_no < 1 || child_no > 4) {
-        memset(data, 0, sizeof(temp_sens_data_t));
-        return false;
+    static child_registry_ref_t refs[CHILD_REGISTRY_MAX_NODES];
+    static json_chunk_writer_t writer;
+    size_t count = child_registry_list(refs, CHILD_REGISTRY_MAX_NODES);
+    
+    child_seq_stats_t st;
+    child_registry_get_seq_totals(&st);
+    wifi_ingest_stats_t ingest;
+    wifi_get_ingest_stats(&ingest);
+    
+    char item[192];
+    writer.req = req;
+    writer.len = 0;
+    
+    int len = snprintf(item, sizeof(item),
+        "{\"ingest_ring\":{\"capacity\":%lu,\"used\":%lu,\"high_water\":%lu,\"overflow\":%lu,"
+        "\"coalesce_bursts\":%lu,\"superseded\":%lu},",
+        (unsigned long)ingest.ring.capacity, (unsigned long)ingest.ring.count,
+        (unsigned long)ingest.ring.high_water, (unsigned long)ingest.ring.overflow,
+        (unsigned long)ingest.coalesce_bursts, (unsigned long)ingest.superseded);
+    json_chunk_append(&writer, item, (size_t)len);
+    
+    // 子機の公開ビュー（読み出しが受信と重なってやり直した回数）
+    child_view_stats_t view_stats;
+    child_registry_get_view_stats(&view_stats);
+    len = snprintf(item, sizeof(item),
+        "\"store\":{\"writes\":%lu,\"reads\":%lu,\"snapshots\":%lu,\"retries\":%lu,\"yields\":%lu,"
+        "\"version\":%lu,\"notifies\":%lu},",
+        (unsigned long)view_stats.publishes, (unsigned long)view_stats.reads, (unsigned long)view_stats.snapshots,
+        (unsigned long)view_stats.retries, (unsigned long)view_stats.yields,
+        (unsigned long)view_stats.version, (unsigned long)view_stats.notifies);
+    json_chunk_append(&writer, item, (size_t)len);
+    
+    // STALE判定・スロット解放の期限（タイマーホイール）
+    child_timer_stats_t timer_stats;
+    child_registry_get_timer_stats(&timer_stats);
+    len = snprintf(item, sizeof(item),
+        "\"timers\":{\"armed\":%lu,\"fired\":%lu,\"stale\":%lu,\"expired\":%lu},",
+        (unsigned long)timer_stats.armed, (unsigned long)timer_stats.fired,
+        (unsigned long)timer_stats.stale, (unsigned long)timer_stats.expired);
+    json_chunk_append(&writer, item, (size_t)len);
+    
+    // 履歴のフラッシュ保存（閉じたブロックの保存待ちと、ログ領域の消去回数）
+    history_store_stats_t store;
+    history_store_get_stats(&store);
+    child_sealed_stats_t sealed;
+    child_registry_get_sealed_stats(&sealed);
+    len = snprintf(item, sizeof(item),
+        "\"history_store\":{\"ready\":%s,\"sectors\":%u,\"used_sectors\":%u,\"boot\":%u,\"head_seq\":%lu,"
+        "\"min_erases\":%lu,\"max_erases\":%lu,",
+        store.ready ? "true" : "false", (unsigned int)store.sectors, (unsigned int)store.used_sectors,
+        (unsigned int)store.boot, (unsigned long)store.head_seq,
+        (unsigned long)store.min_erases, (unsigned long)store.max_erases);
+    json_chunk_append(&writer, item, (size_t)len);
+    len = snprintf(item, sizeof(item),
+        "\"appends\":%lu,\"erases\":%lu,\"write_errors\":%lu,\"sealed\":%lu,\"dropped\":%lu,\"pending\":%lu},",
+        (unsigned long)store.log.appends, (unsigned long)store.log.erases, (unsigned long)store.log.write_errors,
+        (unsigned long)sealed.sealed, (unsigned long)sealed.dropped, (unsigned long)sealed.pending);
+    json_chunk_append(&writer, item, (size_t)len);
+    
+    // 測定値の区間ごとの遅延（ソケット受信・公開・HTTP・表示、latency_trace）
+    json_chunk_append(&writer, "\"latency\":{", 11);
+    for (int stage = 0; stage < LATENCY_STAGES; stage++) {
+        latency_stage_append(&writer, (latency_stage_t)stage);
     }
+    json_chunk_append(&writer, "},", 2);
     
-    if (s_sensor_data_mutex == NULL) {
-        memset(data, 0, sizeof(temp_sens_data_t));
-        return false;
+    // 送信元ごとのレート制限（捨てたことのある送信元のみ列挙、0.0.0.0は表に入りきらなかった送信元の合計）
+    static ingest_admission_source_t drops[INGEST_ADMIT_MAX_SOURCES + 1];
+    size_t drop_count = wifi_list_admission_drops(drops, INGEST_ADMIT_MAX_SOURCES + 1);
+    len = snprintf(item, sizeof(item),
+        "\"admission\":{\"enabled\":%s,\"rate\":%lu,\"burst\":%lu,\"sources\":%lu,\"admitted\":%lu,\"dropped\":%lu,\"dropping\":[",
+        ingest.admission_enabled ? "true" : "false",
+        (unsigned long)ingest.admission.rate_per_sec, (unsigned long)ingest.admission.burst,
+        (unsigned long)ingest.admission.sources, (unsigned long)ingest.admission.admitted,
+        (unsigned long)ingest.admission.dropped);
+    json_chunk_append(&writer, item, (size_t)len);
+    for (size_t i = 0; i < drop_count; i++) {
+        char ip_str[16];
+        struct in_addr addr = { .s_addr = drops[i].source_ip };
+        inet_ntop(AF_INET, &addr, ip_str, sizeof(ip_str));
+        len = snprintf(item, sizeof(item), "%s{\"ip\":\"%s\",\"admitted\":%lu,\"dropped\":%lu}",
+                       i == 0 ? "" : ",", ip_str, (unsigned long)drops[i].admitted, (unsigned long)drops[i].dropped);
+        json_chunk_append(&writer, item, (size_t)len);
     }
+    json_chunk_append(&writer, "]},", 3);
     
-    xSemaphoreTake(s_sensor_data_mutex, portMAX_DELAY);
-    int idx = child_no - 1;  // 0-3に変換
-    uint32_t current_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    report_control_status_t ctrl;
+    report_control_get_status(&ctrl);
+    len = snprintf(item, sizeof(item),
+        "\"report_control\":{\"interval_ms\":%lu,\"backoff\":%u,\"overloaded\":%s,\"viewer\":%s,\"display\":%s,"
+        "\"ctrl_seq\":%u,\"sent\":%lu,\"send_errors\":%lu},",
+        (unsigned long)ctrl.interval_ms, (unsigned int)ctrl.backoff, ctrl.overloaded ? "true" : "false",
+        ctrl.viewer_active ? "true" : "false", ctrl.display_active ? "true" : "false",
+        (unsigned int)ctrl.ctrl_seq, (unsigned long)ctrl.frames_sent, (unsigned long)ctrl.send_errors);
+    json_chunk_append(&writer, item, (size_t)len);
     
-    // タイムアウトチェック（10秒以上更新がない場合は0を返す）
-    if (s_child_sensor_data[idx].is_valid) {
-        uint32_t elapsed_ms = current_ms - s_child_sensor_data[idx].last_update_ms;
-        if (elapsed_ms >= CHILD_DATA_TIMEOUT_MS) {
-            // タイムアウト：データを0にクリア
-            memset(data, 0, sizeof(temp_sens_data_t));
-            s_child_sensor_data[idx].is_valid = false;
-            xSemaphoreGive(s_sensor_data_mutex);
-            return false;
-        } else {
-            // 有効なデータ
-            memcpy(data, &s_child_sensor_data[idx].data, sizeof(temp_sens_data_t));
-            xSemaphoreGive(s_sensor_data_mutex);
+    len = snprintf(item, sizeof(item),
+        "\"tx_schedule\":{\"enabled\":%s,\"scheduled\":%lu,\"aligned\":%lu,\"jitter_ms\":%lu,"
+        "\"close_permille\":%u,\"loss_permille\":%u,\"shifts\":%lu},",
+        ctrl.schedule_enabled ? "true" : "false", (unsigned long)ctrl.scheduled_children,
+        (unsigned long)ctrl.aligned_children, (unsigned long)ctrl.jitter_ms,
+        (unsigned int)ctrl.close_permille, (unsigned int)ctrl.loss_permille, (unsigned long)ctrl.phase_shifts);
+    json_chunk_append(&writer, item, (size_t)len);
+    
+    len = snprintf(item, sizeof(item),
+        "\"total\":{\"received\":%lu,\"lost\":%lu,\"duplicate\":%lu,\"reordered\":%lu,\"resync\":%lu},\"children\":[",
+        (unsigned long)st.received, (unsigned long)st.lost, (unsigned long)st.duplicate,
+        (unsigned long)st.reordered, (unsigned long)st.resync);
+    json_chunk_append(&writer, item, (size_t)len);
+    
+    bool first = true;
+    for (size_t i = 0; i < count; i++) {
+        tx_phase_t phase;
+        if (!child_registry_get_seq_stats(refs[i].child_no, &st) ||
+            !child_registry_get_tx_phase(refs[i].child_no, &phase)) {
+            continue;  // 列挙後に解放された
+        }
+        len = snprintf(item, sizeof(item),
+            "%s{\"child_no\":%d,\"last_seq\":%lu,\"received\":%lu,\"lost\":%lu,\"duplicate\":%lu,\"reordered\":%lu,\"resync\":%lu,"
+            "\"jitter_ms\":%lu}",
+            first ? "" : ",", refs[i].child_no,
+            (unsigned long)st.last_seq, (unsigned long)st.received, (unsigned long)st.lost,
+            (unsigned long)st.duplicate, (unsigned long)st.reordered, (unsigned long)st.resync,
+            (unsigned long)tx_phase_jitter_ms(&phase));
+        json_chunk_append(&writer, item, (size_t)len);
+        first = false;
+    }
+    
+    json_chunk_append(&writer, "]}", 2);
+    json_chunk_flush(&writer);
+    httpd_resp_send_chunk(req, NULL, 0);
+    return ESP_OK;
+}
+
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+// 通知先の数を数え直す（httpdタスクから呼ぶ）
+static void ws_count_clients(void)
+{
+    uint32_t clients = 0;
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (s_ws_fds[i] >= 0) {
+            clients++;
+        }
+    }
+    s_ws_clients = clients;
+}
+
+static bool ws_client_add(int fd)
+{
+    int free_index = -1;
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (s_ws_fds[i] == fd) {
             return true;
         }
-    } else {
-        // 無効なデータ
-        memset(data, 0, sizeof(temp_sens_data_t));
-        xSemaphoreGive(s_sensor_data_mutex);
+        if (s_ws_fds[i] < 0 && free_index < 0) {
+            free_index = i;
+        }
+    }
+    if (free_index < 0) {
         return false;
     }
+    s_ws_fds[free_index] = fd;
+    ws_count_clients();
+    return true;
+}
+
+// 全クライアントへ更新通知を送る（httpd_queue_workでhttpdタスクから呼ばれる、argは公開ビューのバージョン）
+static void ws_push_work(void *arg)
+{
+    char msg[32];
+    int len = snprintf(msg, sizeof(msg), "{\"version\":%lu}", (unsigned long)(uintptr_t)arg);
+    httpd_ws_frame_t frame = {
+        .final   = true,
+        .type    = HTTPD_WS_TYPE_TEXT,
+        .payload = (uint8_t *)msg,
+        .len     = (size_t)len,
+    };
+
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        int fd = s_ws_fds[i];
+        if (fd < 0) {
+            continue;
+        }
+        // 切断済み（ソケットが通常のHTTP接続に再利用された場合も含む）なら外す
+        if (httpd_ws_get_fd_info(s_server, fd) != HTTPD_WS_CLIENT_WEBSOCKET ||
+            httpd_ws_send_frame_async(s_server, fd, &frame) != ESP_OK) {
+            s_ws_fds[i] = -1;
+        }
+    }
+    ws_count_clients();
 }
 
+// WebSocketハンドラ: /sensor/ws（サーバーから通知するだけで、クライアントからのフレームは読み捨てる）
+static esp_err_t sensor_ws_handler(httpd_req_t *req)
+{
+    if (req->method == HTTP_GET) {
+        // ハンドシェイク完了: 通知先に登録（満杯なら切断し、クライアントは周期取得を続ける）
+        if (!ws_client_add(httpd_req_to_sockfd(req))) {
+            syslog(WARN, "sensor_ws_handler: too many clients (max %d)", WS_MAX_CLIENTS);
+            return ESP_FAIL;
+        }
+        syslog(INFO, "sensor_ws_handler: client connected (%lu)", (unsigned long)s_ws_clients);
+        return ESP_OK;
+    }
+
+    httpd_ws_frame_t frame = { 0 };
+    uint8_t buf[16];
+    esp_err_t ret = httpd_ws_recv_frame(req, &frame, 0);  // 長さのみ取得
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (frame.len > sizeof(buf)) {
+        return ESP_FAIL;
+    }
+    if (frame.len > 0) {
+        frame.payload = buf;
+        ret = httpd_ws_recv_frame(req, &frame, frame.len);
+    }
+    return ret;
+}
+#endif
+
+bool web_server_has_viewer(void)
+{
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+    if (s_ws_clients > 0) {
+        return true;
+    }
+#endif
+    if (!s_polled) {
+        return false;
+    }
+    uint32_t current_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    return (current_ms - s_last_poll_ms) < WEB_VIEWER_TIMEOUT_MS;
+}
 
 // HTTPサーバー開始
 static void start_web_server(void)
@@ -394,6 +949,65 @@ static void start_web_server(void)
             syslog(ERR, "Failed to register sensor data handler: %d", ret);
         }
         
+        // 受信統計ハンドラ
+        httpd_uri_t sensor_stats_uri = {
+            .uri       = "/sensor/stats",
+            .method    = HTTP_GET,
+            .handler   = sensor_stats_handler,
+            .user_ctx  = NULL
+        };
+        ret = httpd_register_uri_handler(s_server, &sensor_stats_uri);
+        if (ret == ESP_OK) {
+            syslog(INFO, "Sensor stats handler registered: /sensor/stats");
+        } else {
+            syslog(ERR, "Failed to register sensor stats handler: %d", ret);
+        }
+        
+        // 履歴ハンドラ
+        httpd_uri_t sensor_history_uri = {
+            .uri       = "/sensor/history",
+            .method    = HTTP_GET,
+            .handler   = sensor_history_handler,
+            .user_ctx  = NULL
+        };
+        ret = httpd_register_uri_handler(s_server, &sensor_history_uri);
+        if (ret == ESP_OK) {
+            syslog(INFO, "Sensor history handler registered: /sensor/history");
+        } else {
+            syslog(ERR, "Failed to register sensor history handler: %d", ret);
+        }
+        
+        // 集計ハンドラ
+        httpd_uri_t sensor_rollup_uri = {
+            .uri       = "/sensor/rollup",
+            .method    = HTTP_GET,
+            .handler   = sensor_rollup_handler,
+            .user_ctx  = NULL
+        };
+        ret = httpd_register_uri_handler(s_server, &sensor_rollup_uri);
+        if (ret == ESP_OK) {
+            syslog(INFO, "Sensor rollup handler registered: /sensor/rollup");
+        } else {
+            syslog(ERR, "Failed to register sensor rollup handler: %d", ret);
+        }
+        
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+        // 更新通知（WebSocket）
+        httpd_uri_t sensor_ws_uri = {
+            .uri          = "/sensor/ws",
+            .method       = HTTP_GET,
+            .handler      = sensor_ws_handler,
+            .user_ctx     = NULL,
+            .is_websocket = true
+        };
+        ret = httpd_register_uri_handler(s_server, &sensor_ws_uri);
+        if (ret == ESP_OK) {
+            syslog(INFO, "Sensor push handler registered: /sensor/ws");
+        } else {
+            syslog(ERR, "Failed to register sensor push handler: %d", ret);
+        }
+#endif
+        
         syslog(INFO, "Web server started successfully");
     } else {
         syslog(ERR, "Failed to start web server");
@@ -403,19 +1017,6 @@ static void start_web_server(void)
 // Webサーバータスク
 static void web_server_task(void *pvParameters)
 {
-    // ミューテックス作成
-    s_sensor_data_mutex = xSemaphoreCreateMutex();
-    if (s_sensor_data_mutex == NULL) {
-        syslog(ERR, "Failed to create sensor data mutex");
-        vTaskDelete(NULL);
-        return;
-    }
-    syslog(INFO, "Web server task: sensor data mutex created");
-    
-    // 初期データを0で初期化（表示用）
-    memset(s_child_sensor_data, 0, sizeof(s_child_sensor_data));
-    syslog(INFO, "Web server task: sensor data initialized for 4 children");
-    
     // WiFi接続待機
     vTaskDelay(pdMS_TO_TICKS(2000));
     
@@ -423,9 +1024,27 @@ static void web_server_task(void *pvParameters)
     
     syslog(INFO, "Web server task: running, waiting for sensor data...");
     
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+    // 子機の値が変わったら接続中のダッシュボードへ通知する
+    child_registry_subscribe(xTaskGetCurrentTaskHandle());
+    uint32_t cursor = child_registry_version();
+    while (1) {
+        uint32_t notified = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(WS_KEEPALIVE_MS));
+        uint32_t version = child_registry_version();
+        if (s_server != NULL && s_ws_clients > 0 && (version != cursor || notified == 0)) {
+            httpd_queue_work(s_server, ws_push_work, (void *)(uintptr_t)version);
+        }
+        cursor = version;
+        if (notified != 0) {
+            // 変化が続く間は通知間隔の下限まで待ち、その間の変化は次の通知にまとめる
+            vTaskDelay(pdMS_TO_TICKS(WS_PUSH_MIN_INTERVAL_MS));
+        }
+    }
+#else
     while (1) {
         vTaskDelay(pdMS_TO_TICKS(10000));
     }
+#endif
 }
 
 // 公開関数: Webサーバータスク開始
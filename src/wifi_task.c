@@ -11,15 +11,24 @@
 #include "nvs_flash.h"
 #include "esp_netif.h"
 #include "esp_netif_ip_addr.h"  // IP2STRマクロ用
+#include "esp_timer.h"         // 受信時刻（µs）用
 #include "lwip/sockets.h"
 #include "lwip/dns.h"
 #include "lwip/netdb.h"
 #include <arpa/inet.h>  // inet_ntop用
 #include "wifi_task.h"
-#include "web_server_task.h"  // temp_sens_data_t定義用、Webサーバーへのデータ送信用
 #include "log_task.h"
 #include "flash_data.h"  // SSID番号取得用
-#include "cJSON.h" 
+#include "sensor_json.h"  // 子機JSONデコード（ヒープ未使用）
+#include "sensor_frame.h" // 子機バイナリフレームデコード
+#include "sensor_legacy.h" // 旧形式 "N=..." デコード
+#include "ingest_reactor.h" // 受信リアクタ（select待ち）
+#include "child_registry.h" // 子機レジストリ
+#include "warm_restart.h"   // 再起動前の子機状態の引き継ぎ
+#include "spsc_ring.h"      // 受信段→処理段のロックフリーリング
+#include "raw_capture.h"    // 受信生データキャプチャ（デバッグ用）
+#include "report_control.h" // 子機送信間隔の下り制御
+#include "ingest_admission.h" // 送信元ごとの受信レート制限
 
 // ==== マクロ定義 ====
 #define WIFI_CONNECTED_BIT BIT0
@@ -29,12 +38,14 @@
 #define DATA_SERVER_HOST   "192.168.4.2"    // 送信先クライアントIPアドレス（APモードで接続したデバイス）
 #define DATA_SERVER_PORT   8080             // 送信先ポート番号
 #define DATA_QUEUE_SIZE    10               // データキューのサイズ
+#define DATA_RETRY_MIN_MS  1000             // 接続失敗後、次に接続を試みるまでの待ち（初回）
+#define DATA_RETRY_MAX_MS  60000            // 同（失敗のたびに倍にし、ここで頭打ち）
 
 // APモード設定（仕様書準拠）
 #define AP_SSID_PREFIX     "PE_IOT_GATEWAY_"  // SSIDプレフィックス
 #define AP_PASSWORD        "12345678"       // APのパスワード（8文字以上）
 #define AP_CHANNEL         1                 // APのチャンネル
-#define AP_MAX_CONNECTIONS 8                 // 最大接続数（子機4台 + PC等）
+#define AP_MAX_CONNECTIONS 8                 // AP直接接続の最大数（それ以上の子機はルータ/Ethernet経由で受信）
 #define AP_IP              "192.168.4.1"    // APのIPアドレス
 #define AP_GATEWAY         "192.168.4.1"    // ゲートウェイ
 #define AP_NETMASK         "255.255.255.0"  // サブネットマスク
@@ -42,205 +53,456 @@
 // UDP受信設定
 #define UDP_RECV_PORT      50000            // UDP受信ポート
 #define MAX_PAYLOAD_SIZE   256              // 最大ペイロードサイズ
-#define MAX_CHILD_NODES    4                // 最大子機数
-#define STALE_TIMEOUT_MS   5000             // STALE判定タイムアウト（5秒）
+
+// 受信段→処理段リング設定
+#define INGEST_RING_SLOTS  32               // リング要素数（2のべき乗）
+#define INGEST_RECV_CORE   0                // 受信リアクタのコア（lwIPと同じPRO_CPU）
+#define INGEST_PROC_CORE   1                // 処理タスクのコア（APP_CPU）
+#define INGEST_COALESCE_THRESHOLD 8         // リング使用数がこれ以上なら過負荷とみなし最新値に集約
 
 // ==== 内部シンボル ====
 static EventGroupHandle_t s_wifi_event_group;
 static TaskHandle_t mainTaskHandle_ = NULL;
 static QueueHandle_t s_data_queue = NULL;
 static TaskHandle_t s_data_send_task = NULL;
-static TaskHandle_t s_udp_recv_task = NULL;
 static TaskHandle_t s_child_monitor_task = NULL;
 
-// ==== 子機テーブル定義 ====
-typedef enum {
-    CHILD_STATE_ACTIVE = 0,
-    CHILD_STATE_STALE
-} child_state_t;
+// バッチフレーム展開用（処理タスク専用、スタック節約のため静的確保）
+static temp_sens_data_t s_batch_readings[SENSOR_FRAME_BATCH_MAX];
 
+// 受信データグラム（受信段が書き込み、処理段が読み出す）
 typedef struct {
-    uint8_t child_no;                    // 子機No（1-4）
-    char source_ip[16];                  // 送信元IPアドレス（文字列）
-    uint32_t last_recv_time_ms;          // 最終受信時刻（ms）
-    char latest_payload[MAX_PAYLOAD_SIZE]; // 最新受信ペイロード
-    child_state_t state;                  // 状態（ACTIVE/STALE）
-    bool is_valid;                        // エントリが有効かどうか
-} child_node_t;
+    uint32_t recv_time_ms;                  // 受信時刻（ms）
+    int64_t recv_us;                        // 受信時刻（esp_timer µs、遅延計測用）
+    struct sockaddr_in source_addr;         // 送信元アドレス
+    uint16_t len;                           // データ長
+    char data[MAX_PAYLOAD_SIZE + 1];        // データ（+1は文字列終端用）
+} ingest_slot_t;
 
-static child_node_t s_child_table[MAX_CHILD_NODES];
-static SemaphoreHandle_t s_child_table_mutex = NULL;
+static ingest_slot_t s_ingest_slots[INGEST_RING_SLOTS];
+static spsc_ring_t s_ingest_ring;
+static TaskHandle_t s_ingest_process_task = NULL;
+
+// 送信元ごとの受信レート制限（受信段のみ更新）
+static ingest_admission_t s_admission;
+static volatile bool s_admission_enabled = true;
 
 // ==== MACアドレス表示用マクロ ====
 #define MAC2STR(a) (a)[0], (a)[1], (a)[2], (a)[3], (a)[4], (a)[5]
 #define MACSTR "%02x:%02x:%02x:%02x:%02x:%02x"
 
-// ==== 子機テーブル管理関数 ====
-static void child_table_init(void)
+// ==== 子機ACTIVE状態確認関数 ====
+bool wifi_has_active_child(void)
 {
-    s_child_table_mutex = xSemaphoreCreateMutex();
-    configASSERT(s_child_table_mutex);
-    
-    for (int i = 0; i < MAX_CHILD_NODES; i++) {
-        s_child_table[i].is_valid = false;
-        s_child_table[i].child_no = 0;
-        s_child_table[i].source_ip[0] = '\0';
-        s_child_table[i].last_recv_time_ms = 0;
-        s_child_table[i].latest_payload[0] = '\0';
-        s_child_table[i].state = CHILD_STATE_STALE;
-    }
+    return child_registry_has_active();
 }
 
-static child_node_t* child_table_find_by_no(uint8_t child_no)
+// ==== SSID生成関数 ====
+static void generate_ssid(char *ssid_buf, size_t buf_size)
 {
-    for (int i = 0; i < MAX_CHILD_NODES; i++) {
-        if (s_child_table[i].is_valid && s_child_table[i].child_no == child_no) {
-            return &s_child_table[i];
-        }
-    }
-    return NULL;
+    uint32_t ssid_no = getSsidNo();
+    snprintf(ssid_buf, buf_size, "%s%lu", AP_SSID_PREFIX, (unsigned long)ssid_no);
 }
 
-static child_node_t* child_table_find_free_slot(void)
+// ==== Wi-Fiイベントハンドラ（APモード用） ====
+static void event_handler(void *arg, esp_event_base_t event_base,
+                          int32_t event_id, void *event_data)
 {
-    for (int i = 0; i < MAX_CHILD_NODES; i++) {
-        if (!s_child_table[i].is_valid) {
-            return &s_child_table[i];
-        }
+    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_AP_START) {
+        char ssid[32];
+        generate_ssid(ssid, sizeof(ssid));
+        syslog(INFO, "Wi-Fi AP started (SSID: %s)", ssid);
+        xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
+    }
+    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_AP_STOP) {
+        syslog(INFO, "Wi-Fi AP stopped");
+        xEventGroupClearBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
+    }
+    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_AP_STACONNECTED) {
+        wifi_event_ap_staconnected_t *event = (wifi_event_ap_staconnected_t *)event_data;
+        syslog(INFO, "Station " MACSTR " joined, AID=%d (子機接続)",
+               MAC2STR(event->mac), event->aid);
+    }
+    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_AP_STADISCONNECTED) {
+        wifi_event_ap_stadisconnected_t *event = (wifi_event_ap_stadisconnected_t *)event_data;
+        syslog(INFO, "Station " MACSTR " left, AID=%d (子機切断)",
+               MAC2STR(event->mac), event->aid);
     }
-    return NULL;
 }
 
-static void child_table_update(uint8_t child_no, const char* source_ip, const char* payload, uint32_t current_time_ms)
+// ==== デコード済みセンサーデータの反映 ====
+static void ingest_sensor_data(const char *format, uint8_t child_no, uint32_t source_ip, const char *source_ip_str,
+                               uint32_t current_time_ms, int64_t recv_us, temp_sens_data_t *sensor_data, bool has_seq)
 {
-    xSemaphoreTake(s_child_table_mutex, portMAX_DELAY);
-    
-    child_node_t* node = child_table_find_by_no(child_no);
-    if (node == NULL) {
-        // 新規登録
-        node = child_table_find_free_slot();
-        if (node == NULL) {
-            syslog(WARN, "Child table full, cannot register child_no=%d", child_no);
-            xSemaphoreGive(s_child_table_mutex);
-            return;
-        }
-        node->is_valid = true;
-        node->child_no = child_no;
-        strncpy(node->source_ip, source_ip, sizeof(node->source_ip) - 1);
-        node->source_ip[sizeof(node->source_ip) - 1] = '\0';
+    // 子機レジストリへ反映（登録・seq追跡・最新値の公開を1回のロックで行う）
+    // 重複は最新値に触れずに破棄、順序逆転した古い値は最新値にしない
+    // seqを送らない旧形式の子機は追跡しない
+    bool advanced = false;
+    int kept = child_registry_ingest(child_no, source_ip, current_time_ms, recv_us, sensor_data, NULL, 1, has_seq,
+                                     &advanced);
+    if (kept < 0) {
+        return;
+    }
+    if (kept == 0) {
+        syslog(DEBUG_WIFI, "[RX] %s N=%d seq=%lu duplicate dropped", format, child_no,
+               (unsigned long)sensor_data->seq);
+        return;
+    }
+    if (!advanced) {
+        syslog(DEBUG_WIFI, "[RX] %s N=%d seq=%lu late (reordered)", format, child_no,
+               (unsigned long)sensor_data->seq);
+        return;
     }
     
-    // 更新
-    node->last_recv_time_ms = current_time_ms;
-    strncpy(node->latest_payload, payload, sizeof(node->latest_payload) - 1);
-    node->latest_payload[sizeof(node->latest_payload) - 1] = '\0';
-    node->state = CHILD_STATE_ACTIVE;
-    
-    xSemaphoreGive(s_child_table_mutex);
+    char values[SENSOR_DATA_TEXT_MAX];
+    sensor_data_format(sensor_data, values, sizeof(values));
+    syslog(INFO, "[RX] %s N=%d IP=%s %s RSSI=%d dBm seq=%lu",
+           format, child_no, source_ip_str, values,
+           sensor_data->rssi,
+           (unsigned long)sensor_data->seq);
 }
 
-// ==== 子機No抽出関数 ====
-// ペイロード形式: "N=<子機No>,<現行フォーマット>"
-static int extract_child_no(const char* payload, uint8_t* child_no)
+// ==== バッチフレームの反映（1データグラム分をまとめて処理） ====
+static void ingest_sensor_batch(uint8_t child_no, uint32_t source_ip, const char *source_ip_str,
+                                uint32_t current_time_ms, int64_t recv_us, temp_sens_data_t *readings,
+                                uint16_t *age_ms, size_t count)
 {
-    if (payload == NULL || strlen(payload) < 3) {
-        return -1;
+    // 子機レジストリへ1回のロックで反映（重複を除いて前詰めし、最大seqの値を最新値として公開）
+    // 各測定値の時刻は受信時刻からage_msをさかのぼったもの
+    size_t received = count;
+    int kept = child_registry_ingest(child_no, source_ip, current_time_ms, recv_us, readings, age_ms, count, true,
+                                     NULL);
+    if (kept < 0) {
+        return;
     }
-    
-    // "N="で始まるか確認
-    if (payload[0] != 'N' || payload[1] != '=') {
-        return -1;
+    count = (size_t)kept;
+    if (count < received) {
+        syslog(DEBUG_WIFI, "[RX] BATCH N=%d dropped %u duplicate(s)", child_no, (unsigned int)(received - count));
     }
+    if (count == 0) {
+        return;
+    }
+    
+    const temp_sens_data_t *last = &readings[count - 1];
+    char values[SENSOR_DATA_TEXT_MAX];
+    sensor_data_format(last, values, sizeof(values));
+    syslog(INFO, "[RX] BATCH N=%d IP=%s count=%u seq=%lu-%lu last %s RSSI=%d dBm",
+           child_no, source_ip_str, (unsigned int)count,
+           (unsigned long)readings[0].seq, (unsigned long)last->seq,
+           values, last->rssi);
+}
+
+// ==== 受信データグラムのデコード ====
+typedef enum {
+    DECODE_READINGS = 0,    // 測定値を取得（JSON/BIN/BATCH/LEGACY）
+    DECODE_TEXT,            // 測定値なしのテキスト（子機Noのみの旧形式・不明形式）
+    DECODE_ERROR,           // フレーム異常（ログ出力済み）
+} decode_result_t;
+
+typedef struct {
+    const char *format;     // ログ用フォーマット名
+    uint8_t child_no;       // 子機No（DECODE_TEXTで旧形式でなければ0）
+    size_t count;           // readingsに格納した測定値数
+    bool has_seq;           // 測定値にseqが含まれる（旧形式はseq省略可）
+    uint16_t age_ms[SENSOR_FRAME_BATCH_MAX];    // 各測定値の受信時刻からさかのぼった測定時刻（BATCH以外は0）
+} decoded_datagram_t;
+
+static decode_result_t decode_datagram(char *recv_buf, int len, const char *source_ip_str,
+                                       decoded_datagram_t *dec, temp_sens_data_t *readings)
+{
+    dec->child_no = 0;
+    dec->count = 0;
+    dec->has_seq = true;
+    dec->age_ms[0] = 0;
     
-    // 数値を抽出
-    int no = 0;
-    int i = 2;
-    while (payload[i] >= '0' && payload[i] <= '9') {
-        no = no * 10 + (payload[i] - '0');
-        i++;
-        if (no > MAX_CHILD_NODES) {
-            return -1; // 範囲外
+    // バイナリフレーム（先頭バイトで判別、テキスト解析なし）
+    if (sensor_frame_is_batch(recv_buf, (size_t)len)) {
+        // 複数測定値のバッチフレーム
+        sensor_frame_result_t frame_result = sensor_frame_decode_batch((const uint8_t *)recv_buf, (size_t)len,
+                                                                       &dec->child_no, readings, dec->age_ms,
+                                                                       SENSOR_FRAME_BATCH_MAX, &dec->count);
+        if (frame_result != SENSOR_FRAME_OK) {
+            syslog(WARN, "[RX] BATCH frame error=%d len=%d IP=%s", frame_result, len, source_ip_str);
+            return DECODE_ERROR;
         }
+        dec->format = "BATCH";
+        return DECODE_READINGS;
     }
     
-    // カンマが続くか確認
-    if (payload[i] != ',') {
-        return -1;
+    if (sensor_frame_is_binary(recv_buf, (size_t)len)) {
+        sensor_frame_result_t frame_result = sensor_frame_decode((const uint8_t *)recv_buf, (size_t)len,
+                                                                 &dec->child_no, &readings[0]);
+        if (frame_result != SENSOR_FRAME_OK) {
+            syslog(WARN, "[RX] BIN frame error=%d len=%d IP=%s", frame_result, len, source_ip_str);
+            return DECODE_ERROR;
+        }
+        dec->format = "BIN";
+        dec->count = 1;
+        return DECODE_READINGS;
     }
     
-    if (no >= 1 && no <= MAX_CHILD_NODES) {
-        *child_no = (uint8_t)no;
-        return 0;
+    // 次にJSON形式のデータを試す（子機からのデータはJSON形式）
+    // ヒープを使わず受信バッファから直接デコードする
+    sensor_json_result_t json_result = sensor_json_decode(recv_buf, (size_t)len, &dec->child_no, &readings[0]);
+    if (json_result == SENSOR_JSON_OK) {
+        dec->format = "JSON";
+        dec->count = 1;
+        return DECODE_READINGS;
+    }
+    if (json_result == SENSOR_JSON_ERR_MISSING) {
+        syslog(WARN, "[RX] JSON parse OK but missing fields IP=%s", source_ip_str);
+        return DECODE_ERROR;
     }
     
-    return -1;
+    // JSONパース失敗、旧形式 "N=1,T=25.3,..." を試す
+    sensor_legacy_result_t legacy_result = sensor_legacy_decode(recv_buf, (size_t)len, &dec->child_no,
+                                                                &readings[0], &dec->has_seq);
+    if (legacy_result == SENSOR_LEGACY_OK) {
+        dec->format = "LEGACY";
+        dec->count = 1;
+        return DECODE_READINGS;
+    }
+    if (legacy_result != SENSOR_LEGACY_ERR_MISSING) {
+        dec->child_no = 0;
+    }
+    return DECODE_TEXT;
 }
 
-// ==== 子機ACTIVE状態確認関数 ====
-bool wifi_has_active_child(void)
+// 測定値を持たないテキスト（子機Noのみの旧形式 "N=1,..." または不明形式）
+static void process_text_datagram(char *recv_buf, uint8_t child_no, uint32_t source_ip, const char *source_ip_str,
+                                  uint32_t current_time_ms)
 {
-    if (s_child_table_mutex == NULL) {
-        return false;  // まだ初期化されていない
+    if (child_no != 0) {
+        child_registry_update(child_no, source_ip, current_time_ms);
+        syslog(INFO, "[RX] N=%d IP=%s payload=%s", child_no, source_ip_str, recv_buf);
+    } else {
+        syslog(WARN, "[RX] UNKNOWN format IP=%s payload=%s", source_ip_str, recv_buf);
     }
+}
+
+// ==== 受信データグラム処理（通常時、1件ずつ反映） ====
+static void process_datagram(char *recv_buf, int len, const struct sockaddr_in *source_addr,
+                             uint32_t current_time_ms, int64_t recv_us)
+{
+    recv_buf[len] = '\0'; // 文字列終端
     
-    xSemaphoreTake(s_child_table_mutex, portMAX_DELAY);
+    // 送信元IPアドレスを文字列に変換（ログ用）
+    uint32_t source_ip = source_addr->sin_addr.s_addr;
+    char source_ip_str[16];
+    inet_ntop(AF_INET, &source_addr->sin_addr, source_ip_str, sizeof(source_ip_str));
     
-    bool has_active = false;
-    for (int i = 0; i < MAX_CHILD_NODES; i++) {
-        if (s_child_table[i].is_valid && s_child_table[i].state == CHILD_STATE_ACTIVE) {
-            has_active = true;
-            break;
+    decoded_datagram_t dec;
+    switch (decode_datagram(recv_buf, len, source_ip_str, &dec, s_batch_readings)) {
+    case DECODE_READINGS:
+        if (sensor_frame_is_batch(recv_buf, (size_t)len)) {
+            ingest_sensor_batch(dec.child_no, source_ip, source_ip_str, current_time_ms, recv_us,
+                                s_batch_readings, dec.age_ms, dec.count);
+        } else {
+            ingest_sensor_data(dec.format, dec.child_no, source_ip, source_ip_str, current_time_ms, recv_us,
+                               &s_batch_readings[0], dec.has_seq);
         }
+        break;
+    case DECODE_TEXT:
+        process_text_datagram(recv_buf, dec.child_no, source_ip, source_ip_str, current_time_ms);
+        break;
+    case DECODE_ERROR:
+        break;
     }
+}
+
+// ==== 過負荷時の最新値集約（コアレッシング） ====
+// リングに溜まったデータグラムを子機ごとにまとめ、ログは最新値の1行だけにする
+// seq追跡・履歴・集計は全データグラムに対して行い（統計を正しく保つため）、
+// 公開ビューの更新と購読タスクへの通知はバーストの終わりに子機ごとに1回だけ行う
+typedef struct {
+    uint8_t child_no;               // 子機No
+    const char *format;             // 最新値のフォーマット名
+    char source_ip_str[16];         // 送信元IP（ログ用）
+    temp_sens_data_t latest;        // 最新値
+    uint16_t superseded;            // このバーストで後の値に置き換わったデータグラム数（公開・ログなし）
+} coalesce_entry_t;
+
+static coalesce_entry_t s_coalesce_entries[INGEST_RING_SLOTS];  // 1バーストで最大リング要素数
+static uint8_t s_coalesce_index[CHILD_NO_MAX + 1];             // 子機No → エントリ+1（0=なし）
+static size_t s_coalesce_count = 0;
+static uint32_t s_coalesce_bursts = 0;                          // 集約を行ったバースト数
+static uint32_t s_coalesce_superseded = 0;                      // 置き換わったデータグラム数（累計）
+
+static void coalesce_datagram(char *recv_buf, int len, const struct sockaddr_in *source_addr,
+                              uint32_t current_time_ms, int64_t recv_us)
+{
+    recv_buf[len] = '\0'; // 文字列終端
     
-    xSemaphoreGive(s_child_table_mutex);
+    uint32_t source_ip = source_addr->sin_addr.s_addr;
+    char source_ip_str[16];
+    inet_ntop(AF_INET, &source_addr->sin_addr, source_ip_str, sizeof(source_ip_str));
     
-    return has_active;
+    decoded_datagram_t dec;
+    decode_result_t result = decode_datagram(recv_buf, len, source_ip_str, &dec, s_batch_readings);
+    if (result == DECODE_TEXT) {
+        process_text_datagram(recv_buf, dec.child_no, source_ip, source_ip_str, current_time_ms);
+        return;
+    }
+    if (result != DECODE_READINGS) {
+        return;
+    }
+    
+    // 子機レジストリへは全データグラムを反映（公開はcoalesce_flushでまとめて行う）
+    // 重複・古い値はここで除去（最大seqを更新しない値はログの候補にしない）
+    bool advanced = false;
+    int kept = child_registry_ingest_deferred(dec.child_no, source_ip, current_time_ms, recv_us, s_batch_readings,
+                                              dec.age_ms, dec.count, dec.has_seq, &advanced);
+    if (kept <= 0 || !advanced) {
+        return;
+    }
+    size_t count = (size_t)kept;
+    
+    const temp_sens_data_t *newest = &s_batch_readings[0];
+    for (size_t i = 1; i < count; i++) {
+        if ((int32_t)(s_batch_readings[i].seq - newest->seq) > 0) {
+            newest = &s_batch_readings[i];
+        }
+    }
+    
+    coalesce_entry_t *entry;
+    if (s_coalesce_index[dec.child_no] != 0) {
+        // 同じ子機の保留中の値を新しい値で置き換える
+        entry = &s_coalesce_entries[s_coalesce_index[dec.child_no] - 1];
+        entry->superseded++;
+        s_coalesce_superseded++;
+    } else {
+        entry = &s_coalesce_entries[s_coalesce_count];
+        s_coalesce_index[dec.child_no] = (uint8_t)(++s_coalesce_count);
+        entry->child_no = dec.child_no;
+        entry->superseded = 0;
+    }
+    entry->format = dec.format;
+    strncpy(entry->source_ip_str, source_ip_str, sizeof(entry->source_ip_str));
+    entry->latest = *newest;
 }
 
-// ==== SSID生成関数 ====
-static void generate_ssid(char *ssid_buf, size_t buf_size)
+static void coalesce_flush(void)
 {
-    uint32_t ssid_no = getSsidNo();
-    snprintf(ssid_buf, buf_size, "%s%lu", AP_SSID_PREFIX, (unsigned long)ssid_no);
+    // 保留した子機を1回ずつ公開（通知もバーストで1回）
+    child_registry_publish_deferred();
+    
+    for (size_t i = 0; i < s_coalesce_count; i++) {
+        coalesce_entry_t *entry = &s_coalesce_entries[i];
+        char values[SENSOR_DATA_TEXT_MAX];
+        sensor_data_format(&entry->latest, values, sizeof(values));
+        syslog(INFO, "[RX] %s N=%d IP=%s %s RSSI=%d dBm seq=%lu (coalesced, superseded=%u)",
+               entry->format, entry->child_no, entry->source_ip_str, values,
+               entry->latest.rssi,
+               (unsigned long)entry->latest.seq,
+               (unsigned int)entry->superseded);
+        
+        s_coalesce_index[entry->child_no] = 0;
+    }
+    s_coalesce_count = 0;
 }
 
-// ==== Wi-Fiイベントハンドラ（APモード用） ====
-static void event_handler(void *arg, esp_event_base_t event_base,
-                          int32_t event_id, void *event_data)
+// ==== UDP受信ハンドラ（受信段、受信リアクタから呼ばれる） ====
+// 起床1回につき、溜まっているデータグラムをすべてリングへ読み切る
+// 解析・ロック・ログは行わず、処理段へ通知するだけ
+static void udp_sensor_socket_handler(int sock, void *ctx)
 {
-    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_AP_START) {
-        char ssid[32];
-        generate_ssid(ssid, sizeof(ssid));
-        syslog(INFO, "Wi-Fi AP started (SSID: %s)", ssid);
-        xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
-    }
-    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_AP_STOP) {
-        syslog(INFO, "Wi-Fi AP stopped");
-        xEventGroupClearBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
-    }
-    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_AP_STACONNECTED) {
-        wifi_event_ap_staconnected_t *event = (wifi_event_ap_staconnected_t *)event_data;
-        syslog(INFO, "Station " MACSTR " joined, AID=%d (子機接続)",
-               MAC2STR(event->mac), event->aid);
+    static char discard_buf[MAX_PAYLOAD_SIZE];  // リング満杯時の読み捨て用（リアクタタスク専用）
+    bool published = false;
+    
+    while (1) {
+        // リングの空き要素へ直接受信（満杯なら読み捨ててソケットを詰まらせない）
+        ingest_slot_t *slot = (ingest_slot_t *)spsc_ring_acquire(&s_ingest_ring);
+        char *buf = (slot != NULL) ? slot->data : discard_buf;
+        
+        struct sockaddr_in source_addr;
+        socklen_t addr_len = sizeof(source_addr);
+        int len = recvfrom(sock, buf, MAX_PAYLOAD_SIZE, MSG_DONTWAIT,
+                           (struct sockaddr *)&source_addr, &addr_len);
+        if (len < 0) {
+            // EWOULDBLOCK: 受信待ちデータなし
+            break;
+        }
+        if (len == 0) {
+            continue;
+        }
+        int64_t recv_us = esp_timer_get_time();   // 遅延計測の起点
+        
+        // デコード前に送信元ごとの上限を確認（超過分はリングに入れず、取得済みの要素は次の受信で再利用）
+        uint32_t recv_time_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+        if (s_admission_enabled) {
+            ingest_admit_t verdict = ingest_admission_check(&s_admission, source_addr.sin_addr.s_addr, recv_time_ms);
+            if (verdict == INGEST_ADMIT_DROP_START) {
+                char ip_str[16];
+                inet_ntop(AF_INET, &source_addr.sin_addr, ip_str, sizeof(ip_str));
+                syslog(WARN, "[ADMIT] %s exceeded %d datagrams/s, dropping", ip_str, INGEST_ADMIT_RATE_PER_SEC);
+            }
+            if (verdict != INGEST_ADMIT_PASS) {
+                continue;
+            }
+        }
+        
+        if (slot == NULL) {
+            spsc_ring_note_overflow(&s_ingest_ring);
+            continue;
+        }
+        
+        slot->recv_time_ms = recv_time_ms;
+        slot->recv_us = recv_us;
+        slot->source_addr = source_addr;
+        slot->len = (uint16_t)len;
+        spsc_ring_publish(&s_ingest_ring);
+        published = true;
     }
-    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_AP_STADISCONNECTED) {
-        wifi_event_ap_stadisconnected_t *event = (wifi_event_ap_stadisconnected_t *)event_data;
-        syslog(INFO, "Station " MACSTR " left, AID=%d (子機切断)",
-               MAC2STR(event->mac), event->aid);
+    
+    if (published && s_ingest_process_task != NULL) {
+        xTaskNotifyGive(s_ingest_process_task);
     }
 }
 
-// ==== UDP受信タスク ====
-static void udp_recv_task(void *pvParameters)
+// ==== 受信処理タスク（処理段、受信段とは別コアで動作） ====
+static void ingest_process_task(void *pvParameters)
 {
-    syslog(INFO, "UDP receive task started on port %d", UDP_RECV_PORT);
+    syslog(INFO, "Ingest process task started on core %d", xPortGetCoreID());
     
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        
+        while (1) {
+            uint32_t pending = spsc_ring_count(&s_ingest_ring);
+            if (pending == 0) {
+                break;
+            }
+            
+            ingest_slot_t *slot;
+            if (pending < INGEST_COALESCE_THRESHOLD) {
+                // 通常時: 1件ずつ反映
+                slot = (ingest_slot_t *)spsc_ring_front(&s_ingest_ring);
+                raw_capture_put(slot->source_addr.sin_addr.s_addr, slot->recv_time_ms, slot->data, slot->len);
+                process_datagram(slot->data, slot->len, &slot->source_addr, slot->recv_time_ms, slot->recv_us);
+                spsc_ring_pop(&s_ingest_ring);
+                continue;
+            }
+            
+            // 過負荷時: 溜まっている分を子機ごとに集約し、最新値のみ反映
+            for (uint32_t i = 0; i < pending; i++) {
+                slot = (ingest_slot_t *)spsc_ring_front(&s_ingest_ring);
+                raw_capture_put(slot->source_addr.sin_addr.s_addr, slot->recv_time_ms, slot->data, slot->len);
+                coalesce_datagram(slot->data, slot->len, &slot->source_addr, slot->recv_time_ms, slot->recv_us);
+                spsc_ring_pop(&s_ingest_ring);
+            }
+            coalesce_flush();
+            s_coalesce_bursts++;
+        }
+    }
+}
+
+// ==== UDP受信ソケット作成 ====
+static int udp_sensor_socket_open(void)
+{
     int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
     if (sock < 0) {
         syslog(ERR, "Failed to create UDP socket");
-        vTaskDelete(NULL);
-        return;
+        return -1;
     }
     
     struct sockaddr_in server_addr;
@@ -252,148 +514,50 @@ static void udp_recv_task(void *pvParameters)
     if (bind(sock, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
         syslog(ERR, "Failed to bind UDP socket to port %d", UDP_RECV_PORT);
         close(sock);
-        vTaskDelete(NULL);
-        return;
+        return -1;
     }
     
     syslog(INFO, "UDP socket bound to port %d", UDP_RECV_PORT);
-    
-    char recv_buf[MAX_PAYLOAD_SIZE + 1];
-    struct sockaddr_in source_addr;
-    socklen_t addr_len = sizeof(source_addr);
-    
-    while (1) {
-        // WiFi接続確認
-        EventBits_t bits = xEventGroupGetBits(s_wifi_event_group);
-        if (!(bits & WIFI_CONNECTED_BIT)) {
-            vTaskDelay(pdMS_TO_TICKS(1000));
-            continue;
-        }
-        
-        // 受信タイムアウト設定（1秒）
-        struct timeval timeout;
-        timeout.tv_sec = 1;
-        timeout.tv_usec = 0;
-        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
-        
-        int len = recvfrom(sock, recv_buf, MAX_PAYLOAD_SIZE, 0,
-                          (struct sockaddr *)&source_addr, &addr_len);
-        
-        if (len > 0) {
-            recv_buf[len] = '\0'; // 文字列終端
-            
-            // 送信元IPアドレスを文字列に変換
-            char source_ip_str[16];
-            inet_ntop(AF_INET, &source_addr.sin_addr, source_ip_str, sizeof(source_ip_str));
-            
-            uint32_t current_time_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
-            
-            // まずJSON形式のデータを試す（子機からのデータはJSON形式）
-            cJSON *json = cJSON_Parse(recv_buf);
-            if (json != NULL) {
-                cJSON *child_no_item = cJSON_GetObjectItem(json, "child_no");
-                cJSON *aht_t01_item = cJSON_GetObjectItem(json, "aht_t01");
-                cJSON *aht_rh01_item = cJSON_GetObjectItem(json, "aht_rh01");
-                cJSON *bmp_t01_item = cJSON_GetObjectItem(json, "bmp_t01");
-                cJSON *bmp_p01_item = cJSON_GetObjectItem(json, "bmp_p01");
-                cJSON *aht_ok_item = cJSON_GetObjectItem(json, "aht_ok");
-                cJSON *bmp_ok_item = cJSON_GetObjectItem(json, "bmp_ok");
-                cJSON *seq_item = cJSON_GetObjectItem(json, "seq");
-                cJSON *rssi_item = cJSON_GetObjectItem(json, "rssi");
-                
-                if (child_no_item && aht_t01_item && aht_rh01_item && 
-                    bmp_t01_item && bmp_p01_item && aht_ok_item && 
-                    bmp_ok_item && seq_item) {
-                    // JSONからセンサーデータを抽出
-                    uint8_t child_no = (uint8_t)cJSON_GetNumberValue(child_no_item);
-                    temp_sens_data_t sensor_data = {0};
-                    sensor_data.aht_t01 = (int16_t)cJSON_GetNumberValue(aht_t01_item);
-                    sensor_data.aht_rh01 = (uint16_t)cJSON_GetNumberValue(aht_rh01_item);
-                    sensor_data.bmp_t01 = (int16_t)cJSON_GetNumberValue(bmp_t01_item);
-                    sensor_data.bmp_p01 = (uint32_t)cJSON_GetNumberValue(bmp_p01_item);
-                    sensor_data.aht_ok = cJSON_IsTrue(aht_ok_item);
-                    sensor_data.bmp_ok = cJSON_IsTrue(bmp_ok_item);
-                    sensor_data.seq = (uint32_t)cJSON_GetNumberValue(seq_item);
-                    // RSSIはオプショナル（存在しない場合は0）
-                    if (rssi_item) {
-                        sensor_data.rssi = (int)cJSON_GetNumberValue(rssi_item);
-                    } else {
-                        sensor_data.rssi = 0;
-                    }
-                    
-                    // 子機テーブルを更新
-                    child_table_update(child_no, source_ip_str, recv_buf, current_time_ms);
-                    
-                    // Webサーバーに最新データを送信（子機番号付き）
-                    web_server_update_sensor_data_with_child_no(child_no, &sensor_data);
-                    
-                    syslog(INFO, "[RX] JSON N=%d IP=%s AHT T=%.1fC RH=%.1f%% BMP T=%.1fC P=%.1fhPa RSSI=%d dBm seq=%lu",
-                           child_no, source_ip_str,
-                           (float)sensor_data.aht_t01 / 10.0f,
-                           (float)sensor_data.aht_rh01 / 10.0f,
-                           (float)sensor_data.bmp_t01 / 10.0f,
-                           (float)sensor_data.bmp_p01 / 10.0f,
-                           sensor_data.rssi,
-                           (unsigned long)sensor_data.seq);
-                } else {
-                    syslog(WARN, "[RX] JSON parse OK but missing fields IP=%s", source_ip_str);
-                }
-                cJSON_Delete(json);
-            } else {
-                // JSONパース失敗、旧形式 "N=1,..." を試す
-                uint8_t child_no = 0;
-                int extract_result = extract_child_no(recv_buf, &child_no);
-                if (extract_result == 0) {
-                    child_table_update(child_no, source_ip_str, recv_buf, current_time_ms);
-                    syslog(INFO, "[RX] N=%d IP=%s payload=%s", child_no, source_ip_str, recv_buf);
-                } else {
-                    syslog(WARN, "[RX] UNKNOWN format IP=%s payload=%s", source_ip_str, recv_buf);
-                }
-            }
-        } else if (len < 0) {
-            // タイムアウトまたはエラー（正常動作）
-            // エラーログは出力しない（タイムアウトは正常）
-        }
-    }
+    return sock;
 }
 
 // ==== 子機監視タスク（STALE判定） ====
+#define CHILD_MONITOR_PERIOD_MS  1000   // 送信間隔の指示の周期
+
 static void child_monitor_task(void *pvParameters)
 {
     syslog(INFO, "Child monitor task started");
     
+    // 送信間隔の指示は1秒ごと、STALE判定・スロット解放は期限を迎える子機がある時だけ起きて行う
+    TickType_t period = pdMS_TO_TICKS(CHILD_MONITOR_PERIOD_MS);
+    TickType_t last_report_tick = xTaskGetTickCount();
+    uint32_t timer_wait_ms = CHILD_MONITOR_PERIOD_MS;
+    
     while (1) {
-        vTaskDelay(pdMS_TO_TICKS(1000)); // 1秒ごとにチェック
+        TickType_t since_report = xTaskGetTickCount() - last_report_tick;
+        TickType_t wait = (since_report < period) ? period - since_report : 0;
+        TickType_t timer_wait = (timer_wait_ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+        vTaskDelay((timer_wait < wait) ? timer_wait : wait);
         
         // WiFi接続確認
         EventBits_t bits = xEventGroupGetBits(s_wifi_event_group);
         if (!(bits & WIFI_CONNECTED_BIT)) {
+            last_report_tick = xTaskGetTickCount();
+            timer_wait_ms = CHILD_MONITOR_PERIOD_MS;
             continue;
         }
         
         uint32_t current_time_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
         
-        xSemaphoreTake(s_child_table_mutex, portMAX_DELAY);
+        // STALE判定（5秒、送信間隔を指示した子機は間隔に応じて延長）とスロット解放（60秒）
+        // 期限を迎えた子機だけを処理し、次の期限までの時間を受け取る
+        timer_wait_ms = child_registry_check_timeouts(current_time_ms);
         
-        for (int i = 0; i < MAX_CHILD_NODES; i++) {
-            if (!s_child_table[i].is_valid) {
-                continue;
-            }
-            
-            uint32_t elapsed_ms = current_time_ms - s_child_table[i].last_recv_time_ms;
-            
-            // STALE判定（5秒経過）
-            if (elapsed_ms >= STALE_TIMEOUT_MS) {
-                if (s_child_table[i].state == CHILD_STATE_ACTIVE) {
-                    // ACTIVE → STALE に遷移
-                    s_child_table[i].state = CHILD_STATE_STALE;
-                    syslog(WARN, "[STALE] N=%d last_seen=%lums", 
-                           s_child_table[i].child_no, elapsed_ms);
-                }
-            }
+        // 受信負荷・表示先に応じた送信間隔を子機へ指示
+        if (xTaskGetTickCount() - last_report_tick >= period) {
+            last_report_tick = xTaskGetTickCount();
+            report_control_tick(current_time_ms);
         }
-        
-        xSemaphoreGive(s_child_table_mutex);
     }
 }
 
@@ -402,86 +566,135 @@ static void child_monitor_task(void *pvParameters)
 static int s_sock = -1;
 static bool s_connected = false;
 static struct sockaddr_in s_server_addr;
+static uint32_t s_retry_ms = 0;             // 接続失敗後の待ち（0=失敗していない）
+static TickType_t s_retry_tick = 0;         // 次に接続を試みてよい時刻
+
+// 接続に失敗した: 次に試みるまでの待ちを倍にする（送信先がいない間、起床のたびに接続でブロックしない）
+static void data_send_backoff(void)
+{
+    s_retry_ms = (s_retry_ms == 0) ? DATA_RETRY_MIN_MS
+               : (s_retry_ms >= DATA_RETRY_MAX_MS / 2) ? DATA_RETRY_MAX_MS : s_retry_ms * 2;
+    s_retry_tick = xTaskGetTickCount() + pdMS_TO_TICKS(s_retry_ms);
+}
+
+// 送信先へ接続（接続済みなら何もしない）、WiFi未接続・接続失敗・再接続の待ち中ならfalse
+static bool data_send_connect(void)
+{
+    // WiFi接続確認
+    EventBits_t bits = xEventGroupGetBits(s_wifi_event_group);
+    if (!(bits & WIFI_CONNECTED_BIT)) {
+        syslog(DEBUG_WIFI, "WiFi not connected, skipping data send");
+        if (s_sock >= 0) {
+            close(s_sock);
+            s_sock = -1;
+            s_connected = false;
+        }
+        return false;
+    }
+    
+    // ソケット未接続の場合は接続を試みる（失敗後は待ちが明けるまで試みない）
+    if (!s_connected || s_sock < 0) {
+        if (s_retry_ms != 0 && (int32_t)(xTaskGetTickCount() - s_retry_tick) < 0) {
+            return false;
+        }
+        s_sock = socket(AF_INET, SOCK_STREAM, 0);
+        if (s_sock < 0) {
+            syslog(DEBUG_WIFI, "Failed to create socket");
+            data_send_backoff();
+            return false;
+        }
+        
+        memset(&s_server_addr, 0, sizeof(s_server_addr));
+        s_server_addr.sin_family = AF_INET;
+        s_server_addr.sin_port = htons(DATA_SERVER_PORT);
+        inet_pton(AF_INET, DATA_SERVER_HOST, &s_server_addr.sin_addr);
+        
+        // 接続タイムアウト設定
+        struct timeval timeout;
+        timeout.tv_sec = 3;
+        timeout.tv_usec = 0;
+        setsockopt(s_sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(s_sock, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        
+        if (connect(s_sock, (struct sockaddr *)&s_server_addr, sizeof(s_server_addr)) < 0) {
+            close(s_sock);
+            s_sock = -1;
+            data_send_backoff();
+            syslog(DEBUG_WIFI, "Failed to connect to %s:%d, retry in %lu ms", DATA_SERVER_HOST, DATA_SERVER_PORT,
+                   (unsigned long)s_retry_ms);
+            return false;
+        }
+        
+        s_connected = true;
+        s_retry_ms = 0;
+        syslog(DEBUG_WIFI, "Connected to %s:%d", DATA_SERVER_HOST, DATA_SERVER_PORT);
+    }
+    return true;
+}
+
+// 1件送信（JSON形式1行、チャネルはsensor_channel.hの表の順、child_no=0なら子機Noを付けない）
+// 例: {"child_no":1,"aht_t01":253,"aht_rh01":482,"bmp_t01":251,"bmp_p01":100845,"aht_ok":true,"bmp_ok":true,"seq":123}
+// 戻り値: 送信失敗（ソケットを閉じた）ならfalse
+static bool data_send_line(uint8_t child_no, const temp_sens_data_t *data)
+{
+    static char send_buf[SENSOR_DATA_JSON_MAX + 40];
+    int len = (child_no != 0) ? snprintf(send_buf, sizeof(send_buf), "{\"child_no\":%d,", child_no)
+                              : snprintf(send_buf, sizeof(send_buf), "{");
+    size_t fields = sensor_data_write_json(data, &send_buf[len], sizeof(send_buf) - len);
+    len += (int)fields;
+    len += snprintf(&send_buf[len], sizeof(send_buf) - len, ",\"seq\":%lu}\n", (unsigned long)data->seq);
+    
+    int sent = send(s_sock, send_buf, len, 0);
+    if (sent < 0) {
+        syslog(DEBUG_WIFI, "Failed to send data, closing socket");
+        close(s_sock);
+        s_sock = -1;
+        s_connected = false;
+        return false;
+    }
+    syslog(DEBUG_WIFI, "Sent temp sens data: N=%d seq=%lu", child_no, (unsigned long)data->seq);
+    return true;
+}
 
 static void data_send_task(void *pvParameters)
 {
     syslog(DEBUG_WIFI, "Data send task started");
     
+    // 子機の値が変わった時（またはキューに積まれた時）だけ起き、変わった子機の最新値だけを送る
+    static child_view_t views[CHILD_REGISTRY_MAX_NODES];
+    child_registry_subscribe(xTaskGetCurrentTaskHandle());
+    uint32_t cursor = child_registry_version();
+    
     while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        
+        // キュー経由の送信（wifi_send_temp_sens_data）
+        // 接続は起床ごとに1回だけ試み、未接続の間に積まれた分は送らずに捨てる
         temp_sens_data_t data;
+        bool connected = (uxQueueMessagesWaiting(s_data_queue) > 0) && data_send_connect();
+        while (xQueueReceive(s_data_queue, &data, 0) == pdTRUE) {
+            if (connected) {
+                connected = data_send_line(0, &data);
+            }
+        }
         
-        // キューからデータを受信（タイムアウト: 1秒）
-        if (xQueueReceive(s_data_queue, &data, pdMS_TO_TICKS(1000)) == pdTRUE) {
-            
-            // WiFi接続確認
-            EventBits_t bits = xEventGroupGetBits(s_wifi_event_group);
-            if (!(bits & WIFI_CONNECTED_BIT)) {
-                syslog(DEBUG_WIFI, "WiFi not connected, skipping data send");
-                if (s_sock >= 0) {
-                    close(s_sock);
-                    s_sock = -1;
-                    s_connected = false;
-                }
+        if (child_registry_version() == cursor) {
+            continue;
+        }
+        uint32_t version = child_registry_snapshot(views);
+        for (int slot = 0; slot < CHILD_REGISTRY_MAX_NODES; slot++) {
+            const child_view_t *view = &views[slot];
+            // STALEへの遷移・解放も変化として通知されるが、送るのは新しい測定値のみ
+            if (!child_view_changed(view, cursor) || !child_view_fresh(view, view->child_no)) {
                 continue;
             }
-            
-            // ソケット未接続の場合は接続を試みる
-            if (!s_connected || s_sock < 0) {
-                s_sock = socket(AF_INET, SOCK_STREAM, 0);
-                if (s_sock < 0) {
-                    syslog(DEBUG_WIFI, "Failed to create socket");
-                    continue;
-                }
-                
-                memset(&s_server_addr, 0, sizeof(s_server_addr));
-                s_server_addr.sin_family = AF_INET;
-                s_server_addr.sin_port = htons(DATA_SERVER_PORT);
-                inet_pton(AF_INET, DATA_SERVER_HOST, &s_server_addr.sin_addr);
-                
-                // 接続タイムアウト設定
-                struct timeval timeout;
-                timeout.tv_sec = 3;
-                timeout.tv_usec = 0;
-                setsockopt(s_sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
-                setsockopt(s_sock, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
-                
-                if (connect(s_sock, (struct sockaddr *)&s_server_addr, sizeof(s_server_addr)) < 0) {
-                    syslog(DEBUG_WIFI, "Failed to connect to %s:%d", DATA_SERVER_HOST, DATA_SERVER_PORT);
-                    close(s_sock);
-                    s_sock = -1;
-                    continue;
-                }
-                
-                s_connected = true;
-                syslog(DEBUG_WIFI, "Connected to %s:%d", DATA_SERVER_HOST, DATA_SERVER_PORT);
-            }
-            
-            // データ送信（JSON形式）
-            // 固定形式: {"aht_t01":253,"aht_rh01":482,"bmp_t01":251,"bmp_p01":100845,"aht_ok":true,"bmp_ok":true,"seq":123}
-            char send_buf[128];
-            int len = snprintf(send_buf, sizeof(send_buf),
-                "{\"aht_t01\":%d,\"aht_rh01\":%u,\"bmp_t01\":%d,\"bmp_p01\":%lu,\"aht_ok\":%s,\"bmp_ok\":%s,\"seq\":%lu}\n",
-                (int)data.aht_t01,
-                (unsigned int)data.aht_rh01,
-                (int)data.bmp_t01,
-                (unsigned long)data.bmp_p01,
-                data.aht_ok ? "true" : "false",
-                data.bmp_ok ? "true" : "false",
-                (unsigned long)data.seq);
-            
-            int sent = send(s_sock, send_buf, len, 0);
-            if (sent < 0) {
-                syslog(DEBUG_WIFI, "Failed to send data, closing socket");
-                close(s_sock);
-                s_sock = -1;
-                s_connected = false;
-            } else {
-                syslog(DEBUG_WIFI, "Sent temp sens data: seq=%lu", (unsigned long)data.seq);
+            if (!data_send_connect()) {
+                break;  // 未接続の間の変化は送らない（接続後は次の変化から送る）
             }
+            sensor_data_unpack(&view->reading, &data);
+            data_send_line(view->child_no, &data);
         }
-        
-        // 接続が長時間使われていない場合は閉じる（5秒間データが来ない場合）
-        // これは実装の簡略化のため。必要に応じて調整可能。
+        cursor = version;
     }
 }
 
@@ -581,19 +794,32 @@ static void wifi_task(void *pvParameters)
             xTaskNotify(mainTaskHandle_, 0x1234, eSetValueWithOverwrite);
         }
         
-        // 子機テーブル初期化
-        child_table_init();
+        // 子機テーブル初期化（ソフトウェアリセットからの起動なら再起動前の子機を登録し直す）
+        child_registry_init();
+        warm_restart_restore();
         
         // データ送信タスクを起動（既存機能維持）
         xTaskCreate(data_send_task, "DataSendTask", 2048, NULL, 2, &s_data_send_task);
         syslog(DEBUG_WIFI, "Data send task started");
         
-        // UDP受信タスクを起動
-        xTaskCreate(udp_recv_task, "UdpRecvTask", 4096, NULL, 5, &s_udp_recv_task);
-        syslog(DEBUG_WIFI, "UDP receive task started");
+        // 受信処理タスク（処理段）を受信リアクタと別コアで起動
+        spsc_ring_init(&s_ingest_ring, s_ingest_slots, sizeof(ingest_slot_t), INGEST_RING_SLOTS);
+        ingest_admission_init(&s_admission, INGEST_ADMIT_RATE_PER_SEC, INGEST_ADMIT_BURST);
+        xTaskCreatePinnedToCore(ingest_process_task, "IngestProcess", 4096, NULL, 4,
+                                &s_ingest_process_task, INGEST_PROC_CORE);
+        syslog(DEBUG_WIFI, "Ingest ring: %d slots x %u bytes", INGEST_RING_SLOTS,
+               (unsigned int)sizeof(ingest_slot_t));
+        
+        // 受信リアクタ（受信段）を起動し、UDP受信ソケットを登録
+        start_ingest_reactor_task(INGEST_RECV_CORE);
+        int udp_sock = udp_sensor_socket_open();
+        if (udp_sock >= 0 && ingest_reactor_add_socket(udp_sock, udp_sensor_socket_handler, NULL)) {
+            syslog(DEBUG_WIFI, "UDP receive socket registered (port %d)", UDP_RECV_PORT);
+        }
         
-        // 子機監視タスクを起動
-        xTaskCreate(child_monitor_task, "ChildMonitorTask", 2048, NULL, 3, &s_child_monitor_task);
+        // 子機監視タスク（送信間隔の下り制御を含む）を起動
+        report_control_init();
+        xTaskCreate(child_monitor_task, "ChildMonitorTask", 3072, NULL, 3, &s_child_monitor_task);
         syslog(DEBUG_WIFI, "Child monitor task started");
     } else {
         syslog(DEBUG_WIFI, "Wi-Fi AP start timeout");
@@ -622,6 +848,30 @@ void start_wifi_task(TaskHandle_t mainTaskHandle)
     xTaskCreate(wifi_task, "WiFiTask", 4096, NULL, 3, NULL);
 }
 
+void wifi_get_ingest_stats(wifi_ingest_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    spsc_ring_get_stats(&s_ingest_ring, &stats->ring);
+    stats->coalesce_bursts = s_coalesce_bursts;
+    stats->superseded = s_coalesce_superseded;
+    ingest_admission_get_stats(&s_admission, &stats->admission);
+    stats->admission_enabled = s_admission_enabled;
+}
+
+size_t wifi_list_admission_drops(ingest_admission_source_t *out, size_t max_count)
+{
+    return ingest_admission_list_dropping(&s_admission, out, max_count);
+}
+
+void wifi_set_admission_enabled(bool enabled)
+{
+    s_admission_enabled = enabled;
+    syslog(INFO, "Ingest admission %s (%d datagrams/s, burst %d per source)", enabled ? "on" : "off",
+           INGEST_ADMIT_RATE_PER_SEC, INGEST_ADMIT_BURST);
+}
+
 QueueHandle_t wifi_get_data_queue(void)
 {
     return s_data_queue;
@@ -643,12 +893,15 @@ bool wifi_send_temp_sens_data(const temp_sens_data_t *data)
     }
     
     // キューにデータを送信（非ブロッキング）
-    if (xQueueSend(s_data_queue, data, 0) == pdTRUE) {
-        return true;
-    } else {
+    bool queued = xQueueSend(s_data_queue, data, 0) == pdTRUE;
+    if (!queued) {
         // キューが満杯の場合は古いデータを上書き
         temp_sens_data_t dummy;
         xQueueReceive(s_data_queue, &dummy, 0);
-        return xQueueSend(s_data_queue, data, 0) == pdTRUE;
+        queued = xQueueSend(s_data_queue, data, 0) == pdTRUE;
+    }
+    if (queued && s_data_send_task != NULL) {
+        xTaskNotifyGive(s_data_send_task);  // 送信タスクは通知でのみ起きる
     }
+    return queued;
 }
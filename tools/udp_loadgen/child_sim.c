@@ -0,0 +1,425 @@
+// tools/udp_loadgen/child_sim.c
+// ホスト用 子機シミュレータ（下り制御による送信間隔の収束確認、Linux）
+//
+// N台の子機をループバックの別アドレス（127.0.0.<base+i>）で模擬し、バイナリフレームを送信する。
+// 各子機は自分のアドレスの制御ポートで制御フレームを受け、typeごとにctrl_seqが変わった時だけ適用する
+// （SET_INTERVAL: 送信間隔の切り替え、SHIFT_PHASE: 次の送信時刻を1回ずらす）。
+// 1秒ごとに送信レートと子機の間隔の分布を表示し、全子機が同じ指示に揃った時刻（収束時刻）を記録する。
+// -V で指定した区間だけ /sensor/data をポーリングし、閲覧者あり／なしの切り替えに対する追従を確認できる。
+// 送信位相の確認用に、子機ごとの時計のずれ（-D、±ppmの一様乱数）と共有チャネルの衝突（-A）を模擬する。
+// 衝突: 他の子機の送信開始から-Aミリ秒以内に送信を始めたフレームは失われる（送信せずseqだけ進める）。
+//
+// ビルド（リポジトリのルートで実行）:
+//   gcc -O2 -Wall -Iinclude -o child_sim tools/udp_loadgen/child_sim.c src/sensor_frame.c src/sensor_channel.c
+//
+// 実行例（host_gatewayに対して実行）:
+//   ./host_gateway -p 50000 -w 8080
+//   ./child_sim -H 127.0.0.1 -w 8080 -n 50 -i 1000 -V 20:40 -d 70
+//   ./host_gateway -p 50000 -w 8080 -s 5000 && ./child_sim -H 127.0.0.1 -w 8080 -n 100 -i 1000 -d 60
+//   ./host_gateway -p 50000 -w 8080 [-S] && ./child_sim -H 127.0.0.1 -w 8080 -n 50 -A 5 -D 200 -V 0:120 -d 120
+//
+// 実機ゲートウェイに対しては、子機アドレスがゲートウェイから到達可能である必要があるため使用できない。
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <getopt.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "sensor_frame.h"
+
+// ==== 設定 ====
+#define MAX_CHILDREN        200
+#define VIEWER_POLL_MS      2000        // ダッシュボードと同じ取得周期
+#define SETTLE_MS           5000        // 全子機が揃ってからこの時間変化がなければ収束とみなす
+#define AIRTIME_HISTORY     8           // 衝突判定に使う直近の送信開始時刻の数
+
+typedef struct {
+    const char *host;
+    int udp_port;
+    int http_port;
+    int control_port;
+    int children;
+    int base_addr;          // 子機アドレスの最下位オクテット（127.0.0.<base_addr + i>）
+    int initial_ms;         // 指示を受けるまでの送信間隔
+    int viewer_from_s;      // /sensor/data をポーリングする区間（-1=なし）
+    int viewer_to_s;
+    int duration_s;
+    int airtime_ms;         // 衝突とみなす送信開始の間隔（0=衝突なし）
+    int drift_ppm;          // 子機の時計のずれの最大値（±ppm）
+} options_t;
+
+typedef struct {
+    int sock;
+    uint8_t child_no;
+    uint32_t seq;
+    uint32_t interval_ms;
+    uint64_t next_us;       // 次の送信時刻（子機の時計のずれを含む）
+    double clock_rate;      // 子機の時計の進み方（1 + ppm/1e6）
+    bool has_interval_seq;
+    uint16_t interval_seq;  // 最後に適用したSET_INTERVALの通番
+    bool has_phase_seq;
+    uint16_t phase_seq;     // 最後に適用したSHIFT_PHASEの通番
+    uint32_t sent;          // この1秒に送信した数
+    uint32_t collided;      // この1秒に衝突で失った数
+} child_t;
+
+static options_t s_opt = {
+    .host = "127.0.0.1",
+    .udp_port = 50000,
+    .http_port = 8080,
+    .control_port = SENSOR_CONTROL_PORT,
+    .children = 20,
+    .base_addr = 10,
+    .initial_ms = 1000,
+    .viewer_from_s = -1,
+    .viewer_to_s = -1,
+    .duration_s = 60,
+    .airtime_ms = 0,
+    .drift_ppm = 0,
+};
+
+static child_t s_children[MAX_CHILDREN];
+static struct pollfd s_pfds[MAX_CHILDREN];
+static uint64_t s_change_start = 0;     // 収束後に最初に間隔が変わった時刻（0=変化なし）
+static uint64_t s_tx_start_us[AIRTIME_HISTORY];     // 直近の送信開始時刻（衝突判定用）
+static size_t s_tx_start_pos = 0;
+static uint64_t s_total_sent = 0;
+static uint64_t s_total_collided = 0;
+
+// ==== 時刻 ====
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static uint64_t now_ms(void)
+{
+    return now_us() / 1000u;
+}
+
+// 子機の時計での送信間隔（実時間のus）
+static uint64_t child_interval_us(const child_t *c)
+{
+    return (uint64_t)((double)c->interval_ms * 1000.0 * c->clock_rate);
+}
+
+// ==== 子機 ====
+static bool child_open(child_t *c, int index)
+{
+    c->sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (c->sock < 0) {
+        return false;
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(0x7F000000u | (uint32_t)(s_opt.base_addr + index));
+    addr.sin_port = htons((uint16_t)s_opt.control_port);
+    if (bind(c->sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(c->sock);
+        return false;
+    }
+
+    c->child_no = (uint8_t)(index + 1);
+    c->seq = 0;
+    c->interval_ms = (uint32_t)s_opt.initial_ms;
+    c->clock_rate = 1.0;
+    if (s_opt.drift_ppm > 0) {
+        c->clock_rate += (double)(rand() % (2 * s_opt.drift_ppm + 1) - s_opt.drift_ppm) / 1e6;
+    }
+    // 送信タイミングを分散させる
+    c->next_us = now_us() + (uint64_t)(rand() % s_opt.initial_ms) * 1000u;
+    return true;
+}
+
+// 他の子機の送信開始からairtime以内なら衝突
+static bool airtime_collides(uint64_t start_us)
+{
+    bool collides = false;
+    if (s_opt.airtime_ms > 0) {
+        uint64_t airtime_us = (uint64_t)s_opt.airtime_ms * 1000u;
+        for (size_t i = 0; i < AIRTIME_HISTORY; i++) {
+            uint64_t t = s_tx_start_us[i];
+            if (t != 0 && (start_us > t ? start_us - t : t - start_us) < airtime_us) {
+                collides = true;
+            }
+        }
+    }
+    s_tx_start_us[s_tx_start_pos] = start_us;
+    s_tx_start_pos = (s_tx_start_pos + 1) % AIRTIME_HISTORY;
+    return collides;
+}
+
+static void child_send(child_t *c, const struct sockaddr_in *gw)
+{
+    temp_sens_data_t data = {
+        .seq = c->seq++,
+        .rssi = -50,
+    };
+    sensor_data_set(&data, SENSOR_CH_AHT_T, 250 + (c->child_no % 10));
+    sensor_data_set(&data, SENSOR_CH_AHT_RH, 500);
+    sensor_data_set(&data, SENSOR_CH_BMP_T, 248);
+    sensor_data_set(&data, SENSOR_CH_BMP_P, 101325);
+    if (airtime_collides(c->next_us)) {
+        c->collided++;
+        s_total_collided++;
+        return;
+    }
+    uint8_t frame[SENSOR_FRAME_SIZE];
+    size_t len = sensor_frame_encode(c->child_no, &data, frame, sizeof(frame));
+    sendto(c->sock, frame, len, MSG_DONTWAIT, (const struct sockaddr *)gw, sizeof(*gw));
+    c->sent++;
+    s_total_sent++;
+}
+
+static void child_receive(child_t *c, uint64_t now)
+{
+    uint8_t buf[64];
+    ssize_t len;
+    while ((len = recv(c->sock, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+        sensor_control_t ctrl;
+        if (sensor_frame_decode_control(buf, (size_t)len, &ctrl) != SENSOR_FRAME_OK ||
+            ctrl.child_no != c->child_no) {
+            continue;
+        }
+
+        if (ctrl.type == SENSOR_CONTROL_SHIFT_PHASE) {
+            if (c->has_phase_seq && ctrl.ctrl_seq == c->phase_seq) {
+                continue;  // 同じ指示の再送
+            }
+            c->has_phase_seq = true;
+            c->phase_seq = ctrl.ctrl_seq;
+            int64_t next_us = (int64_t)c->next_us + (int64_t)(int32_t)ctrl.value * 1000;
+            c->next_us = (next_us > (int64_t)now * 1000) ? (uint64_t)next_us : now * 1000u;
+            continue;
+        }
+
+        if (ctrl.type != SENSOR_CONTROL_SET_INTERVAL || ctrl.value == 0) {
+            continue;
+        }
+        if (c->has_interval_seq && ctrl.ctrl_seq == c->interval_seq) {
+            continue;  // 同じ指示の再送
+        }
+        c->has_interval_seq = true;
+        c->interval_seq = ctrl.ctrl_seq;
+        if (ctrl.value != c->interval_ms) {
+            if (s_change_start == 0) {
+                s_change_start = now;
+            }
+            c->interval_ms = ctrl.value;
+            // 全子機が同時に指示を受けるため、次の送信を新しい間隔内の乱数位置にずらして集中を避ける
+            c->next_us = (now + (uint64_t)(rand() % c->interval_ms)) * 1000u;
+        }
+    }
+}
+
+// ==== 閲覧者の模擬（/sensor/data の取得） ====
+static void viewer_poll(void)
+{
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0) {
+        return;
+    }
+    struct timeval tv = { .tv_sec = 1, .tv_usec = 0 };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)s_opt.http_port);
+    inet_pton(AF_INET, s_opt.host, &addr.sin_addr);
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+        static const char req[] = "GET /sensor/data HTTP/1.1\r\nHost: gw\r\nConnection: close\r\n\r\n";
+        static char discard[64 * 1024];
+        send(sock, req, sizeof(req) - 1, MSG_NOSIGNAL);
+        while (recv(sock, discard, sizeof(discard), 0) > 0) {
+        }
+    }
+    close(sock);
+}
+
+// ==== メイン ====
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -H host        gateway address (default 127.0.0.1)\n"
+        "  -p port        gateway UDP port (default 50000)\n"
+        "  -w port        gateway HTTP port (default 8080)\n"
+        "  -c port        child control port (default %d)\n"
+        "  -n count       number of children (default 20, max %d)\n"
+        "  -a octet       first child address 127.0.0.<octet> (default 10)\n"
+        "  -i ms          interval before the first control frame (default 1000)\n"
+        "  -V from:to     poll /sensor/data between these seconds (viewer present)\n"
+        "  -A ms          frames starting within this time of another child's frame are lost (default 0)\n"
+        "  -D ppm         random clock error per child, up to +/- ppm (default 0)\n"
+        "  -d seconds     run time (default 60)\n",
+        prog, SENSOR_CONTROL_PORT, MAX_CHILDREN);
+}
+
+int main(int argc, char **argv)
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "H:p:w:c:n:a:i:V:A:D:d:h")) != -1) {
+        switch (opt) {
+        case 'H': s_opt.host = optarg; break;
+        case 'p': s_opt.udp_port = atoi(optarg); break;
+        case 'w': s_opt.http_port = atoi(optarg); break;
+        case 'c': s_opt.control_port = atoi(optarg); break;
+        case 'n': s_opt.children = atoi(optarg); break;
+        case 'a': s_opt.base_addr = atoi(optarg); break;
+        case 'i': s_opt.initial_ms = atoi(optarg); break;
+        case 'V':
+            if (sscanf(optarg, "%d:%d", &s_opt.viewer_from_s, &s_opt.viewer_to_s) != 2) {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'A': s_opt.airtime_ms = atoi(optarg); break;
+        case 'D': s_opt.drift_ppm = atoi(optarg); break;
+        case 'd': s_opt.duration_s = atoi(optarg); break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (s_opt.children < 1 || s_opt.children > MAX_CHILDREN || s_opt.base_addr < 1 ||
+        s_opt.base_addr + s_opt.children > 255 || s_opt.initial_ms <= 0 || s_opt.airtime_ms < 0 ||
+        s_opt.drift_ppm < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    struct sockaddr_in gw;
+    memset(&gw, 0, sizeof(gw));
+    gw.sin_family = AF_INET;
+    gw.sin_port = htons((uint16_t)s_opt.udp_port);
+    if (inet_pton(AF_INET, s_opt.host, &gw.sin_addr) != 1) {
+        fprintf(stderr, "invalid host: %s\n", s_opt.host);
+        return 1;
+    }
+
+    srand((unsigned int)time(NULL));
+    for (int i = 0; i < s_opt.children; i++) {
+        if (!child_open(&s_children[i], i)) {
+            fprintf(stderr, "child %d: cannot bind 127.0.0.%d:%d: %s\n", i + 1, s_opt.base_addr + i,
+                    s_opt.control_port, strerror(errno));
+            return 1;
+        }
+        s_pfds[i].fd = s_children[i].sock;
+        s_pfds[i].events = POLLIN;
+    }
+
+    printf("child_sim: %d children 127.0.0.%d-%d -> %s:%d, control port %d, initial %dms, airtime %dms, drift +/-%dppm\n",
+           s_opt.children, s_opt.base_addr, s_opt.base_addr + s_opt.children - 1,
+           s_opt.host, s_opt.udp_port, s_opt.control_port, s_opt.initial_ms, s_opt.airtime_ms, s_opt.drift_ppm);
+    printf("%5s %7s %7s %8s %8s %8s %6s\n", "t[s]", "tx/s", "coll/s", "min[ms]", "max[ms]", "agreed", "viewer");
+
+    uint64_t start = now_ms();
+    uint64_t end = start + (uint64_t)s_opt.duration_s * 1000u;
+    uint64_t next_report = start + 1000;
+    uint64_t next_viewer = start;
+    uint64_t agreed_since = 0;          // 全子機が同じ間隔に揃った時刻（0=揃っていない）
+    uint32_t agreed_ms = 0;
+
+    while (1) {
+        uint64_t now = now_ms();
+        if (now >= end) {
+            break;
+        }
+
+        // 次の送信・表示・閲覧のうち最も早い時刻まで制御フレームを待つ
+        uint64_t wake_us = next_report * 1000u;
+        for (int i = 0; i < s_opt.children; i++) {
+            if (s_children[i].next_us < wake_us) {
+                wake_us = s_children[i].next_us;
+            }
+        }
+        uint64_t now_u = now_us();
+        int timeout = (wake_us > now_u) ? (int)((wake_us - now_u + 999u) / 1000u) : 0;
+        if (poll(s_pfds, (nfds_t)s_opt.children, timeout) > 0) {
+            for (int i = 0; i < s_opt.children; i++) {
+                if (s_pfds[i].revents & POLLIN) {
+                    child_receive(&s_children[i], now_ms());
+                }
+            }
+        }
+
+        now_u = now_us();
+        now = now_u / 1000u;
+        for (int i = 0; i < s_opt.children; i++) {
+            child_t *c = &s_children[i];
+            if (now_u >= c->next_us) {
+                child_send(c, &gw);
+                c->next_us += child_interval_us(c);
+                if (c->next_us < now_u) {
+                    c->next_us = now_u + child_interval_us(c);
+                }
+            }
+        }
+
+        int t_s = (int)((now - start) / 1000u);
+        bool viewer = t_s >= s_opt.viewer_from_s && t_s < s_opt.viewer_to_s;
+        if (viewer && now >= next_viewer) {
+            viewer_poll();
+            next_viewer = now + VIEWER_POLL_MS;
+        }
+
+        if (now >= next_report) {
+            uint32_t tx = 0;
+            uint32_t coll = 0;
+            uint32_t min_ms = UINT32_MAX;
+            uint32_t max_ms = 0;
+            for (int i = 0; i < s_opt.children; i++) {
+                child_t *c = &s_children[i];
+                tx += c->sent;
+                coll += c->collided;
+                c->sent = 0;
+                c->collided = 0;
+                if (c->interval_ms < min_ms) min_ms = c->interval_ms;
+                if (c->interval_ms > max_ms) max_ms = c->interval_ms;
+            }
+
+            // 収束判定: 全子機が同じ間隔に揃い、SETTLE_MSの間変化しない
+            if (min_ms != max_ms) {
+                agreed_since = 0;
+            } else if (agreed_since == 0 || agreed_ms != min_ms) {
+                agreed_since = now;
+                agreed_ms = min_ms;
+            }
+
+            printf("%5d %7u %7u %8u %8u %8s %6s\n", t_s, tx, coll, min_ms, max_ms,
+                   agreed_since != 0 ? "yes" : "no", viewer ? "on" : "off");
+            if (agreed_since != 0 && s_change_start != 0 && now - agreed_since >= SETTLE_MS) {
+                printf("  -> converged to %ums, %.1fs after the first child changed interval\n",
+                       agreed_ms, (double)(agreed_since - s_change_start) / 1000.0);
+                s_change_start = 0;
+            }
+            fflush(stdout);
+            next_report += 1000;
+        }
+    }
+
+    if (s_opt.airtime_ms > 0) {
+        uint64_t total = s_total_sent + s_total_collided;
+        printf("collided %llu of %llu frames (%.2f%%)\n", (unsigned long long)s_total_collided,
+               (unsigned long long)total, total > 0 ? 100.0 * (double)s_total_collided / (double)total : 0.0);
+    }
+
+    for (int i = 0; i < s_opt.children; i++) {
+        close(s_children[i].sock);
+    }
+    return 0;
+}
@@ -0,0 +1,420 @@
+// tools/udp_loadgen/codec_bench.c
+// 測定値の時系列圧縮（src/sensor_codec.c）の圧縮率・速度の測定（Linux）
+//
+// ゲートウェイがSDカードに記録したsensor.csv（ms,child_no,seq,<チャネル>...,rssi）を読み、
+// 子機ごとに受信順のまま固定長ブロック（-b、既定はオンデバイス履歴と同じ64バイト）へ符号化する。
+// 全件を復号して元の値と照合した上で、
+//   - 1件あたりのビット数（使用バイト数ベース・ブロック確保量ベース）と、コンパクト形式・CSVとの比
+//   - 符号化・復号の速度（件/秒、MB/秒は符号化後のバイト数で計算）
+// を表示する。ファイルを指定しなければ、-n台・-t時間分の受信を合成する（揺れ・欠落・測定失敗あり）。
+// 時刻はSENSOR_CODEC_TIME_UNIT_MS単位に切り捨てて保持するため、照合は時刻の差がその範囲内かで行う。
+//
+// ビルド（リポジトリのルートで実行）:
+//   gcc -O2 -Wall -Iinclude -o codec_bench tools/udp_loadgen/codec_bench.c src/sensor_codec.c src/sensor_channel.c
+//
+// 実行例:
+//   ./codec_bench /sdcard/sensor.csv                 （SDカードの記録）
+//   ./codec_bench /sdcard/sensor.csv -b 4096         （エクスポート向けの大きいブロック）
+//   ./codec_bench -n 64 -t 24 -i 1000                （合成データ: 64台・24時間・1秒間隔）
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include "sensor_channel.h"
+#include "sensor_codec.h"
+
+// ==== 設定 ====
+#define CHILD_NO_LIMIT      256
+#define CSV_LINE_MAX        512
+
+typedef struct {
+    uint32_t time_ms;
+    uint8_t child_no;
+    temp_sens_data_t data;
+} sample_t;
+
+typedef struct {
+    sample_t *items;
+    size_t count;
+    size_t capacity;
+    size_t csv_bytes;       // 元のCSVのデータ行のバイト数（合成時は0）
+} trace_t;
+
+typedef struct {
+    uint8_t *data;          // 固定長ブロックの列
+    size_t count;
+    size_t capacity;
+    size_t used_bytes;      // 各ブロックの使用バイト数の合計
+} blocks_t;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void *grow(void *p, size_t *capacity, size_t need, size_t item_size)
+{
+    if (need <= *capacity) {
+        return p;
+    }
+    size_t cap = (*capacity > 0) ? *capacity : 1024;
+    while (cap < need) {
+        cap *= 2;
+    }
+    p = realloc(p, cap * item_size);
+    if (p == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    *capacity = cap;
+    return p;
+}
+
+static void trace_push(trace_t *trace, const sample_t *s)
+{
+    trace->items = grow(trace->items, &trace->capacity, trace->count + 1, sizeof(sample_t));
+    trace->items[trace->count++] = *s;
+}
+
+// ==== sensor.csv ====
+// 実単位の小数 → 10^decimals倍の整数（余分な桁は切り捨て）。空・不正ならfalse
+static bool parse_fixed(const char *s, int decimals, int32_t *value)
+{
+    bool neg = (*s == '-');
+    if (neg) {
+        s++;
+    }
+    if (*s < '0' || *s > '9') {
+        return false;
+    }
+    int64_t v = 0;
+    while (*s >= '0' && *s <= '9') {
+        v = v * 10 + (*s++ - '0');
+    }
+    int frac = 0;
+    if (*s == '.') {
+        s++;
+        while (*s >= '0' && *s <= '9') {
+            if (frac < decimals) {
+                v = v * 10 + (*s - '0');
+                frac++;
+            }
+            s++;
+        }
+    }
+    for (; frac < decimals; frac++) {
+        v *= 10;
+    }
+    *value = (int32_t)(neg ? -v : v);
+    return true;
+}
+
+static bool load_csv(const char *path, trace_t *trace)
+{
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        perror(path);
+        return false;
+    }
+
+    // ヘッダ: ms,child_no,seq,<label>[<unit>]...,rssi（チャネルは短い表示名で対応付ける）
+    char line[CSV_LINE_MAX];
+    int column_ch[64];
+    int columns = 0;
+    if (fgets(line, sizeof(line), fp) == NULL) {
+        fprintf(stderr, "%s: empty file\n", path);
+        fclose(fp);
+        return false;
+    }
+    line[strcspn(line, "\r\n")] = '\0';
+    for (char *save = NULL, *tok = strtok_r(line, ",", &save); tok != NULL && columns < 64;
+         tok = strtok_r(NULL, ",", &save)) {
+        column_ch[columns] = (columns >= 3) ? sensor_channel_find_label(tok, strcspn(tok, "[")) : -1;
+        columns++;
+    }
+    if (columns < 3) {
+        fprintf(stderr, "%s: not a sensor.csv header\n", path);
+        fclose(fp);
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        size_t len = strlen(line);
+        line[strcspn(line, "\r\n")] = '\0';
+        if (strncmp(line, "ms,", 3) == 0) {
+            continue;   // 追記の途中で繰り返されたヘッダ
+        }
+        sample_t s;
+        memset(&s, 0, sizeof(s));
+        char *p = line;
+        bool ok = true;
+        for (int col = 0; col < columns && ok; col++) {
+            char *field = p;
+            char *comma = strchr(p, ',');
+            if (comma != NULL) {
+                *comma = '\0';
+                p = comma + 1;
+            } else if (col < columns - 1) {
+                ok = false;     // 列が足りない（書きかけの行）
+            }
+            if (col == 0) {
+                s.time_ms = (uint32_t)strtoul(field, NULL, 10);
+            } else if (col == 1) {
+                unsigned long child_no = strtoul(field, NULL, 10);
+                ok = ok && child_no > 0 && child_no < CHILD_NO_LIMIT;
+                s.child_no = (uint8_t)child_no;
+            } else if (col == 2) {
+                s.data.seq = (uint32_t)strtoul(field, NULL, 10);
+            } else if (column_ch[col] >= 0) {
+                const sensor_channel_t *c = sensor_channel_get((sensor_ch_t)column_ch[col]);
+                int32_t v;
+                if (parse_fixed(field, c->decimals, &v)) {
+                    sensor_data_set(&s.data, (sensor_ch_t)column_ch[col], v);
+                }
+            }
+        }
+        if (ok) {
+            trace_push(trace, &s);
+            trace->csv_bytes += len;
+        }
+    }
+    fclose(fp);
+    return true;
+}
+
+// ==== 合成データ ====
+// 1子機あたり: interval_ms ±20msの揺れ、1%の欠落（seqの飛び）、0.5%のBMP測定失敗、
+// 値は実際の室内環境程度のゆっくりした変化（0.1刻みのランダムウォーク）
+static void synthesize(trace_t *trace, int children, double hours, uint32_t interval_ms, unsigned int seed)
+{
+    srand(seed);
+    uint32_t duration_ms = (uint32_t)(hours * 3600000.0);
+    for (int i = 0; i < children; i++) {
+        uint32_t t = 20 + (uint32_t)rand() % interval_ms;
+        uint32_t seq = (uint32_t)rand() % 1000;
+        int32_t temp = 200 + rand() % 80;
+        int32_t rh = 400 + rand() % 200;
+        int32_t pressure = 100500 + rand() % 1000;
+        while (t < duration_ms) {
+            sample_t s;
+            memset(&s, 0, sizeof(s));
+            s.child_no = (uint8_t)(i + 1);
+            s.time_ms = t + (uint32_t)(rand() % 41) - 20;
+            temp += (rand() % 100 < 10) ? (rand() % 3 - 1) : 0;
+            rh += (rand() % 100 < 20) ? (rand() % 3 - 1) : 0;
+            pressure += (rand() % 100 < 5) ? (rand() % 3 - 1) : 0;
+            s.data.seq = seq++;
+            sensor_data_set(&s.data, SENSOR_CH_AHT_T, temp);
+            sensor_data_set(&s.data, SENSOR_CH_AHT_RH, rh);
+            if (rand() % 1000 >= 5) {
+                sensor_data_set(&s.data, SENSOR_CH_BMP_T, temp - 2 + rand() % 2);
+                sensor_data_set(&s.data, SENSOR_CH_BMP_P, pressure);
+            }
+            if (rand() % 100 > 0) {
+                trace_push(trace, &s);
+            }
+            t += interval_ms;
+        }
+    }
+}
+
+// ==== 符号化・復号 ====
+// 子機ごとに時刻順（記録順）へ並べた添字
+static size_t *group_by_child(const trace_t *trace)
+{
+    size_t start[CHILD_NO_LIMIT + 1] = { 0 };
+    for (size_t i = 0; i < trace->count; i++) {
+        start[trace->items[i].child_no + 1]++;
+    }
+    for (int c = 1; c <= CHILD_NO_LIMIT; c++) {
+        start[c] += start[c - 1];
+    }
+    size_t *order = malloc((trace->count + 1) * sizeof(size_t));
+    if (order == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < trace->count; i++) {
+        order[start[trace->items[i].child_no]++] = i;
+    }
+    return order;
+}
+
+static uint8_t *block_at(const blocks_t *blocks, size_t index, size_t block_bytes)
+{
+    return &blocks->data[index * block_bytes];
+}
+
+static bool encode_all(const trace_t *trace, const size_t *order, size_t block_bytes, blocks_t *blocks)
+{
+    blocks->count = 0;
+    blocks->used_bytes = 0;
+    sensor_codec_state_t state;
+    int child_no = -1;
+    for (size_t k = 0; k < trace->count; k++) {
+        const sample_t *s = &trace->items[order[k]];
+        if (s->child_no == child_no &&
+            sensor_codec_block_append(block_at(blocks, blocks->count - 1, block_bytes), block_bytes, &state,
+                                      s->time_ms, &s->data)) {
+            continue;
+        }
+        // 子機の切り替わり・ブロックが満杯: 次のブロックを始める
+        if (blocks->count > 0) {
+            blocks->used_bytes += sensor_codec_block_bytes(&state);
+        }
+        blocks->data = grow(blocks->data, &blocks->capacity, (blocks->count + 1) * block_bytes, 1);
+        uint8_t *block = block_at(blocks, blocks->count++, block_bytes);
+        if (!sensor_codec_block_begin(block, block_bytes, &state) ||
+            !sensor_codec_block_append(block, block_bytes, &state, s->time_ms, &s->data)) {
+            fprintf(stderr, "block size %zu is too small for one sample\n", block_bytes);
+            return false;
+        }
+        child_no = s->child_no;
+    }
+    if (blocks->count > 0) {
+        blocks->used_bytes += sensor_codec_block_bytes(&state);
+    }
+    return true;
+}
+
+// 全ブロックを復号する。expectを渡すと元の値と照合する（戻り値: 復号件数、不一致があれば-1）
+static long decode_all(const blocks_t *blocks, size_t block_bytes, const trace_t *expect, const size_t *order)
+{
+    long n = 0;
+    volatile uint32_t sink = 0;
+    for (size_t b = 0; b < blocks->count; b++) {
+        sensor_codec_reader_t reader;
+        uint32_t time_ms;
+        temp_sens_data_t data;
+        sensor_codec_reader_begin(&reader, block_at(blocks, b, block_bytes), block_bytes);
+        while (sensor_codec_read(&reader, &time_ms, &data)) {
+            if (expect == NULL) {
+                sink += time_ms + data.ch[0];
+                n++;
+                continue;
+            }
+            const sample_t *s = &expect->items[order[n]];
+            uint32_t lag = s->time_ms - time_ms;
+            bool ok = lag < SENSOR_CODEC_TIME_UNIT_MS && data.seq == s->data.seq &&
+                      data.ch_valid == s->data.ch_valid;
+            for (int ch = 0; ch < SENSOR_CH_COUNT && ok; ch++) {
+                ok = !sensor_data_valid(&data, (sensor_ch_t)ch) || data.ch[ch] == s->data.ch[ch];
+            }
+            if (!ok) {
+                fprintf(stderr, "mismatch at sample %ld (child %d, t=%lu, seq=%lu)\n",
+                        n, s->child_no, (unsigned long)s->time_ms, (unsigned long)s->data.seq);
+                return -1;
+            }
+            n++;
+        }
+    }
+    (void)sink;
+    return n;
+}
+
+// ==== main ====
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "usage: %s [options] [sensor.csv]\n"
+        "  -b bytes       block size (default 64, max %d)\n"
+        "  -r repeats     encode/decode repetitions for timing (default 20)\n"
+        "  -n children    synthesized: number of children (default 64)\n"
+        "  -t hours       synthesized: duration (default 24)\n"
+        "  -i msec        synthesized: send interval (default 1000)\n",
+        prog, SENSOR_CODEC_BLOCK_MAX);
+}
+
+int main(int argc, char **argv)
+{
+    size_t block_bytes = 64;
+    int repeats = 20;
+    int children = 64;
+    double hours = 24.0;
+    uint32_t interval_ms = 1000;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "b:r:n:t:i:h")) != -1) {
+        switch (opt) {
+            case 'b': block_bytes = (size_t)strtoul(optarg, NULL, 10); break;
+            case 'r': repeats = atoi(optarg); break;
+            case 'n': children = atoi(optarg); break;
+            case 't': hours = atof(optarg); break;
+            case 'i': interval_ms = (uint32_t)strtoul(optarg, NULL, 10); break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (block_bytes <= SENSOR_CODEC_HEADER_BYTES || block_bytes > SENSOR_CODEC_BLOCK_MAX || repeats < 1 ||
+        children < 1 || children >= CHILD_NO_LIMIT || interval_ms == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    trace_t trace = { 0 };
+    if (optind < argc) {
+        if (!load_csv(argv[optind], &trace)) {
+            return 1;
+        }
+        printf("input: %s\n", argv[optind]);
+    } else {
+        synthesize(&trace, children, hours, interval_ms, 1);
+        printf("input: synthesized (%d children, %.1f h, %lu ms interval)\n",
+               children, hours, (unsigned long)interval_ms);
+    }
+    if (trace.count == 0) {
+        fprintf(stderr, "no samples\n");
+        return 1;
+    }
+
+    size_t *order = group_by_child(&trace);
+    blocks_t blocks = { 0 };
+    if (!encode_all(&trace, order, block_bytes, &blocks)) {
+        return 1;
+    }
+    long decoded = decode_all(&blocks, block_bytes, &trace, order);
+    if (decoded != (long)trace.count) {
+        fprintf(stderr, "round trip failed: %ld of %zu samples\n", decoded, trace.count);
+        return 1;
+    }
+
+    uint64_t t0 = now_ns();
+    for (int r = 0; r < repeats; r++) {
+        encode_all(&trace, order, block_bytes, &blocks);
+    }
+    double encode_s = (double)(now_ns() - t0) / 1e9 / repeats;
+    t0 = now_ns();
+    for (int r = 0; r < repeats; r++) {
+        decode_all(&blocks, block_bytes, NULL, NULL);
+    }
+    double decode_s = (double)(now_ns() - t0) / 1e9 / repeats;
+
+    // 比較: コンパクト形式 + 時刻（RSSIは符号化しないが形式の一部として含める）
+    double n = (double)trace.count;
+    size_t packed_bytes = sizeof(sensor_packed_t) + sizeof(uint32_t);
+    printf("samples: %zu, blocks: %zu x %zu bytes (round trip ok)\n", trace.count, blocks.count, block_bytes);
+    printf("size: %.2f bits/sample used, %.2f bits/sample allocated\n",
+           (double)blocks.used_bytes * 8 / n, (double)(blocks.count * block_bytes) * 8 / n);
+    printf("  vs packed+time (%zu bytes/sample): %.1fx",
+           packed_bytes, (double)packed_bytes * n / (double)blocks.used_bytes);
+    if (trace.csv_bytes > 0) {
+        printf(", vs csv (%.1f bytes/sample): %.1fx",
+               (double)trace.csv_bytes / n, (double)trace.csv_bytes / (double)blocks.used_bytes);
+    }
+    printf("\n");
+    printf("encode: %.2f Msamples/s, %.1f MB/s\n", n / encode_s / 1e6, (double)blocks.used_bytes / encode_s / 1e6);
+    printf("decode: %.2f Msamples/s, %.1f MB/s\n", n / decode_s / 1e6, (double)blocks.used_bytes / decode_s / 1e6);
+
+    free(order);
+    free(blocks.data);
+    free(trace.items);
+    return 0;
+}
@@ -0,0 +1,369 @@
+// tools/udp_loadgen/flash_log_sim.c
+// 履歴のフラッシュログ（src/history_log.c）の電源断・消去回数の確認（NORフラッシュの模擬、Linux）
+//
+// RAM上にNORフラッシュを模擬し（書き込みは1→0のみ、消去はセクタ単位で0xFF、セクタごとに消去回数を数える）、
+// history_logへ番号入りのブロックを追記し続ける。所定の確率で書き込み・消去の途中で電源を切り
+// （書きかけのバイトは一部のビットだけ落ちる、消去は先頭から途中までだけ0xFFになる）、ログを開き直して
+//   - 読み出したレコードが、追記に成功したレコードの末尾部分と順序・内容・起動番号まで一致すること
+//     （電源断の時に書いていたレコードは、ヘッダを書き終えていれば残ってよい）
+//   - 最後に追記に成功したレコードが残っていること、保持件数が(セクタ数-2)セクタ分を下回らないこと（書きかけで使わなかった位置・消しかけたセクタの分を見込む）
+//   - 消去していない位置へ書き込んでいないこと（0→1の書き込みがないこと）
+//   - 追記中に数えておいた消去回数の最小・最大（history_log_wear()）が、開き直してヘッダから数えた値と一致すること
+// を確認する。終了時に消去回数の分布（模擬側で数えた値とセクタのヘッダに記録された値）と、
+// 開き直しで読んだバイト数（ヘッダの走査だけで復旧できているか）を表示する。1件でも不一致なら終了コード1。
+//
+// ビルド（リポジトリのルートで実行）:
+//   gcc -O2 -Wall -Iinclude -o flash_log_sim tools/udp_loadgen/flash_log_sim.c src/history_log.c
+//
+// 実行例:
+//   ./flash_log_sim                          （userdataと同じ31セクタ、20万件、約500件ごとに電源断）
+//   ./flash_log_sim -s 4 -n 100000 -c 50     （少ないセクタで巡回・電源断を多くする）
+//   ./flash_log_sim -g                       （消去されていない（ゴミの入った）領域から始める）
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <getopt.h>
+#include "history_log.h"
+
+// ==== NORフラッシュの模擬 ====
+typedef struct {
+    uint8_t *mem;
+    size_t size;
+    uint16_t sectors;
+    uint32_t *erase_counts;     // セクタごとの消去回数（電源断で途中までの消去も数える）
+    long budget;                // 電源断までに書けるバイト数（-1=切らない）
+    bool power_lost;
+    uint32_t violations;        // 0を1へ書こうとした回数
+    uint64_t bytes_written;
+    uint64_t bytes_read;
+} nor_flash_t;
+
+static bool nor_read(void *ctx, uint32_t offset, void *buf, size_t len)
+{
+    nor_flash_t *f = ctx;
+    if (f->power_lost || offset + len > f->size) {
+        return false;
+    }
+    memcpy(buf, &f->mem[offset], len);
+    f->bytes_read += len;
+    return true;
+}
+
+static bool nor_write(void *ctx, uint32_t offset, const void *buf, size_t len)
+{
+    nor_flash_t *f = ctx;
+    const uint8_t *src = buf;
+    if (f->power_lost || offset + len > f->size) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (f->budget == 0) {
+            // 電源断: 書きかけのバイトは一部のビットだけ落ちる
+            f->mem[offset + i] &= (uint8_t)(src[i] | (uint8_t)rand());
+            f->power_lost = true;
+            return false;
+        }
+        if (f->budget > 0) {
+            f->budget--;
+        }
+        if ((f->mem[offset + i] & src[i]) != src[i]) {
+            f->violations++;
+        }
+        f->mem[offset + i] &= src[i];
+        f->bytes_written++;
+    }
+    return true;
+}
+
+static bool nor_erase(void *ctx, uint32_t offset)
+{
+    nor_flash_t *f = ctx;
+    if (f->power_lost || offset % HISTORY_LOG_SECTOR_BYTES != 0 || offset >= f->size) {
+        return false;
+    }
+    f->erase_counts[offset / HISTORY_LOG_SECTOR_BYTES]++;
+    if (f->budget == 0) {
+        // 電源断: 先頭から途中までだけ消える
+        memset(&f->mem[offset], 0xFF, (size_t)rand() % HISTORY_LOG_SECTOR_BYTES);
+        f->power_lost = true;
+        return false;
+    }
+    if (f->budget > 0) {
+        f->budget--;
+    }
+    memset(&f->mem[offset], 0xFF, HISTORY_LOG_SECTOR_BYTES);
+    return true;
+}
+
+// ==== 追記したレコードの記録 ====
+typedef struct {
+    uint32_t number;            // 追記した順の通し番号（ブロックの先頭に書く）
+    uint16_t boot;
+    uint8_t child_no;
+} committed_t;
+
+static void make_block(uint32_t number, uint8_t *block)
+{
+    uint32_t x = number * 2654435761u + 12345u;
+    for (size_t i = 0; i < HISTORY_LOG_BLOCK_BYTES; i++) {
+        x = x * 1103515245u + 12345u;
+        block[i] = (uint8_t)(x >> 24);
+    }
+    memcpy(block, &number, sizeof(number));
+}
+
+// 最も新しいレコードの通し番号。なければfalse
+static bool newest_number(const history_log_t *log, uint32_t *number)
+{
+    history_log_iter_t it;
+    history_log_record_t record;
+    bool found = false;
+    history_log_iter_begin(&it, log);
+    while (history_log_iter_next(&it, &record)) {
+        memcpy(number, record.block, sizeof(*number));
+        found = true;
+    }
+    return found;
+}
+
+// 開き直したログを読み、追記に成功したレコードの末尾部分と一致するか確かめる
+static int verify(const history_log_t *log, const committed_t *committed, size_t count, size_t min_kept)
+{
+    history_log_iter_t it;
+    history_log_record_t record;
+    history_log_iter_begin(&it, log);
+    size_t pos = 0;
+    size_t kept = 0;
+    bool first = true;
+    while (history_log_iter_next(&it, &record)) {
+        uint32_t number;
+        memcpy(&number, record.block, sizeof(number));
+        if (first) {
+            // 最初に読めたレコードの位置から末尾まで一致すること
+            size_t lo = 0;
+            size_t hi = count;
+            while (lo < hi) {
+                size_t mid = (lo + hi) / 2;
+                if (committed[mid].number < number) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
+            }
+            pos = lo;
+            first = false;
+        }
+        uint8_t expect[HISTORY_LOG_BLOCK_BYTES];
+        make_block(number, expect);
+        if (pos >= count || committed[pos].number != number || committed[pos].boot != record.boot ||
+            committed[pos].child_no != record.child_no || memcmp(expect, record.block, sizeof(expect)) != 0) {
+            fprintf(stderr, "mismatch: read #%lu (boot %u, N=%u), expected #%lu\n",
+                    (unsigned long)number, record.boot, record.child_no,
+                    pos < count ? (unsigned long)committed[pos].number : 0ul);
+            return 1;
+        }
+        pos++;
+        kept++;
+    }
+    if (count > 0 && pos != count) {
+        fprintf(stderr, "lost the newest records: read up to %zu of %zu\n", pos, count);
+        return 1;
+    }
+    if (kept < min_kept && kept < count) {
+        fprintf(stderr, "kept only %zu records (expected at least %zu)\n", kept, min_kept);
+        return 1;
+    }
+    return 0;
+}
+
+// ==== main ====
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -s sectors     log sectors (default 31 = userdata after the settings sector)\n"
+        "  -n appends     number of append attempts (default 200000)\n"
+        "  -c count       cut power every ~count appends on average, 0=never (default 500)\n"
+        "  -S seed        random seed (default 1)\n"
+        "  -g             start from garbage instead of an erased region\n",
+        prog);
+}
+
+// 数えておいた消去回数が、同じフラッシュを別に開いてヘッダから数えた値と一致するか（開くだけでは書き込まない）
+static int verify_wear(const history_log_t *log, const history_log_flash_t *ops, uint16_t sectors)
+{
+    history_log_t fresh;
+    uint32_t lo, hi, fresh_lo, fresh_hi;
+    size_t used = history_log_wear(log, &lo, &hi);
+    if (!history_log_open(&fresh, ops, sectors)) {
+        fprintf(stderr, "open for the wear check failed\n");
+        return 1;
+    }
+    size_t fresh_used = history_log_wear(&fresh, &fresh_lo, &fresh_hi);
+    if (used != fresh_used || lo != fresh_lo || hi != fresh_hi) {
+        fprintf(stderr, "cached wear %zu sectors %lu..%lu, headers %zu sectors %lu..%lu\n", used,
+                (unsigned long)lo, (unsigned long)hi, fresh_used, (unsigned long)fresh_lo, (unsigned long)fresh_hi);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int sectors = 31;
+    long appends = 200000;
+    long cut_every = 500;
+    unsigned int seed = 1;
+    bool garbage = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:n:c:S:gh")) != -1) {
+        switch (opt) {
+            case 's': sectors = atoi(optarg); break;
+            case 'n': appends = atol(optarg); break;
+            case 'c': cut_every = atol(optarg); break;
+            case 'S': seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+            case 'g': garbage = true; break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (sectors < HISTORY_LOG_MIN_SECTORS || sectors > UINT16_MAX || appends < 1 || cut_every < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    srand(seed);
+
+    nor_flash_t flash = { 0 };
+    flash.sectors = (uint16_t)sectors;
+    flash.size = (size_t)sectors * HISTORY_LOG_SECTOR_BYTES;
+    flash.mem = malloc(flash.size);
+    flash.erase_counts = calloc((size_t)sectors, sizeof(uint32_t));
+    committed_t *committed = malloc((size_t)appends * sizeof(committed_t));
+    if (flash.mem == NULL || flash.erase_counts == NULL || committed == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    for (size_t i = 0; i < flash.size; i++) {
+        flash.mem[i] = garbage ? (uint8_t)rand() : 0xFF;
+    }
+    flash.budget = -1;
+
+    const history_log_flash_t ops = { .read = nor_read, .write = nor_write, .erase = nor_erase, .ctx = &flash };
+    history_log_t log;
+    if (!history_log_open(&log, &ops, (uint16_t)sectors)) {
+        fprintf(stderr, "open failed\n");
+        return 1;
+    }
+
+    size_t count = 0;
+    size_t min_kept = (size_t)(sectors - 2) * HISTORY_LOG_RECORDS_PER_SECTOR;
+    uint32_t reboots = 0;
+    uint32_t failed = 0;
+    uint32_t survived = 0;
+    uint64_t recovery_bytes = 0;
+    uint64_t recovery_max = 0;
+    int errors = 0;
+
+    for (long n = 0; n < appends && errors == 0; n++) {
+        if (cut_every > 0 && flash.budget < 0 && rand() % cut_every == 0) {
+            // 次の数レコード分の書き込みのどこかで電源を切る
+            flash.budget = rand() % (3 * HISTORY_LOG_RECORD_BYTES);
+        }
+
+        uint8_t block[HISTORY_LOG_BLOCK_BYTES];
+        uint8_t child_no = (uint8_t)(1 + rand() % 64);
+        make_block((uint32_t)n, block);
+        if (history_log_append(&log, child_no, block)) {
+            committed[count].number = (uint32_t)n;
+            committed[count].boot = log.boot;
+            committed[count].child_no = child_no;
+            count++;
+            if (log.next_record == 1) {
+                errors += verify_wear(&log, &ops, (uint16_t)sectors);   // セクタを始めた直後
+            }
+            continue;
+        }
+        failed++;
+        if (!flash.power_lost) {
+            continue;
+        }
+        committed_t inflight = { .number = (uint32_t)n, .boot = log.boot, .child_no = child_no };
+
+        // 電源断 → 再起動: 開き直して照合する
+        flash.power_lost = false;
+        flash.budget = -1;
+        reboots++;
+        uint64_t before = flash.bytes_read;
+        if (!history_log_open(&log, &ops, (uint16_t)sectors)) {
+            fprintf(stderr, "reopen failed\n");
+            return 1;
+        }
+        uint64_t read = flash.bytes_read - before;
+        recovery_bytes += read;
+        if (read > recovery_max) {
+            recovery_max = read;
+        }
+        uint32_t newest = 0;
+        if (newest_number(&log, &newest) && newest == inflight.number) {
+            committed[count++] = inflight;   // ヘッダを書き終えてから電源が切れた
+            survived++;
+        }
+        // 書いたレコードと起動番号が重ならないこと（何も書かずに切れた起動の番号は再利用してよい）
+        if (count > 0 && (int16_t)(log.boot - committed[count - 1].boot) <= 0) {
+            fprintf(stderr, "boot number did not advance (%u -> %u)\n", committed[count - 1].boot, log.boot);
+            errors++;
+        }
+        errors += verify(&log, committed, count, min_kept);
+    }
+    if (errors == 0) {
+        errors += verify(&log, committed, count, min_kept);
+        errors += verify_wear(&log, &ops, (uint16_t)sectors);
+    }
+    if (flash.violations > 0) {
+        fprintf(stderr, "%lu writes to bytes that were not erased\n", (unsigned long)flash.violations);
+        errors++;
+    }
+
+    // 消去回数の分布
+    uint32_t lo = UINT32_MAX;
+    uint32_t hi = 0;
+    uint64_t total = 0;
+    for (int s = 0; s < sectors; s++) {
+        if (flash.erase_counts[s] < lo) {
+            lo = flash.erase_counts[s];
+        }
+        if (flash.erase_counts[s] > hi) {
+            hi = flash.erase_counts[s];
+        }
+        total += flash.erase_counts[s];
+    }
+    uint32_t header_lo;
+    uint32_t header_hi;
+    size_t used = history_log_wear(&log, &header_lo, &header_hi);
+
+    printf("sectors: %d x %d records (%d bytes/record), appends: %zu ok / %lu failed, reboots: %lu "
+           "(%lu in-flight records survived)\n",
+           sectors, HISTORY_LOG_RECORDS_PER_SECTOR, HISTORY_LOG_RECORD_BYTES, count,
+           (unsigned long)failed, (unsigned long)reboots, (unsigned long)survived);
+    printf("erases: total %llu, per sector min %lu / max %lu / mean %.1f (headers: %zu sectors, %lu..%lu)\n",
+           (unsigned long long)total, (unsigned long)lo, (unsigned long)hi, (double)total / sectors,
+           used, (unsigned long)header_lo, (unsigned long)header_hi);
+    printf("bytes written per erase: %.0f (sector %d bytes)\n",
+           total > 0 ? (double)flash.bytes_written / (double)total : 0.0, HISTORY_LOG_SECTOR_BYTES);
+    if (reboots > 0) {
+        printf("recovery: mean %.0f / max %llu bytes read per open (region %zu bytes)\n",
+               (double)recovery_bytes / reboots, (unsigned long long)recovery_max, flash.size);
+    }
+    printf("%s\n", errors == 0 ? "PASS" : "FAIL");
+
+    free(committed);
+    free(flash.erase_counts);
+    free(flash.mem);
+    return errors == 0 ? 0 : 1;
+}
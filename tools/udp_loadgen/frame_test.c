@@ -0,0 +1,373 @@
+// tools/udp_loadgen/frame_test.c
+// バイナリセンサーフレーム（src/sensor_frame.c）の往復・異常系の確認（Linux）
+//
+// version 1（単一測定値）のフレームについて、
+//   - CRC16-CCITTの既知の値と、フレームの固定配置（オフセット・ビッグエンディアン）
+//   - 乱数で作った測定値（値の範囲の端・測定失敗・RSSIの飽和を含む）をエンコード → デコードして一致すること
+//   - 1ビット・2ビットの反転、16ビット以内のバースト誤りをすべて検出すること（先頭2バイトはMAGIC/VERSIONエラー）
+//   - 短い・長いフレーム、バッファ不足でのエンコード、JSON・旧形式の先頭バイトを誤判定しないこと
+// version 2（バッチ）のフレームについて、
+//   - 件数1～SENSOR_FRAME_BATCH_MAXの測定値と各測定値のage_ms（受信時刻からさかのぼる測定時刻）の往復
+//   - seqの差が255を超える・件数0/上限超えのエンコード拒否、件数と長さの不一致・切り詰め・CRC不一致の検出
+// を確認する。1件でも不一致なら終了コード1。
+//
+// ビルド（リポジトリのルートで実行）:
+//   gcc -O2 -Wall -Iinclude -o frame_test tools/udp_loadgen/frame_test.c src/sensor_frame.c src/sensor_channel.c
+//
+// 実行例:
+//   ./frame_test                 （10万フレームの往復）
+//   ./frame_test -n 1000000 -s 7
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <getopt.h>
+#include "sensor_frame.h"
+
+static unsigned long s_checks;
+static unsigned long s_failures;
+
+#define CHECK(cond, ...) do {                                       \
+        s_checks++;                                                 \
+        if (!(cond)) {                                              \
+            if (s_failures++ < 20) {                                \
+                printf("FAIL %s:%d: ", __func__, __LINE__);         \
+                printf(__VA_ARGS__);                                \
+                printf("\n");                                       \
+            }                                                       \
+        }                                                           \
+    } while (0)
+
+static uint32_t rand32(void)
+{
+    return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+// 範囲の端を多めに含む値
+static int32_t pick(int32_t lo, int32_t hi)
+{
+    switch (rand() % 8) {
+        case 0: return lo;
+        case 1: return hi;
+        case 2: return 0;
+        default: return (int32_t)((int64_t)lo + (int64_t)(rand32() % ((uint32_t)((int64_t)hi - lo) + 1u)));
+    }
+}
+
+static void random_reading(temp_sens_data_t *data)
+{
+    memset(data, 0, sizeof(*data));
+    sensor_data_set(data, SENSOR_CH_AHT_T, pick(INT16_MIN, INT16_MAX));
+    sensor_data_set(data, SENSOR_CH_AHT_RH, pick(0, UINT16_MAX));
+    sensor_data_set(data, SENSOR_CH_BMP_T, pick(INT16_MIN, INT16_MAX));
+    sensor_data_set(data, SENSOR_CH_BMP_P, pick(0, INT32_MAX));
+    sensor_data_apply_group(data, SENSOR_GROUP_AHT, rand() % 10 != 0);
+    sensor_data_apply_group(data, SENSOR_GROUP_BMP, rand() % 10 != 0);
+    data->seq = rand32();
+    data->rssi = pick(-128, 127);
+}
+
+static bool same_reading(const temp_sens_data_t *a, const temp_sens_data_t *b)
+{
+    if (a->seq != b->seq || a->rssi != b->rssi || a->ch_valid != b->ch_valid) {
+        return false;
+    }
+    for (int ch = 0; ch < SENSOR_CH_COUNT; ch++) {
+        if (sensor_data_valid(a, (sensor_ch_t)ch) && a->ch[ch] != b->ch[ch]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ==== 既知の値・固定配置 ====
+static void test_layout(void)
+{
+    CHECK(sensor_frame_crc16((const uint8_t *)"123456789", 9) == 0x29B1, "CRC16-CCITT check value");
+    CHECK(sensor_frame_crc16(NULL, 0) == 0xFFFF, "CRC of empty input is the initial value");
+
+    temp_sens_data_t data;
+    memset(&data, 0, sizeof(data));
+    sensor_data_set(&data, SENSOR_CH_AHT_T, -45);
+    sensor_data_set(&data, SENSOR_CH_AHT_RH, 482);
+    sensor_data_set(&data, SENSOR_CH_BMP_T, 251);
+    sensor_data_set(&data, SENSOR_CH_BMP_P, 100845);
+    data.seq = 0x01020304;
+    data.rssi = -60;
+
+    uint8_t buf[SENSOR_FRAME_SIZE];
+    CHECK(sensor_frame_encode(7, &data, buf, sizeof(buf)) == SENSOR_FRAME_SIZE, "encode size");
+    static const uint8_t expect[SENSOR_FRAME_SIZE - 2] = {
+        SENSOR_FRAME_MAGIC, SENSOR_FRAME_VERSION, 7, SENSOR_FRAME_FLAG_AHT_OK | SENSOR_FRAME_FLAG_BMP_OK,
+        0xFF, 0xD3,                 // aht_t01 = -45
+        0x01, 0xE2,                 // aht_rh01 = 482
+        0x00, 0xFB,                 // bmp_t01 = 251
+        0x00, 0x01, 0x89, 0xED,     // bmp_p01 = 100845
+        0x01, 0x02, 0x03, 0x04,     // seq
+        0xC4,                       // rssi = -60
+    };
+    CHECK(memcmp(buf, expect, sizeof(expect)) == 0, "fixed layout");
+    uint16_t crc = sensor_frame_crc16(buf, SENSOR_FRAME_SIZE - 2);
+    CHECK(buf[19] == (uint8_t)(crc >> 8) && buf[20] == (uint8_t)crc, "CRC is big-endian after the payload");
+
+    // BMPだけ測定失敗: フラグが落ち、デコード側でBMPのチャネルが無効になる
+    sensor_data_apply_group(&data, SENSOR_GROUP_BMP, false);
+    sensor_frame_encode(7, &data, buf, sizeof(buf));
+    CHECK(buf[3] == SENSOR_FRAME_FLAG_AHT_OK, "flags with BMP failed: 0x%02x", buf[3]);
+    uint8_t child_no;
+    temp_sens_data_t out;
+    CHECK(sensor_frame_decode(buf, sizeof(buf), &child_no, &out) == SENSOR_FRAME_OK && child_no == 7 &&
+          same_reading(&data, &out), "round trip with BMP failed");
+
+    // RSSIはint8に飽和
+    data.rssi = -200;
+    sensor_frame_encode(7, &data, buf, sizeof(buf));
+    CHECK(sensor_frame_decode(buf, sizeof(buf), &child_no, &out) == SENSOR_FRAME_OK && out.rssi == -128,
+          "rssi -200 saturates to -128 (got %d)", out.rssi);
+    data.rssi = 300;
+    sensor_frame_encode(7, &data, buf, sizeof(buf));
+    CHECK(sensor_frame_decode(buf, sizeof(buf), &child_no, &out) == SENSOR_FRAME_OK && out.rssi == 127,
+          "rssi 300 saturates to 127 (got %d)", out.rssi);
+}
+
+// ==== 往復 ====
+static void test_round_trip(unsigned long count)
+{
+    for (unsigned long n = 0; n < count; n++) {
+        temp_sens_data_t data, out;
+        random_reading(&data);
+        uint8_t child_no = (uint8_t)(1 + rand() % 254);
+        uint8_t buf[SENSOR_FRAME_SIZE + 4];
+        size_t len = sensor_frame_encode(child_no, &data, buf, sizeof(buf));
+        CHECK(len == SENSOR_FRAME_SIZE, "encode returned %zu", len);
+        CHECK(sensor_frame_is_binary(buf, len) && !sensor_frame_is_batch(buf, len), "detected as single frame");
+
+        uint8_t decoded_no = 0;
+        sensor_frame_result_t result = sensor_frame_decode(buf, len, &decoded_no, &out);
+        CHECK(result == SENSOR_FRAME_OK && decoded_no == child_no && same_reading(&data, &out),
+              "round trip #%lu (result %d, child %u/%u, seq %lu/%lu)", n, result, child_no, decoded_no,
+              (unsigned long)data.seq, (unsigned long)out.seq);
+    }
+}
+
+// ==== CRC・長さの異常 ====
+static bool rejected(const uint8_t *buf, size_t len)
+{
+    uint8_t child_no;
+    temp_sens_data_t out;
+    return sensor_frame_decode(buf, len, &child_no, &out) != SENSOR_FRAME_OK;
+}
+
+// 反転したビットの位置で期待する結果（先頭2バイトはCRCより前に判定される）
+static sensor_frame_result_t expected_error(size_t first_bit)
+{
+    if (first_bit < 8) {
+        return SENSOR_FRAME_ERR_MAGIC;
+    }
+    if (first_bit < 16) {
+        return SENSOR_FRAME_ERR_VERSION;
+    }
+    return SENSOR_FRAME_ERR_CRC;
+}
+
+static void test_corruption(unsigned long frames)
+{
+    const size_t bits = SENSOR_FRAME_SIZE * 8;
+    for (unsigned long n = 0; n < frames; n++) {
+        temp_sens_data_t data;
+        random_reading(&data);
+        uint8_t good[SENSOR_FRAME_SIZE];
+        sensor_frame_encode((uint8_t)(1 + rand() % 254), &data, good, sizeof(good));
+
+        for (size_t i = 0; i < bits; i++) {
+            uint8_t buf[SENSOR_FRAME_SIZE];
+            memcpy(buf, good, sizeof(buf));
+            buf[i / 8] ^= (uint8_t)(0x80 >> (i % 8));
+            uint8_t child_no;
+            temp_sens_data_t out;
+            sensor_frame_result_t result = sensor_frame_decode(buf, sizeof(buf), &child_no, &out);
+            CHECK(result == expected_error(i), "1-bit flip at bit %zu: result %d", i, result);
+
+            // 2ビット（CRC16-CCITTは32767ビット未満のフレームの2ビット誤りをすべて検出する）
+            for (size_t j = i + 1; j < bits; j++) {
+                uint8_t buf2[SENSOR_FRAME_SIZE];
+                memcpy(buf2, buf, sizeof(buf2));
+                buf2[j / 8] ^= (uint8_t)(0x80 >> (j % 8));
+                CHECK(rejected(buf2, sizeof(buf2)), "2-bit flip at bits %zu,%zu accepted", i, j);
+            }
+        }
+
+        // 16ビット以内のバースト誤り（先頭・末尾のビットは必ず反転）
+        for (int k = 0; k < 1000; k++) {
+            uint8_t buf[SENSOR_FRAME_SIZE];
+            memcpy(buf, good, sizeof(buf));
+            size_t width = 1 + (size_t)rand() % 16;
+            size_t start = (size_t)rand() % (bits - width + 1);
+            uint32_t pattern = (width == 1) ? 1u : (1u | (1u << (width - 1)) | (rand32() & ((1u << width) - 1)));
+            for (size_t b = 0; b < width; b++) {
+                if (pattern & (1u << b)) {
+                    size_t bit = start + b;
+                    buf[bit / 8] ^= (uint8_t)(0x80 >> (bit % 8));
+                }
+            }
+            CHECK(rejected(buf, sizeof(buf)), "%zu-bit burst at bit %zu accepted", width, start);
+        }
+    }
+}
+
+static void test_length(void)
+{
+    temp_sens_data_t data;
+    random_reading(&data);
+    uint8_t buf[SENSOR_FRAME_SIZE + 1];
+    CHECK(sensor_frame_encode(1, &data, buf, SENSOR_FRAME_SIZE - 1) == 0, "encode into a short buffer");
+    CHECK(sensor_frame_encode(1, NULL, buf, sizeof(buf)) == 0, "encode without data");
+    sensor_frame_encode(1, &data, buf, sizeof(buf));
+    buf[SENSOR_FRAME_SIZE] = 0;
+
+    uint8_t child_no;
+    temp_sens_data_t out;
+    CHECK(sensor_frame_decode(buf, 0, &child_no, &out) == SENSOR_FRAME_ERR_MAGIC, "empty datagram");
+    for (size_t len = 1; len < SENSOR_FRAME_SIZE; len++) {
+        sensor_frame_result_t result = sensor_frame_decode(buf, len, &child_no, &out);
+        CHECK(result == SENSOR_FRAME_ERR_LENGTH, "truncated to %zu bytes: result %d", len, result);
+    }
+    CHECK(sensor_frame_decode(buf, SENSOR_FRAME_SIZE + 1, &child_no, &out) == SENSOR_FRAME_ERR_LENGTH,
+          "one trailing byte");
+    CHECK(sensor_frame_decode(NULL, SENSOR_FRAME_SIZE, &child_no, &out) == SENSOR_FRAME_ERR_LENGTH, "NULL buffer");
+
+    // 他の形式の先頭バイト
+    CHECK(!sensor_frame_is_binary("{\"child_no\":1}", 14), "JSON is not binary");
+    CHECK(!sensor_frame_is_binary("N=1,T=25.3", 10), "legacy text is not binary");
+    CHECK(!sensor_frame_is_binary(buf, 0), "empty datagram is not binary");
+    buf[1] = 9;
+    CHECK(sensor_frame_decode(buf, SENSOR_FRAME_SIZE, &child_no, &out) == SENSOR_FRAME_ERR_VERSION,
+          "unknown version");
+}
+
+// ==== バッチフレーム ====
+static void test_batch(unsigned long count)
+{
+    uint8_t buf[SENSOR_FRAME_BATCH_SIZE(SENSOR_FRAME_BATCH_MAX) + 1];
+    for (unsigned long n = 0; n < count; n++) {
+        size_t records = 1 + (size_t)rand() % SENSOR_FRAME_BATCH_MAX;
+        temp_sens_data_t data[SENSOR_FRAME_BATCH_MAX];
+        uint16_t age_ms[SENSOR_FRAME_BATCH_MAX];
+        uint32_t base_seq = rand32();
+        int rssi = pick(-128, 127);
+        for (size_t i = 0; i < records; i++) {
+            random_reading(&data[i]);
+            data[i].seq = base_seq + (uint32_t)(rand() % 256);     // 周回も含む
+            data[i].rssi = rssi;
+            age_ms[i] = (uint16_t)pick(0, UINT16_MAX);
+        }
+        data[0].seq = base_seq;
+        uint8_t child_no = (uint8_t)(1 + rand() % 254);
+        size_t len = sensor_frame_encode_batch(child_no, rssi, data, age_ms, records, buf, sizeof(buf));
+        CHECK(len == SENSOR_FRAME_BATCH_SIZE(records), "batch of %zu: encode returned %zu", records, len);
+        CHECK(sensor_frame_is_batch(buf, len), "detected as batch");
+
+        temp_sens_data_t out[SENSOR_FRAME_BATCH_MAX];
+        uint16_t out_age[SENSOR_FRAME_BATCH_MAX];
+        uint8_t decoded_no = 0;
+        size_t decoded = 0;
+        sensor_frame_result_t result = sensor_frame_decode_batch(buf, len, &decoded_no, out, out_age,
+                                                                 SENSOR_FRAME_BATCH_MAX, &decoded);
+        CHECK(result == SENSOR_FRAME_OK && decoded_no == child_no && decoded == records,
+              "batch #%lu: result %d, %zu of %zu readings", n, result, decoded, records);
+        for (size_t i = 0; i < decoded && i < records; i++) {
+            CHECK(same_reading(&data[i], &out[i]) && out_age[i] == age_ms[i],
+                  "batch #%lu reading %zu (seq %lu/%lu, age %u/%u)", n, i, (unsigned long)data[i].seq,
+                  (unsigned long)out[i].seq, age_ms[i], out_age[i]);
+        }
+
+        // 受け取り側の上限が件数より小さい・切り詰め・末尾の余分・CRC
+        if (records > 1) {
+            CHECK(sensor_frame_decode_batch(buf, len, &decoded_no, out, NULL, records - 1, &decoded) ==
+                  SENSOR_FRAME_ERR_LENGTH, "batch larger than max_count");
+        }
+        size_t cut = (size_t)rand() % len;
+        CHECK(sensor_frame_decode_batch(buf, cut, &decoded_no, out, NULL, SENSOR_FRAME_BATCH_MAX, &decoded) !=
+              SENSOR_FRAME_OK, "batch truncated to %zu of %zu bytes", cut, len);
+        CHECK(sensor_frame_decode_batch(buf, len + 1, &decoded_no, out, NULL, SENSOR_FRAME_BATCH_MAX, &decoded) ==
+              SENSOR_FRAME_ERR_LENGTH, "batch with a trailing byte");
+        size_t bit = 16 + (size_t)rand() % ((len - 2) * 8);    // 先頭2バイト以外
+        buf[bit / 8] ^= (uint8_t)(0x80 >> (bit % 8));
+        result = sensor_frame_decode_batch(buf, len, &decoded_no, out, NULL, SENSOR_FRAME_BATCH_MAX, &decoded);
+        CHECK(result == SENSOR_FRAME_ERR_CRC || (bit / 8 == 3 && result == SENSOR_FRAME_ERR_LENGTH),
+              "batch bit flip at %zu: result %d", bit, result);
+    }
+
+    // エンコードできない入力
+    temp_sens_data_t data[SENSOR_FRAME_BATCH_MAX + 1];
+    memset(data, 0, sizeof(data));
+    data[1].seq = 256;
+    CHECK(sensor_frame_encode_batch(1, 0, data, NULL, 2, buf, sizeof(buf)) == 0, "seq delta above 255");
+    data[1].seq = 255;
+    CHECK(sensor_frame_encode_batch(1, 0, data, NULL, 2, buf, sizeof(buf)) == SENSOR_FRAME_BATCH_SIZE(2),
+          "seq delta 255");
+    CHECK(sensor_frame_encode_batch(1, 0, data, NULL, 0, buf, sizeof(buf)) == 0, "empty batch");
+    CHECK(sensor_frame_encode_batch(1, 0, data, NULL, SENSOR_FRAME_BATCH_MAX + 1, buf, sizeof(buf)) == 0,
+          "batch above SENSOR_FRAME_BATCH_MAX");
+    CHECK(sensor_frame_encode_batch(1, 0, data, NULL, 2, buf, SENSOR_FRAME_BATCH_SIZE(2) - 1) == 0,
+          "batch into a short buffer");
+
+    // age_msなしのエンコードは0、デコード側のage_msは省略可
+    uint16_t out_age[SENSOR_FRAME_BATCH_MAX] = { 1, 1 };
+    temp_sens_data_t out[SENSOR_FRAME_BATCH_MAX];
+    uint8_t child_no;
+    size_t decoded;
+    size_t len = sensor_frame_encode_batch(1, 0, data, NULL, 2, buf, sizeof(buf));
+    CHECK(sensor_frame_decode_batch(buf, len, &child_no, out, out_age, SENSOR_FRAME_BATCH_MAX, &decoded) ==
+          SENSOR_FRAME_OK && out_age[0] == 0 && out_age[1] == 0, "batch without age_ms");
+    CHECK(sensor_frame_decode_batch(buf, len, &child_no, out, NULL, SENSOR_FRAME_BATCH_MAX, &decoded) ==
+          SENSOR_FRAME_OK && decoded == 2, "decode without age_ms");
+    uint8_t single[SENSOR_FRAME_SIZE];
+    sensor_frame_encode(1, &data[0], single, sizeof(single));
+    CHECK(!sensor_frame_is_batch(single, sizeof(single)) &&
+          sensor_frame_decode_batch(single, sizeof(single), &child_no, out, NULL, SENSOR_FRAME_BATCH_MAX,
+                                    &decoded) == SENSOR_FRAME_ERR_VERSION, "v1 frame is not a batch");
+}
+
+// ==== main ====
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -n frames      random round-trip frames, single and batch (default 100000)\n"
+        "  -c frames      frames for exhaustive bit-flip checks (default 20)\n"
+        "  -s seed        random seed (default 1)\n",
+        prog);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long frames = 100000;
+    unsigned long corrupt_frames = 20;
+    unsigned int seed = 1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:c:s:h")) != -1) {
+        switch (opt) {
+            case 'n': frames = strtoul(optarg, NULL, 10); break;
+            case 'c': corrupt_frames = strtoul(optarg, NULL, 10); break;
+            case 's': seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    srand(seed);
+
+    test_layout();
+    test_round_trip(frames);
+    test_corruption(corrupt_frames);
+    test_length();
+    test_batch(frames);
+
+    printf("frame_test: %lu checks, %lu failures\n", s_checks, s_failures);
+    return (s_failures > 0) ? 1 : 0;
+}
@@ -0,0 +1,339 @@
+// tools/udp_loadgen/history_test.c
+// 子機ごとの測定値履歴（src/sensor_history.c）の往復テスト（Linux）
+//
+// 1つのリングへ-n件の測定値を追記し、追記のたびに全件を復号して、追記した列の末尾（古いブロックを捨てた残り）と
+// 一致することを確かめる。追記する列には次を混ぜる:
+//   - 受信間隔の揺れ・間隔の切り替え・長い途絶、uint32_tの時刻の周回
+//   - seqの欠番・子機再起動による巻き戻り
+//   - 測定失敗（組ごとの有効ビットの変化）、値の跳び（32bitの範囲全体を含む）
+//   - 直前の追記より古い時刻（バッチフレームの測定時刻）。直前の時刻に切り上げて保持されること
+// 時刻はSENSOR_CODEC_TIME_UNIT_MS単位に切り捨てて保持するため、照合は時刻の差がその範囲内かで行う。
+// 途中の時刻からの読み出し（時間索引の二分探索）が、その時刻以降の最初のレコードから始まることも確かめ、
+// 閉じたブロックの1件あたりの平均バイト数を表示する。1件でも不一致なら終了コード1。
+//
+// ビルド（リポジトリのルートで実行）:
+//   gcc -O2 -Wall -Iinclude -o history_test tools/udp_loadgen/history_test.c src/sensor_history.c src/sensor_codec.c src/sensor_channel.c
+//
+// 実行例:
+//   ./history_test                   （10万件）
+//   ./history_test -n 1000000 -s 7   （100万件、乱数の種を変える）
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <getopt.h>
+#include "sensor_channel.h"
+#include "sensor_history.h"
+
+// ==== 設定 ====
+#define START_BEFORE_WRAP   3600000u    // 開始時刻: uint32_tの周回の1時間前
+#define SEEK_EVERY          16          // この件数ごとに途中からの読み出しを確かめる
+
+static unsigned long s_checks;
+static unsigned long s_failures;
+
+#define CHECK(cond, ...) do {                                       \
+        s_checks++;                                                 \
+        if (!(cond)) {                                              \
+            if (s_failures++ < 20) {                                \
+                printf("FAIL %s:%d: ", __func__, __LINE__);         \
+                printf(__VA_ARGS__);                                \
+                printf("\n");                                       \
+            }                                                       \
+        }                                                           \
+    } while (0)
+
+typedef struct {
+    uint32_t time_ms;           // 保持されるはずの時刻（直前より古ければ直前の時刻）
+    temp_sens_data_t data;
+} expected_t;
+
+typedef struct {
+    uint32_t time_ms;
+    temp_sens_data_t data;
+} decoded_t;
+
+static uint32_t rand32(void)
+{
+    return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+// ==== 追記する列 ====
+typedef struct {
+    uint32_t time_ms;           // 受信時刻
+    uint32_t interval_ms;       // 現在の受信間隔
+    temp_sens_data_t data;
+} generator_t;
+
+static const uint32_t s_intervals[] = { 1000, 5000, 20000, 60000 };
+
+static void generator_init(generator_t *gen)
+{
+    memset(gen, 0, sizeof(*gen));
+    gen->time_ms = (uint32_t)0 - START_BEFORE_WRAP;
+    gen->interval_ms = 20000;
+    gen->data.seq = 1;
+    gen->data.ch[SENSOR_CH_AHT_T] = 253;
+    gen->data.ch[SENSOR_CH_AHT_RH] = 480;
+    gen->data.ch[SENSOR_CH_BMP_T] = 251;
+    gen->data.ch[SENSOR_CH_BMP_P] = 10132;
+    gen->data.ch_valid = (1u << SENSOR_CH_COUNT) - 1;
+}
+
+// 次の測定値と、その追記時刻（戻り値）
+static uint32_t generator_next(generator_t *gen, temp_sens_data_t *data)
+{
+    int r = rand() % 1000;
+
+    // 時刻: 間隔の揺れ（±3tick）、まれに間隔の切り替え・長い途絶
+    if (r < 5) {
+        gen->interval_ms = s_intervals[rand() % (sizeof(s_intervals) / sizeof(s_intervals[0]))];
+    }
+    uint32_t step = gen->interval_ms + (uint32_t)(rand() % 61) - 30;
+    if (r >= 5 && r < 10) {
+        step += rand32() % 7200000;             // 2時間までの途絶
+    }
+    gen->time_ms += step;
+
+    // seq: 通常+1、欠番、子機再起動
+    if (r >= 10 && r < 40) {
+        gen->data.seq += 1 + rand() % 50;
+    } else if (r >= 40 && r < 45) {
+        gen->data.seq = 0;
+    } else {
+        gen->data.seq++;
+    }
+
+    // 値: 0.1刻みのゆっくりした変化、まれに跳び
+    for (int ch = 0; ch < SENSOR_CH_COUNT; ch++) {
+        gen->data.ch[ch] += rand() % 5 - 2;
+    }
+    if (r >= 45 && r < 55) {
+        gen->data.ch[rand() % SENSOR_CH_COUNT] += (int32_t)(rand32() % 2000001) - 1000000;
+    } else if (r >= 55 && r < 57) {
+        gen->data.ch[rand() % SENSOR_CH_COUNT] = (int32_t)rand32();
+    }
+
+    // 測定失敗: 組ごとに有効ビットを落とす・戻す
+    if (r >= 57 && r < 77) {
+        static const uint32_t groups[] = {
+            (1u << SENSOR_CH_AHT_T) | (1u << SENSOR_CH_AHT_RH),
+            (1u << SENSOR_CH_BMP_T) | (1u << SENSOR_CH_BMP_P),
+        };
+        gen->data.ch_valid ^= groups[rand() % 2];
+    }
+
+    *data = gen->data;
+    // バッチフレームの測定値: 受信時刻から最大30秒さかのぼる
+    if (r >= 77 && r < 97) {
+        return gen->time_ms - rand32() % 30000;
+    }
+    return gen->time_ms;
+}
+
+// ==== 照合 ====
+static size_t decode_all(const sensor_history_t *history, decoded_t *out, size_t max_count)
+{
+    uint32_t oldest_ms;
+    if (!sensor_history_span(history, &oldest_ms, NULL)) {
+        return 0;
+    }
+    sensor_history_iter_t it;
+    sensor_history_seek(&it, history, oldest_ms);
+    size_t n = 0;
+    while (n < max_count && sensor_history_next(&it, &out[n].time_ms, &out[n].data)) {
+        n++;
+    }
+    return n;
+}
+
+static bool same_record(const decoded_t *got, const expected_t *want)
+{
+    uint32_t lag = want->time_ms - got->time_ms;
+    if (lag >= SENSOR_CODEC_TIME_UNIT_MS || got->data.seq != want->data.seq ||
+        got->data.ch_valid != want->data.ch_valid) {
+        return false;
+    }
+    for (int ch = 0; ch < SENSOR_CH_COUNT; ch++) {
+        if ((want->data.ch_valid & (1u << ch)) && got->data.ch[ch] != want->data.ch[ch]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// from_msからの読み出しが、復号した列でfrom_ms以降の最初のレコードから終端まで返すこと
+static void check_seek(const sensor_history_t *history, const decoded_t *decoded, size_t n, uint32_t from_ms)
+{
+    size_t first = 0;
+    while (first < n && (int32_t)(decoded[first].time_ms - from_ms) < 0) {
+        first++;
+    }
+
+    size_t block = sensor_history_find_block(history, from_ms);
+    const uint8_t *start = sensor_history_block(history, block);
+    CHECK(start != NULL, "find_block %zu of %zu", block, sensor_history_block_count(history));
+    // 選んだブロックはfrom_msより前に始まり（最初のブロックを除く）、次のブロックはfrom_ms以降に始まる
+    if (start != NULL && block > 0) {
+        CHECK((int32_t)(sensor_codec_block_first_ms(start) - from_ms) < 0, "block %zu starts at or after %lu",
+              block, (unsigned long)from_ms);
+    }
+    const uint8_t *next = sensor_history_block(history, block + 1);
+    if (next != NULL) {
+        CHECK((int32_t)(sensor_codec_block_first_ms(next) - from_ms) >= 0, "block %zu starts before %lu",
+              block + 1, (unsigned long)from_ms);
+    }
+
+    sensor_history_iter_t it;
+    sensor_history_seek(&it, history, from_ms);
+    decoded_t got;
+    size_t i = first;
+    while (sensor_history_next(&it, &got.time_ms, &got.data)) {
+        if (i >= n) {
+            CHECK(false, "seek %lu returned more than %zu records", (unsigned long)from_ms, n - first);
+            return;
+        }
+        CHECK(got.time_ms == decoded[i].time_ms && got.data.seq == decoded[i].data.seq,
+              "seek %lu record %zu: t=%lu seq=%lu, want t=%lu seq=%lu", (unsigned long)from_ms, i - first,
+              (unsigned long)got.time_ms, (unsigned long)got.data.seq,
+              (unsigned long)decoded[i].time_ms, (unsigned long)decoded[i].data.seq);
+        i++;
+    }
+    CHECK(i == n, "seek %lu returned %zu records, want %zu", (unsigned long)from_ms, i - first, n - first);
+}
+
+// ==== 往復テスト ====
+static void test_round_trip(size_t total)
+{
+    expected_t *expected = calloc(total, sizeof(*expected));
+    size_t decoded_max = SENSOR_HISTORY_BLOCKS * SENSOR_HISTORY_BLOCK_BYTES * 8;    // 1件は1bit以上
+    decoded_t *decoded = calloc(decoded_max, sizeof(*decoded));
+    if (expected == NULL || decoded == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+
+    static sensor_history_t history;
+    sensor_history_reset(&history);
+    CHECK(!sensor_history_span(&history, NULL, NULL) && sensor_history_block_count(&history) == 0, "empty");
+
+    generator_t gen;
+    generator_init(&gen);
+    size_t retained = 0;
+    unsigned long sealed_blocks = 0, sealed_records = 0, clamped = 0;
+    uint32_t first_ms = gen.time_ms;
+    bool wrapped = false;
+
+    for (size_t i = 0; i < total; i++) {
+        temp_sens_data_t data;
+        uint32_t time_ms = generator_next(&gen, &data);
+        expected[i].data = data;
+        expected[i].time_ms = time_ms;
+        if (i > 0 && (int32_t)(time_ms - expected[i - 1].time_ms) < 0) {
+            expected[i].time_ms = expected[i - 1].time_ms;
+            clamped++;
+        }
+        wrapped |= (i > 0) && expected[i].time_ms < expected[i - 1].time_ms;
+
+        size_t blocks_before = sensor_history_block_count(&history);
+        bool sealed = sensor_history_append(&history, time_ms, &data);
+        size_t blocks = sensor_history_block_count(&history);
+        if (sealed) {
+            // 閉じたブロックは新しいブロックの1つ前
+            const uint8_t *block = sensor_history_block(&history, blocks - 2);
+            CHECK(block != NULL, "sealed block at %zu", i);
+            if (block != NULL) {
+                sealed_blocks++;
+                sealed_records += (unsigned long)block[0] | ((unsigned long)block[1] << 8);
+            }
+        } else {
+            CHECK(blocks == ((i == 0) ? 1 : blocks_before), "block count %zu -> %zu without sealing",
+                  blocks_before, blocks);
+        }
+
+        size_t n = decode_all(&history, decoded, decoded_max);
+        // 捨てるのは満杯のリングで新しいブロックを始めた時だけ
+        bool dropped = sealed && blocks_before == SENSOR_HISTORY_BLOCKS;
+        CHECK(dropped ? (n > 0 && n <= retained + 1) : (n == retained + 1),
+              "append %zu: %zu records decoded, %zu before (sealed %d)", i, n, retained, sealed);
+        retained = n;
+        if (n == 0 || n > i + 1) {
+            continue;
+        }
+
+        // 復号した列は追記した列の末尾
+        size_t base = i + 1 - n;
+        for (size_t j = 0; j < n; j++) {
+            if (!same_record(&decoded[j], &expected[base + j])) {
+                CHECK(false, "append %zu: record %zu (t=%lu seq=%lu) differs from appended #%zu (t=%lu seq=%lu)",
+                      i, j, (unsigned long)decoded[j].time_ms, (unsigned long)decoded[j].data.seq, base + j,
+                      (unsigned long)expected[base + j].time_ms, (unsigned long)expected[base + j].data.seq);
+                break;
+            }
+            s_checks++;
+        }
+
+        uint32_t oldest_ms, newest_ms;
+        CHECK(sensor_history_span(&history, &oldest_ms, &newest_ms) && oldest_ms == decoded[0].time_ms &&
+              newest_ms == decoded[n - 1].time_ms, "span at %zu", i);
+
+        if (i % SEEK_EVERY == 0) {
+            uint32_t width = newest_ms - oldest_ms;
+            check_seek(&history, decoded, n, oldest_ms - 1000 + rand32() % (width + 2001));
+            check_seek(&history, decoded, n, decoded[rand() % n].time_ms);
+        }
+    }
+
+    CHECK(wrapped, "appended times did not cross the uint32_t wrap");
+    CHECK(clamped > 0, "no older time was appended");
+    printf("round trip: %zu readings over %lu days, %lu clamped to the previous time, %zu retained\n",
+           total, (unsigned long)((gen.time_ms - first_ms) / 86400000u), clamped, retained);
+    if (sealed_records > 0) {
+        printf("  %lu sealed blocks, %.2f bytes per reading (block of %d bytes, keyframes included)\n",
+               sealed_blocks, (double)sealed_blocks * SENSOR_HISTORY_BLOCK_BYTES / (double)sealed_records,
+               SENSOR_HISTORY_BLOCK_BYTES);
+    }
+
+    free(expected);
+    free(decoded);
+}
+
+// ==== main ====
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -n count       readings to append (default 100000)\n"
+        "  -s seed        random seed (default 1)\n",
+        prog);
+}
+
+int main(int argc, char **argv)
+{
+    size_t total = 100000;
+    unsigned int seed = 1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:h")) != -1) {
+        switch (opt) {
+            case 'n': total = strtoul(optarg, NULL, 10); break;
+            case 's': seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (total == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    srand(seed);
+
+    test_round_trip(total);
+
+    printf("history_test: %lu checks, %lu failures\n", s_checks, s_failures);
+    return (s_failures > 0) ? 1 : 0;
+}
@@ -0,0 +1,558 @@
+// tools/udp_loadgen/host_gateway.c
+// 受信経路のホストビルド（実機なしでudp_loadgenを実行するためのゲートウェイ代替）
+//
+// ファームウェアと同じ src/sensor_json.c・src/sensor_frame.c・src/sensor_channel.c・src/spsc_ring.c・src/ingest_admission.c を使い、
+// 受信スレッド（recvfromして送信元ごとのレート制限を通ったものをリングへ格納のみ）→ 処理スレッド（デコード・ストア更新）の
+// 2段構成でUDPポートを受信する。/sensor/data と /sensor/stats を同じJSON形式で返す。
+// 子機レジストリ・Webサーバ本体はFreeRTOS/ESP-IDFに依存するため、最小限のストアで代替している。
+// 送信間隔の下り制御は src/report_policy.c をそのまま使い、1秒周期で子機の送信元IPの制御ポートへ指示を送る
+// （/sensor/data の取得を閲覧中とみなす。ディスプレイはなし）。
+// 送信位相の割り当ても src/tx_schedule.c をそのまま使い（スロット番号 = 子機No-1）、10秒ごとに [SCHED] 行で
+// 整列した子機数・到着揺らぎ・近接到着率・欠番率を表示する（-S で補正を止めて比較できる）。
+//
+// ビルド（リポジトリのルートで実行）:
+//   gcc -O2 -Wall -pthread -Iinclude -o host_gateway tools/udp_loadgen/host_gateway.c src/sensor_json.c src/sensor_frame.c src/sensor_channel.c src/spsc_ring.c src/report_policy.c src/tx_schedule.c src/ingest_admission.c
+//
+// 実行例:
+//   ./host_gateway -p 50000 -w 8080
+//   ./udp_loadgen -H 127.0.0.1 -w 8080 -n 100 -r 5   （1つの送信元から多数の子機を送るため、-L 0 でレート制限を外す）
+//   ./host_gateway -p 50000 -w 8080 -s 5000          （1データグラムあたり5ms処理を遅らせて過負荷を再現）
+//   ./host_gateway -p 50000 -w 8080 -L 20:40         （送信元ごとのレート制限、既定はファームウェアと同じ値）
+//   ./child_sim -H 127.0.0.1 -w 8080 -n 50 -V 20:40
+//   ./host_gateway -p 50000 -w 8080 [-S] && ./child_sim -H 127.0.0.1 -w 8080 -n 50 -A 5 -D 200   （送信位相の比較）
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "sensor_json.h"
+#include "sensor_frame.h"
+#include "spsc_ring.h"
+#include "report_policy.h"
+#include "tx_schedule.h"
+#include "ingest_admission.h"
+
+// ==== 設定 ====
+#define MAX_PAYLOAD_SIZE    256
+#define RING_SLOTS          32
+#define CHILD_NO_MAX        254
+#define SEQ_RESTART_GAP     1024        // ファームウェアのCHILD_SEQ_RESTART_GAPと同じ
+#define HTTP_BODY_SIZE      (64 * 1024)
+#define STALE_TIMEOUT_MS    5000        // ファームウェアのCHILD_STALE_TIMEOUT_MSと同じ
+#define STALE_MISSED        2           // ファームウェアのCHILD_STALE_MISSED_REPORTSと同じ
+#define VIEWER_TIMEOUT_MS   6000        // ファームウェアのWEB_VIEWER_TIMEOUT_MSと同じ
+#define CONTROL_REFRESH_MS  10000       // ファームウェアのREPORT_CONTROL_REFRESH_MSと同じ
+#define SCHEDULE_WINDOW_MS  10000       // ファームウェアのREPORT_SCHEDULE_WINDOW_MSと同じ
+
+typedef struct {
+    uint16_t len;
+    uint32_t source_ip;                 // 送信元IP（ネットワークバイトオーダ）
+    uint32_t recv_time_ms;              // 受信時刻（受信段で記録）
+    char data[MAX_PAYLOAD_SIZE + 1];
+} ingest_slot_t;
+
+typedef struct {
+    bool valid;
+    temp_sens_data_t data;
+    uint32_t received;      // 受理した測定値数
+    uint32_t duplicate;     // 重複・古いseqとして破棄した数
+    uint32_t lost;          // seqの欠番数
+    uint32_t source_ip;     // 送信元IP（下り制御の宛先）
+    uint64_t last_recv_ms;  // 最終受信時刻
+    uint16_t sent_seq;      // 送信済みの指示通番
+    uint64_t sent_ms;       // 指示の最終送信時刻（0=未送信）
+    uint32_t interval_ms;   // 指示した送信間隔（0=未指示）
+    tx_phase_t tx_phase;    // 到着位相・揺らぎ
+} child_entry_t;
+
+static ingest_slot_t s_slots[RING_SLOTS];
+static spsc_ring_t s_ring;
+static pthread_mutex_t s_ring_mutex = PTHREAD_MUTEX_INITIALIZER;   // 処理スレッドの起床用のみ
+static pthread_cond_t s_ring_cond = PTHREAD_COND_INITIALIZER;
+
+static child_entry_t s_children[CHILD_NO_MAX + 1];
+static pthread_mutex_t s_store_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int s_process_delay_us = 0;                  // 処理段の模擬遅延（1データグラムあたり）
+static ingest_admission_t s_admission;              // 受信スレッドのみ更新
+static bool s_admission_enabled = true;
+static volatile uint64_t s_last_poll_ms = 0;        // /sensor/data の最終取得時刻
+static report_policy_t s_policy;
+static uint16_t s_ctrl_seq = 0;
+static uint32_t s_ctrl_sent = 0;
+static bool s_schedule_enabled = true;
+static uint16_t s_phase_seq = 0;
+static uint32_t s_phase_shifts = 0;
+static tx_arrival_stats_t s_arrival_stats;          // s_store_mutexで保護
+
+static uint64_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+// ==== 受信スレッド（受信段） ====
+static void *recv_thread(void *arg)
+{
+    int sock = *(int *)arg;
+    static char discard[MAX_PAYLOAD_SIZE];
+
+    while (1) {
+        ingest_slot_t *slot = (ingest_slot_t *)spsc_ring_acquire(&s_ring);
+        char *buf = (slot != NULL) ? slot->data : discard;
+        struct sockaddr_in src;
+        socklen_t src_len = sizeof(src);
+        ssize_t len = recvfrom(sock, buf, MAX_PAYLOAD_SIZE, 0, (struct sockaddr *)&src, &src_len);
+        if (len <= 0) {
+            continue;
+        }
+        uint32_t recv_time_ms = (uint32_t)now_ms();
+        if (s_admission_enabled) {
+            ingest_admit_t verdict = ingest_admission_check(&s_admission, src.sin_addr.s_addr, recv_time_ms);
+            if (verdict == INGEST_ADMIT_DROP_START) {
+                printf("[ADMIT] %s exceeded %u datagrams/s, dropping\n", inet_ntoa(src.sin_addr),
+                       s_admission.rate_per_sec);
+                fflush(stdout);
+            }
+            if (verdict != INGEST_ADMIT_PASS) {
+                continue;
+            }
+        }
+        if (slot == NULL) {
+            spsc_ring_note_overflow(&s_ring);
+            continue;
+        }
+        slot->len = (uint16_t)len;
+        slot->source_ip = src.sin_addr.s_addr;
+        slot->recv_time_ms = recv_time_ms;
+        spsc_ring_publish(&s_ring);
+
+        pthread_mutex_lock(&s_ring_mutex);
+        pthread_cond_signal(&s_ring_cond);
+        pthread_mutex_unlock(&s_ring_mutex);
+    }
+    return NULL;
+}
+
+// ==== 処理スレッド（処理段） ====
+static void store_readings(uint8_t child_no, uint32_t source_ip, uint32_t recv_time_ms,
+                           const temp_sens_data_t *readings, size_t count)
+{
+    if (child_no < 1 || child_no > CHILD_NO_MAX) {
+        return;
+    }
+
+    pthread_mutex_lock(&s_store_mutex);
+    child_entry_t *c = &s_children[child_no];
+    c->source_ip = source_ip;
+    c->last_recv_ms = now_ms();
+    if (c->interval_ms != 0) {
+        tx_phase_on_arrival(&c->tx_phase, recv_time_ms, c->interval_ms);
+    }
+    tx_arrival_note(&s_arrival_stats, recv_time_ms);
+    for (size_t i = 0; i < count; i++) {
+        if (c->valid) {
+            int32_t diff = (int32_t)(readings[i].seq - c->data.seq);
+            if (diff <= 0 && diff >= -SEQ_RESTART_GAP) {
+                c->duplicate++;
+                continue;
+            }
+            if (diff > 0) {
+                c->lost += (uint32_t)(diff - 1);
+            }
+        }
+        c->data = readings[i];
+        c->valid = true;
+        c->received++;
+    }
+    pthread_mutex_unlock(&s_store_mutex);
+}
+
+static void *process_thread(void *arg)
+{
+    (void)arg;
+    static temp_sens_data_t readings[SENSOR_FRAME_BATCH_MAX];
+
+    while (1) {
+        pthread_mutex_lock(&s_ring_mutex);
+        while (spsc_ring_count(&s_ring) == 0) {
+            pthread_cond_wait(&s_ring_cond, &s_ring_mutex);
+        }
+        pthread_mutex_unlock(&s_ring_mutex);
+
+        ingest_slot_t *slot;
+        while ((slot = (ingest_slot_t *)spsc_ring_front(&s_ring)) != NULL) {
+            uint8_t child_no = 0;
+            size_t count = 0;
+            const uint8_t *buf = (const uint8_t *)slot->data;
+
+            if (sensor_frame_is_batch(buf, slot->len)) {
+                if (sensor_frame_decode_batch(buf, slot->len, &child_no, readings, NULL,
+                                              SENSOR_FRAME_BATCH_MAX, &count) != SENSOR_FRAME_OK) {
+                    count = 0;
+                }
+            } else if (sensor_frame_is_binary(buf, slot->len)) {
+                count = (sensor_frame_decode(buf, slot->len, &child_no, &readings[0]) == SENSOR_FRAME_OK) ? 1 : 0;
+            } else {
+                count = (sensor_json_decode(slot->data, slot->len, &child_no, &readings[0]) == SENSOR_JSON_OK) ? 1 : 0;
+            }
+            if (count > 0) {
+                store_readings(child_no, slot->source_ip, slot->recv_time_ms, readings, count);
+            }
+            spsc_ring_pop(&s_ring);
+            if (s_process_delay_us > 0) {
+                usleep((useconds_t)s_process_delay_us);
+            }
+        }
+    }
+    return NULL;
+}
+
+// ==== 下り制御スレッド（ファームウェアのreport_control_tick相当） ====
+static bool send_control(int sock, int control_port, const child_entry_t *c, const sensor_control_t *ctrl)
+{
+    uint8_t frame[SENSOR_CONTROL_FRAME_SIZE];
+    size_t len = sensor_frame_encode_control(ctrl, frame, sizeof(frame));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = c->source_ip;
+    addr.sin_port = htons((uint16_t)control_port);
+    return sendto(sock, frame, len, MSG_DONTWAIT, (struct sockaddr *)&addr, sizeof(addr)) == (ssize_t)len;
+}
+
+// 送信位相の補正（ファームウェアのschedule_child相当、s_store_mutex取得済みで呼ぶ）
+static void schedule_children(int sock, int control_port, uint32_t interval_ms, uint64_t now,
+                              uint32_t *scheduled, uint32_t *aligned, uint32_t *jitter_sum)
+{
+    int span = 0;
+    for (int no = 1; no <= CHILD_NO_MAX; no++) {
+        if (s_children[no].valid) {
+            span = no;
+        }
+    }
+    uint32_t tolerance_ms = tx_schedule_tolerance_ms(interval_ms, (size_t)span);
+
+    for (int no = 1; no <= CHILD_NO_MAX; no++) {
+        child_entry_t *c = &s_children[no];
+        tx_phase_t *phase = &c->tx_phase;
+        if (!c->valid || phase->interval_ms != interval_ms ||
+            (uint32_t)now - phase->last_arrival_ms > interval_ms * STALE_MISSED) {
+            continue;
+        }
+        (*scheduled)++;
+        *jitter_sum += tx_phase_jitter_ms(phase);
+
+        int32_t shift_ms;
+        if (!tx_schedule_correction(phase, tx_schedule_target_ms((uint8_t)(no - 1), interval_ms),
+                                    tolerance_ms, &shift_ms)) {
+            if (phase->arrivals >= TX_PHASE_SETTLE_ARRIVALS) {
+                (*aligned)++;
+            }
+            continue;
+        }
+        if (!s_schedule_enabled) {
+            continue;
+        }
+        sensor_control_t ctrl = {
+            .child_no = (uint8_t)no,
+            .type = SENSOR_CONTROL_SHIFT_PHASE,
+            .ctrl_seq = (uint16_t)(s_phase_seq + 1),
+            .value = (uint32_t)shift_ms,
+        };
+        if (send_control(sock, control_port, c, &ctrl)) {
+            s_phase_seq++;
+            s_phase_shifts++;
+            tx_phase_restart(phase);
+        }
+    }
+}
+
+static void *control_thread(void *arg)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int control_port = *(int *)arg;
+    uint32_t last_overflow = 0;
+    spsc_ring_stats_t ring;
+    uint64_t window_start = now_ms();
+    tx_arrival_stats_t window_arrivals = { 0 };
+    uint32_t window_received = 0;
+    uint32_t window_lost = 0;
+
+    report_policy_init(&s_policy);
+    s_ctrl_seq = (uint16_t)now_ms();
+    s_phase_seq = (uint16_t)(now_ms() >> 16);
+
+    while (1) {
+        sleep(1);
+        uint64_t now = now_ms();
+        spsc_ring_get_stats(&s_ring, &ring);
+
+        report_policy_input_t in = {
+            .ring_pending = ring.count,
+            .ring_capacity = ring.capacity,
+            .overflow_delta = ring.overflow - last_overflow,
+            .viewer_active = s_last_poll_ms != 0 && now - s_last_poll_ms < VIEWER_TIMEOUT_MS,
+        };
+        last_overflow = ring.overflow;
+
+        uint32_t prev_ms = s_policy.interval_ms;
+        pthread_mutex_lock(&s_store_mutex);
+        for (int no = 1; no <= CHILD_NO_MAX; no++) {
+            const child_entry_t *c = &s_children[no];
+            uint32_t stale_ms = prev_ms * STALE_MISSED > STALE_TIMEOUT_MS ? prev_ms * STALE_MISSED : STALE_TIMEOUT_MS;
+            if (c->valid && now - c->last_recv_ms < stale_ms) {
+                in.active_children++;
+            }
+        }
+        pthread_mutex_unlock(&s_store_mutex);
+
+        uint32_t interval_ms = report_policy_update(&s_policy, &in);
+        if (interval_ms != prev_ms) {
+            s_ctrl_seq++;
+            printf("[CTRL] interval %ums -> %ums (children=%u viewer=%d backoff=%u%s)\n",
+                   prev_ms, interval_ms, in.active_children, in.viewer_active,
+                   s_policy.backoff, s_policy.overloaded ? " overload" : "");
+            fflush(stdout);
+        }
+
+        sensor_control_t ctrl = {
+            .type = SENSOR_CONTROL_SET_INTERVAL,
+            .ctrl_seq = s_ctrl_seq,
+            .value = interval_ms,
+        };
+        uint32_t scheduled = 0;
+        uint32_t aligned = 0;
+        uint32_t jitter_sum = 0;
+
+        pthread_mutex_lock(&s_store_mutex);
+        schedule_children(sock, control_port, interval_ms, now, &scheduled, &aligned, &jitter_sum);
+        for (int no = 1; no <= CHILD_NO_MAX; no++) {
+            child_entry_t *c = &s_children[no];
+            if (!c->valid || (c->sent_ms != 0 && c->sent_seq == s_ctrl_seq && now - c->sent_ms < CONTROL_REFRESH_MS)) {
+                continue;
+            }
+            ctrl.child_no = (uint8_t)no;
+            if (send_control(sock, control_port, c, &ctrl)) {
+                c->sent_seq = s_ctrl_seq;
+                c->sent_ms = now;
+                c->interval_ms = interval_ms;
+                s_ctrl_sent++;
+            }
+        }
+
+        // 集計区間ごとの到着統計
+        if (now - window_start >= SCHEDULE_WINDOW_MS) {
+            uint32_t received = 0;
+            uint32_t lost = 0;
+            for (int no = 1; no <= CHILD_NO_MAX; no++) {
+                received += s_children[no].received;
+                lost += s_children[no].lost;
+            }
+            uint32_t rx = s_arrival_stats.arrivals - window_arrivals.arrivals;
+            uint32_t close = s_arrival_stats.close_arrivals - window_arrivals.close_arrivals;
+            uint32_t rx_seq = received - window_received;
+            uint32_t lost_seq = lost - window_lost;
+            if (rx > 0) {
+                printf("[SCHED] %s interval=%ums aligned=%u/%u jitter=%ums close=%.1f%% loss=%.1f%% shifts=%u\n",
+                       s_schedule_enabled ? "on" : "off", interval_ms, aligned, scheduled,
+                       scheduled > 0 ? jitter_sum / scheduled : 0,
+                       100.0 * close / rx, rx_seq + lost_seq > 0 ? 100.0 * lost_seq / (rx_seq + lost_seq) : 0.0,
+                       s_phase_shifts);
+                fflush(stdout);
+            }
+            window_start = now;
+            window_arrivals = s_arrival_stats;
+            window_received = received;
+            window_lost = lost;
+        }
+        pthread_mutex_unlock(&s_store_mutex);
+    }
+    return NULL;
+}
+
+// ==== HTTP ====
+static size_t build_sensor_data(char *body, size_t size)
+{
+    size_t len = (size_t)snprintf(body, size, "{\"children\":[");
+    bool first = true;
+
+    pthread_mutex_lock(&s_store_mutex);
+    for (int no = 1; no <= CHILD_NO_MAX && len < size - (SENSOR_DATA_JSON_MAX + 64); no++) {
+        const child_entry_t *c = &s_children[no];
+        if (!c->valid) {
+            continue;
+        }
+        len += (size_t)snprintf(body + len, size - len, "%s{\"child_no\":%d,\"valid\":true,", first ? "" : ",", no);
+        len += sensor_data_write_json(&c->data, body + len, size - len);
+        len += (size_t)snprintf(body + len, size - len, ",\"seq\":%u,\"rssi\":%d}", c->data.seq, c->data.rssi);
+        first = false;
+    }
+    pthread_mutex_unlock(&s_store_mutex);
+
+    len += (size_t)snprintf(body + len, size - len, "]}");
+    return len;
+}
+
+static size_t build_sensor_stats(char *body, size_t size)
+{
+    spsc_ring_stats_t ring;
+    spsc_ring_get_stats(&s_ring, &ring);
+    ingest_admission_stats_t adm;
+    ingest_admission_get_stats(&s_admission, &adm);
+    size_t len = (size_t)snprintf(body, size,
+        "{\"ingest_ring\":{\"capacity\":%u,\"used\":%u,\"high_water\":%u,\"overflow\":%u},"
+        "\"admission\":{\"enabled\":%s,\"rate\":%u,\"burst\":%u,\"sources\":%u,\"admitted\":%u,\"dropped\":%u},"
+        "\"report_control\":{\"interval_ms\":%u,\"backoff\":%u,\"overloaded\":%s,\"ctrl_seq\":%u,\"sent\":%u},"
+        "\"tx_schedule\":{\"enabled\":%s,\"shifts\":%u},\"children\":[",
+        ring.capacity, ring.count, ring.high_water, ring.overflow,
+        s_admission_enabled ? "true" : "false", adm.rate_per_sec, adm.burst, adm.sources, adm.admitted, adm.dropped,
+        s_policy.interval_ms, s_policy.backoff, s_policy.overloaded ? "true" : "false", s_ctrl_seq, s_ctrl_sent,
+        s_schedule_enabled ? "true" : "false", s_phase_shifts);
+    bool first = true;
+
+    pthread_mutex_lock(&s_store_mutex);
+    for (int no = 1; no <= CHILD_NO_MAX && len < size - 256; no++) {
+        const child_entry_t *c = &s_children[no];
+        if (!c->valid) {
+            continue;
+        }
+        len += (size_t)snprintf(body + len, size - len,
+            "%s{\"child_no\":%d,\"last_seq\":%u,\"received\":%u,\"lost\":%u,\"duplicate\":%u,\"jitter_ms\":%u}",
+            first ? "" : ",", no, c->data.seq, c->received, c->lost, c->duplicate, tx_phase_jitter_ms(&c->tx_phase));
+        first = false;
+    }
+    pthread_mutex_unlock(&s_store_mutex);
+
+    len += (size_t)snprintf(body + len, size - len, "]}");
+    return len;
+}
+
+static void http_serve(int client)
+{
+    static char req[1024];
+    static char body[HTTP_BODY_SIZE];
+    char hdr[160];
+
+    ssize_t n = recv(client, req, sizeof(req) - 1, 0);
+    if (n <= 0) {
+        return;
+    }
+    req[n] = '\0';
+
+    size_t len;
+    const char *status = "200 OK";
+    if (strncmp(req, "GET /sensor/data ", 17) == 0) {
+        s_last_poll_ms = now_ms();
+        len = build_sensor_data(body, sizeof(body));
+    } else if (strncmp(req, "GET /sensor/stats ", 18) == 0) {
+        len = build_sensor_stats(body, sizeof(body));
+    } else {
+        status = "404 Not Found";
+        len = (size_t)snprintf(body, sizeof(body), "{}");
+    }
+
+    int hdr_len = snprintf(hdr, sizeof(hdr),
+        "HTTP/1.1 %s\r\nContent-Type: application/json\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+        status, len);
+    send(client, hdr, (size_t)hdr_len, MSG_NOSIGNAL);
+    send(client, body, len, MSG_NOSIGNAL);
+}
+
+// ==== メイン ====
+static int open_socket(int type, int port)
+{
+    int sock = socket(AF_INET, type, 0);
+    if (sock < 0) {
+        return -1;
+    }
+    int yes = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons((uint16_t)port);
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+int main(int argc, char **argv)
+{
+    int udp_port = 50000;
+    int http_port = 8080;
+    int control_port = SENSOR_CONTROL_PORT;
+    unsigned int admit_rate = INGEST_ADMIT_RATE_PER_SEC;
+    unsigned int admit_burst = INGEST_ADMIT_BURST;
+    int opt;
+    while ((opt = getopt(argc, argv, "p:w:c:s:SL:")) != -1) {
+        switch (opt) {
+        case 'p': udp_port = atoi(optarg); break;
+        case 'w': http_port = atoi(optarg); break;
+        case 'c': control_port = atoi(optarg); break;
+        case 's': s_process_delay_us = atoi(optarg); break;
+        case 'S': s_schedule_enabled = false; break;
+        case 'L':
+            if (strcmp(optarg, "0") == 0) {
+                s_admission_enabled = false;
+            } else if (sscanf(optarg, "%u:%u", &admit_rate, &admit_burst) != 2) {
+                fprintf(stderr, "-L expects rate:burst or 0\n");
+                return 1;
+            }
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-p udp_port] [-w http_port] [-c child_control_port] [-s process_delay_us]"
+                    " [-S (no phase schedule)] [-L rate:burst | -L 0 (no admission limit)]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    spsc_ring_init(&s_ring, s_slots, sizeof(ingest_slot_t), RING_SLOTS);
+    if (!ingest_admission_init(&s_admission, admit_rate, admit_burst)) {
+        fprintf(stderr, "invalid admission limit %u:%u\n", admit_rate, admit_burst);
+        return 1;
+    }
+
+    int udp_sock = open_socket(SOCK_DGRAM, udp_port);
+    int http_sock = open_socket(SOCK_STREAM, http_port);
+    if (udp_sock < 0 || http_sock < 0 || listen(http_sock, 8) < 0) {
+        perror("bind");
+        return 1;
+    }
+    printf("host gateway: UDP %d, HTTP %d, child control %d, phase schedule %s, admission %s\n", udp_port, http_port,
+           control_port, s_schedule_enabled ? "on" : "off", s_admission_enabled ? "on" : "off");
+
+    pthread_t rx, proc, ctrl;
+    pthread_create(&rx, NULL, recv_thread, &udp_sock);
+    pthread_create(&proc, NULL, process_thread, NULL);
+    pthread_create(&ctrl, NULL, control_thread, &control_port);
+
+    while (1) {
+        int client = accept(http_sock, NULL, NULL);
+        if (client < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("accept");
+            break;
+        }
+        http_serve(client);
+        close(client);
+    }
+    return 0;
+}
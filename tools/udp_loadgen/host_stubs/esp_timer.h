@@ -0,0 +1,6 @@
+#pragma once
+
+#include <stdint.h>
+
+// 起動からのµs（テスト側で用意する）
+int64_t esp_timer_get_time(void);
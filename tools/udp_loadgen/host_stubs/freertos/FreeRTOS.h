@@ -0,0 +1,40 @@
+#pragma once
+
+// ホスト側テスト（registry_test等）でファームウェアのモジュールをそのままコンパイルするための最小限のスタブ
+//
+// 型・マクロだけを置き、関数の実体はテスト側で用意する（時刻を進める・ロックを何もしない等）。
+// 1タスクで呼ぶ前提のため、クリティカルセクションとミューテックスは何もしない。
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef void *TaskHandle_t;
+typedef void *SemaphoreHandle_t;
+typedef void *QueueHandle_t;
+
+typedef struct {
+    int unused;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED    { 0 }
+#define portMAX_DELAY                   0xFFFFFFFFu
+#define portTICK_PERIOD_MS              1
+#define pdMS_TO_TICKS(ms)               (ms)
+#define pdTRUE                          1
+#define pdFALSE                         0
+#define pdPASS                          1
+
+#define configASSERT(x)                 ((void)(x))
+#define taskENTER_CRITICAL(mux)         ((void)(mux))
+#define taskEXIT_CRITICAL(mux)          ((void)(mux))
+
+TickType_t xTaskGetTickCount(void);
+void vTaskDelay(TickType_t ticks);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
@@ -0,0 +1,7 @@
+#pragma once
+
+// lwIPのソケットAPIはPOSIXと同じ名前なので、ホストのヘッダで代用する
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
@@ -0,0 +1,390 @@
+// tools/udp_loadgen/json_bench.c
+// 子機JSONデコードの速度・ヒープ使用の比較（src/sensor_json.c と cJSON、Linux）
+//
+// 同じデータグラムの列を、ファームウェアのストリーミングデコーダ（sensor_json_decode）と、
+// 従来の受信処理と同じcJSON経由のデコード（cJSON_Parse → キーごとにcJSON_GetObjectItem → cJSON_Delete）で読み、
+//   - 両者の結果（戻り値・child_no・チャネル値と有効ビット・seq・rssi）が一致すること
+//   - 1データグラムあたりの時間とスループット
+//   - cJSON側のmalloc回数・確保バイト数（cJSON_InitHooksで数える。sensor_jsonはヒープを使わない）
+// を表示する。入力はファイル・ディレクトリ（1ファイル1データグラム、json_corpus/等）を指定するか、
+// 指定がなければ子機と同じ形式のJSONを-n件合成する（測定失敗・rssi省略・キー順の入れ替えを含む）。
+// 結果が食い違った入力は先頭の数件を表示し、終了コード1にする。
+// cJSONは入れ子の中身まで検証し、キーのエスケープを展開するため、壊れたJSON（json_corpus/の一部）では
+// 戻り値が食い違うことがある。その場合は -k で食い違いを表示だけにして計測を続けられる。
+//
+// ビルド（リポジトリのルートで実行、cJSONはESP-IDF同梱のもの）:
+//   gcc -O2 -Wall -Iinclude -I$IDF_PATH/components/json/cJSON -o json_bench tools/udp_loadgen/json_bench.c src/sensor_json.c src/sensor_channel.c $IDF_PATH/components/json/cJSON/cJSON.c
+//
+// 実行例:
+//   ./json_bench                                  （合成した10万件）
+//   ./json_bench -n 1000000 -r 5
+//   ./json_bench -k tools/udp_loadgen/json_corpus （シードコーパス、壊れた入力の食い違いは表示のみ）
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <dirent.h>
+#include <getopt.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "cJSON.h"
+#include "sensor_json.h"
+
+// ==== 設定 ====
+#define DATAGRAM_MAX        1024        // 受信バッファ（MAX_PAYLOAD_SIZE）と同程度
+#define MISMATCH_SHOW       5
+
+typedef struct {
+    char *data;             // NUL終端付き（cJSON_Parse用、sensor_jsonには長さで渡す）
+    size_t len;
+    const char *name;       // 表示用（合成時はNULL）
+} datagram_t;
+
+typedef struct {
+    datagram_t *items;
+    size_t count;
+    size_t capacity;
+    size_t bytes;
+} input_t;
+
+typedef struct {
+    sensor_json_result_t result;
+    uint8_t child_no;
+    temp_sens_data_t data;
+} decoded_t;
+
+// cJSONのヒープ使用
+static uint64_t s_mallocs;
+static uint64_t s_malloc_bytes;
+
+static void *count_malloc(size_t size)
+{
+    s_mallocs++;
+    s_malloc_bytes += size;
+    return malloc(size);
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void input_push(input_t *in, const char *data, size_t len, const char *name)
+{
+    if (in->count == in->capacity) {
+        in->capacity = (in->capacity > 0) ? in->capacity * 2 : 1024;
+        in->items = realloc(in->items, in->capacity * sizeof(datagram_t));
+        if (in->items == NULL) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+    datagram_t *d = &in->items[in->count++];
+    d->data = malloc(len + 1);
+    if (d->data == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    memcpy(d->data, data, len);
+    d->data[len] = '\0';
+    d->len = len;
+    d->name = (name != NULL) ? strdup(name) : NULL;
+    in->bytes += len;
+}
+
+// ==== 入力 ====
+static bool load_file(input_t *in, const char *path)
+{
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        perror(path);
+        return false;
+    }
+    char buf[DATAGRAM_MAX];
+    size_t len = fread(buf, 1, sizeof(buf), fp);
+    fclose(fp);
+    input_push(in, buf, len, path);
+    return true;
+}
+
+static bool load_path(input_t *in, const char *path)
+{
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        perror(path);
+        return false;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        return load_file(in, path);
+    }
+    struct dirent **names;
+    int n = scandir(path, &names, NULL, alphasort);
+    if (n < 0) {
+        perror(path);
+        return false;
+    }
+    bool ok = true;
+    for (int i = 0; i < n; i++) {
+        if (names[i]->d_name[0] != '.') {
+            char file[4096];
+            snprintf(file, sizeof(file), "%s/%s", path, names[i]->d_name);
+            ok = load_file(in, file) && ok;
+        }
+        free(names[i]);
+    }
+    free(names);
+    return ok;
+}
+
+// 子機の送信と同じ形式（sensor_data_write_json）。3%はBMP測定失敗、10%はrssi省略、10%はseqを先頭に置く
+static void synthesize(input_t *in, size_t count, unsigned int seed)
+{
+    srand(seed);
+    for (size_t i = 0; i < count; i++) {
+        temp_sens_data_t data;
+        memset(&data, 0, sizeof(data));
+        sensor_data_set(&data, SENSOR_CH_AHT_T, 200 + rand() % 80);
+        sensor_data_set(&data, SENSOR_CH_AHT_RH, 400 + rand() % 200);
+        if (rand() % 100 >= 3) {
+            sensor_data_set(&data, SENSOR_CH_BMP_T, 200 + rand() % 80);
+            sensor_data_set(&data, SENSOR_CH_BMP_P, 100000 + rand() % 2000);
+        }
+        int child_no = 1 + (int)(i % 64);
+        unsigned long seq = (unsigned long)(i / 64);
+        char members[SENSOR_DATA_JSON_MAX];
+        sensor_data_write_json(&data, members, sizeof(members));
+
+        char buf[DATAGRAM_MAX];
+        int len;
+        int variant = rand() % 10;
+        if (variant == 0) {
+            len = snprintf(buf, sizeof(buf), "{\"child_no\":%d,%s,\"seq\":%lu}", child_no, members, seq);
+        } else if (variant == 1) {
+            len = snprintf(buf, sizeof(buf), "{\"seq\":%lu,\"rssi\":%d,%s,\"child_no\":%d}",
+                           seq, -40 - rand() % 50, members, child_no);
+        } else {
+            len = snprintf(buf, sizeof(buf), "{\"child_no\":%d,%s,\"seq\":%lu,\"rssi\":%d}",
+                           child_no, members, seq, -40 - rand() % 50);
+        }
+        input_push(in, buf, (size_t)len, NULL);
+    }
+}
+
+// ==== cJSON経由のデコード ====
+// 従来の受信処理と同じ手順。キーは大文字小文字を区別する（sensor_jsonと同じ）、同じキーは最初の値を採用する
+static int64_t cjson_int(const cJSON *item)
+{
+    double d = cJSON_GetNumberValue(item);
+    if (!(d == d)) {
+        return 0;   // 数値以外（NaN）
+    }
+    if (d >= 9.2e18) {
+        return INT64_MAX;
+    }
+    if (d <= -9.2e18) {
+        return INT64_MIN;
+    }
+    return (int64_t)d;
+}
+
+static void decode_cjson(const datagram_t *d, decoded_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    cJSON *json = cJSON_ParseWithLength(d->data, d->len);
+    if (json == NULL || !cJSON_IsObject(json)) {
+        out->result = SENSOR_JSON_ERR_SYNTAX;
+        cJSON_Delete(json);
+        return;
+    }
+    const cJSON *child_no = cJSON_GetObjectItemCaseSensitive(json, "child_no");
+    const cJSON *seq = cJSON_GetObjectItemCaseSensitive(json, "seq");
+    const cJSON *rssi = cJSON_GetObjectItemCaseSensitive(json, "rssi");
+    const cJSON *channels[SENSOR_CH_COUNT];
+    bool any_channel = false;
+    for (int ch = 0; ch < SENSOR_CH_COUNT; ch++) {
+        channels[ch] = cJSON_GetObjectItemCaseSensitive(json, sensor_channel_get((sensor_ch_t)ch)->key);
+        any_channel = any_channel || channels[ch] != NULL;
+    }
+    if (child_no == NULL || seq == NULL || !any_channel) {
+        out->result = SENSOR_JSON_ERR_MISSING;
+        cJSON_Delete(json);
+        return;
+    }
+
+    out->result = SENSOR_JSON_OK;
+    out->child_no = (uint8_t)cjson_int(child_no);
+    out->data.seq = (uint32_t)cjson_int(seq);
+    out->data.rssi = (rssi != NULL) ? (int)cjson_int(rssi) : 0;
+    for (int ch = 0; ch < SENSOR_CH_COUNT; ch++) {
+        if (cJSON_IsNumber(channels[ch])) {
+            sensor_data_set(&out->data, (sensor_ch_t)ch, cjson_int(channels[ch]));
+        }
+    }
+    for (int g = 0; g < SENSOR_GROUP_COUNT; g++) {
+        const cJSON *ok = cJSON_GetObjectItemCaseSensitive(json, sensor_group_ok_key((sensor_group_t)g));
+        if (ok != NULL) {
+            sensor_data_apply_group(&out->data, (sensor_group_t)g, cJSON_IsTrue(ok));
+        }
+    }
+    cJSON_Delete(json);
+}
+
+static void decode_stream(const datagram_t *d, decoded_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->result = sensor_json_decode(d->data, d->len, &out->child_no, &out->data);
+}
+
+static bool same_result(const decoded_t *a, const decoded_t *b)
+{
+    if (a->result != b->result) {
+        return false;
+    }
+    if (a->result != SENSOR_JSON_OK) {
+        return true;
+    }
+    if (a->child_no != b->child_no || a->data.seq != b->data.seq || a->data.rssi != b->data.rssi ||
+        a->data.ch_valid != b->data.ch_valid) {
+        return false;
+    }
+    for (int ch = 0; ch < SENSOR_CH_COUNT; ch++) {
+        if (sensor_data_valid(&a->data, (sensor_ch_t)ch) && a->data.ch[ch] != b->data.ch[ch]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void print_result(const char *label, const decoded_t *r)
+{
+    printf("    %-7s result=%d", label, r->result);
+    if (r->result == SENSOR_JSON_OK) {
+        char values[SENSOR_DATA_TEXT_MAX];
+        sensor_data_format(&r->data, values, sizeof(values));
+        printf(" N=%d seq=%lu rssi=%d %s", r->child_no, (unsigned long)r->data.seq, r->data.rssi, values);
+    }
+    printf("\n");
+}
+
+// ==== 計測 ====
+typedef void (*decode_fn_t)(const datagram_t *d, decoded_t *out);
+
+static double time_decoder(const input_t *in, decode_fn_t fn, int repeats)
+{
+    volatile uint32_t sink = 0;
+    decoded_t r;
+    uint64_t t0 = now_ns();
+    for (int k = 0; k < repeats; k++) {
+        for (size_t i = 0; i < in->count; i++) {
+            fn(&in->items[i], &r);
+            sink += r.data.seq + (uint32_t)r.result;
+        }
+    }
+    (void)sink;
+    return (double)(now_ns() - t0) / 1e9 / repeats;
+}
+
+// ==== main ====
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "usage: %s [options] [file|dir]...\n"
+        "  -n count       synthesized datagrams when no input is given (default 100000)\n"
+        "  -r repeats     decode repetitions for timing (default 10)\n"
+        "  -k             report mismatches but keep going (exit 0)\n",
+        prog);
+}
+
+int main(int argc, char **argv)
+{
+    size_t count = 100000;
+    int repeats = 10;
+    bool keep_going = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:r:kh")) != -1) {
+        switch (opt) {
+            case 'n': count = (size_t)strtoul(optarg, NULL, 10); break;
+            case 'r': repeats = atoi(optarg); break;
+            case 'k': keep_going = true; break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (count == 0 || repeats < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    input_t in = { 0 };
+    if (optind < argc) {
+        for (int i = optind; i < argc; i++) {
+            if (!load_path(&in, argv[i])) {
+                return 1;
+            }
+        }
+        printf("input: %zu datagrams from %d path(s), %.1f bytes avg\n",
+               in.count, argc - optind, in.count ? (double)in.bytes / in.count : 0.0);
+    } else {
+        synthesize(&in, count, 1);
+        printf("input: %zu synthesized datagrams, %.1f bytes avg\n", in.count, (double)in.bytes / in.count);
+    }
+    if (in.count == 0) {
+        fprintf(stderr, "no input\n");
+        return 1;
+    }
+
+    cJSON_Hooks hooks = { count_malloc, free };
+    cJSON_InitHooks(&hooks);
+
+    // 結果の照合
+    size_t mismatches = 0;
+    size_t ok_count = 0;
+    for (size_t i = 0; i < in.count; i++) {
+        decoded_t a, b;
+        decode_stream(&in.items[i], &a);
+        decode_cjson(&in.items[i], &b);
+        ok_count += (a.result == SENSOR_JSON_OK);
+        if (same_result(&a, &b)) {
+            continue;
+        }
+        if (mismatches++ < MISMATCH_SHOW) {
+            printf("  mismatch: %s\n", in.items[i].name ? in.items[i].name : in.items[i].data);
+            print_result("stream", &a);
+            print_result("cjson", &b);
+        }
+    }
+    printf("results: %zu decoded OK, %zu of %zu differ\n", ok_count, mismatches, in.count);
+
+    // 計測（cJSONのヒープ使用は1回分を数える）
+    s_mallocs = 0;
+    s_malloc_bytes = 0;
+    double cjson_s = time_decoder(&in, decode_cjson, 1);
+    uint64_t mallocs = s_mallocs;
+    uint64_t malloc_bytes = s_malloc_bytes;
+    if (repeats > 1) {
+        cjson_s = time_decoder(&in, decode_cjson, repeats);
+    }
+    double stream_s = time_decoder(&in, decode_stream, repeats);
+
+    double n = (double)in.count;
+    printf("sensor_json: %7.1f ns/datagram, %7.1f MB/s, 0 mallocs\n",
+           stream_s / n * 1e9, (double)in.bytes / stream_s / 1e6);
+    printf("cJSON:       %7.1f ns/datagram, %7.1f MB/s, %.1f mallocs (%.0f bytes)/datagram\n",
+           cjson_s / n * 1e9, (double)in.bytes / cjson_s / 1e6,
+           (double)mallocs / n, (double)malloc_bytes / n);
+    printf("speedup: %.1fx\n", cjson_s / stream_s);
+
+    for (size_t i = 0; i < in.count; i++) {
+        free(in.items[i].data);
+        free((void *)in.items[i].name);
+    }
+    free(in.items);
+    return (mismatches > 0 && !keep_going) ? 1 : 0;
+}
@@ -0,0 +1,331 @@
+// tools/udp_loadgen/json_fuzz.c
+// 子機JSONデコーダ（src/sensor_json.c）のファズドライバ（Linux）
+//
+// 入力は毎回ちょうどの長さのヒープ領域へ写してから渡す（NUL終端なし）ため、範囲外の読み出しはASanで検出される。
+// 各入力について次の性質を確かめ、破れたら入力を表示してabort()する。
+//   - 戻り値がOK/ERR_SYNTAX/ERR_MISSINGのいずれかで、同じ入力は同じ結果になる
+//   - OKなら、有効ビットは表のチャネルだけで、値は格納幅に収まっている（コンパクト形式で往復しても変わらない）
+//   - OKなら、閉じ括弧より後ろに何を付け足しても結果は変わらない
+//   - OKなら、子機と同じ形式（sensor_data_write_json）で書き直して読み直すと、child_no・seq・rssiと
+//     有効なチャネルの値が一致する（測定成功フラグで組ごと無効になったチャネルを除く）
+//
+// libFuzzerで実行（clang）:
+//   clang -g -O1 -fsanitize=fuzzer,address,undefined -DJSON_FUZZ_LIBFUZZER -Iinclude -o json_fuzz tools/udp_loadgen/json_fuzz.c src/sensor_json.c src/sensor_channel.c
+//   ./json_fuzz -max_len=1024 tools/udp_loadgen/json_corpus
+//
+// libFuzzerなしで実行（gcc、コーパスへの簡単な変異: バイトの置換・挿入・削除・切り詰め・他の入力との継ぎ合わせ）:
+//   gcc -g -O1 -fsanitize=address,undefined -Iinclude -o json_fuzz tools/udp_loadgen/json_fuzz.c src/sensor_json.c src/sensor_channel.c
+//   ./json_fuzz -n 1000000 tools/udp_loadgen/json_corpus
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "sensor_json.h"
+
+// ==== 設定 ====
+#define FUZZ_INPUT_MAX      1024        // 受信バッファ（MAX_PAYLOAD_SIZE）と同程度
+
+static void fail(const char *what, const uint8_t *data, size_t size)
+{
+    fprintf(stderr, "json_fuzz: %s\ninput (%zu bytes): ", what, size);
+    for (size_t i = 0; i < size; i++) {
+        uint8_t ch = data[i];
+        if (ch >= 0x20 && ch < 0x7F && ch != '\\') {
+            fputc(ch, stderr);
+        } else {
+            fprintf(stderr, "\\x%02x", ch);
+        }
+    }
+    fputc('\n', stderr);
+    abort();
+}
+
+// ちょうどの長さの領域に写してデコード（範囲外の読み出しをASanで検出する）
+static sensor_json_result_t decode_exact(const void *data, size_t size, uint8_t *child_no, temp_sens_data_t *out)
+{
+    char *buf = malloc(size > 0 ? size : 1);
+    if (buf == NULL) {
+        abort();
+    }
+    memcpy(buf, data, size);
+    memset(out, 0, sizeof(*out));
+    *child_no = 0;
+    sensor_json_result_t result = sensor_json_decode(buf, size, child_no, out);
+    free(buf);
+    return result;
+}
+
+static bool same_reading(uint8_t a_no, const temp_sens_data_t *a, uint8_t b_no, const temp_sens_data_t *b)
+{
+    if (a_no != b_no || a->seq != b->seq || a->rssi != b->rssi || a->ch_valid != b->ch_valid) {
+        return false;
+    }
+    for (int ch = 0; ch < SENSOR_CH_COUNT; ch++) {
+        if (sensor_data_valid(a, (sensor_ch_t)ch) && a->ch[ch] != b->ch[ch]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ==== 1入力分の確認 ====
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if (size > FUZZ_INPUT_MAX) {
+        return 0;
+    }
+
+    uint8_t child_no, child_no2;
+    temp_sens_data_t out, out2;
+    sensor_json_result_t result = decode_exact(data, size, &child_no, &out);
+    if (result != SENSOR_JSON_OK && result != SENSOR_JSON_ERR_SYNTAX && result != SENSOR_JSON_ERR_MISSING) {
+        fail("unexpected result", data, size);
+    }
+    if (decode_exact(data, size, &child_no2, &out2) != result ||
+        (result == SENSOR_JSON_OK && !same_reading(child_no, &out, child_no2, &out2))) {
+        fail("not deterministic", data, size);
+    }
+    if (result != SENSOR_JSON_OK) {
+        return 0;
+    }
+
+    // 有効ビット・格納幅
+    if ((out.ch_valid & ~((1u << SENSOR_CH_COUNT) - 1)) != 0) {
+        fail("valid bit outside the channel table", data, size);
+    }
+    sensor_packed_t packed;
+    temp_sens_data_t unpacked;
+    sensor_data_pack(&out, &packed);
+    sensor_data_unpack(&packed, &unpacked);
+    unpacked.rssi = out.rssi;   // コンパクト形式のrssiはint8
+    if (!same_reading(child_no, &out, child_no, &unpacked)) {
+        fail("channel value outside its packed width", data, size);
+    }
+
+    // 閉じ括弧より後ろのデータは読まない
+    uint8_t extended[FUZZ_INPUT_MAX + 8];
+    memcpy(extended, data, size);
+    memcpy(&extended[size], "\"{[,x\\", 6);
+    if (decode_exact(extended, size + 6, &child_no2, &out2) != SENSOR_JSON_OK ||
+        !same_reading(child_no, &out, child_no2, &out2)) {
+        fail("trailing bytes changed the result", data, size);
+    }
+
+    // 子機と同じ形式で書き直して読み直す
+    char members[SENSOR_DATA_JSON_MAX];
+    char rewritten[FUZZ_INPUT_MAX];
+    if (sensor_data_write_json(&out, members, sizeof(members)) == 0) {
+        fail("sensor_data_write_json buffer too small", data, size);
+    }
+    int len = snprintf(rewritten, sizeof(rewritten), "{\"child_no\":%u,%s,\"seq\":%lu,\"rssi\":%d}",
+                       (unsigned int)child_no, members, (unsigned long)out.seq, out.rssi);
+    if (decode_exact(rewritten, (size_t)len, &child_no2, &out2) != SENSOR_JSON_OK) {
+        fail("rewritten reading does not decode", data, size);
+    }
+    // 組の一部だけ有効だった場合、書き直すと測定成功フラグがfalseになり組ごと無効になる
+    uint32_t original = out.ch_valid;
+    out.ch_valid &= out2.ch_valid;
+    if ((out2.ch_valid & ~original) != 0 || !same_reading(child_no, &out, child_no2, &out2)) {
+        fail("rewritten reading differs", data, size);
+    }
+    return 0;
+}
+
+#ifndef JSON_FUZZ_LIBFUZZER
+// ==== libFuzzerなしの実行 ====
+#include <dirent.h>
+#include <getopt.h>
+#include <sys/stat.h>
+
+typedef struct {
+    uint8_t data[FUZZ_INPUT_MAX];
+    size_t len;
+} seed_t;
+
+static seed_t *s_seeds;
+static size_t s_seed_count;
+static size_t s_seed_capacity;
+
+static bool load_file(const char *path)
+{
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        perror(path);
+        return false;
+    }
+    if (s_seed_count == s_seed_capacity) {
+        s_seed_capacity = (s_seed_capacity > 0) ? s_seed_capacity * 2 : 64;
+        s_seeds = realloc(s_seeds, s_seed_capacity * sizeof(seed_t));
+        if (s_seeds == NULL) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+    seed_t *seed = &s_seeds[s_seed_count++];
+    seed->len = fread(seed->data, 1, sizeof(seed->data), fp);
+    fclose(fp);
+    return true;
+}
+
+static bool load_path(const char *path)
+{
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        perror(path);
+        return false;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        return load_file(path);
+    }
+    struct dirent **names;
+    int n = scandir(path, &names, NULL, alphasort);   // 同じ-sで同じ入力列になるよう名前順
+    if (n < 0) {
+        perror(path);
+        return false;
+    }
+    bool ok = true;
+    for (int i = 0; i < n; i++) {
+        if (names[i]->d_name[0] != '.') {
+            char file[4096];
+            snprintf(file, sizeof(file), "%s/%s", path, names[i]->d_name);
+            ok = load_file(file) && ok;
+        }
+        free(names[i]);
+    }
+    free(names);
+    return ok;
+}
+
+// JSONの構造に関わる文字を多めに選ぶ
+static uint8_t random_byte(void)
+{
+    static const char interesting[] = "{}[]\":,\\-+.eE0123456789 \t\ntfnul";
+    if (rand() % 4 == 0) {
+        return (uint8_t)(rand() % 256);
+    }
+    return (uint8_t)interesting[rand() % (int)(sizeof(interesting) - 1)];
+}
+
+static size_t mutate(uint8_t *buf, size_t len)
+{
+    int rounds = 1 + rand() % 4;
+    for (int r = 0; r < rounds; r++) {
+        size_t pos = (len > 0) ? (size_t)rand() % len : 0;
+        switch (rand() % 6) {
+            case 0:     // 置換
+                if (len > 0) {
+                    buf[pos] = random_byte();
+                }
+                break;
+            case 1:     // 挿入
+                if (len < FUZZ_INPUT_MAX) {
+                    memmove(&buf[pos + 1], &buf[pos], len - pos);
+                    buf[pos] = random_byte();
+                    len++;
+                }
+                break;
+            case 2:     // 削除
+                if (len > 0) {
+                    size_t n = 1 + (size_t)rand() % 8;
+                    if (n > len - pos) {
+                        n = len - pos;
+                    }
+                    memmove(&buf[pos], &buf[pos + n], len - pos - n);
+                    len -= n;
+                }
+                break;
+            case 3:     // 切り詰め
+                len = pos;
+                break;
+            case 4: {   // 他の入力の後半と継ぎ合わせ
+                const seed_t *other = &s_seeds[(size_t)rand() % s_seed_count];
+                size_t from = (other->len > 0) ? (size_t)rand() % other->len : 0;
+                size_t n = other->len - from;
+                if (n > FUZZ_INPUT_MAX - pos) {
+                    n = FUZZ_INPUT_MAX - pos;
+                }
+                memcpy(&buf[pos], &other->data[from], n);
+                len = pos + n;
+                break;
+            }
+            default: {  // 一部を複製
+                size_t n = 1 + (size_t)rand() % 16;
+                if (n > len - pos) {
+                    n = len - pos;
+                }
+                if (len + n <= FUZZ_INPUT_MAX) {
+                    memmove(&buf[pos + n], &buf[pos], len - pos);
+                    len += n;
+                }
+                break;
+            }
+        }
+    }
+    return len;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "usage: %s [options] file|dir...\n"
+        "  -n iterations  mutated inputs to run (default 1000000)\n"
+        "  -s seed        random seed (default 1)\n",
+        prog);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long iterations = 1000000;
+    unsigned int seed = 1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:h")) != -1) {
+        switch (opt) {
+            case 'n': iterations = strtoul(optarg, NULL, 10); break;
+            case 's': seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (optind >= argc) {
+        usage(argv[0]);
+        return 1;
+    }
+    for (int i = optind; i < argc; i++) {
+        if (!load_path(argv[i])) {
+            return 1;
+        }
+    }
+    if (s_seed_count == 0) {
+        fprintf(stderr, "no seed inputs\n");
+        return 1;
+    }
+
+    // シードそのもの → 変異
+    for (size_t i = 0; i < s_seed_count; i++) {
+        LLVMFuzzerTestOneInput(s_seeds[i].data, s_seeds[i].len);
+    }
+    srand(seed);
+    unsigned long ok = 0;
+    uint8_t buf[FUZZ_INPUT_MAX];
+    for (unsigned long n = 0; n < iterations; n++) {
+        const seed_t *base = &s_seeds[(size_t)rand() % s_seed_count];
+        memcpy(buf, base->data, base->len);
+        size_t len = mutate(buf, base->len);
+        uint8_t child_no;
+        temp_sens_data_t out;
+        ok += (decode_exact(buf, len, &child_no, &out) == SENSOR_JSON_OK);
+        LLVMFuzzerTestOneInput(buf, len);
+    }
+    printf("json_fuzz: %zu seeds, %lu mutated inputs (%lu decoded OK), no failures\n",
+           s_seed_count, iterations, ok);
+    free(s_seeds);
+    return 0;
+}
+#endif
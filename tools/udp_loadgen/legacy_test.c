@@ -0,0 +1,653 @@
+// tools/udp_loadgen/legacy_test.c
+// 旧形式 "N=<子機No>,<key>=<value>,..." のデコード（src/sensor_legacy.c）の確認と速度比較（Linux）
+//
+//   - 既知のペイロード（実単位の小数と四捨五入、JSONキーの整数、別名H、測定成功フラグ、seq/rssiの有無）
+//   - 不正なペイロード（子機Noの欠落・範囲外、"="のないトークン、空・数値以外・小数点の重複した値、
+//     真偽値以外の測定成功フラグ）で、先頭が不正なら拒否、値が不正なキーだけ読み飛ばすこと
+//   - 長すぎる入力（数百文字のキー・数値、数百桁の小数部、数千トークンのペイロード）で飽和・読み飛ばしができること
+//   - 乱数で作った測定値を3通りの書式（短い表示名、JSONキー、別名・未知のキー・順序の入れ替え）で往復
+//   - 有効なペイロードの全ての切り詰め・乱数のバイト置換でバッファ外を読まず、結果が矛盾しないこと
+// を確認する。入力は終端のない、ちょうどの長さのヒープ領域に置くので、-fsanitize=addressで範囲外の読み出しも検出できる。
+// 最後に同じ測定値の旧形式とJSON（sensor_json_decode）のデコード結果が一致することを確かめ、
+// 1データグラムあたりの時間とスループットを表示する。1件でも不一致なら終了コード1。
+//
+// ビルド（リポジトリのルートで実行）:
+//   gcc -O2 -Wall -Iinclude -o legacy_test tools/udp_loadgen/legacy_test.c src/sensor_legacy.c src/sensor_json.c src/sensor_channel.c
+//
+// 実行例:
+//   ./legacy_test                （10万件の往復と速度比較）
+//   ./legacy_test -n 1000000 -r 20 -s 7
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include "sensor_legacy.h"
+#include "sensor_json.h"
+#include "child_registry.h"  // CHILD_NO_MIN/CHILD_NO_MAX
+
+// ==== 設定 ====
+#define PAYLOAD_MAX     256         // 1件の旧形式・JSONペイロードの最大長（往復・速度比較用）
+#define LONG_RUN        400         // 長すぎるキー・数値の文字数
+#define MANY_TOKENS     4000        // 長いペイロードに並べる未知のトークン数
+
+#define CH_BIT(ch)      (1u << (ch))
+#define ALL_CH          (CH_BIT(SENSOR_CH_COUNT) - 1u)
+
+static unsigned long s_checks;
+static unsigned long s_failures;
+
+#define CHECK(cond, ...) do {                                       \
+        s_checks++;                                                 \
+        if (!(cond)) {                                              \
+            if (s_failures++ < 20) {                                \
+                printf("FAIL %s:%d: ", __func__, __LINE__);         \
+                printf(__VA_ARGS__);                                \
+                printf("\n");                                       \
+            }                                                       \
+        }                                                           \
+    } while (0)
+
+static uint32_t rand32(void)
+{
+    return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// 終端のない、ちょうどの長さのコピーでデコードする（範囲外の読み出しをASanで検出するため）
+static sensor_legacy_result_t decode_exact(const char *payload, size_t len, uint8_t *child_no,
+                                           temp_sens_data_t *out, bool *has_seq)
+{
+    char *copy = malloc(len > 0 ? len : 1);
+    if (copy == NULL) {
+        perror("malloc");
+        exit(1);
+    }
+    memcpy(copy, payload, len);
+    sensor_legacy_result_t result = sensor_legacy_decode(copy, len, child_no, out, has_seq);
+    free(copy);
+    return result;
+}
+
+static bool same_reading(const temp_sens_data_t *a, const temp_sens_data_t *b)
+{
+    if (a->seq != b->seq || a->rssi != b->rssi || a->ch_valid != b->ch_valid) {
+        return false;
+    }
+    for (int ch = 0; ch < SENSOR_CH_COUNT; ch++) {
+        if (sensor_data_valid(a, (sensor_ch_t)ch) && a->ch[ch] != b->ch[ch]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ==== 既知のペイロード ====
+typedef struct {
+    const char *payload;
+    sensor_legacy_result_t result;
+    uint8_t child_no;                   // ERR_FORMAT以外で確認
+    uint32_t valid;                     // OKの場合に確認（bit n = SENSOR_CH_n）
+    int32_t ch[SENSOR_CH_COUNT];        // 有効なチャネルのみ確認
+    uint32_t seq;
+    int rssi;
+    bool has_seq;                       // ERR_FORMAT以外で確認
+} known_case_t;
+
+#define T_  CH_BIT(SENSOR_CH_AHT_T)
+#define RH_ CH_BIT(SENSOR_CH_AHT_RH)
+#define BT_ CH_BIT(SENSOR_CH_BMP_T)
+#define P_  CH_BIT(SENSOR_CH_BMP_P)
+
+static const known_case_t s_known[] = {
+    // 正常系
+    { "N=1,T=25.3,RH=48.2,BT=25.1,P=1008.5,S=42,R=-60", SENSOR_LEGACY_OK, 1, ALL_CH, { 253, 482, 251, 10085 }, 42, -60, true },
+    { "N=7,aht_t01=253,aht_rh01=482,bmp_t01=251,bmp_p01=100845,aht_ok=1,bmp_ok=1,seq=9,rssi=-70",
+      SENSOR_LEGACY_OK, 7, ALL_CH, { 253, 482, 251, 100845 }, 9, -70, true },
+    { "N=2,T=20.0", SENSOR_LEGACY_OK, 2, T_, { 200 }, 0, 0, false },
+    { "N=2,T=25.34", SENSOR_LEGACY_OK, 2, T_, { 253 }, 0, 0, false },
+    { "N=2,T=25.35", SENSOR_LEGACY_OK, 2, T_, { 254 }, 0, 0, false },
+    { "N=2,T=-0.05", SENSOR_LEGACY_OK, 2, T_, { -1 }, 0, 0, false },
+    { "N=2,T=-12.34", SENSOR_LEGACY_OK, 2, T_, { -123 }, 0, 0, false },
+    { "N=2,T=25", SENSOR_LEGACY_OK, 2, T_, { 250 }, 0, 0, false },
+    { "N=2,T=25.", SENSOR_LEGACY_OK, 2, T_, { 250 }, 0, 0, false },
+    { "N=2,T=.5", SENSOR_LEGACY_OK, 2, T_, { 5 }, 0, 0, false },
+    { "N=2,T=+3.0", SENSOR_LEGACY_OK, 2, T_, { 30 }, 0, 0, false },
+    { "N=3,H=55.5", SENSOR_LEGACY_OK, 3, RH_, { 0, 555 }, 0, 0, false },
+    { "N=3,RH=55.5,H=60", SENSOR_LEGACY_OK, 3, RH_, { 0, 555 }, 0, 0, false },
+    { "N=4,T=20.0,RH=50.0,aht_ok=0", SENSOR_LEGACY_OK, 4, 0, { 0 }, 0, 0, false },
+    { "N=4,T=20,aht_ok=false,bmp_ok=true,BT=21", SENSOR_LEGACY_OK, 4, BT_, { 0, 0, 210 }, 0, 0, false },
+    { "N=4,aht_ok=true,T=20", SENSOR_LEGACY_OK, 4, T_, { 200 }, 0, 0, false },
+    { "N=5,T=20.0,R=-60\r\n", SENSOR_LEGACY_OK, 5, T_, { 200 }, 0, -60, false },
+    { "N=5,T=20.0,S=1,", SENSOR_LEGACY_OK, 5, T_, { 200 }, 1, 0, true },
+    { "N=254,T=1", SENSOR_LEGACY_OK, 254, T_, { 10 }, 0, 0, false },
+    { "N=01,T=1", SENSOR_LEGACY_OK, 1, T_, { 10 }, 0, 0, false },
+    { "N=1,T=1,S=4294967295", SENSOR_LEGACY_OK, 1, T_, { 10 }, 4294967295u, 0, true },
+    { "N=1,T=1,S=4294967296", SENSOR_LEGACY_OK, 1, T_, { 10 }, 4294967295u, 0, true },
+    { "N=1,P=999999", SENSOR_LEGACY_OK, 1, P_, { 0, 0, 0, 9999990 }, 0, 0, false },
+    { "N=1,T=4000", SENSOR_LEGACY_OK, 1, T_, { INT16_MAX }, 0, 0, false },
+    { "N=1,T=-4000", SENSOR_LEGACY_OK, 1, T_, { INT16_MIN }, 0, 0, false },
+    { "N=1,RH=-1", SENSOR_LEGACY_OK, 1, RH_, { 0, 0 }, 0, 0, false },
+
+    // 子機Noのみ
+    { "N=1,", SENSOR_LEGACY_ERR_MISSING, 1, 0, { 0 }, 0, 0, false },
+    { "N=1,S=5,R=-60", SENSOR_LEGACY_ERR_MISSING, 1, 0, { 0 }, 0, 0, true },
+    { "N=1,fw=1.2.3,aht_ok=1", SENSOR_LEGACY_ERR_MISSING, 1, 0, { 0 }, 0, 0, false },
+
+    // 先頭が不正
+    { "", SENSOR_LEGACY_ERR_FORMAT, 0, 0, { 0 }, 0, 0, false },
+    { "N=1", SENSOR_LEGACY_ERR_FORMAT, 0, 0, { 0 }, 0, 0, false },
+    { "N=0,T=1", SENSOR_LEGACY_ERR_FORMAT, 0, 0, { 0 }, 0, 0, false },
+    { "N=255,T=1", SENSOR_LEGACY_ERR_FORMAT, 0, 0, { 0 }, 0, 0, false },
+    { "N=99999999999,T=1", SENSOR_LEGACY_ERR_FORMAT, 0, 0, { 0 }, 0, 0, false },
+    { "N=,T=1", SENSOR_LEGACY_ERR_FORMAT, 0, 0, { 0 }, 0, 0, false },
+    { "N=-1,T=1", SENSOR_LEGACY_ERR_FORMAT, 0, 0, { 0 }, 0, 0, false },
+    { "N=1x,T=1", SENSOR_LEGACY_ERR_FORMAT, 0, 0, { 0 }, 0, 0, false },
+    { "N=1;T=1", SENSOR_LEGACY_ERR_FORMAT, 0, 0, { 0 }, 0, 0, false },
+    { "n=1,T=1", SENSOR_LEGACY_ERR_FORMAT, 0, 0, { 0 }, 0, 0, false },
+    { " N=1,T=1", SENSOR_LEGACY_ERR_FORMAT, 0, 0, { 0 }, 0, 0, false },
+    { "T=1,N=1", SENSOR_LEGACY_ERR_FORMAT, 0, 0, { 0 }, 0, 0, false },
+    { "{\"child_no\":1,\"aht_t01\":253}", SENSOR_LEGACY_ERR_FORMAT, 0, 0, { 0 }, 0, 0, false },
+
+    // 不正な値・トークンは読み飛ばす
+    { "N=1,T=abc,RH=50", SENSOR_LEGACY_OK, 1, RH_, { 0, 500 }, 0, 0, false },
+    { "N=1,T=1.2.3,RH=50", SENSOR_LEGACY_OK, 1, RH_, { 0, 500 }, 0, 0, false },
+    { "N=1,T=--5,RH=50", SENSOR_LEGACY_OK, 1, RH_, { 0, 500 }, 0, 0, false },
+    { "N=1,T=-,RH=50", SENSOR_LEGACY_OK, 1, RH_, { 0, 500 }, 0, 0, false },
+    { "N=1,T=.,RH=50", SENSOR_LEGACY_OK, 1, RH_, { 0, 500 }, 0, 0, false },
+    { "N=1,T=,RH=50", SENSOR_LEGACY_OK, 1, RH_, { 0, 500 }, 0, 0, false },
+    { "N=1,T=12x,RH=50", SENSOR_LEGACY_OK, 1, RH_, { 0, 500 }, 0, 0, false },
+    { "N=1,T=1e3,RH=50", SENSOR_LEGACY_OK, 1, RH_, { 0, 500 }, 0, 0, false },
+    { "N=1,T= 1,RH=50", SENSOR_LEGACY_OK, 1, RH_, { 0, 500 }, 0, 0, false },
+    { "N=1,T==5,RH=50", SENSOR_LEGACY_OK, 1, RH_, { 0, 500 }, 0, 0, false },
+    { "N=1,T 1,RH=50", SENSOR_LEGACY_OK, 1, RH_, { 0, 500 }, 0, 0, false },
+    { "N=1,=5,RH=50", SENSOR_LEGACY_OK, 1, RH_, { 0, 500 }, 0, 0, false },
+    { "N=1,,,RH=50,,", SENSOR_LEGACY_OK, 1, RH_, { 0, 500 }, 0, 0, false },
+    { "N=1,t=20,rh=50,RH=50", SENSOR_LEGACY_OK, 1, RH_, { 0, 500 }, 0, 0, false },
+    { "N=1,T=abc,T=30", SENSOR_LEGACY_OK, 1, T_, { 300 }, 0, 0, false },
+    { "N=1,T=20,T=30", SENSOR_LEGACY_OK, 1, T_, { 200 }, 0, 0, false },
+    { "N=1,aht_ok=yes,T=20", SENSOR_LEGACY_OK, 1, T_, { 200 }, 0, 0, false },
+    { "N=1,aht_ok=0x,T=20", SENSOR_LEGACY_OK, 1, T_, { 200 }, 0, 0, false },
+    { "N=1,T=20,S=x,R=-60", SENSOR_LEGACY_OK, 1, T_, { 200 }, 0, -60, false },
+    { "N=1,T=20,S=1.5", SENSOR_LEGACY_OK, 1, T_, { 200 }, 2, 0, true },     // 整数のキーも小数は四捨五入
+};
+
+static void test_known(void)
+{
+    for (size_t i = 0; i < sizeof(s_known) / sizeof(s_known[0]); i++) {
+        const known_case_t *k = &s_known[i];
+        uint8_t child_no = 0;
+        bool has_seq = false;
+        temp_sens_data_t out;
+        sensor_legacy_result_t result = decode_exact(k->payload, strlen(k->payload), &child_no, &out, &has_seq);
+
+        CHECK(result == k->result, "\"%s\": result %d, expected %d", k->payload, result, k->result);
+        if (result != k->result || result == SENSOR_LEGACY_ERR_FORMAT) {
+            continue;
+        }
+        CHECK(child_no == k->child_no, "\"%s\": child_no %u", k->payload, child_no);
+        CHECK(has_seq == k->has_seq, "\"%s\": has_seq %d", k->payload, has_seq);
+        if (result != SENSOR_LEGACY_OK) {
+            continue;
+        }
+        CHECK(out.ch_valid == k->valid, "\"%s\": ch_valid 0x%x, expected 0x%x", k->payload, out.ch_valid, k->valid);
+        for (int ch = 0; ch < SENSOR_CH_COUNT; ch++) {
+            if (k->valid & CH_BIT(ch)) {
+                CHECK(out.ch[ch] == k->ch[ch], "\"%s\": ch %d = %ld, expected %ld",
+                      k->payload, ch, (long)out.ch[ch], (long)k->ch[ch]);
+            }
+        }
+        CHECK(out.seq == k->seq && out.rssi == k->rssi, "\"%s\": seq %lu rssi %d",
+              k->payload, (unsigned long)out.seq, out.rssi);
+    }
+
+    // 引数の不足
+    uint8_t child_no;
+    temp_sens_data_t out;
+    CHECK(sensor_legacy_decode(NULL, 0, &child_no, &out, NULL) == SENSOR_LEGACY_ERR_FORMAT, "NULL buffer");
+    CHECK(sensor_legacy_decode("N=1,T=1", 7, NULL, &out, NULL) == SENSOR_LEGACY_ERR_FORMAT, "NULL child_no");
+    CHECK(sensor_legacy_decode("N=1,T=1", 7, &child_no, NULL, NULL) == SENSOR_LEGACY_ERR_FORMAT, "NULL out");
+    CHECK(sensor_legacy_decode("N=1,T=1", 7, &child_no, &out, NULL) == SENSOR_LEGACY_OK, "has_seq may be NULL");
+
+    // lenより後ろは読まない
+    CHECK(sensor_legacy_decode("N=1,T=2,RH=50", 7, &child_no, &out, NULL) == SENSOR_LEGACY_OK &&
+          out.ch_valid == T_ && out.ch[SENSOR_CH_AHT_T] == 20, "stops at len");
+}
+
+// ==== 長すぎる入力 ====
+// prefix + 同じ文字をn個 + suffix
+static char *make_run(const char *prefix, char fill, size_t n, const char *suffix, size_t *len)
+{
+    size_t a = strlen(prefix);
+    size_t b = strlen(suffix);
+    char *s = malloc(a + n + b + 1);
+    if (s == NULL) {
+        perror("malloc");
+        exit(1);
+    }
+    memcpy(s, prefix, a);
+    memset(s + a, fill, n);
+    memcpy(s + a + n, suffix, b + 1);
+    *len = a + n + b;
+    return s;
+}
+
+static void expect_one(const char *what, const char *payload, size_t len, sensor_ch_t ch, int32_t value)
+{
+    uint8_t child_no;
+    temp_sens_data_t out;
+    sensor_legacy_result_t result = decode_exact(payload, len, &child_no, &out, NULL);
+    CHECK(result == SENSOR_LEGACY_OK && child_no == 1 && out.ch_valid == CH_BIT(ch) && out.ch[ch] == value,
+          "%s: result %d child_no %u valid 0x%x value %ld, expected %ld",
+          what, result, child_no, out.ch_valid, (long)out.ch[ch], (long)value);
+}
+
+static void test_overlong(void)
+{
+    size_t len;
+    char *s;
+
+    // 数百桁の整数は飽和し、格納幅にも飽和する
+    s = make_run("N=1,T=", '9', LONG_RUN, "", &len);
+    expect_one("long positive value", s, len, SENSOR_CH_AHT_T, INT16_MAX);
+    free(s);
+    s = make_run("N=1,T=-", '9', LONG_RUN, "", &len);
+    expect_one("long negative value", s, len, SENSOR_CH_AHT_T, INT16_MIN);
+    free(s);
+    s = make_run("N=1,bmp_p01=", '9', LONG_RUN, ",S=1", &len);
+    expect_one("long I32 value", s, len, SENSOR_CH_BMP_P, INT32_MAX);
+    free(s);
+    s = make_run("N=1,RH=", '9', LONG_RUN, ".95", &len);
+    expect_one("long value with fraction", s, len, SENSOR_CH_AHT_RH, UINT16_MAX);
+    free(s);
+
+    // 先頭の0は値を変えない
+    s = make_run("N=1,T=", '0', LONG_RUN, "25.3", &len);
+    expect_one("leading zeros", s, len, SENSOR_CH_AHT_T, 253);
+    free(s);
+
+    // 数百桁の小数部は格納桁の次の桁だけで四捨五入する
+    s = make_run("N=1,T=25.3", '9', LONG_RUN, "", &len);
+    expect_one("long fraction rounds up", s, len, SENSOR_CH_AHT_T, 254);
+    free(s);
+    s = make_run("N=1,T=25.34", '9', LONG_RUN, "", &len);
+    expect_one("long fraction below half", s, len, SENSOR_CH_AHT_T, 253);
+    free(s);
+    s = make_run("N=1,T=0.0", '0', LONG_RUN, "1", &len);
+    expect_one("long fraction of zeros", s, len, SENSOR_CH_AHT_T, 0);
+    free(s);
+
+    // 長すぎる子機No（先頭の0）は受け付け、値が範囲を超えたら拒否
+    s = make_run("N=", '0', LONG_RUN, "1,T=1", &len);
+    expect_one("child_no with leading zeros", s, len, SENSOR_CH_AHT_T, 10);
+    free(s);
+    s = make_run("N=1", '0', LONG_RUN, ",T=1", &len);
+    uint8_t child_no;
+    temp_sens_data_t out;
+    CHECK(decode_exact(s, len, &child_no, &out, NULL) == SENSOR_LEGACY_ERR_FORMAT, "long child_no");
+    free(s);
+
+    // 長すぎるキー・未知の値は読み飛ばす
+    s = make_run("N=1,", 'T', LONG_RUN, "=5,T=20", &len);
+    expect_one("long key", s, len, SENSOR_CH_AHT_T, 200);
+    free(s);
+    s = make_run("N=1,", 'x', LONG_RUN, ",T=20", &len);
+    expect_one("long token without '='", s, len, SENSOR_CH_AHT_T, 200);
+    free(s);
+    s = make_run("N=1,fw=", 'v', LONG_RUN, ",T=20", &len);
+    expect_one("long unknown value", s, len, SENSOR_CH_AHT_T, 200);
+    free(s);
+    s = make_run("N=1,aht_ok=", '1', LONG_RUN, ",T=20", &len);
+    expect_one("long flag value", s, len, SENSOR_CH_AHT_T, 200);
+    free(s);
+
+    // 数千トークンのペイロードの末尾の値も拾う
+    size_t cap = 16 + MANY_TOKENS * 12;
+    char *big = malloc(cap);
+    if (big == NULL) {
+        perror("malloc");
+        exit(1);
+    }
+    len = (size_t)snprintf(big, cap, "N=1,");
+    for (int i = 0; i < MANY_TOKENS; i++) {
+        len += (size_t)snprintf(big + len, cap - len, "x%d=%d,", i % 100, i);
+    }
+    len += (size_t)snprintf(big + len, cap - len, "RH=48.2");
+    expect_one("many tokens", big, len, SENSOR_CH_AHT_RH, 482);
+    free(big);
+}
+
+// ==== 乱数の往復 ====
+static int32_t pick(int32_t lo, int32_t hi)
+{
+    switch (rand() % 8) {
+        case 0: return lo;
+        case 1: return hi;
+        case 2: return 0;
+        default: return (int32_t)((int64_t)lo + (int64_t)(rand32() % ((uint32_t)((int64_t)hi - lo) + 1u)));
+    }
+}
+
+static void random_reading(temp_sens_data_t *data)
+{
+    memset(data, 0, sizeof(*data));
+    sensor_data_set(data, SENSOR_CH_AHT_T, pick(INT16_MIN, INT16_MAX));
+    sensor_data_set(data, SENSOR_CH_AHT_RH, pick(0, UINT16_MAX));
+    sensor_data_set(data, SENSOR_CH_BMP_T, pick(INT16_MIN, INT16_MAX));
+    sensor_data_set(data, SENSOR_CH_BMP_P, pick(INT32_MIN + 1, INT32_MAX));
+    sensor_data_apply_group(data, SENSOR_GROUP_AHT, rand() % 10 != 0);
+    sensor_data_apply_group(data, SENSOR_GROUP_BMP, rand() % 10 != 0);
+    data->seq = rand32();
+    data->rssi = pick(-128, 0);
+}
+
+typedef enum {
+    STYLE_LABEL = 0,    // 短い表示名・実単位（無効なチャネルは送らない）、S/R
+    STYLE_KEY,          // JSONキー・整数と測定成功フラグ、seq/rssi
+    STYLE_MIXED,        // 組ごとに表示名とJSONキーを混ぜ、別名H・未知のキーを挟み、順序を入れ替える
+    STYLE_COUNT
+} legacy_style_t;
+
+// 測定値を旧形式に書式化する。戻り値: 長さ
+// channels: 書き出したチャネルの数（NULL可、表示名で送る無効なチャネルは書き出さない）
+static size_t format_legacy(uint8_t child_no, const temp_sens_data_t *data, legacy_style_t style,
+                            char *buf, size_t size, size_t *channels)
+{
+    char tokens[SENSOR_CH_COUNT + SENSOR_GROUP_COUNT + 4][48];
+    size_t n = 0;
+
+    for (int ch = 0; ch < SENSOR_CH_COUNT; ch++) {
+        const sensor_channel_t *c = sensor_channel_get((sensor_ch_t)ch);
+        bool valid = sensor_data_valid(data, (sensor_ch_t)ch);
+        bool as_label = (style == STYLE_LABEL) || (style == STYLE_MIXED && rand() % 2 == 0);
+        if (as_label) {
+            if (!valid) {
+                continue;
+            }
+            char value[24];
+            sensor_channel_format((sensor_ch_t)ch, data->ch[ch], value, sizeof(value));
+            const char *label = (ch == SENSOR_CH_AHT_RH && style == STYLE_MIXED && rand() % 2 == 0) ? "H" : c->label;
+            snprintf(tokens[n++], sizeof(tokens[0]), "%s=%s", label, value);
+        } else {
+            snprintf(tokens[n++], sizeof(tokens[0]), "%s=%ld", c->key, (long)data->ch[ch]);
+        }
+    }
+    if (channels != NULL) {
+        *channels = n;
+    }
+    if (style != STYLE_LABEL) {
+        for (int g = 0; g < SENSOR_GROUP_COUNT; g++) {
+            bool ok = sensor_data_group_ok(data, (sensor_group_t)g);
+            const char *value = (style == STYLE_KEY) ? (ok ? "true" : "false") : (ok ? "1" : "0");
+            snprintf(tokens[n++], sizeof(tokens[0]), "%s=%s", sensor_group_ok_key((sensor_group_t)g), value);
+        }
+    }
+    bool long_names = (style == STYLE_KEY) || (style == STYLE_MIXED && rand() % 2 == 0);
+    snprintf(tokens[n++], sizeof(tokens[0]), "%s=%lu", long_names ? "seq" : "S", (unsigned long)data->seq);
+    snprintf(tokens[n++], sizeof(tokens[0]), "%s=%d", long_names ? "rssi" : "R", data->rssi);
+    if (style == STYLE_MIXED) {
+        snprintf(tokens[n++], sizeof(tokens[0]), "fw=1.%d.%d", rand() % 10, rand() % 10);
+        snprintf(tokens[n++], sizeof(tokens[0]), "vbat%d", rand() % 100);
+        for (size_t i = n - 1; i > 0; i--) {
+            size_t j = (size_t)rand() % (i + 1);
+            char tmp[sizeof(tokens[0])];
+            memcpy(tmp, tokens[i], sizeof(tmp));
+            memcpy(tokens[i], tokens[j], sizeof(tmp));
+            memcpy(tokens[j], tmp, sizeof(tmp));
+        }
+    }
+
+    size_t len = (size_t)snprintf(buf, size, "N=%u", child_no);
+    for (size_t i = 0; i < n && len < size; i++) {
+        len += (size_t)snprintf(buf + len, size - len, ",%s", tokens[i]);
+    }
+    return len;
+}
+
+static void test_round_trip(unsigned long count)
+{
+    for (unsigned long n = 0; n < count; n++) {
+        temp_sens_data_t data, out;
+        random_reading(&data);
+        uint8_t no = (uint8_t)(CHILD_NO_MIN + rand32() % (CHILD_NO_MAX - CHILD_NO_MIN + 1));
+        legacy_style_t style = (legacy_style_t)(n % STYLE_COUNT);
+
+        char buf[PAYLOAD_MAX];
+        size_t channels;
+        size_t len = format_legacy(no, &data, style, buf, sizeof(buf), &channels);
+        CHECK(len < sizeof(buf), "payload too long for the test buffer");
+
+        uint8_t child_no = 0;
+        bool has_seq = false;
+        sensor_legacy_result_t result = decode_exact(buf, len, &child_no, &out, &has_seq);
+        // 表示名で送ると測定失敗の組は値ごと届かないので、チャネルが1つもなければ子機Noのみ
+        if (channels == 0) {
+            CHECK(result == SENSOR_LEGACY_ERR_MISSING && child_no == no && has_seq,
+                  "\"%.*s\": result %d", (int)len, buf, result);
+            continue;
+        }
+        CHECK(result == SENSOR_LEGACY_OK && child_no == no && has_seq && same_reading(&data, &out),
+              "\"%.*s\": result %d child_no %u valid 0x%x/0x%x", (int)len, buf, result, child_no,
+              out.ch_valid, data.ch_valid);
+    }
+}
+
+// ==== 切り詰め・バイト置換 ====
+// デコード結果が入力の範囲内で矛盾しないこと（クラッシュ・範囲外の読み出しはサニタイザで検出）
+static void check_sane(const char *what, const char *payload, size_t len)
+{
+    uint8_t child_no = 0;
+    bool has_seq = false;
+    temp_sens_data_t out;
+    sensor_legacy_result_t result = decode_exact(payload, len, &child_no, &out, &has_seq);
+    CHECK(result == SENSOR_LEGACY_OK || result == SENSOR_LEGACY_ERR_FORMAT || result == SENSOR_LEGACY_ERR_MISSING,
+          "%s: result %d", what, result);
+    if (result != SENSOR_LEGACY_ERR_FORMAT) {
+        CHECK(child_no >= CHILD_NO_MIN && child_no <= CHILD_NO_MAX, "%s: child_no %u", what, child_no);
+    }
+    if (result == SENSOR_LEGACY_OK) {
+        CHECK((out.ch_valid & ~ALL_CH) == 0, "%s: ch_valid 0x%x", what, out.ch_valid);
+        CHECK(!has_seq || memchr(payload, 'S', len) != NULL || memmem(payload, len, "seq=", 4) != NULL,
+              "%s: has_seq without a seq key", what);
+
+        // 同じ入力は同じ結果
+        uint8_t again_no = 0;
+        temp_sens_data_t again;
+        CHECK(decode_exact(payload, len, &again_no, &again, NULL) == result && again_no == child_no &&
+              same_reading(&out, &again), "%s: not deterministic", what);
+    }
+}
+
+static void test_mutation(unsigned long count)
+{
+    static const char charset[] = "N=,.-+0123456789TRHSPBaht_ok01true\r\n x\xff";
+
+    for (unsigned long n = 0; n < count; n++) {
+        temp_sens_data_t data;
+        random_reading(&data);
+        char buf[PAYLOAD_MAX];
+        size_t len = format_legacy((uint8_t)(1 + rand() % 254), &data, (legacy_style_t)(n % STYLE_COUNT),
+                                   buf, sizeof(buf), NULL);
+
+        // 全ての切り詰め
+        if (n < 1000) {
+            for (size_t cut = 0; cut <= len; cut++) {
+                check_sane("truncated", buf, cut);
+            }
+        }
+
+        // 1～4バイトの置換（区切り・数字・キーの文字を多めに）
+        int edits = 1 + rand() % 4;
+        for (int e = 0; e < edits && len > 0; e++) {
+            size_t at = (size_t)rand() % len;
+            buf[at] = (rand() % 4 == 0) ? (char)rand() : charset[(size_t)rand() % (sizeof(charset) - 1)];
+        }
+        check_sane("mutated", buf, len);
+    }
+}
+
+// ==== 速度比較（sensor_json） ====
+typedef struct {
+    char *data;
+    size_t len;
+} payload_t;
+
+static double time_legacy(const payload_t *items, size_t count, int repeats)
+{
+    volatile uint32_t sink = 0;
+    uint64_t t0 = now_ns();
+    for (int k = 0; k < repeats; k++) {
+        for (size_t i = 0; i < count; i++) {
+            uint8_t child_no;
+            temp_sens_data_t out;
+            sink += (uint32_t)sensor_legacy_decode(items[i].data, items[i].len, &child_no, &out, NULL) + out.seq;
+        }
+    }
+    (void)sink;
+    return (double)(now_ns() - t0) / 1e9 / repeats;
+}
+
+static double time_json(const payload_t *items, size_t count, int repeats)
+{
+    volatile uint32_t sink = 0;
+    uint64_t t0 = now_ns();
+    for (int k = 0; k < repeats; k++) {
+        for (size_t i = 0; i < count; i++) {
+            uint8_t child_no;
+            temp_sens_data_t out;
+            sink += (uint32_t)sensor_json_decode(items[i].data, items[i].len, &child_no, &out) + out.seq;
+        }
+    }
+    (void)sink;
+    return (double)(now_ns() - t0) / 1e9 / repeats;
+}
+
+static char *dup_payload(const char *s, size_t len)
+{
+    char *p = malloc(len);
+    if (p == NULL) {
+        perror("malloc");
+        exit(1);
+    }
+    memcpy(p, s, len);
+    return p;
+}
+
+// 子機が実際に送る値の範囲で、同じ測定値の旧形式（表示名）とJSONを作る
+static void bench(size_t count, int repeats)
+{
+    payload_t *legacy = calloc(count, sizeof(*legacy));
+    payload_t *json = calloc(count, sizeof(*json));
+    if (legacy == NULL || json == NULL) {
+        perror("calloc");
+        exit(1);
+    }
+
+    size_t legacy_bytes = 0, json_bytes = 0;
+    for (size_t i = 0; i < count; i++) {
+        temp_sens_data_t data;
+        memset(&data, 0, sizeof(data));
+        sensor_data_set(&data, SENSOR_CH_AHT_T, 200 + rand() % 80);
+        sensor_data_set(&data, SENSOR_CH_AHT_RH, 400 + rand() % 200);
+        sensor_data_set(&data, SENSOR_CH_BMP_T, 200 + rand() % 80);
+        sensor_data_set(&data, SENSOR_CH_BMP_P, 10000 + rand() % 200);
+        sensor_data_apply_group(&data, SENSOR_GROUP_BMP, rand() % 100 >= 3);
+        data.seq = (uint32_t)(i / 64);
+        data.rssi = -40 - rand() % 50;
+        uint8_t no = (uint8_t)(1 + i % 64);
+
+        char buf[PAYLOAD_MAX];
+        size_t len = format_legacy(no, &data, STYLE_LABEL, buf, sizeof(buf), NULL);
+        legacy[i].data = dup_payload(buf, len);
+        legacy[i].len = len;
+        legacy_bytes += len;
+
+        char members[SENSOR_DATA_JSON_MAX];
+        sensor_data_write_json(&data, members, sizeof(members));
+        len = (size_t)snprintf(buf, sizeof(buf), "{\"child_no\":%u,%s,\"seq\":%lu,\"rssi\":%d}",
+                               no, members, (unsigned long)data.seq, data.rssi);
+        json[i].data = dup_payload(buf, len);
+        json[i].len = len;
+        json_bytes += len;
+
+        // 同じ測定値になること（旧形式は測定失敗の組を送らないので有効ビットも一致する）
+        uint8_t a_no, b_no;
+        temp_sens_data_t a, b;
+        sensor_legacy_result_t ra = sensor_legacy_decode(legacy[i].data, legacy[i].len, &a_no, &a, NULL);
+        sensor_json_result_t rb = sensor_json_decode(json[i].data, json[i].len, &b_no, &b);
+        CHECK(ra == SENSOR_LEGACY_OK && rb == SENSOR_JSON_OK && a_no == b_no && same_reading(&a, &b),
+              "legacy \"%.*s\" and json \"%.*s\" differ", (int)legacy[i].len, legacy[i].data,
+              (int)json[i].len, json[i].data);
+    }
+
+    double legacy_s = time_legacy(legacy, count, repeats);
+    double json_s = time_json(json, count, repeats);
+    double n = (double)count;
+    printf("sensor_legacy: %7.1f ns/datagram, %7.1f MB/s, %.1f bytes avg\n",
+           legacy_s / n * 1e9, (double)legacy_bytes / legacy_s / 1e6, (double)legacy_bytes / n);
+    printf("sensor_json:   %7.1f ns/datagram, %7.1f MB/s, %.1f bytes avg\n",
+           json_s / n * 1e9, (double)json_bytes / json_s / 1e6, (double)json_bytes / n);
+
+    for (size_t i = 0; i < count; i++) {
+        free(legacy[i].data);
+        free(json[i].data);
+    }
+    free(legacy);
+    free(json);
+}
+
+// ==== main ====
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -n count       random round-trip and benchmark payloads (default 100000)\n"
+        "  -r repeats     decode repetitions for timing, 0 = skip the benchmark (default 10)\n"
+        "  -s seed        random seed (default 1)\n",
+        prog);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long count = 100000;
+    int repeats = 10;
+    unsigned int seed = 1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:r:s:h")) != -1) {
+        switch (opt) {
+            case 'n': count = strtoul(optarg, NULL, 10); break;
+            case 'r': repeats = atoi(optarg); break;
+            case 's': seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (count == 0 || repeats < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    srand(seed);
+
+    test_known();
+    test_overlong();
+    test_round_trip(count);
+    test_mutation(count);
+    if (repeats > 0) {
+        bench(count, repeats);
+    }
+
+    printf("legacy_test: %lu checks, %lu failures\n", s_checks, s_failures);
+    return (s_failures > 0) ? 1 : 0;
+}
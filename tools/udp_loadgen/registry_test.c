@@ -0,0 +1,759 @@
+// tools/udp_loadgen/registry_test.c
+// 子機レジストリ（src/child_registry.c）をホストで動かす確認用ハーネス（Linux）
+//
+// FreeRTOS/ESP-IDFのヘッダはhost_stubs/の最小限のスタブで置き換え、時刻（xTaskGetTickCount・esp_timer_get_time）は
+// このファイルで進める。ミューテックス・クリティカルセクションは何もしない（1スレッドで呼ぶ）。
+//
+// STALE判定・スロット解放の期限（タイマーホイール）:
+//   - 期限をずらした30台: 期限を迎えた子機だけが期限（から1tick以内）にSTALEになり、受信で期限が延び、
+//     60秒無通信でスロットを解放すること。child_registry_check_timeouts()の待ち時間どおりに起きれば遅れないこと
+//   - 30台に乱数の間隔で受信させ、送信間隔の指示（延長・短縮）を混ぜて、子機監視タスクと同じく
+//     min(待ち時間, 1秒)ごとに期限を確認し、ACTIVE/STALE/解放が早すぎず1tickより遅れないこと、
+//     ACTIVEな子機数・期限の統計・購読タスクへの通知が状態と一致すること
+// 過負荷時の保留公開（child_registry_ingest_deferred/publish_deferred）:
+//   - seq追跡・履歴はデータグラムごとに進み、公開ビュー・遅延の記録・通知はpublish_deferredまで変わらないこと
+//   - 公開は子機ごとに1回、バージョンは変化した子機だけ1つ進み、通知はバーストで1回、
+//     遅延は最後に最新値を更新した測定値の受信時刻から測ること
+//   - 保留中のスロットが解放され、同じバーストの新規登録で再利用されても一覧に二重に載らないこと
+// 履歴:
+//   - バッチフレームの測定値は各自の測定時刻（受信時刻 - age_ms）で追記され、重複は追記されないこと
+//   - スロットの解放・再登録で履歴が空に戻ること
+// 保存待ち:
+//   - ブロックが閉じるたび・解放で最後のブロックを写すたびに取り出しタスクを1回起こし、
+//     起こした時だけ取り出せるブロックがあること
+// 集計:
+//   - 2つの1分境界をまたぐ65秒のバッチが、測定時刻の1分バケットへ振り分けられること
+// 時刻はuint32_tの周回直前から始め、テスト中に周回をまたぐ。1件でも不一致なら終了コード1。
+//
+// ビルド（リポジトリのルートで実行）:
+//   gcc -O2 -Wall -Itools/udp_loadgen/host_stubs -Iinclude -o registry_test tools/udp_loadgen/registry_test.c src/child_registry.c src/timer_wheel.c src/sensor_history.c src/sensor_codec.c src/sensor_rollup.c src/sensor_channel.c src/tx_schedule.c src/latency_trace.c src/latency_hist.c
+//
+// 実行例:
+//   ./registry_test                  （乱数の受信を4時間分）
+//   ./registry_test -m 30 -s 7 -v    （30分間、レジストリのログを表示）
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <string.h>
+#include <getopt.h>
+#include "freertos/FreeRTOS.h"
+#include "child_registry.h"
+#include "latency_trace.h"
+#include "log_task.h"
+
+// ==== 設定 ====
+#define CHILDREN            30
+#define START_BEFORE_WRAP   600000u     // 開始時刻: uint32_tの周回の10分前
+#define TICK                CHILD_TIMER_TICK_MS
+
+static unsigned long s_checks;
+static unsigned long s_failures;
+
+#define CHECK(cond, ...) do {                                       \
+        s_checks++;                                                 \
+        if (!(cond)) {                                              \
+            if (s_failures++ < 20) {                                \
+                printf("FAIL %s:%d: ", __func__, __LINE__);         \
+                printf(__VA_ARGS__);                                \
+                printf("\n");                                       \
+            }                                                       \
+        }                                                           \
+    } while (0)
+
+// ==== スタブ（host_stubs/で宣言した関数の実体） ====
+static uint32_t s_now_ms;
+static unsigned long s_notifies;
+static bool s_verbose;
+static int s_subscriber;        // 購読タスクのハンドル代わり
+static int s_store;             // 保存待ちの取り出しタスクのハンドル代わり
+static unsigned long s_store_notifies;
+
+TickType_t xTaskGetTickCount(void)
+{
+    return s_now_ms;
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return (int64_t)s_now_ms * 1000 + 1;    // 0は「不明」なので避ける
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    (void)ticks;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    if (task == &s_subscriber) {
+        s_notifies++;
+    } else if (task == &s_store) {
+        s_store_notifies++;
+    }
+    return pdPASS;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    static int mutex;
+    return &mutex;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    (void)sem;
+    (void)ticks;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    (void)sem;
+    return pdTRUE;
+}
+
+void syslog(unsigned char mode, const char *fmt, ...)
+{
+    (void)mode;
+    if (!s_verbose) {
+        return;
+    }
+    va_list ap;
+    va_start(ap, fmt);
+    vprintf(fmt, ap);
+    va_end(ap);
+    printf("\n");
+}
+
+// ==== 参照モデル ====
+typedef struct {
+    bool registered;
+    bool stale;
+    uint32_t last_ms;           // 最終受信時刻
+    uint32_t interval_ms;       // STALE判定に使う送信間隔
+    uint32_t pending_ms;        // 次の受信で反映する短い間隔
+    uint32_t seq;
+    uint32_t next_send_ms;      // 乱数テスト: 次に受信させる時刻
+} model_child_t;
+
+static model_child_t s_model[CHILDREN + 1];     // 子機No 1～CHILDREN
+static unsigned long s_seen_stale;
+static unsigned long s_seen_expired;
+
+static uint32_t model_stale_ms(const model_child_t *m)
+{
+    uint32_t timeout_ms = m->interval_ms * CHILD_STALE_MISSED_REPORTS;
+    if (timeout_ms < CHILD_STALE_TIMEOUT_MS) {
+        timeout_ms = CHILD_STALE_TIMEOUT_MS;
+    }
+    // ACTIVEの期限は解放の期限で頭打ち
+    return (timeout_ms < CHILD_EXPIRE_TIMEOUT_MS) ? timeout_ms : CHILD_EXPIRE_TIMEOUT_MS;
+}
+
+static bool later_or_equal(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) >= 0;
+}
+
+static uint32_t rand32(void)
+{
+    return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+// 履歴の記録数（times・seqsがNULLでなければ古い順に最大max_count件写す）
+static size_t history_read(uint8_t no, uint32_t *times, uint32_t *seqs, size_t max_count)
+{
+    static sensor_history_t history;
+    if (!child_registry_copy_history(no, &history)) {
+        return 0;
+    }
+    sensor_history_iter_t it;
+    sensor_history_seek(&it, &history, s_now_ms - 0x40000000u);
+    size_t records = 0;
+    uint32_t time_ms;
+    temp_sens_data_t data;
+    while (sensor_history_next(&it, &time_ms, &data)) {
+        if (times != NULL && records < max_count) {
+            times[records] = time_ms;
+            seqs[records] = data.seq;
+        }
+        records++;
+    }
+    return records;
+}
+
+static size_t history_records(uint8_t no)
+{
+    return history_read(no, NULL, NULL, 0);
+}
+
+// 子機から受信（測定値ありは1件の測定値、なしは子機Noのみの旧形式と同じ扱い）
+static void model_receive(uint8_t no, bool with_reading)
+{
+    model_child_t *m = &s_model[no];
+    uint32_t ip = 0x0A000000u | no;
+    if (with_reading) {
+        temp_sens_data_t data;
+        memset(&data, 0, sizeof(data));
+        sensor_data_set(&data, SENSOR_CH_AHT_T, 200 + no);
+        data.seq = ++m->seq;
+        bool advanced = false;
+        int kept = child_registry_ingest(no, ip, s_now_ms, esp_timer_get_time(), &data, NULL, 1, true, &advanced);
+        CHECK(kept == 1 && advanced, "N=%u ingest kept %d", no, kept);
+    } else {
+        CHECK(child_registry_update(no, ip, s_now_ms) >= 0, "N=%u update", no);
+    }
+
+    if (!m->registered) {
+        // 新規登録（解放後の再登録を含む）は指示間隔なしから
+        m->interval_ms = 0;
+        m->pending_ms = 0;
+    }
+    m->registered = true;
+    m->stale = false;
+    m->last_ms = s_now_ms;
+    if (m->pending_ms != 0) {
+        m->interval_ms = m->pending_ms;
+        m->pending_ms = 0;
+    }
+}
+
+static void model_set_interval(uint8_t no, uint32_t interval_ms)
+{
+    child_registry_set_report_interval(no, interval_ms);
+    model_child_t *m = &s_model[no];
+    if (!m->registered) {
+        return;
+    }
+    if (interval_ms >= m->interval_ms) {
+        m->interval_ms = interval_ms;
+        m->pending_ms = 0;
+    } else {
+        m->pending_ms = interval_ms;
+    }
+}
+
+// 期限を確認し、全子機の公開ビューがモデルの許す範囲にあることを確かめる
+// 戻り値: child_registry_check_timeouts()の待ち時間
+static uint32_t check_and_verify(void)
+{
+    child_timer_stats_t before;
+    child_registry_get_timer_stats(&before);
+    unsigned long notifies = s_notifies;
+
+    uint32_t wait = child_registry_check_timeouts(s_now_ms);
+    CHECK(wait <= CHILD_EXPIRE_TIMEOUT_MS, "wait %lu", (unsigned long)wait);
+
+    unsigned long transitions = 0;
+    size_t active = 0;
+    for (uint8_t no = 1; no <= CHILDREN; no++) {
+        model_child_t *m = &s_model[no];
+        child_view_t view;
+        bool present = child_registry_read_view(no, &view);
+        uint32_t elapsed = s_now_ms - m->last_ms;
+
+        if (!m->registered) {
+            CHECK(!present, "N=%u present before registration", no);
+            continue;
+        }
+        if (!present) {
+            // 解放: 60秒無通信から1tick以内
+            CHECK(elapsed >= CHILD_EXPIRE_TIMEOUT_MS, "N=%u expired early after %lu ms", no, (unsigned long)elapsed);
+            m->registered = false;
+            s_seen_expired++;
+            transitions++;
+            continue;
+        }
+        CHECK(elapsed < CHILD_EXPIRE_TIMEOUT_MS + TICK, "N=%u not expired after %lu ms", no, (unsigned long)elapsed);
+
+        if (!m->stale) {
+            uint32_t stale_ms = model_stale_ms(m);
+            if (!view.active) {
+                CHECK(elapsed >= stale_ms, "N=%u stale early after %lu ms (timeout %lu)", no,
+                      (unsigned long)elapsed, (unsigned long)stale_ms);
+                m->stale = true;
+                s_seen_stale++;
+                transitions++;
+            } else {
+                CHECK(elapsed < stale_ms + TICK, "N=%u not stale after %lu ms (timeout %lu)", no,
+                      (unsigned long)elapsed, (unsigned long)stale_ms);
+            }
+        } else {
+            CHECK(!view.active, "N=%u active again without a reception", no);
+        }
+        if (!m->stale) {
+            active++;
+        }
+    }
+
+    // 一覧（ロックなし）は登録済みの子機を子機No昇順で、スロットは子機No → スロットと一致
+    static child_registry_ref_t refs[CHILD_REGISTRY_MAX_NODES];
+    size_t listed = child_registry_list(refs, CHILD_REGISTRY_MAX_NODES);
+    size_t registered = 0;
+    for (uint8_t no = 1; no <= CHILDREN; no++) {
+        if (!s_model[no].registered) {
+            continue;
+        }
+        CHECK(registered < listed && refs[registered].child_no == no &&
+              refs[registered].slot == child_registry_slot_of(no), "N=%u listed at %zu", no, registered);
+        registered++;
+    }
+    CHECK(listed == registered, "%zu listed, %zu registered", listed, registered);
+
+    CHECK(child_registry_count_active() == active, "active count %zu, model %zu",
+          child_registry_count_active(), active);
+    CHECK(child_registry_has_active() == (active > 0), "has_active");
+
+    child_timer_stats_t after;
+    child_registry_get_timer_stats(&after);
+    CHECK(after.stale + after.expired - before.stale - before.expired == transitions,
+          "timer stats moved by %lu, %lu transitions seen",
+          (unsigned long)(after.stale + after.expired - before.stale - before.expired), transitions);
+    CHECK((transitions > 0) == (s_notifies != notifies), "notify on transitions (%lu)", transitions);
+    return wait;
+}
+
+static void reset_registry(uint32_t start_ms)
+{
+    s_now_ms = start_ms;
+    memset(s_model, 0, sizeof(s_model));
+    s_seen_stale = 0;
+    s_seen_expired = 0;
+    child_registry_init();
+}
+
+// ==== 期限をずらした30台 ====
+static void test_staggered(void)
+{
+    uint32_t t0 = (uint32_t)0 - START_BEFORE_WRAP;
+    reset_registry(t0);
+
+    // 100msずつずらして登録、N=5は最後にもう一度受信（期限が延びる）
+    for (uint8_t no = 1; no <= CHILDREN; no++) {
+        s_now_ms = t0 + (uint32_t)no * 100;
+        model_receive(no, true);
+        check_and_verify();
+    }
+    s_now_ms = t0 + (CHILDREN + 1) * 100;
+    model_receive(5, true);
+
+    // 待ち時間どおりに起きる（1秒で頭打ちにしない）
+    unsigned long wakeups = 0;
+    uint32_t stale_at[CHILDREN + 1] = { 0 };
+    uint32_t expire_at[CHILDREN + 1] = { 0 };
+    while (s_seen_expired < CHILDREN && wakeups < 10000) {
+        uint32_t wait = check_and_verify();
+        wakeups++;
+        for (uint8_t no = 1; no <= CHILDREN; no++) {
+            if (s_model[no].stale && stale_at[no] == 0) {
+                stale_at[no] = s_now_ms - s_model[no].last_ms;
+            }
+            if (!s_model[no].registered && expire_at[no] == 0) {
+                expire_at[no] = s_now_ms - s_model[no].last_ms;
+            }
+        }
+        s_now_ms += (wait > 0) ? wait : 1;
+    }
+
+    CHECK(s_seen_stale == CHILDREN && s_seen_expired == CHILDREN, "stale %lu expired %lu",
+          s_seen_stale, s_seen_expired);
+    for (uint8_t no = 1; no <= CHILDREN; no++) {
+        CHECK(stale_at[no] >= CHILD_STALE_TIMEOUT_MS && stale_at[no] < CHILD_STALE_TIMEOUT_MS + TICK,
+              "N=%u went stale %lu ms after its last reception", no, (unsigned long)stale_at[no]);
+        CHECK(expire_at[no] >= CHILD_EXPIRE_TIMEOUT_MS && expire_at[no] < CHILD_EXPIRE_TIMEOUT_MS + TICK,
+              "N=%u expired %lu ms after its last reception", no, (unsigned long)expire_at[no]);
+    }
+    CHECK(s_model[5].last_ms == t0 + (CHILDREN + 1) * 100, "N=5 deadline pushed out by its second reception");
+
+    // 起きた回数は期限のあるtick数程度（1秒ごとの全子機走査ではない）
+    CHECK(wakeups <= 2 * CHILDREN + 4, "%lu wakeups for %d children", wakeups, CHILDREN);
+
+    child_timer_stats_t stats;
+    child_registry_get_timer_stats(&stats);
+    CHECK(stats.stale == CHILDREN && stats.expired == CHILDREN && stats.armed == 0,
+          "timer stats stale %lu expired %lu armed %lu", (unsigned long)stats.stale,
+          (unsigned long)stats.expired, (unsigned long)stats.armed);
+    CHECK(!child_registry_has_active() && child_registry_count_active() == 0, "no active child left");
+    CHECK(child_registry_check_timeouts(s_now_ms) == CHILD_EXPIRE_TIMEOUT_MS, "idle wheel waits the limit");
+    printf("staggered: %d children, %lu wakeups\n", CHILDREN, wakeups);
+}
+
+// ==== 過負荷時の保留公開 ====
+static int ingest_deferred(uint8_t no, uint32_t seq, int64_t recv_us, bool *advanced)
+{
+    temp_sens_data_t data;
+    memset(&data, 0, sizeof(data));
+    sensor_data_set(&data, SENSOR_CH_AHT_T, (int64_t)seq * 10 + no);
+    data.seq = seq;
+    if ((int32_t)(seq - s_model[no].seq) > 0) {
+        s_model[no].seq = seq;
+    }
+    return child_registry_ingest_deferred(no, 0x0A000000u | no, s_now_ms, recv_us, &data, NULL, 1, true, advanced);
+}
+
+static void test_deferred(void)
+{
+    uint32_t t0 = (uint32_t)0 - 1000;
+    reset_registry(t0);
+    latency_trace_reset();
+    for (uint8_t no = 1; no <= 3; no++) {
+        model_receive(no, true);    // seq=1で登録して公開済み
+    }
+
+    child_view_t before[5];
+    for (uint8_t no = 1; no <= 4; no++) {
+        CHECK(child_registry_read_view(no, &before[no]) == (no <= 3), "N=%u view before the burst", no);
+    }
+    child_view_stats_t vstats_before;
+    child_registry_get_view_stats(&vstats_before);
+    uint32_t version_before = child_registry_version();
+    unsigned long notifies_before = s_notifies;
+
+    // バースト（周回をまたぐ）: N=1は5件、N=2は順序逆転を含む2件、N=3は重複1件、N=4は新規登録
+    s_now_ms = t0 + 1500;
+    bool advanced;
+    int64_t last_recv_us_1 = 0;
+    for (uint32_t seq = 2; seq <= 6; seq++) {
+        int64_t recv_us = 5000000 + seq;
+        CHECK(ingest_deferred(1, seq, recv_us, &advanced) == 1 && advanced, "N=1 seq=%lu", (unsigned long)seq);
+        last_recv_us_1 = recv_us;
+    }
+    CHECK(ingest_deferred(2, 4, 6000000, &advanced) == 1 && advanced, "N=2 seq=4");
+    CHECK(ingest_deferred(2, 3, 6000001, &advanced) == 1 && !advanced, "N=2 reordered seq=3");
+    CHECK(ingest_deferred(3, 1, 7000000, &advanced) == 0 && !advanced, "N=3 duplicate");
+    CHECK(ingest_deferred(4, 1, 8000000, &advanced) == 1 && advanced, "N=4 new");
+
+    // 公開前: seq追跡・履歴は進み、公開ビュー・通知・遅延の記録はそのまま
+    child_seq_stats_t seq1, seq2, seq3;
+    CHECK(child_registry_get_seq_stats(1, &seq1) && seq1.received == 6 && seq1.last_seq == 6, "N=1 seq stats");
+    CHECK(child_registry_get_seq_stats(2, &seq2) && seq2.reordered == 1 && seq2.last_seq == 4, "N=2 seq stats");
+    CHECK(child_registry_get_seq_stats(3, &seq3) && seq3.duplicate == 1, "N=3 seq stats");
+    CHECK(history_records(1) == 6, "N=1 history has %zu records", history_records(1));
+    CHECK(history_records(2) == 3, "N=2 history has %zu records", history_records(2));
+    for (uint8_t no = 1; no <= 3; no++) {
+        child_view_t view;
+        CHECK(child_registry_read_view(no, &view) && memcmp(&view, &before[no], sizeof(view)) == 0,
+              "N=%u view changed before publish", no);
+    }
+    child_view_t view;
+    CHECK(!child_registry_read_view(4, &view), "N=4 visible before publish");
+    child_view_stats_t vstats;
+    child_registry_get_view_stats(&vstats);
+    CHECK(vstats.publishes == vstats_before.publishes && child_registry_version() == version_before,
+          "view written before publish");
+    CHECK(s_notifies == notifies_before, "notified before publish");
+    latency_hist_t hist;
+    latency_trace_get(LATENCY_RECV_TO_COMMIT, &hist);
+    uint32_t traced_before = hist.count;
+
+    // 公開: 子機ごとに1回、変化した3台だけバージョンが進み、通知は1回
+    s_now_ms += 7;
+    int64_t commit_us = esp_timer_get_time();
+    CHECK(child_registry_publish_deferred() == 4, "published slots");
+    child_registry_get_view_stats(&vstats);
+    CHECK(vstats.publishes == vstats_before.publishes + 4, "%lu view writes",
+          (unsigned long)(vstats.publishes - vstats_before.publishes));
+    CHECK(child_registry_version() == version_before + 3, "version moved by %lu",
+          (unsigned long)(child_registry_version() - version_before));
+    CHECK(s_notifies == notifies_before + 1, "%lu notifies", s_notifies - notifies_before);
+
+    CHECK(child_registry_read_view(1, &view) && view.version > before[1].version
+          && view.last_recv_ms == t0 + 1500 && view.commit_us == commit_us
+          && view.commit_delay_us == (uint32_t)(commit_us - last_recv_us_1), "N=1 published view");
+    temp_sens_data_t latest;
+    CHECK(child_registry_read_latest(1, &latest) && latest.ch[SENSOR_CH_AHT_T] == 61, "N=1 latest value");
+    CHECK(child_registry_read_view(2, &view) && view.commit_delay_us == (uint32_t)(commit_us - 6000000),
+          "N=2 delay from the reading that advanced");
+    CHECK(child_registry_read_view(3, &view) && view.version == before[3].version
+          && view.last_recv_ms == t0 + 1500, "N=3 only its reception time moves");
+    CHECK(child_registry_read_view(4, &view) && view.has_reading, "N=4 published");
+    latency_trace_get(LATENCY_RECV_TO_COMMIT, &hist);
+    CHECK(hist.count == traced_before + 3, "%lu delays traced", (unsigned long)(hist.count - traced_before));
+
+    CHECK(child_registry_publish_deferred() == 0 && s_notifies == notifies_before + 1, "empty publish");
+
+    // 保留中に解放されたスロットを同じバーストの新規登録が再利用しても、一覧には1回だけ載る
+    uint32_t t1 = s_now_ms;
+    CHECK(ingest_deferred(9, 1, 9000000, &advanced) == 1, "N=9 new");
+    int slot = child_registry_slot_of(9);
+    s_now_ms = t1 + CHILD_STALE_TIMEOUT_MS;
+    child_registry_check_timeouts(s_now_ms);
+    for (uint8_t no = 1; no <= 4; no++) {
+        model_receive(no, true);     // 他の子機は受信を続ける（公開済み）
+    }
+    s_now_ms = t1 + CHILD_EXPIRE_TIMEOUT_MS;
+    child_registry_check_timeouts(s_now_ms);
+    CHECK(child_registry_slot_of(9) < 0, "N=9 released");
+    CHECK(ingest_deferred(10, 1, 9500000, &advanced) == 1, "N=10 new");
+    CHECK(child_registry_slot_of(10) == slot, "N=10 reuses the slot of N=9");
+    CHECK(child_registry_publish_deferred() == 1, "reused slot listed once");
+    CHECK(child_registry_read_view(10, &view) && view.child_no == 10 && view.has_reading, "N=10 published");
+    CHECK(!child_registry_read_view(9, &view), "N=9 still visible");
+    printf("deferred: publish once per child, notify once per burst\n");
+}
+
+// ==== 履歴 ====
+static void test_history(void)
+{
+    uint32_t t0 = (uint32_t)0 - 20000;   // バッチの測定時刻が周回をまたぐ
+    reset_registry(t0);
+
+    // 1件ずつの受信は受信時刻で追記
+    model_receive(1, true);
+    CHECK(history_records(1) == 1, "N=1 first reading");
+
+    // バッチ（seq 2～5、10秒間隔で測定）を、最後の測定から3秒後に受信
+    s_now_ms = t0 + 43000;
+    temp_sens_data_t batch[4];
+    uint16_t age_ms[4] = { 33000, 23000, 13000, 3000 };
+    for (int i = 0; i < 4; i++) {
+        memset(&batch[i], 0, sizeof(batch[i]));
+        sensor_data_set(&batch[i], SENSOR_CH_AHT_T, 200 + i);
+        batch[i].seq = (uint32_t)(2 + i);
+    }
+    bool advanced = false;
+    CHECK(child_registry_ingest(1, 0x0A000001u, s_now_ms, esp_timer_get_time(), batch, age_ms, 4, true,
+                                &advanced) == 4 && advanced, "batch accepted");
+    s_model[1].seq = 5;
+    s_model[1].last_ms = s_now_ms;
+
+    uint32_t times[8], seqs[8];
+    CHECK(history_read(1, times, seqs, 8) == 5, "N=1 history after the batch");
+    for (int i = 0; i < 4; i++) {
+        uint32_t want = t0 + 43000 - (uint32_t)(33000 - 10000 * i);
+        CHECK(seqs[1 + i] == (uint32_t)(2 + i) && want - times[1 + i] < SENSOR_CODEC_TIME_UNIT_MS,
+              "batch record %d at %lu, measured at %lu", i, (unsigned long)times[1 + i], (unsigned long)want);
+    }
+
+    // 重複（同じバッチの再送）は追記しない。受信時刻より前の測定値は直前の時刻に切り上げる
+    uint16_t resend_age[4] = { 33000, 23000, 13000, 3000 };
+    CHECK(child_registry_ingest(1, 0x0A000001u, s_now_ms, esp_timer_get_time(), batch, resend_age, 4, true,
+                                &advanced) == 0 && !advanced, "duplicate batch dropped");
+    CHECK(history_records(1) == 5, "duplicates appended");
+    temp_sens_data_t late;
+    memset(&late, 0, sizeof(late));
+    late.seq = 6;
+    uint16_t late_age = 20000;
+    CHECK(child_registry_ingest(1, 0x0A000001u, s_now_ms, esp_timer_get_time(), &late, &late_age, 1, true,
+                                &advanced) == 1, "late reading accepted");
+    s_model[1].seq = 6;
+    CHECK(history_read(1, times, seqs, 8) == 6 && times[5] == times[4] && seqs[5] == 6,
+          "older reading kept at the previous time");
+
+    // 解放で履歴を消し、再登録は空から
+    s_now_ms += CHILD_STALE_TIMEOUT_MS;
+    check_and_verify();
+    s_now_ms = s_model[1].last_ms + CHILD_EXPIRE_TIMEOUT_MS;
+    check_and_verify();
+    CHECK(!s_model[1].registered && history_records(1) == 0, "history kept after expiry");
+    s_now_ms += 1000;
+    model_receive(1, true);
+    CHECK(history_read(1, times, seqs, 8) == 1 && times[0] == s_now_ms, "history after re-registration");
+    printf("history: batch readings at their measurement time\n");
+}
+
+// ==== 保存待ち ====
+static void test_sealed(void)
+{
+    uint32_t t0 = (uint32_t)0 - 30000;
+    reset_registry(t0);
+    uint8_t child_no;
+    uint8_t block[SENSOR_HISTORY_BLOCK_BYTES];
+    while (child_registry_take_sealed(&child_no, block)) {
+        // 前のテストの解放で写したブロックを捨てる
+    }
+
+    // 値が大きく跳ぶ測定値でブロックを次々に閉じる
+    unsigned long taken = 0;
+    for (uint32_t seq = 1; seq <= 200; seq++) {
+        temp_sens_data_t data;
+        memset(&data, 0, sizeof(data));
+        sensor_data_set(&data, SENSOR_CH_AHT_T, (int32_t)rand32());
+        data.seq = seq;
+        s_now_ms = t0 + seq * 100;
+        unsigned long notifies = s_store_notifies;
+        CHECK(child_registry_ingest(1, 0x0A000001u, s_now_ms, esp_timer_get_time(), &data, NULL, 1, true,
+                                    NULL) == 1, "seq=%lu accepted", (unsigned long)seq);
+        bool woken = (s_store_notifies != notifies);
+        CHECK(s_store_notifies - notifies <= 1, "%lu wakes for one reading", s_store_notifies - notifies);
+        bool found = child_registry_take_sealed(&child_no, block);
+        CHECK(found == woken && (!found || child_no == 1), "seq=%lu: woken %d, sealed block %d",
+              (unsigned long)seq, woken, found);
+        taken += found;
+    }
+    CHECK(taken >= 4, "%lu blocks sealed", taken);
+
+    // 解放で書き込み中のブロックを写す
+    s_model[1] = (model_child_t){ .registered = true, .last_ms = s_now_ms, .seq = 200 };
+    unsigned long notifies = s_store_notifies;
+    s_now_ms += CHILD_EXPIRE_TIMEOUT_MS;
+    check_and_verify();
+    CHECK(s_store_notifies == notifies + 1 && child_registry_take_sealed(&child_no, block) && child_no == 1 &&
+          !child_registry_take_sealed(&child_no, block), "release: last block queued with one wake");
+    printf("sealed: %lu blocks, one wake per block\n", taken + 1);
+}
+
+// ==== 集計 ====
+static void test_rollup(void)
+{
+    uint32_t t0 = 10 * 60000u;
+    reset_registry(t0 + 30000);
+    model_receive(1, true);     // 集計中の1分は t0 から
+
+    // t0+55000 ～ t0+120000 の14件（5秒間隔）を t0+120500 に受信
+    s_now_ms = t0 + 120500;
+    temp_sens_data_t batch[14];
+    uint16_t age_ms[14];
+    for (int i = 0; i < 14; i++) {
+        memset(&batch[i], 0, sizeof(batch[i]));
+        sensor_data_set(&batch[i], SENSOR_CH_AHT_T, 210 + i);
+        batch[i].seq = (uint32_t)(2 + i);
+        age_ms[i] = (uint16_t)(s_now_ms - (t0 + 55000 + 5000 * (uint32_t)i));
+    }
+    bool advanced = false;
+    CHECK(child_registry_ingest(1, 0x0A000001u, s_now_ms, esp_timer_get_time(), batch, age_ms, 14, true,
+                                &advanced) == 14 && advanced, "65 s batch accepted");
+
+    static sensor_rollup_t rollup;
+    CHECK(child_registry_copy_rollup(1, &rollup), "N=1 rollup");
+    const sensor_rollup_bucket_t *closed = &rollup.closed[SENSOR_ROLLUP_MINUTE];
+    const sensor_rollup_bucket_t *open = &rollup.open[SENSOR_ROLLUP_MINUTE];
+    // t0 の1分: 単発 + t0+55000、t0+60000 の1分: 12件（211～222）、t0+120000 の1分: 1件（223）
+    CHECK(closed->start_ms == t0 + 60000 && closed->samples == 12 && closed->ch[SENSOR_CH_AHT_T].min == 211 &&
+          closed->ch[SENSOR_CH_AHT_T].max == 222, "closed minute start %lu samples %lu",
+          (unsigned long)closed->start_ms, (unsigned long)closed->samples);
+    CHECK(open->start_ms == t0 + 120000 && open->samples == 1 && open->ch[SENSOR_CH_AHT_T].sum == 223,
+          "open minute start %lu samples %lu", (unsigned long)open->start_ms, (unsigned long)open->samples);
+    CHECK(rollup.open[SENSOR_ROLLUP_HOUR].samples == 15, "hour samples %lu",
+          (unsigned long)rollup.open[SENSOR_ROLLUP_HOUR].samples);
+    printf("rollup: batch readings in the minute they were measured\n");
+}
+
+// ==== 乱数の受信と送信間隔の指示 ====
+static uint32_t pick_gap(void)
+{
+    int r = rand() % 100;
+    if (r < 70) {
+        return 500 + rand32() % 3500;           // 通常
+    }
+    if (r < 90) {
+        return 4000 + rand32() % 8000;          // STALE判定の前後
+    }
+    if (r < 97) {
+        return 12000 + rand32() % 33000;        // 長めの途絶
+    }
+    return 55000 + rand32() % 35000;            // 解放の前後
+}
+
+static void test_random(uint32_t minutes)
+{
+    uint32_t t0 = (uint32_t)0 - START_BEFORE_WRAP;
+    reset_registry(t0);
+    for (uint8_t no = 1; no <= CHILDREN; no++) {
+        s_model[no].next_send_ms = t0 + rand32() % 5000;
+    }
+
+    static const uint32_t intervals[] = { 0, 1000, 2000, 5000, 10000, 20000, 35000 };
+    uint32_t end_ms = t0 + minutes * 60000u;
+    uint32_t wait = 0;
+    unsigned long receptions = 0, wakeups = 0;
+    bool wrapped = false;
+
+    while ((int32_t)(end_ms - s_now_ms) > 0) {
+        // 子機監視タスクと同じく min(待ち時間, 1秒) 後、その前に受信があればその時刻
+        uint32_t step = (wait < 1000) ? wait : 1000;
+        uint32_t next = s_now_ms + ((step > 0) ? step : 1);
+        for (uint8_t no = 1; no <= CHILDREN; no++) {
+            if ((int32_t)(s_model[no].next_send_ms - next) < 0) {
+                next = s_model[no].next_send_ms;
+            }
+        }
+        if (later_or_equal(s_now_ms, next)) {
+            next = s_now_ms + 1;
+        }
+        wrapped |= next < s_now_ms;
+        s_now_ms = next;
+
+        for (uint8_t no = 1; no <= CHILDREN; no++) {
+            model_child_t *m = &s_model[no];
+            if (!later_or_equal(s_now_ms, m->next_send_ms)) {
+                continue;
+            }
+            model_receive(no, rand() % 4 != 0);
+            receptions++;
+            m->next_send_ms = s_now_ms + pick_gap();
+            if (rand() % 20 == 0) {
+                model_set_interval(no, intervals[rand() % (sizeof(intervals) / sizeof(intervals[0]))]);
+            }
+        }
+        // 送信間隔の指示は受信と無関係な時刻にも来る（report_control）
+        if (rand() % 50 == 0) {
+            uint8_t no = (uint8_t)(1 + rand() % CHILDREN);
+            model_set_interval(no, intervals[rand() % (sizeof(intervals) / sizeof(intervals[0]))]);
+        }
+
+        wait = check_and_verify();
+        wakeups++;
+    }
+
+    CHECK(wrapped, "test did not cross the uint32_t time wrap");
+    CHECK(s_seen_stale > 0 && s_seen_expired > 0, "random traffic produced stale %lu, expired %lu",
+          s_seen_stale, s_seen_expired);
+    printf("random: %d children, %lu min, %lu receptions, %lu wakeups, %lu stale, %lu expired\n",
+           CHILDREN, (unsigned long)minutes, receptions, wakeups, s_seen_stale, s_seen_expired);
+}
+
+// ==== main ====
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -m minutes     simulated minutes of random traffic (default 240)\n"
+        "  -s seed        random seed (default 1)\n"
+        "  -v             print the registry log\n",
+        prog);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long minutes = 240;
+    unsigned int seed = 1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "m:s:vh")) != -1) {
+        switch (opt) {
+            case 'm': minutes = strtoul(optarg, NULL, 10); break;
+            case 's': seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+            case 'v': s_verbose = true; break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (minutes == 0 || minutes > 30000) {   // 終了時刻をint32_tの差で比べるため
+        usage(argv[0]);
+        return 1;
+    }
+    srand(seed);
+    // 購読は起動時だけ（child_registry_init()では解除されない）
+    child_registry_init();
+    if (!child_registry_subscribe(&s_subscriber)) {
+        printf("subscribe failed\n");
+        return 1;
+    }
+    child_registry_set_sealed_consumer(&s_store);
+
+    test_staggered();
+    test_deferred();
+    test_history();
+    test_sealed();
+    test_rollup();
+    test_random((uint32_t)minutes);
+
+    printf("registry_test: %lu checks, %lu failures\n", s_checks, s_failures);
+    return (s_failures > 0) ? 1 : 0;
+}
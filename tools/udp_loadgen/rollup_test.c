@@ -0,0 +1,337 @@
+// tools/udp_loadgen/rollup_test.c
+// 測定値の集計（src/sensor_rollup.c）のテスト（Linux）
+//
+//   - 1秒間隔で2時間分を順に足し込み、閉じた1分・1時間のバケットがその周期の全測定値から求めた
+//     件数・最小・最大・合計・2乗の合計と一致すること。周期を過ぎてからのsensor_rollup_roll()で閉じること
+//   - 5秒間隔で14件（65秒）のバッチが2つの1分境界をまたぐ時、各測定値が測定時刻の周期に入ること
+//   - バッチフレームを乱数の遅れ・入れ替わりで-d日分足し込み、足し込むたびに集計中・直前に閉じたバケットが
+//     参照モデル（周期番号で振り分け、集計中より前は直前に閉じた周期ならそこへ、それより前は集計中へ）と一致すること
+// 1件でも不一致なら終了コード1。
+//
+// ビルド（リポジトリのルートで実行）:
+//   gcc -O2 -Wall -Iinclude -o rollup_test tools/udp_loadgen/rollup_test.c src/sensor_rollup.c src/sensor_channel.c
+//
+// 実行例:
+//   ./rollup_test                 （バッチを7日分）
+//   ./rollup_test -d 40 -s 7      （40日分、乱数の種を変える）
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <getopt.h>
+#include "sensor_channel.h"
+#include "sensor_rollup.h"
+
+// ==== 設定 ====
+#define BATCH_MAX           16          // バッチフレームの最大件数
+
+static unsigned long s_checks;
+static unsigned long s_failures;
+
+#define CHECK(cond, ...) do {                                       \
+        s_checks++;                                                 \
+        if (!(cond)) {                                              \
+            if (s_failures++ < 20) {                                \
+                printf("FAIL %s:%d: ", __func__, __LINE__);         \
+                printf(__VA_ARGS__);                                \
+                printf("\n");                                       \
+            }                                                       \
+        }                                                           \
+    } while (0)
+
+static uint32_t rand32(void)
+{
+    return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+static void make_reading(temp_sens_data_t *data, uint32_t seq, int32_t base)
+{
+    memset(data, 0, sizeof(*data));
+    data->seq = seq;
+    sensor_data_set(data, SENSOR_CH_AHT_T, base);
+    sensor_data_set(data, SENSOR_CH_AHT_RH, 500 + (int32_t)(seq % 97));
+    if (seq % 7 != 0) {     // BMPはときどき測定失敗
+        sensor_data_set(data, SENSOR_CH_BMP_T, base - 3);
+        sensor_data_set(data, SENSOR_CH_BMP_P, 100000 + (int32_t)(seq % 1013) * 7);
+    }
+}
+
+// ==== 参照の集計 ====
+static void ref_add(sensor_rollup_bucket_t *bucket, const temp_sens_data_t *data)
+{
+    bucket->samples++;
+    for (int ch = 0; ch < SENSOR_CH_COUNT; ch++) {
+        if (!sensor_data_valid(data, (sensor_ch_t)ch)) {
+            continue;
+        }
+        sensor_rollup_stat_t *stat = &bucket->ch[ch];
+        int32_t v = data->ch[ch];
+        if (stat->count == 0 || v < stat->min) {
+            stat->min = v;
+        }
+        if (stat->count == 0 || v > stat->max) {
+            stat->max = v;
+        }
+        stat->count++;
+        stat->sum += v;
+        stat->sum_sq += (uint64_t)((int64_t)v * v);
+    }
+}
+
+static bool same_bucket(const sensor_rollup_bucket_t *got, const sensor_rollup_bucket_t *want)
+{
+    if (got->samples != want->samples) {
+        return false;
+    }
+    if (want->samples == 0) {
+        return true;
+    }
+    if (got->start_ms != want->start_ms) {
+        return false;
+    }
+    for (int ch = 0; ch < SENSOR_CH_COUNT; ch++) {
+        const sensor_rollup_stat_t *a = &got->ch[ch];
+        const sensor_rollup_stat_t *b = &want->ch[ch];
+        if (a->count != b->count || a->sum != b->sum || a->sum_sq != b->sum_sq ||
+            (b->count > 0 && (a->min != b->min || a->max != b->max))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ==== 1秒間隔で2時間 ====
+static void test_steady(void)
+{
+    enum { SECONDS = 7200 };
+    static temp_sens_data_t readings[SECONDS + 1];
+    static sensor_rollup_t rollup;
+    sensor_rollup_reset(&rollup);
+
+    int32_t base = 250;
+    for (uint32_t s = 0; s <= SECONDS; s++) {
+        base += rand() % 5 - 2;
+        make_reading(&readings[s], s + 1, base);
+        sensor_rollup_add(&rollup, s * 1000, &readings[s]);
+    }
+
+    // 7200秒の測定値で2時間目・121分目が始まり、直前の1時間・1分が閉じている
+    struct { int level; uint32_t start_ms; uint32_t period_ms; } cases[] = {
+        { SENSOR_ROLLUP_MINUTE, 119 * 60000u, 60000u },
+        { SENSOR_ROLLUP_HOUR, 3600000u, 3600000u },
+    };
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        sensor_rollup_bucket_t want;
+        memset(&want, 0, sizeof(want));
+        want.start_ms = cases[c].start_ms;
+        for (uint32_t s = cases[c].start_ms / 1000; s < (cases[c].start_ms + cases[c].period_ms) / 1000; s++) {
+            ref_add(&want, &readings[s]);
+        }
+        CHECK(same_bucket(&rollup.closed[cases[c].level], &want), "closed %s bucket",
+              sensor_rollup_level_name(cases[c].level));
+        CHECK(rollup.open[cases[c].level].samples == 1 && rollup.open[cases[c].level].start_ms == SECONDS * 1000u,
+              "open %s bucket", sensor_rollup_level_name(cases[c].level));
+    }
+    CHECK(rollup.open[SENSOR_ROLLUP_DAY].samples == SECONDS + 1 && rollup.closed[SENSOR_ROLLUP_DAY].samples == 0,
+          "day bucket");
+
+    // 測定値が来ないまま周期を過ぎたら、読み出し時に閉じる
+    sensor_rollup_t copy = rollup;
+    sensor_rollup_roll(&copy, SECONDS * 1000u + 60000u);
+    CHECK(copy.open[SENSOR_ROLLUP_MINUTE].samples == 0 && copy.closed[SENSOR_ROLLUP_MINUTE].samples == 1 &&
+          copy.closed[SENSOR_ROLLUP_MINUTE].start_ms == SECONDS * 1000u, "roll closes the idle minute");
+    CHECK(same_bucket(&copy.open[SENSOR_ROLLUP_HOUR], &rollup.open[SENSOR_ROLLUP_HOUR]), "roll keeps the hour");
+    printf("steady: %d readings at 1 s\n", SECONDS + 1);
+}
+
+// ==== 2つの1分境界をまたぐ65秒のバッチ ====
+static void test_batch_edges(void)
+{
+    static sensor_rollup_t rollup;
+    sensor_rollup_reset(&rollup);
+    uint32_t t0 = 10 * 60000u;
+
+    // 直前の単発の測定値（t0+30000）で、集計中の1分は t0 から
+    temp_sens_data_t data;
+    make_reading(&data, 1, 200);
+    sensor_rollup_add(&rollup, t0 + 60000 - 30000, &data);
+
+    // t0+55000 ～ t0+120000 の14件（5秒間隔）を t0+120500 に受信
+    sensor_rollup_bucket_t want[3];
+    memset(want, 0, sizeof(want));
+    ref_add(&want[0], &data);
+    for (uint32_t i = 0; i < 14; i++) {
+        uint32_t time_ms = t0 + 55000 + 5000 * i;
+        make_reading(&data, 2 + i, 210 + (int32_t)i);
+        sensor_rollup_add(&rollup, time_ms, &data);
+        ref_add(&want[(time_ms - t0) / 60000], &data);
+    }
+    want[1].start_ms = t0 + 60000;
+    want[2].start_ms = t0 + 120000;
+
+    CHECK(want[1].samples == 12 && want[2].samples == 1, "reference split %lu/%lu/%lu",
+          (unsigned long)want[0].samples, (unsigned long)want[1].samples, (unsigned long)want[2].samples);
+    CHECK(same_bucket(&rollup.closed[SENSOR_ROLLUP_MINUTE], &want[1]), "closed minute holds t0+60000..119999");
+    CHECK(same_bucket(&rollup.open[SENSOR_ROLLUP_MINUTE], &want[2]), "open minute holds t0+120000");
+    CHECK(rollup.open[SENSOR_ROLLUP_HOUR].samples == 15, "hour holds all readings");
+
+    // 閉じた周期より前の測定値は集計中へ寄せ、バケットを戻さない
+    make_reading(&data, 30, 999);
+    sensor_rollup_add(&rollup, t0 + 5000, &data);
+    ref_add(&want[2], &data);
+    CHECK(same_bucket(&rollup.open[SENSOR_ROLLUP_MINUTE], &want[2]) &&
+          same_bucket(&rollup.closed[SENSOR_ROLLUP_MINUTE], &want[1]), "older than the closed minute");
+    printf("batch edges: 65 s batch split across minute edges\n");
+}
+
+// ==== 乱数の遅れ・入れ替わりのあるバッチ ====
+typedef struct {
+    int64_t open_p;                     // 集計中の周期番号（-1=なし）
+    int64_t closed_p;                   // 直前に閉じた周期番号（-1=なし）
+    sensor_rollup_bucket_t open;
+    sensor_rollup_bucket_t closed;
+} model_level_t;
+
+static model_level_t s_model[SENSOR_ROLLUP_LEVELS];
+static unsigned long s_to_closed;       // 直前に閉じたバケットへ足し込んだ数（1分）
+static unsigned long s_to_open_late;    // 閉じた周期より前で集計中へ寄せた数（1分）
+
+static void model_add(uint32_t time_ms, const temp_sens_data_t *data)
+{
+    for (int level = 0; level < SENSOR_ROLLUP_LEVELS; level++) {
+        model_level_t *m = &s_model[level];
+        uint32_t period = sensor_rollup_period_ms((sensor_rollup_level_t)level);
+        int64_t p = time_ms / period;
+        if (m->open_p < 0 || p > m->open_p) {
+            if (m->open_p >= 0) {
+                m->closed = m->open;
+                m->closed_p = m->open_p;
+            }
+            memset(&m->open, 0, sizeof(m->open));
+            m->open.start_ms = (uint32_t)(p * period);
+            m->open_p = p;
+            ref_add(&m->open, data);
+        } else if (p < m->open_p && p == m->closed_p) {
+            ref_add(&m->closed, data);
+            s_to_closed += (level == SENSOR_ROLLUP_MINUTE);
+        } else {
+            ref_add(&m->open, data);
+            s_to_open_late += (level == SENSOR_ROLLUP_MINUTE && p < m->open_p);
+        }
+    }
+}
+
+static void test_random(uint32_t days)
+{
+    static sensor_rollup_t rollup;
+    sensor_rollup_reset(&rollup);
+    memset(s_model, 0, sizeof(s_model));
+    for (int level = 0; level < SENSOR_ROLLUP_LEVELS; level++) {
+        s_model[level].open_p = -1;
+        s_model[level].closed_p = -1;
+    }
+
+    // 子機は5秒ごとに測り、1～14件ごとにまとめて送る。一部のバッチは次のバッチの後に届く
+    uint32_t end_ms = days * 86400000u;
+    uint32_t measure_ms = 1000;
+    uint32_t seq = 0;
+    int32_t base = 250;
+    static temp_sens_data_t held[BATCH_MAX];    // 遅れて届くバッチ
+    static uint32_t held_time[BATCH_MAX];
+    size_t held_count = 0;
+    unsigned long batches = 0, readings = 0;
+
+    while (measure_ms < end_ms) {
+        size_t count = 1 + (size_t)(rand() % 14);
+        temp_sens_data_t batch[BATCH_MAX];
+        uint32_t times[BATCH_MAX];
+        for (size_t i = 0; i < count; i++) {
+            base += rand() % 5 - 2;
+            make_reading(&batch[i], ++seq, base);
+            times[i] = measure_ms;
+            measure_ms += 4900 + rand32() % 200;
+            if (rand() % 500 == 0) {
+                measure_ms += rand32() % 7200000;  // 途絶
+            }
+        }
+
+        bool hold = held_count == 0 && rand() % 5 == 0;
+        if (hold) {
+            memcpy(held, batch, count * sizeof(batch[0]));
+            memcpy(held_time, times, count * sizeof(times[0]));
+            held_count = count;
+            continue;
+        }
+        for (int pass = 0; pass < 2; pass++) {
+            const temp_sens_data_t *src = (pass == 0) ? batch : held;
+            const uint32_t *src_time = (pass == 0) ? times : held_time;
+            size_t n = (pass == 0) ? count : held_count;
+            for (size_t i = 0; i < n; i++) {
+                sensor_rollup_add(&rollup, src_time[i], &src[i]);
+                model_add(src_time[i], &src[i]);
+                readings++;
+                for (int level = 0; level < SENSOR_ROLLUP_LEVELS; level++) {
+                    if (!same_bucket(&rollup.open[level], &s_model[level].open) ||
+                        !same_bucket(&rollup.closed[level], &s_model[level].closed)) {
+                        CHECK(false, "reading %lu at %lu: %s buckets differ (open %lu/%lu, closed %lu/%lu samples)",
+                              readings, (unsigned long)src_time[i], sensor_rollup_level_name(level),
+                              (unsigned long)rollup.open[level].samples, (unsigned long)s_model[level].open.samples,
+                              (unsigned long)rollup.closed[level].samples,
+                              (unsigned long)s_model[level].closed.samples);
+                    } else {
+                        s_checks++;
+                    }
+                }
+            }
+            batches++;
+        }
+        held_count = 0;
+    }
+
+    CHECK(s_to_closed > 0 && s_to_open_late > 0, "late readings: %lu to the closed minute, %lu to the open one",
+          s_to_closed, s_to_open_late);
+    printf("random: %lu days, %lu readings, %lu late readings to the closed minute, %lu to the open minute\n",
+           (unsigned long)days, readings, s_to_closed, s_to_open_late);
+}
+
+// ==== main ====
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -d days        simulated days of batched readings (default 7, max 45)\n"
+        "  -s seed        random seed (default 1)\n",
+        prog);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long days = 7;
+    unsigned int seed = 1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "d:s:h")) != -1) {
+        switch (opt) {
+            case 'd': days = strtoul(optarg, NULL, 10); break;
+            case 's': seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (days == 0 || days > 45) {   // 周期番号の参照モデルは時刻の周回を扱わない
+        usage(argv[0]);
+        return 1;
+    }
+    srand(seed);
+
+    test_steady();
+    test_batch_edges();
+    test_random((uint32_t)days);
+
+    printf("rollup_test: %lu checks, %lu failures\n", s_checks, s_failures);
+    return (s_failures > 0) ? 1 : 0;
+}
@@ -0,0 +1,362 @@
+// tools/udp_loadgen/store_bench.c
+// 子機センサデータ格納の競合測定（ミューテックス方式とシーケンスロック方式の比較、Linux）
+//
+// 子機レジストリの公開ビュー（child_view_t: コンパクト形式 + 最終受信時刻・子機No・ACTIVE）を
+// 1つのライタ（受信処理タスク相当）と2つのリーダ（SSD1306・httpd相当）で同時に使い、
+//   - ライタ1回あたりの書き込み時間（リーダに待たされた時間を含む）
+//   - リーダ1回あたりの読み出し時間・やり直し回数
+// を分布で表示する。
+//   -m mutex:   従来方式。全員が1つのミューテックスを取り、/sensor/data は子機ごとにロックを取り直す
+//   -m seqlock: include/seqlock.h。リーダはロックを取らず、/sensor/data は全子機を1回で写す
+// -C 1 で全スレッドを1つのCPUに固定すると、ロックを持ったままリーダが横取りされた時の待ちが再現される。
+//
+// ビルド（リポジトリのルートで実行）:
+//   gcc -O2 -Wall -pthread -Iinclude -o store_bench tools/udp_loadgen/store_bench.c src/sensor_channel.c
+//
+// 実行例:
+//   ./store_bench -m mutex -n 64                    （表示100ms周期・/sensor/data 2秒周期の通常の負荷）
+//   ./store_bench -m seqlock -n 64
+//   ./store_bench -m mutex -n 64 -D 0 -W 0 -C 1     （リーダを連続で回し、1CPUで競合させる）
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include "child_registry.h"  // child_view_t（FreeRTOSに依存しない型定義のみ使用）
+#include "seqlock.h"
+
+// ==== 設定 ====
+#define MAX_CHILDREN        CHILD_REGISTRY_MAX_NODES
+#define DISPLAY_ROWS        4       // SSD1306の1ページの行数
+#define MAX_SAMPLES         (4u * 1024u * 1024u)
+
+typedef enum {
+    MODE_MUTEX = 0,
+    MODE_SEQLOCK,
+} bench_mode_t;
+
+static struct {
+    bench_mode_t mode;
+    int children;
+    uint32_t writes;
+    int display_us;     // SSD1306の読み出し周期（0=連続）
+    int http_us;        // /sensor/dataの周期（0=連続）
+    int cpus;           // 0=固定しない、1以上=CPU 0..cpus-1に固定
+} s_opt = { MODE_SEQLOCK, 64, 2000000, 100000, 2000000, 0 };
+
+typedef child_view_t entry_t;
+
+#define ENTRY_WORDS SEQLOCK_WORDS(entry_t)
+
+// ミューテックス方式
+static entry_t s_mutex_store[MAX_CHILDREN];
+static pthread_mutex_t s_store_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// シーケンスロック方式
+static _Atomic uint32_t s_seq_store[MAX_CHILDREN][ENTRY_WORDS];
+static seqlock_t s_seq_lock = SEQLOCK_INITIALIZER;
+
+static volatile bool s_done = false;
+static uint32_t s_write_contended = 0;     // ライタがリーダのロック解放を待った回数（ミューテックス方式のみ）
+
+// 読み出し側の結果
+typedef struct {
+    const char *name;
+    uint32_t *samples;      // 1回あたりの時間（ns）
+    uint32_t count;
+    uint64_t retries;
+    uint32_t max_retries;
+    uint32_t torn;          // 子機Noと値が食い違った（一貫しない状態を読んだ）回数
+} reader_result_t;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void pin_thread(int index)
+{
+    if (s_opt.cpus <= 0) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(index % s_opt.cpus, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+static void record(reader_result_t *r, uint64_t ns)
+{
+    if (r->count < MAX_SAMPLES) {
+        r->samples[r->count++] = (ns > UINT32_MAX) ? UINT32_MAX : (uint32_t)ns;
+    }
+}
+
+// 書き込む値（全チャネルを子機No・seqから求める、読み出し側で食い違いを検出できるように）
+static void make_entry(entry_t *e, uint8_t child_no, uint32_t seq)
+{
+    temp_sens_data_t data;
+    memset(&data, 0, sizeof(data));
+    for (int ch = 0; ch < SENSOR_CH_COUNT; ch++) {
+        sensor_data_set(&data, (sensor_ch_t)ch, (int64_t)((seq + (uint32_t)ch) % 1000u));
+    }
+    data.seq = seq;
+    data.rssi = -(int)(child_no % 100);
+
+    memset(e, 0, sizeof(*e));
+    sensor_data_pack(&data, &e->reading);
+    e->last_recv_ms = seq;
+    e->child_no = child_no;
+    e->has_reading = 1;
+    e->active = 1;
+}
+
+static bool entry_consistent(const entry_t *e)
+{
+    if (e->child_no == 0) {
+        return true;  // 未書き込み
+    }
+    temp_sens_data_t data;
+    sensor_data_unpack(&e->reading, &data);
+    return data.seq == e->last_recv_ms && data.rssi == -(int)(e->child_no % 100) &&
+           data.ch[0] == (int32_t)(data.seq % 1000u);
+}
+
+// ==== 書き込み・読み出し ====
+static void store_write(int slot, const entry_t *e)
+{
+    if (s_opt.mode == MODE_MUTEX) {
+        if (pthread_mutex_trylock(&s_store_mutex) != 0) {
+            s_write_contended++;
+            pthread_mutex_lock(&s_store_mutex);
+        }
+        s_mutex_store[slot] = *e;
+        pthread_mutex_unlock(&s_store_mutex);
+    } else {
+        seqlock_write_begin(&s_seq_lock);
+        seqlock_store_words(s_seq_store[slot], e, ENTRY_WORDS);
+        seqlock_write_end(&s_seq_lock);
+    }
+}
+
+// 戻り値: やり直し回数
+static uint32_t store_read(int slot, entry_t *e)
+{
+    if (s_opt.mode == MODE_MUTEX) {
+        pthread_mutex_lock(&s_store_mutex);
+        *e = s_mutex_store[slot];
+        pthread_mutex_unlock(&s_store_mutex);
+        return 0;
+    }
+    uint32_t retries = 0;
+    for (;;) {
+        uint32_t start = seqlock_read_begin(&s_seq_lock);
+        seqlock_load_words(e, s_seq_store[slot], ENTRY_WORDS);
+        if (!seqlock_read_retry(&s_seq_lock, start)) {
+            return retries;
+        }
+        retries++;
+        if (retries % 16 == 0) {
+            sched_yield();
+        }
+    }
+}
+
+// /sensor/data相当: 全子機分（従来方式は子機ごとにロックを取り直す）
+static uint32_t store_read_all(entry_t *entries)
+{
+    if (s_opt.mode == MODE_MUTEX) {
+        for (int i = 0; i < s_opt.children; i++) {
+            store_read(i, &entries[i]);
+        }
+        return 0;
+    }
+    uint32_t retries = 0;
+    for (;;) {
+        uint32_t start = seqlock_read_begin(&s_seq_lock);
+        seqlock_load_words(entries, &s_seq_store[0][0], (size_t)MAX_CHILDREN * ENTRY_WORDS);
+        if (!seqlock_read_retry(&s_seq_lock, start)) {
+            return retries;
+        }
+        retries++;
+        if (retries % 16 == 0) {
+            sched_yield();
+        }
+    }
+}
+
+// ==== スレッド ====
+static void *display_thread(void *arg)
+{
+    reader_result_t *r = (reader_result_t *)arg;
+    pin_thread(1);
+    int page = 0;
+    while (!s_done) {
+        uint64_t t0 = now_ns();
+        for (int row = 0; row < DISPLAY_ROWS; row++) {
+            entry_t e;
+            int slot = (page * DISPLAY_ROWS + row) % s_opt.children;
+            uint32_t retries = store_read(slot, &e);
+            r->retries += retries;
+            if (retries > r->max_retries) {
+                r->max_retries = retries;
+            }
+            if (!entry_consistent(&e)) {
+                r->torn++;
+            }
+        }
+        record(r, now_ns() - t0);
+        page++;
+        if (s_opt.display_us > 0) {
+            usleep((useconds_t)s_opt.display_us);
+        }
+    }
+    return NULL;
+}
+
+static void *http_thread(void *arg)
+{
+    reader_result_t *r = (reader_result_t *)arg;
+    static entry_t entries[MAX_CHILDREN];
+    pin_thread(2);
+    while (!s_done) {
+        uint64_t t0 = now_ns();
+        uint32_t retries = store_read_all(entries);
+        record(r, now_ns() - t0);
+        r->retries += retries;
+        if (retries > r->max_retries) {
+            r->max_retries = retries;
+        }
+        for (int i = 0; i < s_opt.children; i++) {
+            if (!entry_consistent(&entries[i])) {
+                r->torn++;
+            }
+        }
+        if (s_opt.http_us > 0) {
+            usleep((useconds_t)s_opt.http_us);
+        }
+    }
+    return NULL;
+}
+
+// ==== 集計 ====
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void print_dist(const char *name, uint32_t *samples, uint32_t count)
+{
+    if (count == 0) {
+        printf("%-8s n=0\n", name);
+        return;
+    }
+    qsort(samples, count, sizeof(samples[0]), cmp_u32);
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        sum += samples[i];
+    }
+    printf("%-8s n=%-8u mean=%6lluns p50=%6uns p99=%7uns p99.9=%8uns max=%9uns\n",
+           name, count, (unsigned long long)(sum / count), samples[count / 2],
+           samples[(uint32_t)((uint64_t)count * 99 / 100)], samples[(uint32_t)((uint64_t)count * 999 / 1000)],
+           samples[count - 1]);
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -m mode        mutex | seqlock (default seqlock)\n"
+        "  -n children    number of children (default 64, max %d)\n"
+        "  -N writes      number of writes (default 2000000)\n"
+        "  -D usec        display read period, 0=continuous (default 100000)\n"
+        "  -W usec        /sensor/data period, 0=continuous (default 2000000)\n"
+        "  -C cpus        pin threads to CPU 0..cpus-1 (default: not pinned)\n",
+        prog, MAX_CHILDREN);
+}
+
+int main(int argc, char **argv)
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "m:n:N:D:W:C:h")) != -1) {
+        switch (opt) {
+        case 'm':
+            if (strcmp(optarg, "mutex") == 0) {
+                s_opt.mode = MODE_MUTEX;
+            } else if (strcmp(optarg, "seqlock") == 0) {
+                s_opt.mode = MODE_SEQLOCK;
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'n': s_opt.children = atoi(optarg); break;
+        case 'N': s_opt.writes = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'D': s_opt.display_us = atoi(optarg); break;
+        case 'W': s_opt.http_us = atoi(optarg); break;
+        case 'C': s_opt.cpus = atoi(optarg); break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (s_opt.children < 1 || s_opt.children > MAX_CHILDREN || s_opt.writes == 0 || s_opt.writes > MAX_SAMPLES) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    uint32_t *write_samples = malloc(sizeof(uint32_t) * s_opt.writes);
+    reader_result_t display = { .name = "display", .samples = malloc(sizeof(uint32_t) * MAX_SAMPLES) };
+    reader_result_t http = { .name = "http", .samples = malloc(sizeof(uint32_t) * MAX_SAMPLES) };
+    if (write_samples == NULL || display.samples == NULL || http.samples == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    pthread_t th_display, th_http;
+    pthread_create(&th_display, NULL, display_thread, &display);
+    pthread_create(&th_http, NULL, http_thread, &http);
+
+    // ライタ（受信処理タスク相当）: 子機を順に更新
+    pin_thread(0);
+    uint64_t start = now_ns();
+    for (uint32_t n = 0; n < s_opt.writes; n++) {
+        int slot = (int)(n % (uint32_t)s_opt.children);
+        entry_t e;
+        make_entry(&e, (uint8_t)(slot + 1), n);
+        uint64_t t0 = now_ns();
+        store_write(slot, &e);
+        write_samples[n] = (uint32_t)(now_ns() - t0);
+    }
+    uint64_t elapsed = now_ns() - start;
+    s_done = true;
+    pthread_join(th_display, NULL);
+    pthread_join(th_http, NULL);
+
+    printf("mode=%s children=%d writes=%u display_us=%d http_us=%d cpus=%d elapsed=%.3fs (%.0f writes/s)\n",
+           s_opt.mode == MODE_MUTEX ? "mutex" : "seqlock", s_opt.children, s_opt.writes,
+           s_opt.display_us, s_opt.http_us, s_opt.cpus, elapsed / 1e9, s_opt.writes / (elapsed / 1e9));
+    print_dist("write", write_samples, s_opt.writes);
+    printf("write contended: %u (%.3f%%)\n", s_write_contended, 100.0 * s_write_contended / s_opt.writes);
+    print_dist("display", display.samples, display.count);
+    print_dist("http", http.samples, http.count);
+    printf("retries: display=%llu (max %u) http=%llu (max %u)  inconsistent reads: %u\n",
+           (unsigned long long)display.retries, display.max_retries,
+           (unsigned long long)http.retries, http.max_retries, display.torn + http.torn);
+
+    free(write_samples);
+    free(display.samples);
+    free(http.samples);
+    return (display.torn + http.torn) == 0 ? 0 : 1;
+}
@@ -0,0 +1,307 @@
+// tools/udp_loadgen/timer_wheel_test.c
+// ハッシュドタイマーホイール（src/timer_wheel.c）を単純な参照モデルと突き合わせる乱数テスト（Linux）
+//
+// 要素ごとに「設定中か・期限」だけを持つ配列を参照モデルとし、設定・付け替え・解除・時刻の前進を乱数で繰り返して
+//   - 期限を迎えた要素だけが、期限を過ぎた最初のtick境界で返ること（早すぎない・1tickより遅れない。
+//     設定した時点で過ぎていた期限は次のtick境界）
+//   - 返した要素は解除され、同じ前進で2回返らないこと、設定中の数とtimer_wheel_armed()が一致すること
+//   - timer_wheel_next_ms()の待ち時間の間に期限を迎える要素がないこと（待ちすぎない）
+// を確認する。期限は過去・数tick先・1周以内・数周先を混ぜ、時刻は小刻みな前進と1周を超える飛びを混ぜる。
+// 時刻はuint32_tの周回直前から始め、テスト中に周回をまたぐ。1件でも不一致なら終了コード1。
+//
+// ビルド（リポジトリのルートで実行）:
+//   gcc -O2 -Wall -Iinclude -o timer_wheel_test tools/udp_loadgen/timer_wheel_test.c src/timer_wheel.c
+//
+// 実行例:
+//   ./timer_wheel_test                  （1000要素、100万操作）
+//   ./timer_wheel_test -c 4000 -t 10 -n 5000000 -s 7
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <getopt.h>
+#include "timer_wheel.h"
+
+// ==== 設定 ====
+#define ENTRIES_DEFAULT     1000
+#define TICK_MS_DEFAULT     250         // CHILD_TIMER_TICK_MSと同じ
+#define START_BEFORE_WRAP   3600000u    // 開始時刻: uint32_tの周回の1時間前
+
+static unsigned long s_checks;
+static unsigned long s_failures;
+
+#define CHECK(cond, ...) do {                                       \
+        s_checks++;                                                 \
+        if (!(cond)) {                                              \
+            if (s_failures++ < 20) {                                \
+                printf("FAIL %s:%d: ", __func__, __LINE__);         \
+                printf(__VA_ARGS__);                                \
+                printf("\n");                                       \
+            }                                                       \
+        }                                                           \
+    } while (0)
+
+// 参照モデル
+typedef struct {
+    bool armed;
+    uint32_t deadline_ms;
+    uint32_t due_ms;        // 返るべきtick境界（期限を過ぎた最初の境界、過ぎていれば設定後の次の境界）
+} model_entry_t;
+
+static uint32_t rand32(void)
+{
+    return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+static bool reached(uint32_t deadline_ms, uint32_t now_ms)
+{
+    return (int32_t)(deadline_ms - now_ms) <= 0;
+}
+
+// 期限を過ぎた最初のtick境界（boundary_msは処理済みの境界、過ぎた期限は次の境界）
+static uint32_t due_boundary(uint32_t deadline_ms, uint32_t boundary_ms, uint32_t tick_ms)
+{
+    int32_t ahead = (int32_t)(deadline_ms - boundary_ms);
+    uint32_t ticks = (ahead <= 0) ? 1 : ((uint32_t)ahead + tick_ms - 1) / tick_ms;
+    return boundary_ms + ticks * tick_ms;
+}
+
+// 期限の候補（過去・数tick先・1周以内・数周先、tick境界ちょうどを多めに）
+static uint32_t pick_deadline(const timer_wheel_t *tw, uint32_t now_ms)
+{
+    uint32_t tick = tw->tick_ms;
+    uint32_t round = TIMER_WHEEL_BUCKETS * tick;
+    switch (rand() % 8) {
+        case 0: return now_ms - rand32() % (4 * tick);                  // 過去・今
+        case 1: return tw->now_ms + (uint32_t)(rand() % 8) * tick;      // tick境界ちょうど
+        case 2: return now_ms + rand32() % (4 * tick);                  // 数tick先
+        case 3: return now_ms + round - tick + rand32() % (2 * tick);   // 1周の前後
+        case 4: return now_ms + rand32() % (6 * round);                 // 数周先
+        default: return now_ms + rand32() % round;                      // 1周以内
+    }
+}
+
+// 時刻の前進（止まる・tick未満・数tick・1周を超える飛び）
+static uint32_t pick_step(const timer_wheel_t *tw)
+{
+    uint32_t tick = tw->tick_ms;
+    switch (rand() % 16) {
+        case 0: return 0;
+        case 1: return TIMER_WHEEL_BUCKETS * tick + rand32() % (3 * TIMER_WHEEL_BUCKETS * tick);
+        case 2: return tick;
+        case 3: case 4: case 5: return rand32() % tick;
+        default: return rand32() % (6 * tick);
+    }
+}
+
+// ==== 乱数テスト ====
+static void test_random(uint16_t count, uint32_t tick_ms, unsigned long ops)
+{
+    timer_wheel_entry_t *entries = calloc(count, sizeof(*entries));
+    model_entry_t *model = calloc(count, sizeof(*model));
+    uint16_t *expired = calloc(count, sizeof(*expired));
+    uint8_t *seen = calloc(count, 1);
+    if (entries == NULL || model == NULL || expired == NULL || seen == NULL) {
+        perror("calloc");
+        exit(1);
+    }
+
+    uint32_t now_ms = (uint32_t)0 - START_BEFORE_WRAP;
+    timer_wheel_t tw;
+    timer_wheel_init(&tw, entries, count, tick_ms, now_ms);
+    uint32_t armed = 0;
+    unsigned long fired = 0;
+    bool wrapped = false;
+
+    for (unsigned long n = 0; n < ops; n++) {
+        uint16_t id = (uint16_t)(rand32() % count);
+        int op = rand() % 10;
+
+        if (op < 5) {
+            // 設定・付け替え
+            uint32_t deadline = pick_deadline(&tw, now_ms);
+            timer_wheel_arm(&tw, id, deadline);
+            if (!model[id].armed) {
+                armed++;
+            }
+            model[id].armed = true;
+            model[id].deadline_ms = deadline;
+            model[id].due_ms = due_boundary(deadline, tw.now_ms, tick_ms);
+        } else if (op < 6) {
+            // 解除（未設定の解除も含む）
+            timer_wheel_cancel(&tw, id);
+            if (model[id].armed) {
+                armed--;
+            }
+            model[id].armed = false;
+        } else {
+            // 前進: 期限を過ぎた最初のtick境界（前進後のtw.now_ms）で返る
+            uint32_t prev = now_ms;
+            now_ms += pick_step(&tw);
+            wrapped |= now_ms < prev;
+            size_t got = timer_wheel_advance(&tw, now_ms, expired);
+            uint32_t boundary = tw.now_ms;
+            CHECK((int32_t)(now_ms - boundary) >= 0 && now_ms - boundary < tick_ms,
+                  "boundary %lu for now %lu", (unsigned long)boundary, (unsigned long)now_ms);
+
+            for (size_t i = 0; i < got; i++) {
+                uint16_t e = expired[i];
+                CHECK(e < count && model[e].armed && !seen[e], "entry %u returned twice or was not armed", e);
+                if (e >= count) {
+                    continue;
+                }
+                CHECK(reached(model[e].deadline_ms, boundary) && reached(model[e].due_ms, boundary),
+                      "entry %u expired early: deadline %lu, due %lu, boundary %lu", e,
+                      (unsigned long)model[e].deadline_ms, (unsigned long)model[e].due_ms,
+                      (unsigned long)boundary);
+                CHECK(!timer_wheel_armed(&tw, e), "expired entry %u still armed", e);
+                seen[e] = 1;
+                model[e].armed = false;
+                armed--;
+            }
+            // 返らなかった要素はまだ返るべき境界の前（遅れない）
+            for (uint16_t e = 0; e < count; e++) {
+                if (model[e].armed) {
+                    CHECK(!reached(model[e].due_ms, boundary),
+                          "entry %u late: deadline %lu, due %lu, boundary %lu", e,
+                          (unsigned long)model[e].deadline_ms, (unsigned long)model[e].due_ms,
+                          (unsigned long)boundary);
+                }
+            }
+            for (size_t i = 0; i < got; i++) {
+                if (expired[i] < count) {
+                    seen[expired[i]] = 0;
+                }
+            }
+            fired += got;
+
+            // 待ち時間の間に期限を迎える要素はない
+            uint32_t limit = 60000;
+            uint32_t wait = timer_wheel_next_ms(&tw, now_ms, limit);
+            CHECK(wait <= limit, "wait %lu above limit", (unsigned long)wait);
+            for (uint16_t e = 0; e < count; e++) {
+                if (!model[e].armed) {
+                    continue;
+                }
+                uint32_t due = model[e].due_ms;
+                CHECK((int32_t)(due - now_ms) >= (int32_t)wait,
+                      "entry %u due in %ld ms but wait is %lu ms", e,
+                      (long)(int32_t)(due - now_ms), (unsigned long)wait);
+            }
+        }
+
+        CHECK(tw.armed == armed, "armed %lu, model %lu", (unsigned long)tw.armed, (unsigned long)armed);
+        CHECK(timer_wheel_armed(&tw, id) == model[id].armed, "entry %u armed state", id);
+    }
+
+    // 残りを全て期限切れにする
+    for (uint16_t e = 0; e < count; e++) {
+        CHECK(timer_wheel_armed(&tw, e) == model[e].armed, "entry %u armed state at the end", e);
+    }
+    now_ms += 8 * TIMER_WHEEL_BUCKETS * tick_ms;
+    size_t got = timer_wheel_advance(&tw, now_ms, expired);
+    CHECK(got == armed && tw.armed == 0, "drain returned %zu of %lu", got, (unsigned long)armed);
+    fired += got;
+
+    CHECK(wrapped, "test did not cross the uint32_t time wrap");
+    printf("random: %u entries, tick %lu ms, %lu ops, %lu expired\n",
+           count, (unsigned long)tick_ms, ops, fired);
+
+    free(entries);
+    free(model);
+    free(expired);
+    free(seen);
+}
+
+// ==== 境界の確認 ====
+static void test_edges(void)
+{
+    timer_wheel_entry_t entries[4];
+    uint16_t expired[4];
+    timer_wheel_t tw;
+    timer_wheel_init(&tw, entries, 4, 250, 1000);
+
+    // 空のホイールはlimitまで待つ
+    CHECK(timer_wheel_next_ms(&tw, 1000, 5000) == 5000, "empty wheel waits the limit");
+
+    // 過去の期限は次のtickで返る
+    timer_wheel_arm(&tw, 0, 500);
+    CHECK(timer_wheel_next_ms(&tw, 1000, 5000) == 250, "past deadline is due next tick");
+    CHECK(timer_wheel_advance(&tw, 1249, expired) == 0, "nothing before the next tick");
+    CHECK(timer_wheel_advance(&tw, 1250, expired) == 1 && expired[0] == 0, "past deadline at the next tick");
+
+    // tick境界ちょうどの期限はその境界で返る
+    timer_wheel_arm(&tw, 1, 1750);
+    CHECK(timer_wheel_advance(&tw, 1749, expired) == 0, "not before the boundary");
+    CHECK(timer_wheel_advance(&tw, 1750, expired) == 1 && expired[0] == 1, "exactly at the boundary");
+
+    // 付け替えで前の期限は消える
+    timer_wheel_arm(&tw, 2, 2000);
+    timer_wheel_arm(&tw, 2, 90000);
+    CHECK(timer_wheel_advance(&tw, 2000, expired) == 0 && tw.armed == 1, "re-arm moves the deadline");
+
+    // 1周（64秒）を超える期限は周回を待つ
+    CHECK(timer_wheel_advance(&tw, 2000 + 64000, expired) == 0, "waits a full rotation");
+    CHECK(timer_wheel_advance(&tw, 90000, expired) == 1 && expired[0] == 2, "after the rotation");
+
+    // 解除した要素は返らない、未設定の解除・範囲外は無視
+    timer_wheel_arm(&tw, 3, 91000);
+    timer_wheel_cancel(&tw, 3);
+    timer_wheel_cancel(&tw, 3);
+    timer_wheel_arm(&tw, 4, 91000);
+    timer_wheel_cancel(&tw, 4);
+    CHECK(tw.armed == 0 && timer_wheel_advance(&tw, 95000, expired) == 0, "cancelled entries");
+
+    // 1周を超える飛びでは全要素を1回ずつ返す
+    for (uint16_t i = 0; i < 4; i++) {
+        timer_wheel_arm(&tw, i, 95000 + i * 30000u);
+    }
+    CHECK(timer_wheel_advance(&tw, 95000 + 500000, expired) == 4 && tw.armed == 0, "jump over several rotations");
+}
+
+// ==== main ====
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -c entries     wheel entries (default %d)\n"
+        "  -t tick_ms     tick width (default %d)\n"
+        "  -n ops         random operations (default 1000000)\n"
+        "  -s seed        random seed (default 1)\n",
+        prog, ENTRIES_DEFAULT, TICK_MS_DEFAULT);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long count = ENTRIES_DEFAULT;
+    unsigned long tick_ms = TICK_MS_DEFAULT;
+    unsigned long ops = 1000000;
+    unsigned int seed = 1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "c:t:n:s:h")) != -1) {
+        switch (opt) {
+            case 'c': count = strtoul(optarg, NULL, 10); break;
+            case 't': tick_ms = strtoul(optarg, NULL, 10); break;
+            case 'n': ops = strtoul(optarg, NULL, 10); break;
+            case 's': seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (count == 0 || count >= TIMER_WHEEL_NONE || tick_ms == 0 || tick_ms > 10000) {
+        usage(argv[0]);
+        return 1;
+    }
+    srand(seed);
+
+    test_edges();
+    test_random((uint16_t)count, (uint32_t)tick_ms, ops);
+
+    printf("timer_wheel_test: %lu checks, %lu failures\n", s_checks, s_failures);
+    return (s_failures > 0) ? 1 : 0;
+}
@@ -0,0 +1,603 @@
+// tools/udp_loadgen/udp_loadgen.c
+// ホスト用UDP負荷生成・エンドツーエンド遅延計測ツール（Linux）
+//
+// N台の子機を模擬してUDPポート50000へセンサーデータを送信しつつ、
+// 同時に /sensor/data をポーリングして子機ごとの遅延パーセンタイルと取りこぼし率を出力する。
+// 開始時と終了時に /sensor/stats からゲートウェイ側の受理数を取得し、その差から受信経路での欠落を求める。
+//
+// ビルド（リポジトリのルートで実行）:
+//   gcc -O2 -Wall -pthread -Iinclude -o udp_loadgen tools/udp_loadgen/udp_loadgen.c src/sensor_frame.c src/sensor_channel.c
+//
+// 実行例:
+//   ./udp_loadgen -H 192.168.4.1 -n 50 -r 2 -j 100 -l 1 -f bin -d 60
+//   ./udp_loadgen -H 127.0.0.1 -w 8080 -n 100 -r 5 -f batch -k 4   （host_gatewayに対して実行）
+//
+// 全子機を1つの送信元IPから送るため、ゲートウェイの送信元ごとのレート制限（INGEST_ADMIT_RATE_PER_SEC）を
+// 超える負荷では、事前にゲートウェイのコンソールで admit off を実行する（host_gatewayは -L 0）。
+//
+// 遅延 = 送信時刻 → ポーリングで初めてそのseqが見えた時刻。ポーリング間隔分の分解能を含む。
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "sensor_frame.h"
+
+// ==== 設定 ====
+#define MAX_CHILDREN        254
+#define SEQ_HISTORY         4096        // 送信時刻を保持するseq数（子機ごと）
+#define HTTP_BUF_SIZE       (64 * 1024)
+#define LATENCY_INIT_CAP    1024
+
+typedef enum {
+    FMT_JSON = 0,
+    FMT_BIN,
+    FMT_BATCH,
+} payload_format_t;
+
+typedef struct {
+    const char *host;
+    int udp_port;
+    int http_port;
+    int children;
+    int base_no;
+    double rate_hz;         // 子機ごとの測定レート
+    int jitter_ms;          // 送信間隔の揺らぎ（±）
+    double loss_pct;        // 模擬パケットロス率（送信しない）
+    payload_format_t format;
+    int batch_size;         // バッチフレームの測定値数
+    int duration_s;
+    int poll_ms;
+} options_t;
+
+typedef struct {
+    uint8_t child_no;
+    uint32_t seq;                       // 次に使うseq
+    uint64_t next_ns;                   // 次回測定時刻
+    temp_sens_data_t pending[SENSOR_FRAME_BATCH_MAX];
+    uint64_t pending_ns[SENSOR_FRAME_BATCH_MAX];   // 各測定値の測定時刻（バッチのage_ms用）
+    int pending_count;
+    uint32_t hist_seq[SEQ_HISTORY];     // 送信時刻表（seq % SEQ_HISTORY）
+    uint64_t hist_ns[SEQ_HISTORY];
+    // 集計（送信スレッド）
+    uint32_t readings_sent;             // 送信した測定値数
+    uint32_t readings_lost;             // 模擬ロスで送らなかった測定値数
+    uint32_t datagrams_sent;
+    long gw_rx_base;                    // 開始時のゲートウェイ受理数（-1=不明）
+    // 集計（ポーリングスレッド）
+    bool seen;
+    uint32_t last_seen_seq;
+    uint32_t updates_seen;
+    double *latency_ms;
+    size_t latency_count;
+    size_t latency_cap;
+} child_sim_t;
+
+static options_t s_opt = {
+    .host = "192.168.4.1",
+    .udp_port = 50000,
+    .http_port = 80,
+    .children = 10,
+    .base_no = 1,
+    .rate_hz = 1.0,
+    .jitter_ms = 0,
+    .loss_pct = 0.0,
+    .format = FMT_JSON,
+    .batch_size = 4,
+    .duration_s = 30,
+    .poll_ms = 100,
+};
+
+static child_sim_t *s_children;
+static pthread_mutex_t s_hist_mutex = PTHREAD_MUTEX_INITIALIZER;
+static volatile bool s_running = true;
+static uint32_t s_poll_count = 0;
+static uint32_t s_poll_errors = 0;
+
+// ==== 時刻 ====
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void sleep_until_ns(uint64_t t)
+{
+    struct timespec ts = { .tv_sec = (time_t)(t / 1000000000ull), .tv_nsec = (long)(t % 1000000000ull) };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+static uint64_t next_interval_ns(void)
+{
+    double interval_ms = 1000.0 / s_opt.rate_hz;
+    if (s_opt.jitter_ms > 0) {
+        interval_ms += (double)((rand() % (2 * s_opt.jitter_ms + 1)) - s_opt.jitter_ms);
+        if (interval_ms < 1.0) {
+            interval_ms = 1.0;
+        }
+    }
+    return (uint64_t)(interval_ms * 1e6);
+}
+
+// ==== 送信 ====
+static void make_reading(child_sim_t *c, temp_sens_data_t *d)
+{
+    memset(d, 0, sizeof(*d));
+    sensor_data_set(d, SENSOR_CH_AHT_T, 200 + (int)(c->seq % 50));
+    sensor_data_set(d, SENSOR_CH_AHT_RH, 450 + c->child_no);
+    sensor_data_set(d, SENSOR_CH_BMP_T, 198 + (int)(c->seq % 50));
+    sensor_data_set(d, SENSOR_CH_BMP_P, 101300);
+    d->seq = c->seq++;
+    d->rssi = -40 - (c->child_no % 40);
+}
+
+static size_t encode_json(uint8_t child_no, const temp_sens_data_t *d, uint8_t *buf, size_t size)
+{
+    char *out = (char *)buf;
+    int len = snprintf(out, size, "{\"child_no\":%u,", child_no);
+    if (len <= 0 || (size_t)len >= size) {
+        return 0;
+    }
+    size_t fields = sensor_data_write_json(d, out + len, size - len);
+    if (fields == 0) {
+        return 0;
+    }
+    len += (int)fields;
+    int tail = snprintf(out + len, size - len, ",\"seq\":%u,\"rssi\":%d}", d->seq, d->rssi);
+    return (tail > 0 && (size_t)(len + tail) < size) ? (size_t)(len + tail) : 0;
+}
+
+static void record_sent(child_sim_t *c, const temp_sens_data_t *d, size_t count, uint64_t t)
+{
+    pthread_mutex_lock(&s_hist_mutex);
+    for (size_t i = 0; i < count; i++) {
+        c->hist_seq[d[i].seq % SEQ_HISTORY] = d[i].seq;
+        c->hist_ns[d[i].seq % SEQ_HISTORY] = t;
+    }
+    pthread_mutex_unlock(&s_hist_mutex);
+}
+
+static void *sender_thread(void *arg)
+{
+    (void)arg;
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        perror("socket");
+        s_running = false;
+        return NULL;
+    }
+
+    struct sockaddr_in dst;
+    memset(&dst, 0, sizeof(dst));
+    dst.sin_family = AF_INET;
+    dst.sin_port = htons((uint16_t)s_opt.udp_port);
+    inet_pton(AF_INET, s_opt.host, &dst.sin_addr);
+
+    uint8_t buf[512];
+    while (s_running) {
+        // 次に測定時刻を迎える子機
+        child_sim_t *c = &s_children[0];
+        for (int i = 1; i < s_opt.children; i++) {
+            if (s_children[i].next_ns < c->next_ns) {
+                c = &s_children[i];
+            }
+        }
+        sleep_until_ns(c->next_ns);
+        c->next_ns += next_interval_ns();
+
+        temp_sens_data_t *d = &c->pending[c->pending_count];
+        make_reading(c, d);
+        c->pending_ns[c->pending_count] = now_ns();
+        int need = (s_opt.format == FMT_BATCH) ? s_opt.batch_size : 1;
+        if (++c->pending_count < need) {
+            continue;
+        }
+
+        size_t count = (size_t)c->pending_count;
+        c->pending_count = 0;
+        if (s_opt.loss_pct > 0.0 && (rand() % 10000) < (int)(s_opt.loss_pct * 100.0)) {
+            c->readings_lost += (uint32_t)count;
+            continue;
+        }
+
+        size_t len = 0;
+        uint64_t t = now_ns();
+        uint16_t age_ms[SENSOR_FRAME_BATCH_MAX];
+        for (size_t i = 0; i < count; i++) {
+            uint64_t age = (t - c->pending_ns[i]) / 1000000u;
+            age_ms[i] = (age < UINT16_MAX) ? (uint16_t)age : UINT16_MAX;
+        }
+        switch (s_opt.format) {
+        case FMT_JSON:
+            len = encode_json(c->child_no, c->pending, buf, sizeof(buf));
+            break;
+        case FMT_BIN:
+            len = sensor_frame_encode(c->child_no, c->pending, buf, sizeof(buf));
+            break;
+        case FMT_BATCH:
+            len = sensor_frame_encode_batch(c->child_no, c->pending[count - 1].rssi, c->pending, age_ms, count,
+                                            buf, sizeof(buf));
+            break;
+        }
+        if (len == 0) {
+            continue;
+        }
+
+        record_sent(c, c->pending, count, t);
+        if (sendto(sock, buf, len, 0, (struct sockaddr *)&dst, sizeof(dst)) == (ssize_t)len) {
+            c->readings_sent += (uint32_t)count;
+            c->datagrams_sent++;
+        }
+    }
+
+    close(sock);
+    return NULL;
+}
+
+// ==== HTTP取得 ====
+// GETしてボディを返す（chunked転送はデコードする）。戻り値: ボディ長、失敗時-1
+static int http_get(const char *path, char *body, size_t body_size)
+{
+    static char raw[HTTP_BUF_SIZE];
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0) {
+        return -1;
+    }
+
+    struct timeval tv = { .tv_sec = 2, .tv_usec = 0 };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    struct sockaddr_in dst;
+    memset(&dst, 0, sizeof(dst));
+    dst.sin_family = AF_INET;
+    dst.sin_port = htons((uint16_t)s_opt.http_port);
+    inet_pton(AF_INET, s_opt.host, &dst.sin_addr);
+    if (connect(sock, (struct sockaddr *)&dst, sizeof(dst)) < 0) {
+        close(sock);
+        return -1;
+    }
+
+    char req[256];
+    int req_len = snprintf(req, sizeof(req), "GET %s HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n\r\n",
+                           path, s_opt.host);
+    if (send(sock, req, (size_t)req_len, 0) != req_len) {
+        close(sock);
+        return -1;
+    }
+
+    size_t raw_len = 0;
+    ssize_t n;
+    while (raw_len < sizeof(raw) - 1 && (n = recv(sock, raw + raw_len, sizeof(raw) - 1 - raw_len, 0)) > 0) {
+        raw_len += (size_t)n;
+    }
+    close(sock);
+    raw[raw_len] = '\0';
+
+    char *hdr_end = strstr(raw, "\r\n\r\n");
+    if (hdr_end == NULL || strncmp(raw, "HTTP/1.", 7) != 0 || strncmp(raw + 9, "200", 3) != 0) {
+        return -1;
+    }
+    *hdr_end = '\0';
+    char *p = hdr_end + 4;
+    size_t out = 0;
+
+    if (strcasestr(raw, "Transfer-Encoding: chunked") == NULL) {
+        size_t len = raw_len - (size_t)(p - raw);
+        if (len >= body_size) {
+            len = body_size - 1;
+        }
+        memcpy(body, p, len);
+        body[len] = '\0';
+        return (int)len;
+    }
+
+    // chunked: "<hex>\r\n<data>\r\n" の繰り返し、サイズ0で終端
+    while (p < raw + raw_len) {
+        char *end;
+        unsigned long chunk = strtoul(p, &end, 16);
+        if (end == p || strncmp(end, "\r\n", 2) != 0) {
+            return -1;
+        }
+        p = end + 2;
+        if (chunk == 0) {
+            break;
+        }
+        if (p + chunk > raw + raw_len || out + chunk >= body_size) {
+            return -1;
+        }
+        memcpy(body + out, p, chunk);
+        out += chunk;
+        p += chunk + 2;
+    }
+    body[out] = '\0';
+    return (int)out;
+}
+
+// オブジェクト内の "key":<数値> を取得（objの範囲は次の'}'まで）
+static bool json_get_number(const char *obj, const char *key, long *value)
+{
+    char pattern[40];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    const char *end = strchr(obj, '}');
+    const char *p = strstr(obj, pattern);
+    if (p == NULL || (end != NULL && p > end)) {
+        return false;
+    }
+    *value = strtol(p + strlen(pattern), NULL, 10);
+    return true;
+}
+
+// /sensor/statsから子機の受理数を取得（-1=取得できない）
+static long stats_received(const char *stats, uint8_t child_no)
+{
+    char key[32];
+    long received;
+    snprintf(key, sizeof(key), "{\"child_no\":%u,", child_no);
+    const char *obj = strstr(stats, key);
+    if (obj == NULL || !json_get_number(obj, "received", &received)) {
+        return -1;
+    }
+    return received;
+}
+
+static child_sim_t *find_child(long child_no)
+{
+    long idx = child_no - s_opt.base_no;
+    if (idx < 0 || idx >= s_opt.children) {
+        return NULL;
+    }
+    return &s_children[idx];
+}
+
+static void add_latency(child_sim_t *c, double ms)
+{
+    if (c->latency_count == c->latency_cap) {
+        size_t cap = c->latency_cap ? c->latency_cap * 2 : LATENCY_INIT_CAP;
+        double *p = realloc(c->latency_ms, cap * sizeof(double));
+        if (p == NULL) {
+            return;
+        }
+        c->latency_ms = p;
+        c->latency_cap = cap;
+    }
+    c->latency_ms[c->latency_count++] = ms;
+}
+
+// ==== ポーリング ====
+static void *poller_thread(void *arg)
+{
+    (void)arg;
+    static char body[HTTP_BUF_SIZE];
+    uint64_t next = now_ns();
+
+    while (s_running) {
+        next += (uint64_t)s_opt.poll_ms * 1000000ull;
+        if (http_get("/sensor/data", body, sizeof(body)) < 0) {
+            s_poll_errors++;
+            sleep_until_ns(next);
+            continue;
+        }
+        uint64_t t = now_ns();
+        s_poll_count++;
+
+        for (const char *p = strstr(body, "{\"child_no\":"); p != NULL; p = strstr(p + 1, "{\"child_no\":")) {
+            long child_no, seq;
+            if (!json_get_number(p, "child_no", &child_no) || !json_get_number(p, "seq", &seq)) {
+                continue;  // valid:false
+            }
+            child_sim_t *c = find_child(child_no);
+            if (c == NULL || (c->seen && c->last_seen_seq == (uint32_t)seq)) {
+                continue;
+            }
+            c->seen = true;
+            c->last_seen_seq = (uint32_t)seq;
+            c->updates_seen++;
+
+            pthread_mutex_lock(&s_hist_mutex);
+            bool known = c->hist_seq[(uint32_t)seq % SEQ_HISTORY] == (uint32_t)seq;
+            uint64_t sent = c->hist_ns[(uint32_t)seq % SEQ_HISTORY];
+            pthread_mutex_unlock(&s_hist_mutex);
+            if (known && t >= sent) {
+                add_latency(c, (double)(t - sent) / 1e6);
+            }
+        }
+        sleep_until_ns(next);
+    }
+    return NULL;
+}
+
+// ==== 結果出力 ====
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const double *sorted, size_t n, double pct)
+{
+    if (n == 0) {
+        return 0.0;
+    }
+    size_t idx = (size_t)(pct / 100.0 * (double)(n - 1) + 0.5);
+    return sorted[idx];
+}
+
+static void report(double elapsed_s)
+{
+    static char body[HTTP_BUF_SIZE];
+    bool have_stats = http_get("/sensor/stats", body, sizeof(body)) >= 0;
+
+    printf("\n==== result: %d children, %s, %.2f Hz/child, %.1f s, poll %d ms ====\n",
+           s_opt.children,
+           s_opt.format == FMT_JSON ? "json" : s_opt.format == FMT_BIN ? "bin" : "batch",
+           s_opt.rate_hz, elapsed_s, s_opt.poll_ms);
+    printf("%5s %8s %7s %8s %8s %8s %8s %8s %8s %8s\n",
+           "child", "sent", "simloss", "gw_rx", "drop%", "updates", "p50ms", "p90ms", "p99ms", "maxms");
+
+    uint64_t tot_sent = 0, tot_lost = 0, tot_rx = 0, tot_dgram = 0;
+    size_t all_count = 0;
+    for (int i = 0; i < s_opt.children; i++) {
+        all_count += s_children[i].latency_count;
+    }
+    double *all = malloc((all_count ? all_count : 1) * sizeof(double));
+    size_t all_n = 0;
+
+    for (int i = 0; i < s_opt.children; i++) {
+        child_sim_t *c = &s_children[i];
+        qsort(c->latency_ms, c->latency_count, sizeof(double), cmp_double);
+        if (all != NULL) {
+            memcpy(all + all_n, c->latency_ms, c->latency_count * sizeof(double));
+            all_n += c->latency_count;
+        }
+
+        // 今回の実行中にゲートウェイが受理した数（開始前からの累計を差し引く）
+        long gw_rx = have_stats ? stats_received(body, c->child_no) : -1;
+        if (gw_rx >= 0 && c->gw_rx_base > 0) {
+            gw_rx -= c->gw_rx_base;
+        }
+
+        char rx_str[24] = "-", drop_str[16] = "-";
+        if (gw_rx >= 0) {
+            snprintf(rx_str, sizeof(rx_str), "%ld", gw_rx);
+            double drop = c->readings_sent ? 100.0 * ((double)c->readings_sent - (double)gw_rx) / c->readings_sent : 0.0;
+            snprintf(drop_str, sizeof(drop_str), "%.2f", drop < 0.0 ? 0.0 : drop);
+            tot_rx += (uint64_t)gw_rx;
+        }
+        printf("%5u %8u %7u %8s %8s %8u %8.1f %8.1f %8.1f %8.1f\n",
+               c->child_no, c->readings_sent, c->readings_lost, rx_str, drop_str, c->updates_seen,
+               percentile(c->latency_ms, c->latency_count, 50),
+               percentile(c->latency_ms, c->latency_count, 90),
+               percentile(c->latency_ms, c->latency_count, 99),
+               c->latency_count ? c->latency_ms[c->latency_count - 1] : 0.0);
+        tot_sent += c->readings_sent;
+        tot_lost += c->readings_lost;
+        tot_dgram += c->datagrams_sent;
+    }
+
+    if (all != NULL) {
+        qsort(all, all_n, sizeof(double), cmp_double);
+    }
+    printf("total: sent=%llu readings (%llu datagrams, %.1f dgram/s) simloss=%llu",
+           (unsigned long long)tot_sent, (unsigned long long)tot_dgram, (double)tot_dgram / elapsed_s,
+           (unsigned long long)tot_lost);
+    if (have_stats) {
+        printf(" gw_rx=%llu drop=%.2f%%", (unsigned long long)tot_rx,
+               tot_sent ? 100.0 * ((double)tot_sent - (double)tot_rx) / (double)tot_sent : 0.0);
+    } else {
+        printf(" gw_rx=- (/sensor/stats unavailable)");
+    }
+    printf("\nlatency (all): n=%zu p50=%.1f p90=%.1f p99=%.1f max=%.1f ms, polls=%u errors=%u\n",
+           all_n, percentile(all, all_n, 50), percentile(all, all_n, 90), percentile(all, all_n, 99),
+           all_n ? all[all_n - 1] : 0.0, s_poll_count, s_poll_errors);
+    free(all);
+}
+
+// ==== メイン ====
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -H host      gateway address (default 192.168.4.1)\n"
+        "  -p port      UDP port (default 50000)\n"
+        "  -w port      HTTP port (default 80)\n"
+        "  -n count     simulated children (default 10, max %d)\n"
+        "  -b no        first child_no (default 1)\n"
+        "  -r hz        readings per second per child (default 1)\n"
+        "  -j ms        send interval jitter +/- ms (default 0)\n"
+        "  -l pct       simulated packet loss %% (default 0)\n"
+        "  -f fmt       json | bin | batch (default json)\n"
+        "  -k n         readings per batch frame (default 4, max %d)\n"
+        "  -d sec       duration (default 30)\n"
+        "  -i ms        /sensor/data poll interval (default 100)\n",
+        prog, MAX_CHILDREN, SENSOR_FRAME_BATCH_MAX);
+}
+
+int main(int argc, char **argv)
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "H:p:w:n:b:r:j:l:f:k:d:i:h")) != -1) {
+        switch (opt) {
+        case 'H': s_opt.host = optarg; break;
+        case 'p': s_opt.udp_port = atoi(optarg); break;
+        case 'w': s_opt.http_port = atoi(optarg); break;
+        case 'n': s_opt.children = atoi(optarg); break;
+        case 'b': s_opt.base_no = atoi(optarg); break;
+        case 'r': s_opt.rate_hz = atof(optarg); break;
+        case 'j': s_opt.jitter_ms = atoi(optarg); break;
+        case 'l': s_opt.loss_pct = atof(optarg); break;
+        case 'f':
+            if (strcmp(optarg, "json") == 0) s_opt.format = FMT_JSON;
+            else if (strcmp(optarg, "bin") == 0) s_opt.format = FMT_BIN;
+            else if (strcmp(optarg, "batch") == 0) s_opt.format = FMT_BATCH;
+            else { usage(argv[0]); return 1; }
+            break;
+        case 'k': s_opt.batch_size = atoi(optarg); break;
+        case 'd': s_opt.duration_s = atoi(optarg); break;
+        case 'i': s_opt.poll_ms = atoi(optarg); break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+
+    if (s_opt.children < 1 || s_opt.base_no < 1 || s_opt.base_no + s_opt.children - 1 > MAX_CHILDREN ||
+        s_opt.rate_hz <= 0.0 || s_opt.batch_size < 1 || s_opt.batch_size > SENSOR_FRAME_BATCH_MAX ||
+        s_opt.duration_s < 1 || s_opt.poll_ms < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    s_children = calloc((size_t)s_opt.children, sizeof(child_sim_t));
+    if (s_children == NULL) {
+        return 1;
+    }
+    srand((unsigned int)time(NULL));
+    uint64_t start = now_ns();
+    for (int i = 0; i < s_opt.children; i++) {
+        s_children[i].child_no = (uint8_t)(s_opt.base_no + i);
+        s_children[i].seq = (uint32_t)rand() & 0xFFFF;
+        s_children[i].next_ns = start + next_interval_ns() * (uint64_t)i / (uint64_t)s_opt.children;
+        for (int h = 0; h < SEQ_HISTORY; h++) {
+            s_children[i].hist_seq[h] = UINT32_MAX;
+        }
+    }
+
+    // ゲートウェイ側の受理数の基準値
+    static char stats[HTTP_BUF_SIZE];
+    bool have_stats = http_get("/sensor/stats", stats, sizeof(stats)) >= 0;
+    for (int i = 0; i < s_opt.children; i++) {
+        s_children[i].gw_rx_base = have_stats ? stats_received(stats, s_children[i].child_no) : -1;
+    }
+
+    printf("sending to %s:%d, polling http://%s:%d/sensor/data every %d ms for %d s\n",
+           s_opt.host, s_opt.udp_port, s_opt.host, s_opt.http_port, s_opt.poll_ms, s_opt.duration_s);
+
+    pthread_t sender, poller;
+    pthread_create(&sender, NULL, sender_thread, NULL);
+    pthread_create(&poller, NULL, poller_thread, NULL);
+
+    sleep_until_ns(start + (uint64_t)s_opt.duration_s * 1000000000ull);
+    s_running = false;
+    pthread_join(sender, NULL);
+    pthread_join(poller, NULL);
+
+    // 最後の送信分がストアに反映されるのを待ってから統計を取得
+    usleep(500 * 1000);
+    report((double)(now_ns() - start) / 1e9);
+
+    for (int i = 0; i < s_opt.children; i++) {
+        free(s_children[i].latency_ms);
+    }
+    free(s_children);
+    return 0;
+}